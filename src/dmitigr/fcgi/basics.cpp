@@ -24,6 +24,7 @@
 #include <algorithm>
 #include <array>
 #include <cstddef>
+#include <cstdint>
 #include <cstring>
 #include <istream>
 #include <memory>
@@ -218,6 +219,14 @@ struct Begin_request_body final {
   /// The default constructor.
   Begin_request_body() = default;
 
+  /// The constructor.
+  Begin_request_body(const Role role, const bool is_keep_conn) noexcept
+    : role_b1_{static_cast<unsigned char>((static_cast<int>(role) >> 8) & 0xff)}
+    , role_b0_{static_cast<unsigned char>( static_cast<int>(role)       & 0xff)}
+    , flags_{static_cast<unsigned char>(is_keep_conn ?
+        static_cast<unsigned char>(Flags::keep_conn) : 0)}
+  {}
+
   /// Constructs by reading the record from `io`.
   explicit Begin_request_body(net::Descriptor* const io)
   {
@@ -265,6 +274,22 @@ struct End_request_body final {
     , protocol_status_{static_cast<unsigned char>(protocol_status)}
   {}
 
+  /// @returns The application status.
+  int application_status() const noexcept
+  {
+    return static_cast<int>(
+      (static_cast<std::uint_least32_t>(application_status_b3_) << 24) +
+      (static_cast<std::uint_least32_t>(application_status_b2_) << 16) +
+      (static_cast<std::uint_least32_t>(application_status_b1_) << 8) +
+      application_status_b0_);
+  }
+
+  /// @returns The protocol status.
+  Protocol_status protocol_status() const noexcept
+  {
+    return Protocol_status{protocol_status_};
+  }
+
 private:
   unsigned char application_status_b3_{};
   unsigned char application_status_b2_{};
@@ -477,4 +502,47 @@ private:
   std::vector<Name_value> pairs_;
 };
 
+/**
+ * @returns The get-values-result record (with padding) which contains the
+ * values of the requested `variables`. (Unknown variables are ignored.)
+ *
+ * @param max_conns The value of `FCGI_MAX_CONNS` variable.
+ * @param max_reqs The value of `FCGI_MAX_REQS` variable.
+ * @param is_multiplexing Specifies the value of `FCGI_MPXS_CONNS` variable.
+ */
+inline std::string get_values_result(const Names_values& variables,
+  const std::size_t max_conns, const std::size_t max_reqs,
+  const bool is_multiplexing)
+{
+  std::string result(sizeof(Header), '\0');
+  const auto variables_count = variables.pair_count();
+  for (std::size_t i{}; i < variables_count; ++i) {
+    const auto name = variables.pair(i).name();
+    std::string value;
+    if (name == "FCGI_MAX_CONNS")
+      value = std::to_string(max_conns);
+    else if (name == "FCGI_MAX_REQS")
+      value = std::to_string(max_reqs);
+    else if (name == "FCGI_MPXS_CONNS")
+      value = is_multiplexing ? "1" : "0";
+    else
+      continue; // Ignoring other variables specified in the get-values record.
+
+    // Note: both the name and the value of known variable are always less
+    // than 128 bytes.
+    result += static_cast<char>(name.size());
+    result += static_cast<char>(value.size());
+    result.append(name);
+    result.append(value);
+  }
+
+  const auto content_length = result.size() - sizeof(Header);
+  const auto padding_length = math::padding<std::size_t>(content_length, 8);
+  const Header header{Record_type::get_values_result, Header::null_request_id,
+    content_length, padding_length};
+  std::memcpy(result.data(), &header, sizeof(header));
+  result.append(padding_length, '\0');
+  return result;
+}
+
 } // namespace dmitigr::fcgi::detail
@@ -0,0 +1,192 @@
+// -*- C++ -*-
+//
+// Copyright 2023 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "../base/assert.hpp"
+#include "basics.hpp"
+#include "client.hpp"
+#include "exceptions.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace dmitigr::fcgi {
+
+namespace detail {
+
+/// The ID of the requests of Client_connection.
+constexpr int client_request_id{1};
+
+/// Appends the length of the name or value to `result`.
+inline void append_name_value_length(std::string& result, const std::size_t length)
+{
+  if (length <= 127)
+    result += static_cast<char>(length);
+  else if (length <= 0x7fffffff) {
+    result += static_cast<char>(((length >> 24) & 0xff) | 0x80);
+    result += static_cast<char>( (length >> 16) & 0xff);
+    result += static_cast<char>( (length >>  8) & 0xff);
+    result += static_cast<char>(  length        & 0xff);
+  } else
+    throw Exception{"too large FastCGI parameter"};
+}
+
+/// Appends the records of the stream of the given `type` to `result`.
+inline void append_stream_records(std::string& result, const Record_type type,
+  std::string_view content)
+{
+  do {
+    const auto content_length = std::min(content.size(), Header::max_content_length);
+    const Header header{type, client_request_id, content_length};
+    result.append(reinterpret_cast<const char*>(&header), sizeof(header));
+    result.append(content.data(), content_length);
+    result.append(header.padding_length(), '\0');
+    content.remove_prefix(content_length);
+  } while (!content.empty());
+}
+
+} // namespace detail
+
+DMITIGR_FCGI_INLINE Client_connection::Client_connection(net::Client_options options)
+  : options_{std::move(options)}
+  , io_{net::make_tcp_connection(options_)}
+{}
+
+DMITIGR_FCGI_INLINE const net::Client_options&
+Client_connection::options() const noexcept
+{
+  return options_;
+}
+
+DMITIGR_FCGI_INLINE bool Client_connection::is_open() const noexcept
+{
+  return static_cast<bool>(io_);
+}
+
+DMITIGR_FCGI_INLINE Response Client_connection::request(const Parameters& parameters,
+  const std::string_view in, const bool is_keep_conn, const Role role)
+{
+  if (!is_open())
+    io_ = net::make_tcp_connection(options_);
+
+  try {
+    auto result = request__(parameters, in, is_keep_conn, role);
+    if (!is_keep_conn)
+      close();
+    return result;
+  } catch (...) {
+    io_.reset();
+    throw;
+  }
+}
+
+DMITIGR_FCGI_INLINE void Client_connection::close()
+{
+  if (io_) {
+    const auto io = std::move(io_);
+    io->close();
+  }
+}
+
+DMITIGR_FCGI_INLINE Response
+Client_connection::request__(const Parameters& parameters,
+  const std::string_view in, const bool is_keep_conn, const Role role)
+{
+  DMITIGR_ASSERT(io_);
+  using detail::Header;
+  using detail::Record_type;
+
+  // Composing the request.
+  output_.clear();
+  {
+    const Header header{Record_type::begin_request, detail::client_request_id,
+      sizeof(detail::Begin_request_body), 0};
+    const detail::Begin_request_body body{role, is_keep_conn};
+    output_.append(reinterpret_cast<const char*>(&header), sizeof(header));
+    output_.append(reinterpret_cast<const char*>(&body), sizeof(body));
+  }
+  {
+    std::string params;
+    for (const auto& [name, value] : parameters) {
+      detail::append_name_value_length(params, name.size());
+      detail::append_name_value_length(params, value.size());
+      params.append(name).append(value);
+    }
+    if (!params.empty())
+      detail::append_stream_records(output_, Record_type::params, params);
+    detail::append_stream_records(output_, Record_type::params, {});
+  }
+  if (role != Role::authorizer) {
+    if (!in.empty())
+      detail::append_stream_records(output_, Record_type::in, in);
+    detail::append_stream_records(output_, Record_type::in, {});
+  }
+
+  // Sending the request.
+  for (std::string_view data{output_}; !data.empty();) {
+    const auto count = io_->write(data.data(),
+      static_cast<std::streamsize>(data.size()));
+    if (count <= 0)
+      throw Exception{"cannot send FastCGI request"};
+    data.remove_prefix(static_cast<std::size_t>(count));
+  }
+
+  // Receiving the response.
+  Response result;
+  input_.resize(Header::max_content_length + Header::max_padding_length);
+  const auto read_exactly = [this](char* buf, std::size_t len)
+  {
+    while (len) {
+      const auto count = io_->read(buf, static_cast<std::streamsize>(len));
+      if (count <= 0)
+        throw Exception{"unexpected end of FastCGI response"};
+      buf += count;
+      len -= static_cast<std::size_t>(count);
+    }
+  };
+  while (true) {
+    Header header;
+    read_exactly(reinterpret_cast<char*>(&header), sizeof(header));
+    header.check_validity();
+    const auto content_length = header.content_length();
+    read_exactly(input_.data(), content_length + header.padding_length());
+    if (header.request_id() != detail::client_request_id)
+      continue; // management record
+
+    const std::string_view content{input_.data(), content_length};
+    switch (header.record_type()) {
+    case Record_type::out:
+      result.out.append(content);
+      break;
+    case Record_type::err:
+      result.err.append(content);
+      break;
+    case Record_type::end_request: {
+      if (content_length < sizeof(detail::End_request_body))
+        throw Exception{"FastCGI protocol violation"};
+      detail::End_request_body body;
+      std::memcpy(&body, content.data(), sizeof(body));
+      if (body.protocol_status() != detail::Protocol_status::request_complete)
+        throw Exception{"FastCGI request rejected"};
+      result.application_status = body.application_status();
+      return result;
+    }
+    default:
+      throw Exception{"FastCGI protocol violation"};
+    }
+  }
+}
+
+} // namespace dmitigr::fcgi
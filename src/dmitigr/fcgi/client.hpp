@@ -0,0 +1,106 @@
+// -*- C++ -*-
+//
+// Copyright 2023 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DMITIGR_FCGI_CLIENT_HPP
+#define DMITIGR_FCGI_CLIENT_HPP
+
+#include "../net/client.hpp"
+#include "basics.hpp"
+#include "dll.hpp"
+#include "types_fwd.hpp"
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace dmitigr::fcgi {
+
+/// A response of the FastCGI application.
+struct Response final {
+  /// The application status.
+  int application_status{};
+
+  /// The content of the Stream_type::out stream.
+  std::string out;
+
+  /// The content of the Stream_type::err stream.
+  std::string err;
+};
+
+/**
+ * @brief A connection of the FastCGI client (i.e. the part of a HTTP server
+ * which communicates with the FastCGI application).
+ *
+ * @details Intended mainly for testing and benchmarking of the FastCGI
+ * applications without a HTTP server. The requests are sent one by one (i.e.
+ * without multiplexing). If the request is sent without the flag keep_conn,
+ * the connection is closed after the response, and the next request is sent
+ * over a new connection.
+ *
+ * @remarks Not thread-safe.
+ */
+class Client_connection final {
+public:
+  /// The alias of the request parameters.
+  using Parameters = std::vector<std::pair<std::string, std::string>>;
+
+  /// Constructs the connection to the FastCGI application at `options`.
+  DMITIGR_FCGI_API explicit Client_connection(net::Client_options options);
+
+  /// @returns The options of the connection.
+  DMITIGR_FCGI_API const net::Client_options& options() const noexcept;
+
+  /// @returns `true` if the connection is open.
+  DMITIGR_FCGI_API bool is_open() const noexcept;
+
+  /**
+   * @brief Sends the request and receives the response.
+   *
+   * @param parameters The request parameters.
+   * @param in The content of the Stream_type::in stream.
+   * @param is_keep_conn The value of the flag keep_conn.
+   * @param role The role of the application.
+   *
+   * @details Opens the connection if it's not open.
+   *
+   * @throws Exception if the request is rejected by the application or on
+   * error. (The connection is closed in this case.)
+   */
+  DMITIGR_FCGI_API Response request(const Parameters& parameters,
+    std::string_view in, bool is_keep_conn = true, Role role = Role::responder);
+
+  /// Closes the connection.
+  DMITIGR_FCGI_API void close();
+
+private:
+  net::Client_options options_;
+  std::unique_ptr<net::Descriptor> io_;
+  std::string output_;
+  std::string input_;
+
+  Response request__(const Parameters& parameters, std::string_view in,
+    bool is_keep_conn, Role role);
+};
+
+} // namespace dmitigr::fcgi
+
+#ifndef DMITIGR_FCGI_NOT_HEADER_ONLY
+#include "client.cpp"
+#endif
+
+#endif  // DMITIGR_FCGI_CLIENT_HPP
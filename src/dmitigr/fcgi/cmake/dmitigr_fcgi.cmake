@@ -26,10 +26,12 @@ dmitigr_libs_set_library_info(fcgi 1 0 0 "FastCGI library")
 
 set(dmitigr_fcgi_headers
   basics.hpp
+  client.hpp
   connection.hpp
   exceptions.hpp
   listener.hpp
   listener_options.hpp
+  server.hpp
   server_connection.hpp
   streambuf.hpp
   streams.hpp
@@ -38,10 +40,13 @@ set(dmitigr_fcgi_headers
 
 set(dmitigr_fcgi_implementations
   basics.cpp
+  client.cpp
   listener.cpp
   listener_options.cpp
+  multiplexer.cpp
+  server.cpp
   server_connection.cpp
-  server_connection_stacked.cpp
+  server_connection_pooled.cpp
   streambuf.cpp
   streams.cpp
   )
@@ -57,6 +62,7 @@ set(dmitigr_libs_fcgi_deps base net)
 # ------------------------------------------------------------------------------
 
 if(DMITIGR_LIBS_TESTS)
-  set(dmitigr_fcgi_tests hello hellomt largesend overload)
+  set(dmitigr_fcgi_tests benchmark directsend echo hello hellompx hellomt largesend overload server)
   set(dmitigr_fcgi_tests_target_link_libraries dmitigr_base)
+  set(dmitigr_fcgi_test_benchmark_target_link_libraries dmitigr_prg)
 endif()
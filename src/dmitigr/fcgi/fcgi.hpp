@@ -19,11 +19,13 @@
 
 #include "types_fwd.hpp"
 #include "basics.hpp"
+#include "client.hpp"
 #include "connection.hpp"
 #include "exceptions.hpp"
 #include "lib_version.hpp"
 #include "listener.hpp"
 #include "listener_options.hpp"
+#include "server.hpp"
 #include "server_connection.hpp"
 #include "streambuf.hpp"
 #include "streams.hpp"
@@ -19,14 +19,52 @@
 #include "basics.hpp"
 #include "exceptions.hpp"
 #include "listener.hpp"
-#include "server_connection_stacked.cpp"
+#include "multiplexer.cpp"
+#include "server_connection_pooled.cpp"
+
+#include <algorithm>
+#include <mutex>
+#include <vector>
+
+#ifndef _WIN32
+#include <poll.h>
+#endif
 
 namespace dmitigr::fcgi {
 
+#ifdef _WIN32
+namespace detail {
+
+/**
+ * @brief The interval of polling while the handles to poll might be changed
+ * by other threads.
+ *
+ * @details Neither the records of new requests read by the threads of
+ * requests nor the connections kept alive by the completed requests can wake
+ * up the Listener on Windows, so the Listener checks for them periodically.
+ */
+constexpr std::chrono::milliseconds wakeup_poll_interval{10};
+
+} // namespace detail
+#endif
+
 DMITIGR_FCGI_INLINE Listener::Listener(Listener_options options)
   : listener_{net::Listener::make(options.options_)}
   , listener_options_{std::move(options)}
-{}
+  , buffer_pools_{std::make_shared<detail::Buffer_pools>(listener_options_)}
+{
+#ifdef _WIN32
+  if (listener_options_.endpoint().communication_mode() ==
+    net::Communication_mode::wnp)
+    return;
+#endif
+  if (listener_options_.is_multiplexing_enabled())
+    multiplexers_ = std::make_shared<detail::Multiplexers>(
+      listener_options_.max_request_count(),
+      listener_options_.max_request_input_size());
+  else
+    kept_connections_ = std::make_shared<detail::Kept_connections>();
+}
 
 DMITIGR_FCGI_INLINE const Listener_options& Listener::options() const noexcept
 {
@@ -45,13 +83,52 @@ DMITIGR_FCGI_INLINE void Listener::listen()
 
 DMITIGR_FCGI_INLINE bool Listener::wait(const std::chrono::milliseconds timeout)
 {
-  return listener_->wait(timeout);
+  return static_cast<bool>(wait__(timeout));
 }
 
 DMITIGR_FCGI_INLINE std::unique_ptr<Server_connection> Listener::accept()
 {
-  auto io = listener_->accept();
-  detail::Header header{io.get()};
+  std::unique_ptr<net::Descriptor> io;
+  detail::Header header;
+  while (!io) {
+    if (multiplexers_) {
+      if (const auto request = multiplexers_->take_pending_request()) {
+        const auto& [multiplexer, pending] = *request;
+        return std::make_unique<detail::pooled_buffers_Server_connection>(
+          std::make_unique<detail::mpx_Descriptor>(multiplexer, pending),
+          pending.role, pending.request_id, pending.is_keep_conn,
+          *buffer_pools_);
+      }
+    }
+
+    const auto handle = wait__(std::chrono::milliseconds{-1});
+    DMITIGR_ASSERT(handle);
+    if (*handle == listener_->native_handle()) {
+      io = listener_->accept();
+      if (multiplexers_) {
+        // The records will be read as soon as they are available.
+        multiplexers_->put(std::make_shared<detail::Multiplexer>(std::move(io),
+            multiplexers_->context()));
+        continue;
+      }
+      header = detail::Header{io.get()};
+    } else if (multiplexers_) {
+      if (const auto multiplexer = multiplexers_->find(*handle))
+        multiplexer->route_available_record();
+    } else if ((io = kept_connections_->take(*handle))) {
+      // The client is free to close the connection kept alive at any time.
+      std::streamsize count{};
+      try {
+        count = io->read(reinterpret_cast<char*>(&header), sizeof(header));
+      } catch (const std::exception&) {}
+      if (!count)
+        io.reset();
+      else if (count != sizeof(header))
+        throw Exception{"FastCGI protocol violation"};
+      else
+        header.check_validity();
+    }
+  }
 
   const auto end_request = [&](const detail::Protocol_status protocol_status)
   {
@@ -69,8 +146,9 @@ DMITIGR_FCGI_INLINE std::unique_ptr<Server_connection> Listener::accept()
     const auto role = body.role();
     if (role == Role::responder ||
       role == Role::authorizer || role == Role::filter) {
-      return std::make_unique<detail::stack_buffers_Server_connection>(
-        std::move(io), role, header.request_id(), body.is_keep_conn());
+      return std::make_unique<detail::pooled_buffers_Server_connection>(
+        std::move(io), role, header.request_id(), body.is_keep_conn(),
+        *buffer_pools_, kept_connections_);
     } else {
       // This is a protocol violation.
       end_request(detail::Protocol_status::unknown_role);
@@ -90,6 +168,126 @@ DMITIGR_FCGI_INLINE std::unique_ptr<Server_connection> Listener::accept()
 DMITIGR_FCGI_INLINE void Listener::close()
 {
   listener_->close();
+  if (kept_connections_)
+    kept_connections_->clear();
+  else if (multiplexers_)
+    multiplexers_->clear();
+}
+
+DMITIGR_FCGI_INLINE std::optional<std::intptr_t>
+Listener::wait__(const std::chrono::milliseconds timeout)
+{
+  using std::chrono::milliseconds;
+  using Clock = std::chrono::steady_clock;
+
+  if (!is_listening())
+    throw Exception{"cannot wait for connection if listener is not listening"};
+  else if (!(timeout >= milliseconds{-1}))
+    throw Exception{"invalid timeout for wait operation"};
+
+  const auto listener_handle = listener_->native_handle();
+  const auto started = Clock::now();
+  const auto rest_of_timeout = [&]
+  {
+    return timeout < milliseconds::zero() ? timeout :
+      std::max(milliseconds::zero(), timeout -
+        std::chrono::duration_cast<milliseconds>(Clock::now() - started));
+  };
+
+#ifndef _WIN32
+  // The changes of the handles to poll are signaled via the wakeup.
+  detail::Wakeup* const wakeup = kept_connections_ ?
+    &kept_connections_->wakeup() : multiplexers_ ?
+    &multiplexers_->context()->wakeup() : nullptr;
+  std::unique_lock<std::timed_mutex> lock;
+  if (wakeup) {
+    lock = std::unique_lock{wakeup->mutex(), std::defer_lock};
+    if (timeout < milliseconds::zero())
+      lock.lock();
+    else if (!lock.try_lock_for(timeout))
+      return std::nullopt;
+  }
+#endif
+
+  while (true) {
+#ifndef _WIN32
+    // The changes made by other threads from now on wake up poll().
+    if (wakeup)
+      wakeup->arm();
+#endif
+
+    // The handles of connections kept alive or multiplexed.
+    std::vector<std::intptr_t> kept;
+    bool has_requests{};
+    if (kept_connections_)
+      kept = kept_connections_->handles();
+    else if (multiplexers_) {
+      if (const auto handle = multiplexers_->pending_request_handle())
+        return handle;
+      kept = multiplexers_->handles(has_requests);
+    }
+
+#ifdef _WIN32
+    if (kept.empty() && !has_requests && !kept_connections_)
+      return listener_->wait(timeout) ?
+        std::optional<std::intptr_t>{listener_handle} : std::nullopt;
+
+    // Nothing wakes up the Listener on Windows, so it polls periodically.
+    const bool is_periodic = has_requests || kept_connections_;
+    auto poll_timeout = rest_of_timeout();
+    if (is_periodic && (poll_timeout < milliseconds::zero() ||
+        poll_timeout > detail::wakeup_poll_interval))
+      poll_timeout = detail::wakeup_poll_interval;
+    using Pollfd = WSAPOLLFD;
+#else
+    if (!wakeup)
+      return listener_->wait(timeout) ?
+        std::optional<std::intptr_t>{listener_handle} : std::nullopt;
+
+    const bool is_periodic{};
+    const auto poll_timeout = rest_of_timeout();
+    using Pollfd = pollfd;
+#endif
+    std::vector<Pollfd> fds(kept.size() + 1);
+    for (std::size_t i{}; i < kept.size(); ++i) {
+      fds[i].fd = static_cast<net::Socket_native>(kept[i]);
+      fds[i].events = POLLIN;
+    }
+    fds.back().fd = static_cast<net::Socket_native>(listener_handle);
+    fds.back().events = POLLIN;
+#ifndef _WIN32
+    fds.push_back({wakeup->native_handle(), POLLIN, 0});
+#endif
+
+#ifdef _WIN32
+    const int r = ::WSAPoll(fds.data(), static_cast<ULONG>(fds.size()),
+      static_cast<INT>(poll_timeout.count()));
+#else
+    const int r = ::poll(fds.data(), static_cast<nfds_t>(fds.size()),
+      static_cast<int>(poll_timeout.count()));
+#endif
+    if (net::is_socket_error(r)) {
+      // Resume the wait with the rest of the timeout if interrupted.
+#ifdef _WIN32
+      if (net::last_error() != WSAEINTR)
+#else
+      if (net::last_error() != EINTR)
+#endif
+        throw DMITIGR_NET_EXCEPTION{"cannot poll sockets of FastCGI listener"};
+    } else if (r > 0) {
+      // The connections kept alive (or multiplexed) are preferred.
+      for (std::size_t i{}; i <= kept.size(); ++i) {
+        if (fds[i].revents)
+          return i < kept.size() ? kept[i] : listener_handle;
+      }
+      // Woken up by another thread, so the handles are changed.
+      DMITIGR_ASSERT(fds.size() > kept.size() + 1);
+    } else if (!is_periodic)
+      return std::nullopt;
+
+    if (timeout >= milliseconds::zero() && Clock::now() - started >= timeout)
+      return std::nullopt;
+  }
 }
 
 } // namespace dmitigr::fcgi
@@ -22,10 +22,31 @@
 #include "types_fwd.hpp"
 
 #include <chrono>
+#include <cstdint>
+#include <memory>
+#include <optional>
 
 namespace dmitigr::fcgi {
 
-/// A FastCGI listener.
+/**
+ * @brief A FastCGI listener.
+ *
+ * @details If the FastCGI client (e.g. a HTTP server) requests to keep the
+ * connection open after responding to the request, the connection is passed
+ * back to the listener upon the destruction of the Server_connection, and
+ * the subsequent wait() and accept() are consider the connections kept alive
+ * as well as the new ones.
+ *
+ * If the multiplexing is enabled, each of the concurrent requests over the same
+ * connection is accepted as the separate Server_connection (which can be
+ * processed in a separate thread), and the connections are kept alive as long
+ * as the FastCGI client wants.
+ *
+ * @remarks Neither the keeping of the connections alive nor the multiplexing
+ * is supported for Windows Named Pipes.
+ *
+ * @see Listener_options::set_multiplexing_enabled().
+ */
 class Listener final {
 public:
   /// Constructs the listener.
@@ -51,8 +72,8 @@ public:
    * @param timeout Maximum amount of time to wait before return. A special
    * value of `-1` denotes "eternity".
    *
-   * @returns `true` if the connection is ready to be accepted before
-   * the `timeout` elapses.
+   * @returns `true` if the connection (either new or kept alive) is ready to
+   * be accepted before the `timeout` elapses.
    *
    * @par Requires
    * `is_listening()`.
@@ -66,6 +87,11 @@ public:
    * @brief Accepts a FastCGI connection, or rejects it in case of a
    * protocol violation.
    *
+   * @details The connections kept alive are preferred over the new ones. The
+   * connections kept alive which are closed by the client are discarded.
+   * If the multiplexing is enabled, the requests with unknown roles are
+   * rejected without throwing.
+   *
    * @returns An instance of the accepted FastCGI connection.
    *
    * @par Requires
@@ -77,12 +103,17 @@ public:
    */
   DMITIGR_FCGI_API std::unique_ptr<Server_connection> accept();
 
-  /// Stops listening.
+  /// Stops listening and closes the connections kept alive.
   DMITIGR_FCGI_API void close();
 
 private:
   std::unique_ptr<net::Listener> listener_;
   Listener_options listener_options_;
+  std::shared_ptr<detail::Buffer_pools> buffer_pools_;
+  std::shared_ptr<detail::Kept_connections> kept_connections_;
+  std::shared_ptr<detail::Multiplexers> multiplexers_;
+
+  std::optional<std::intptr_t> wait__(std::chrono::milliseconds timeout);
 };
 
 } // namespace dmitigr::fcgi
@@ -14,10 +14,25 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include "exceptions.hpp"
 #include "listener_options.hpp"
 
+#include <string>
+
 namespace dmitigr::fcgi {
 
+namespace detail {
+
+/// Throws if `size` is not valid size of the stream buffer.
+inline void check_buffer_size(const std::size_t size, const char* const what)
+{
+  if (!(2048 <= size && size <= 65528))
+    throw Exception{std::string{"invalid size of FastCGI "}.append(what)
+      .append(" buffer")};
+}
+
+} // namespace detail
+
 #ifdef _WIN32
 DMITIGR_FCGI_INLINE Listener_options::Listener_options(std::string pipe_name)
   : options_{std::move(pipe_name)}
@@ -32,7 +47,9 @@ DMITIGR_FCGI_INLINE Listener_options::Listener_options(std::filesystem::path pat
 DMITIGR_FCGI_INLINE Listener_options::Listener_options(std::string address,
   const int port, const int backlog)
   : options_{std::move(address), port, backlog}
-{}
+{
+  options_.set_no_delay_enabled(true);
+}
 
 DMITIGR_FCGI_INLINE const net::Endpoint& Listener_options::endpoint() const noexcept
 {
@@ -44,4 +61,123 @@ DMITIGR_FCGI_INLINE std::optional<int> Listener_options::backlog() const noexcep
   return options_.backlog();
 }
 
+DMITIGR_FCGI_INLINE Listener_options&
+Listener_options::set_multiplexing_enabled(const bool value) noexcept
+{
+  is_multiplexing_enabled_ = value;
+  return *this;
+}
+
+DMITIGR_FCGI_INLINE bool Listener_options::is_multiplexing_enabled() const noexcept
+{
+  return is_multiplexing_enabled_;
+}
+
+DMITIGR_FCGI_INLINE Listener_options&
+Listener_options::set_max_request_count(const std::size_t count)
+{
+  if (!count)
+    throw Exception{"invalid maximum number of FastCGI requests"};
+  max_request_count_ = count;
+  return *this;
+}
+
+DMITIGR_FCGI_INLINE std::size_t Listener_options::max_request_count() const noexcept
+{
+  return max_request_count_;
+}
+
+DMITIGR_FCGI_INLINE Listener_options&
+Listener_options::set_max_request_input_size(const std::size_t size)
+{
+  if (!size)
+    throw Exception{"invalid maximum size of FastCGI request input"};
+  max_request_input_size_ = size;
+  return *this;
+}
+
+DMITIGR_FCGI_INLINE std::size_t
+Listener_options::max_request_input_size() const noexcept
+{
+  return max_request_input_size_;
+}
+
+DMITIGR_FCGI_INLINE Listener_options&
+Listener_options::set_in_buffer_size(const std::size_t size)
+{
+  detail::check_buffer_size(size, "input");
+  in_buffer_size_ = size;
+  return *this;
+}
+
+DMITIGR_FCGI_INLINE std::size_t Listener_options::in_buffer_size() const noexcept
+{
+  return in_buffer_size_;
+}
+
+DMITIGR_FCGI_INLINE Listener_options&
+Listener_options::set_out_buffer_size(const std::size_t size)
+{
+  detail::check_buffer_size(size, "output");
+  out_buffer_size_ = size;
+  return *this;
+}
+
+DMITIGR_FCGI_INLINE std::size_t Listener_options::out_buffer_size() const noexcept
+{
+  return out_buffer_size_;
+}
+
+DMITIGR_FCGI_INLINE Listener_options&
+Listener_options::set_err_buffer_size(const std::size_t size)
+{
+  detail::check_buffer_size(size, "error");
+  err_buffer_size_ = size;
+  return *this;
+}
+
+DMITIGR_FCGI_INLINE std::size_t Listener_options::err_buffer_size() const noexcept
+{
+  return err_buffer_size_;
+}
+
+DMITIGR_FCGI_INLINE Listener_options&
+Listener_options::set_no_delay_enabled(const bool value) noexcept
+{
+  options_.set_no_delay_enabled(value);
+  return *this;
+}
+
+DMITIGR_FCGI_INLINE bool Listener_options::is_no_delay_enabled() const noexcept
+{
+  return options_.is_no_delay_enabled();
+}
+
+DMITIGR_FCGI_INLINE Listener_options&
+Listener_options::set_defer_accept(
+  const std::optional<std::chrono::seconds> timeout) noexcept
+{
+  options_.set_defer_accept(timeout);
+  return *this;
+}
+
+DMITIGR_FCGI_INLINE std::optional<std::chrono::seconds>
+Listener_options::defer_accept() const noexcept
+{
+  return options_.defer_accept();
+}
+
+DMITIGR_FCGI_INLINE Listener_options&
+Listener_options::set_fast_open_queue_size(const std::optional<int> size)
+{
+  options_.set_fast_open_queue_size(size);
+  return *this;
+}
+
+DMITIGR_FCGI_INLINE std::optional<int>
+Listener_options::fast_open_queue_size() const noexcept
+{
+  return options_.fast_open_queue_size();
+}
+
 } // namespace dmitigr::fcgi
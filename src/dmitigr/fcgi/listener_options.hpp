@@ -21,6 +21,8 @@
 #include "dll.hpp"
 #include "types_fwd.hpp"
 
+#include <chrono>
+#include <cstddef>
 #include <filesystem>
 #include <optional>
 #include <string>
@@ -83,10 +85,157 @@ public:
    */
   DMITIGR_FCGI_API std::optional<int> backlog() const noexcept;
 
+  /**
+   * @brief Sets the option of the multiplexing of the requests.
+   *
+   * @details If enabled, the concurrent requests over the same connection are
+   * accepted as the independent Server_connection instances, and the value of
+   * `FCGI_MPXS_CONNS` variable is reported as `1` in the get-values-result
+   * records.
+   *
+   * @remarks The multiplexing is not supported for Windows Named Pipes.
+   *
+   * @see is_multiplexing_enabled(), set_max_request_count().
+   */
+  DMITIGR_FCGI_API Listener_options& set_multiplexing_enabled(bool value) noexcept;
+
+  /// @returns `true` if the multiplexing of the requests is enabled.
+  DMITIGR_FCGI_API bool is_multiplexing_enabled() const noexcept;
+
+  /**
+   * @brief Sets the maximum number of the concurrent requests over all the
+   * multiplexed connections, or over all the connections of the Server.
+   *
+   * @details The requests begun in excess of this limit are rejected with the
+   * protocol status `FCGI_OVERLOADED`. The value is reported as the values of
+   * both `FCGI_MAX_REQS` and `FCGI_MAX_CONNS` variables in the
+   * get-values-result records. Has no effect on the Listener if the
+   * multiplexing is disabled.
+   *
+   * @par Requires
+   * `count > 0`.
+   *
+   * @see max_request_count().
+   */
+  DMITIGR_FCGI_API Listener_options& set_max_request_count(std::size_t count);
+
+  /// @returns The maximum number of the concurrent multiplexed requests.
+  DMITIGR_FCGI_API std::size_t max_request_count() const noexcept;
+
+  /**
+   * @brief Sets the maximum size of the buffered input of the request.
+   *
+   * @details The size of the input is the total size of the records of the
+   * parameters and the input streams of the request which are received but
+   * not yet read. (The Server reads the input after receiving it entirely.)
+   * The request which input exceeds this limit is ended with the protocol
+   * status `FCGI_OVERLOADED`, and the subsequent reading of its input and
+   * writing of its output are failing. Has no effect on the Listener if the
+   * multiplexing is disabled, since the input is read directly from the
+   * connection then.
+   *
+   * @par Requires
+   * `size > 0`.
+   *
+   * @see max_request_input_size().
+   */
+  DMITIGR_FCGI_API Listener_options& set_max_request_input_size(std::size_t size);
+
+  /// @returns The maximum size of the buffered input of the request.
+  DMITIGR_FCGI_API std::size_t max_request_input_size() const noexcept;
+
+  /**
+   * @brief Sets the size of the buffer of the input stream of connections.
+   *
+   * @par Requires
+   * `2048 <= size && size <= 65528`.
+   *
+   * @see in_buffer_size().
+   */
+  DMITIGR_FCGI_API Listener_options& set_in_buffer_size(std::size_t size);
+
+  /// @returns The size of the buffer of the input stream of connections.
+  DMITIGR_FCGI_API std::size_t in_buffer_size() const noexcept;
+
+  /**
+   * @brief Sets the size of the buffer of the output stream of connections.
+   *
+   * @details The larger the buffer, the fewer records are transmitted.
+   *
+   * @par Requires
+   * `2048 <= size && size <= 65528`.
+   *
+   * @see out_buffer_size().
+   */
+  DMITIGR_FCGI_API Listener_options& set_out_buffer_size(std::size_t size);
+
+  /// @returns The size of the buffer of the output stream of connections.
+  DMITIGR_FCGI_API std::size_t out_buffer_size() const noexcept;
+
+  /**
+   * @brief Sets the size of the buffer of the error stream of connections.
+   *
+   * @remarks The buffer is allocated upon the first use of the error stream.
+   *
+   * @par Requires
+   * `2048 <= size && size <= 65528`.
+   *
+   * @see err_buffer_size().
+   */
+  DMITIGR_FCGI_API Listener_options& set_err_buffer_size(std::size_t size);
+
+  /// @returns The size of the buffer of the error stream of connections.
+  DMITIGR_FCGI_API std::size_t err_buffer_size() const noexcept;
+
+  /**
+   * @brief Sets the option which disables the Nagle's algorithm on the
+   * accepted connections.
+   *
+   * @details Enabled by default, since the output is already coalesced into
+   * the records by the streams, and delaying of the last records of the
+   * response just increases the latency.
+   *
+   * @see net::Listener_options::set_no_delay_enabled().
+   */
+  DMITIGR_FCGI_API Listener_options& set_no_delay_enabled(bool value) noexcept;
+
+  /// @returns `true` if the Nagle's algorithm is disabled.
+  DMITIGR_FCGI_API bool is_no_delay_enabled() const noexcept;
+
+  /**
+   * @brief Sets the option which defers the acceptance of the connection
+   * until the first record arrives, but no longer than `timeout`.
+   *
+   * @see net::Listener_options::set_defer_accept().
+   */
+  DMITIGR_FCGI_API Listener_options& set_defer_accept(
+    std::optional<std::chrono::seconds> timeout) noexcept;
+
+  /// @returns The timeout of the deferred acceptance.
+  DMITIGR_FCGI_API std::optional<std::chrono::seconds> defer_accept() const noexcept;
+
+  /**
+   * @brief Sets the option which enables the TCP Fast Open.
+   *
+   * @see net::Listener_options::set_fast_open_queue_size().
+   */
+  DMITIGR_FCGI_API Listener_options& set_fast_open_queue_size(
+    std::optional<int> size);
+
+  /// @returns The size of the queue of pending TCP Fast Open requests.
+  DMITIGR_FCGI_API std::optional<int> fast_open_queue_size() const noexcept;
+
 private:
   friend Listener;
+  friend Server;
 
   net::Listener_options options_;
+  bool is_multiplexing_enabled_{};
+  std::size_t max_request_count_{1024};
+  std::size_t max_request_input_size_{16777216};
+  std::size_t in_buffer_size_{16384};
+  std::size_t out_buffer_size_{65528};
+  std::size_t err_buffer_size_{65528};
 };
 
 } // namespace dmitigr::fcgi
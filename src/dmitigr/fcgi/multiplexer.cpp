@@ -0,0 +1,901 @@
+// -*- C++ -*-
+//
+// Copyright 2023 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "../base/assert.hpp"
+#include "../net/descriptor.hpp"
+#include "basics.hpp"
+#include "exceptions.hpp"
+#include "server_connection.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace dmitigr::fcgi::detail {
+
+/**
+ * @brief The state shared by the multiplexed connections of the Listener.
+ *
+ * @remarks Thread-safe.
+ */
+class Multiplexer_context final {
+public:
+  /// The constructor.
+  Multiplexer_context(const std::size_t max_request_count,
+    const std::size_t max_request_input_size)
+    : max_request_count_{max_request_count}
+    , max_request_input_size_{max_request_input_size}
+  {
+    DMITIGR_ASSERT(max_request_count_ > 0 && max_request_input_size_ > 0);
+  }
+
+  /// @returns The maximum number of the concurrent requests.
+  std::size_t max_request_count() const noexcept
+  {
+    return max_request_count_;
+  }
+
+  /// @returns The maximum size of the unread input of the request.
+  std::size_t max_request_input_size() const noexcept
+  {
+    return max_request_input_size_;
+  }
+
+  /**
+   * @brief Counts the new request.
+   *
+   * @returns `false` if the maximum number of the concurrent requests is
+   * already reached.
+   */
+  bool begin_request() noexcept
+  {
+    auto count = request_count_.load();
+    do {
+      if (count >= max_request_count_)
+        return false;
+    } while (!request_count_.compare_exchange_weak(count, count + 1));
+    return true;
+  }
+
+  /// Uncounts the `count` requests.
+  void end_requests(const std::size_t count = 1) noexcept
+  {
+    DMITIGR_ASSERT(request_count_.load() >= count);
+    request_count_ -= count;
+  }
+
+#ifndef _WIN32
+  /// @returns The wakeup of the Listener.
+  Wakeup& wakeup() noexcept
+  {
+    return wakeup_;
+  }
+#endif
+
+private:
+  const std::size_t max_request_count_{};
+  const std::size_t max_request_input_size_{};
+  std::atomic<std::size_t> request_count_{};
+#ifndef _WIN32
+  Wakeup wakeup_;
+#endif
+};
+
+/**
+ * @brief A FastCGI connection shared by the concurrent requests.
+ *
+ * @details The records are read by the thread which needs them at the moment
+ * (either the thread of a request or the thread of the Listener) and routed
+ * to the input queues of the requests by the request IDs, while the other
+ * threads are waiting for the records to be routed to them. The management
+ * records are processed by the router. The records are written under the
+ * lock, so the records of different requests are never interleaved.
+ *
+ * The connection is closed as soon as the last request is completed after
+ * either the end of input, or completion of the request without the flag
+ * Begin_request_body::Flags::keep_conn.
+ *
+ * The begin-request records with IDs of the active requests are ignored. The
+ * ID of the request is released as soon as the end-request record of the
+ * request is about to be written (see release_id()), since the FastCGI client
+ * is free to reuse the ID right after receiving this record.
+ *
+ * @remarks Thread-safe.
+ */
+class Multiplexer final {
+public:
+  /// The input of the request.
+  struct Input final {
+    std::string data;
+    std::string::size_type offset{};
+    bool is_overflowed{}; // guarded by both mutex_ and write_mutex_
+  };
+
+  /// A request which is begun but not yet accepted.
+  struct Pending_request final {
+    /// The request ID.
+    int request_id{};
+
+    /// The role.
+    Role role{};
+
+    /// The value of Begin_request_body::Flags::keep_conn flag.
+    bool is_keep_conn{};
+
+    /// The input of the request.
+    std::shared_ptr<Input> input;
+  };
+
+  /// The destructor.
+  ~Multiplexer()
+  {
+    // The requests which are never accepted.
+    context_->end_requests(pending_.size());
+  }
+
+  /// The constructor.
+  Multiplexer(std::unique_ptr<net::Descriptor> io,
+    std::shared_ptr<Multiplexer_context> context)
+    : io_{std::move(io)}
+    , native_handle_{io_ ? io_->native_handle() : -1}
+    , context_{std::move(context)}
+  {
+    DMITIGR_ASSERT(io_ && context_);
+  }
+
+  /// Non copy-constructible.
+  Multiplexer(const Multiplexer&) = delete;
+
+  /// Non copy-assignable.
+  Multiplexer& operator=(const Multiplexer&) = delete;
+
+  /// Non move-constructible.
+  Multiplexer(Multiplexer&&) = delete;
+
+  /// Non move-assignable.
+  Multiplexer& operator=(Multiplexer&&) = delete;
+
+  /// @returns The native handle of the underlying descriptor.
+  std::intptr_t native_handle() const noexcept
+  {
+    return native_handle_;
+  }
+
+  /// @returns `true` if the underlying descriptor is closed.
+  bool is_closed() const
+  {
+    const std::lock_guard lg{mutex_};
+    return !io_;
+  }
+
+  /// @returns `true` if there are requests which are not yet completed.
+  bool has_requests() const
+  {
+    const std::lock_guard lg{mutex_};
+    return active_request_count_ > 0;
+  }
+
+  /// @returns `true` if there are requests which are not yet accepted.
+  bool has_pending_requests() const
+  {
+    const std::lock_guard lg{mutex_};
+    return !pending_.empty();
+  }
+
+  /**
+   * @returns `true` if the underlying descriptor should be polled by the
+   * Listener, i.e. the input is not ended and no one is reading it now.
+   */
+  bool is_pollable() const
+  {
+    const std::lock_guard lg{mutex_};
+    return io_ && !is_eof_ && !is_reading_;
+  }
+
+  /// @returns The next request which is not yet accepted.
+  std::optional<Pending_request> take_pending_request()
+  {
+    const std::lock_guard lg{mutex_};
+    if (pending_.empty())
+      return std::nullopt;
+
+    const auto result = pending_.front();
+    pending_.pop_front();
+    return result;
+  }
+
+  /**
+   * @brief Reads and routes the next record if it's available.
+   *
+   * @returns `false` if the input is being read by another thread or if
+   * there is no input available.
+   *
+   * @remarks Any error results in the end of input.
+   */
+  bool route_available_record() noexcept
+  {
+    try {
+      std::unique_lock lock{mutex_};
+      if (!io_ || is_eof_ || is_reading_)
+        return false;
+
+      using Sr = net::Socket_readiness;
+      const auto mask = net::poll(static_cast<net::Socket_native>(native_handle_),
+        Sr::read_ready, std::chrono::milliseconds{});
+      if (!bool(mask & Sr::read_ready))
+        return false;
+
+      is_reading_ = true;
+      route__(lock);
+      return true;
+    } catch (const std::exception& e) {
+      std::clog << "error upon reading FastCGI connection: " << e.what() << '\n';
+    } catch (...) {
+      std::clog << "unknown error upon reading FastCGI connection\n";
+    }
+    return true;
+  }
+
+  /**
+   * @brief Reads the records of the `request`.
+   *
+   * @returns The number of bytes read, or `0` at the end of input.
+   *
+   * @par Requires
+   * The request must not be completed.
+   */
+  std::streamsize read(const Pending_request& request, char* const buf,
+    const std::streamsize len)
+  {
+    DMITIGR_ASSERT(request.input && buf && len > 0);
+    std::unique_lock lock{mutex_};
+    auto& input = *request.input;
+    while (true) {
+      if (input.is_overflowed)
+        throw Exception{"FastCGI request ended due to input overflow"};
+      else if (input.offset < input.data.size()) {
+        const auto count = std::min(input.data.size() - input.offset,
+          static_cast<std::size_t>(len));
+        std::memcpy(buf, input.data.data() + input.offset, count);
+        input.offset += count;
+        if (input.offset == input.data.size()) {
+          input.data.clear();
+          input.offset = 0;
+        }
+        return static_cast<std::streamsize>(count);
+      } else if (is_eof_)
+        return 0;
+      else if (!is_reading_) {
+        is_reading_ = true;
+        route__(lock);
+      } else
+        routed_.wait(lock);
+    }
+  }
+
+  /// Writes the records of `len` bytes of the `request`.
+  void write(const Pending_request& request, const char* const buf,
+    const std::streamsize len)
+  {
+    DMITIGR_ASSERT(buf && len >= 0);
+    const std::lock_guard lg{write_mutex_};
+    if (check_writable__(&request))
+      write__(buf, len);
+  }
+
+  /// Writes the records of `count` buffers of the `request`.
+  void writev(const Pending_request& request, const std::string_view* bufs,
+    std::size_t count)
+  {
+    DMITIGR_ASSERT(bufs || !count);
+    const std::lock_guard lg{write_mutex_};
+    if (!check_writable__(&request))
+      return;
+
+    while (count) {
+      auto written = io_->writev(bufs, count);
+      for (; count && static_cast<std::size_t>(written) >= bufs->size();
+           ++bufs, --count)
+        written -= static_cast<std::streamsize>(bufs->size());
+      if (count && written) {
+        const auto rest = bufs->substr(static_cast<std::size_t>(written));
+        for (std::size_t offset{}; offset < rest.size();)
+          offset += static_cast<std::size_t>(io_->write(rest.data() + offset,
+            static_cast<std::streamsize>(rest.size() - offset)));
+        ++bufs;
+        --count;
+      }
+    }
+  }
+
+  /// Writes the record of the `request` with the content from the file.
+  void send_file(const Pending_request& request, const int fd,
+    const std::int64_t offset, const std::size_t size,
+    const std::string_view header, const std::string_view trailer)
+  {
+    const std::lock_guard lg{write_mutex_};
+    if (check_writable__(&request))
+      io_->send_file(fd, offset, size, header, trailer);
+  }
+
+  /**
+   * @brief Releases the ID of the `request`, so the subsequent begin-request
+   * record with this ID begins the new request.
+   *
+   * @details Must be called before writing the end-request record of the
+   * `request`. The records with the released ID which are read after this
+   * call are not routed to the `request`.
+   */
+  void release_id(const Pending_request& request)
+  {
+    const std::lock_guard lg{mutex_};
+    release_id__(request);
+  }
+
+  /**
+   * @brief Completes the `request`.
+   *
+   * @details The input of the request that has not been read is discarded.
+   *
+   * @par Effects
+   * The effects of release_id().
+   */
+  void complete(const Pending_request& request)
+  {
+    std::unique_lock lock{mutex_};
+    release_id__(request);
+    DMITIGR_ASSERT(active_request_count_ > 0);
+    --active_request_count_;
+    context_->end_requests();
+    if (!request.is_keep_conn)
+      is_closing_ = true;
+    close_if_done__(lock);
+  }
+
+private:
+  mutable std::mutex mutex_;
+  std::condition_variable routed_;
+  std::mutex write_mutex_;
+  std::unique_ptr<net::Descriptor> io_;
+  const std::intptr_t native_handle_{};
+  std::shared_ptr<Multiplexer_context> context_;
+  std::map<int, std::shared_ptr<Input>> requests_;
+  std::deque<Pending_request> pending_;
+  int active_request_count_{};
+  bool is_reading_{};
+  bool is_eof_{};
+  bool is_closing_{};
+
+  /**
+   * @brief Reads the next record and routes it to the request.
+   *
+   * @par Requires
+   * `lock` must own `mutex_`, `is_reading_`.
+   *
+   * @par Effects
+   * `lock` owns `mutex_`, `!is_reading_`.
+   */
+  void route__(std::unique_lock<std::mutex>& lock)
+  {
+    DMITIGR_ASSERT(lock.owns_lock() && is_reading_);
+    lock.unlock();
+
+    Header header;
+    std::string record;
+    bool is_read{};
+    std::optional<Pending_request> begun;
+    try {
+      if ((is_read = read_record(header, record))) {
+        if (header.is_management_record())
+          process_management_record(header, record);
+        else if (header.record_type() == Record_type::begin_request)
+          begun = process_begin_request_record(header, record);
+      }
+    } catch (...) {
+      lock.lock();
+      is_eof_ = true;
+      stop_reading__(lock);
+      throw;
+    }
+
+    lock.lock();
+    if (!is_read)
+      is_eof_ = true;
+    else if (begun) {
+      // Begin-request with ID of an active request is ignored.
+      if (!is_closing_ && !requests_.count(begun->request_id)) {
+        begun->input = std::make_shared<Input>();
+        requests_.emplace(begun->request_id, begun->input);
+        pending_.push_back(std::move(*begun));
+        ++active_request_count_;
+      } else
+        context_->end_requests();
+    } else if (!header.is_management_record()) {
+      if (const auto i = requests_.find(header.request_id());
+        i != end(requests_)) {
+        auto& input = *i->second;
+        if (record.size() > context_->max_request_input_size() -
+          std::min(input.data.size() - input.offset,
+            context_->max_request_input_size())) {
+          try {
+            end_overflowed__(i);
+          } catch (...) {
+            is_eof_ = true;
+            stop_reading__(lock);
+            throw;
+          }
+        } else if (input.data.empty())
+          input.data = std::move(record);
+        else
+          input.data.append(record);
+      }
+    }
+    stop_reading__(lock);
+  }
+
+  /**
+   * @brief Resets `is_reading_` and wakes up the waiting threads including
+   * the Listener, since both the pending requests and the pollability of this
+   * instance are changed.
+   */
+  void stop_reading__(std::unique_lock<std::mutex>& lock)
+  {
+    DMITIGR_ASSERT(lock.owns_lock());
+    is_reading_ = false;
+    routed_.notify_all();
+#ifndef _WIN32
+    context_->wakeup().signal();
+#endif
+    close_if_done__(lock);
+  }
+
+  /**
+   * @returns `false` if the output of the `request` (if any) must be
+   * discarded, since the request is already ended by end_overflowed__().
+   *
+   * @par Requires
+   * `write_mutex_` must be locked.
+   */
+  bool check_writable__(const Pending_request* const request) const
+  {
+    if (!io_)
+      throw Exception{"cannot write to closed FastCGI connection"};
+    return !request || !request->input->is_overflowed;
+  }
+
+  /// Writes `len` bytes. (The `write_mutex_` must be locked.)
+  void write__(const char* const buf, const std::streamsize len)
+  {
+    for (std::streamsize offset{}; offset < len;)
+      offset += io_->write(buf + offset, len - offset);
+  }
+
+  /// Writes the management record of `len` bytes.
+  void write(const char* const buf, const std::streamsize len)
+  {
+    const std::lock_guard lg{write_mutex_};
+    if (check_writable__(nullptr))
+      write__(buf, len);
+  }
+
+  /**
+   * @brief Ends the request which unread input would exceed the limit with
+   * the protocol status `FCGI_OVERLOADED`.
+   *
+   * @details The request which is not yet accepted is discarded. The reading
+   * of the input of the accepted one is failing, and its output is discarded.
+   *
+   * @par Requires
+   * `mutex_` must be locked.
+   */
+  void end_overflowed__(const decltype(requests_)::iterator i)
+  {
+    const auto request_id = i->first;
+    const auto input = std::move(i->second);
+    requests_.erase(i);
+    input->data.clear();
+    input->data.shrink_to_fit();
+    input->offset = 0;
+    if (const auto p = find_if(begin(pending_), end(pending_),
+        [&input](const auto& r){return r.input == input;}); p != end(pending_)) {
+      pending_.erase(p);
+      DMITIGR_ASSERT(active_request_count_ > 0);
+      --active_request_count_;
+      context_->end_requests();
+    }
+
+    const std::lock_guard lg{write_mutex_};
+    input->is_overflowed = true;
+    if (io_) {
+      const End_request_record record{request_id, 0, Protocol_status::overloaded};
+      write__(reinterpret_cast<const char*>(&record), sizeof(record));
+    }
+  }
+
+  /// Releases the ID of the `request` if it's not yet released.
+  void release_id__(const Pending_request& request) noexcept
+  {
+    if (const auto i = requests_.find(request.request_id);
+      i != end(requests_) && i->second == request.input)
+      requests_.erase(i);
+  }
+
+  /**
+   * @brief Closes the underlying descriptor if all the requests are completed
+   * and no more requests are expected.
+   *
+   * @par Requires
+   * `lock` must own `mutex_`.
+   *
+   * @par Effects
+   * `lock` owns `mutex_`.
+   */
+  void close_if_done__(std::unique_lock<std::mutex>& lock) noexcept
+  {
+    DMITIGR_ASSERT(lock.owns_lock());
+    if (io_ && !is_reading_ && !active_request_count_ && (is_eof_ || is_closing_)) {
+      is_eof_ = true;
+      auto io = std::move(io_);
+      // The graceful shutdown of the socket may take a while.
+      lock.unlock();
+      io.reset();
+      lock.lock();
+    }
+  }
+
+  /**
+   * @brief Reads the entire record.
+   *
+   * @returns `false` at the end of input.
+   */
+  bool read_record(Header& header, std::string& record)
+  {
+    if (!read_exactly(reinterpret_cast<char*>(&header), sizeof(header)))
+      return false;
+
+    header.check_validity();
+    const auto length = header.content_length() + header.padding_length();
+    record.resize(sizeof(header) + length);
+    std::memcpy(record.data(), &header, sizeof(header));
+    if (!read_exactly(record.data() + sizeof(header), length))
+      throw Exception{"FastCGI protocol violation"};
+
+    return true;
+  }
+
+  /**
+   * @brief Reads exactly `size` bytes.
+   *
+   * @returns `false` if the end of input reached before the first byte.
+   */
+  bool read_exactly(char* const buf, const std::size_t size)
+  {
+    for (std::size_t offset{}; offset < size;) {
+      const auto count = io_->read(buf + offset,
+        static_cast<std::streamsize>(size - offset));
+      if (count > 0)
+        offset += static_cast<std::size_t>(count);
+      else if (!offset)
+        return false;
+      else
+        throw Exception{"FastCGI protocol violation"};
+    }
+    return true;
+  }
+
+  /// Responds with either get-values-result or unknown-type record.
+  void process_management_record(const Header& header,
+    const std::string& record)
+  {
+    if (header.record_type() == Record_type::get_values) {
+      std::istringstream stream{record.substr(sizeof(header),
+        header.content_length())};
+      const auto max_count = context_->max_request_count();
+      const auto result = get_values_result(Names_values{stream, 3},
+        max_count, max_count, true);
+      write(result.data(), static_cast<std::streamsize>(result.size()));
+    } else {
+      const Unknown_type_record result{header.record_type()};
+      write(reinterpret_cast<const char*>(&result), sizeof(result));
+    }
+  }
+
+  /**
+   * @returns The request to accept (which is counted by the context), or
+   * `std::nullopt` if the request is rejected.
+   */
+  std::optional<Pending_request>
+  process_begin_request_record(const Header& header, const std::string& record)
+  {
+    if (header.content_length() != sizeof(Begin_request_body))
+      throw Exception{"FastCGI protocol violation"};
+
+    Begin_request_body body;
+    std::memcpy(&body, record.data() + sizeof(header), sizeof(body));
+    const auto role = body.role();
+    auto status = Protocol_status::unknown_role;
+    if (role == Role::responder ||
+      role == Role::authorizer || role == Role::filter) {
+      if (context_->begin_request())
+        return Pending_request{header.request_id(), role, body.is_keep_conn(), {}};
+      status = Protocol_status::overloaded;
+    }
+
+    const End_request_record result{header.request_id(), 0, status};
+    write(reinterpret_cast<const char*>(&result), sizeof(result));
+    return std::nullopt;
+  }
+};
+
+/**
+ * @brief The descriptor of the request over the Multiplexer.
+ *
+ * @details Reads only the records of the request, releases the ID of the
+ * request before writing its end-request record, and completes the request
+ * upon close.
+ */
+class mpx_Descriptor final : public net::detail::iDescriptor {
+public:
+  ~mpx_Descriptor() override
+  {
+    try {
+      close();
+    } catch (const std::exception& e) {
+      std::clog << "error upon closing FastCGI request: " << e.what() << '\n';
+    } catch (...) {
+      std::clog << "unknown error upon closing FastCGI request\n";
+    }
+  }
+
+  /// The constructor.
+  mpx_Descriptor(std::shared_ptr<Multiplexer> multiplexer,
+    const Multiplexer::Pending_request& request)
+    : multiplexer_{std::move(multiplexer)}
+    , request_{request}
+  {
+    DMITIGR_ASSERT(multiplexer_);
+  }
+
+  std::streamsize read(char* const buf, const std::streamsize len) override
+  {
+    if (!multiplexer_)
+      throw Exception{"cannot read from completed FastCGI request"};
+    return multiplexer_->read(request_, buf, len);
+  }
+
+  std::streamsize write(const char* const buf, const std::streamsize len) override
+  {
+    if (!multiplexer_)
+      throw Exception{"cannot write to completed FastCGI request"};
+    track_output({buf, static_cast<std::size_t>(len)});
+    multiplexer_->write(request_, buf, len);
+    return len;
+  }
+
+  std::streamsize writev(const std::string_view* const bufs,
+    const std::size_t count) override
+  {
+    if (!multiplexer_)
+      throw Exception{"cannot write to completed FastCGI request"};
+    for (std::size_t i{}; i < count; ++i)
+      track_output(bufs[i]);
+    multiplexer_->writev(request_, bufs, count);
+    std::streamsize result{};
+    for (std::size_t i{}; i < count; ++i)
+      result += static_cast<std::streamsize>(bufs[i].size());
+    return result;
+  }
+
+  void send_file(const int fd, const std::int64_t offset,
+    const std::size_t size, const std::string_view header,
+    const std::string_view trailer) override
+  {
+    if (!multiplexer_)
+      throw Exception{"cannot write to completed FastCGI request"};
+    track_output(header);
+    track_output({}, size);
+    track_output(trailer);
+    multiplexer_->send_file(request_, fd, offset, size, header, trailer);
+  }
+
+  void close() override
+  {
+    if (multiplexer_) {
+      const auto multiplexer = std::move(multiplexer_);
+      multiplexer->complete(request_);
+    }
+  }
+
+  std::intptr_t native_handle() noexcept override
+  {
+    return multiplexer_ ? multiplexer_->native_handle() : -1;
+  }
+
+private:
+  std::shared_ptr<Multiplexer> multiplexer_;
+  Multiplexer::Pending_request request_;
+
+  std::array<char, sizeof(Header)> output_header_{};
+  std::size_t output_header_size_{};
+  std::size_t output_record_rest_{};
+
+  /**
+   * @brief Follows the boundaries of the output records through the entire
+   * output of the request, and releases the ID of the request as soon as the
+   * header of its end-request record is about to be written.
+   *
+   * @param data The next portion of the output.
+   * @param opaque_size The size of the next portion of the output which is
+   * not available in memory (e.g. the content sent from file).
+   *
+   * @remarks The bytes of the contents of the records are never interpreted
+   * as the headers, regardless of how the output is split into the calls.
+   */
+  void track_output(std::string_view data, std::size_t opaque_size = 0)
+  {
+    DMITIGR_ASSERT(data.empty() || !opaque_size);
+    while (!data.empty() || opaque_size) {
+      if (output_record_rest_) {
+        const auto count = std::min(output_record_rest_,
+          data.empty() ? opaque_size : data.size());
+        output_record_rest_ -= count;
+        if (data.empty())
+          opaque_size -= count;
+        else
+          data.remove_prefix(count);
+        continue;
+      } else if (opaque_size)
+        throw Exception{"cannot write FastCGI record content without header"};
+
+      const auto count = std::min(sizeof(Header) - output_header_size_,
+        data.size());
+      std::memcpy(output_header_.data() + output_header_size_, data.data(),
+        count);
+      output_header_size_ += count;
+      data.remove_prefix(count);
+      if (output_header_size_ == sizeof(Header)) {
+        Header header;
+        std::memcpy(&header, output_header_.data(), sizeof(header));
+        output_header_size_ = 0;
+        output_record_rest_ = header.content_length() + header.padding_length();
+        if (header.record_type() == Record_type::end_request &&
+          header.request_id() == request_.request_id)
+          multiplexer_->release_id(request_);
+      }
+    }
+  }
+};
+
+/**
+ * @brief The connections of the Listener with the multiplexing enabled.
+ *
+ * @remarks Thread-safe.
+ */
+class Multiplexers final {
+public:
+  /// The constructor.
+  Multiplexers(const std::size_t max_request_count,
+    const std::size_t max_request_input_size)
+    : context_{std::make_shared<Multiplexer_context>(max_request_count,
+        max_request_input_size)}
+  {}
+
+  /// @returns The context to construct the multiplexers with.
+  const std::shared_ptr<Multiplexer_context>& context() const noexcept
+  {
+    return context_;
+  }
+
+  /// Puts the `multiplexer` to this instance.
+  void put(std::shared_ptr<Multiplexer> multiplexer)
+  {
+    DMITIGR_ASSERT(multiplexer);
+    const std::lock_guard lg{mutex_};
+    multiplexers_.push_back(std::move(multiplexer));
+  }
+
+  /// @returns The opened multiplexer with the specified native `handle`.
+  std::shared_ptr<Multiplexer> find(const std::intptr_t handle) const
+  {
+    const std::lock_guard lg{mutex_};
+    const auto e = cend(multiplexers_);
+    const auto i = find_if(cbegin(multiplexers_), e, [handle](const auto& m)
+    {
+      return m->native_handle() == handle && !m->is_closed();
+    });
+    return i != e ? *i : nullptr;
+  }
+
+  /// @returns The native handle of the multiplexer with a pending request.
+  std::optional<std::intptr_t> pending_request_handle() const
+  {
+    const std::lock_guard lg{mutex_};
+    for (const auto& m : multiplexers_) {
+      if (m->has_pending_requests())
+        return m->native_handle();
+    }
+    return std::nullopt;
+  }
+
+  /// @returns The next request which is not yet accepted.
+  std::optional<std::pair<std::shared_ptr<Multiplexer>, Multiplexer::Pending_request>>
+  take_pending_request()
+  {
+    const std::lock_guard lg{mutex_};
+    for (const auto& m : multiplexers_) {
+      if (auto request = m->take_pending_request())
+        return std::make_pair(m, *request);
+    }
+    return std::nullopt;
+  }
+
+  /**
+   * @brief Removes the closed multiplexers.
+   *
+   * @param[out] has_requests Set to `true` if there are multiplexers which
+   * input can be read by the threads of requests.
+   *
+   * @returns The native handles of the multiplexers to poll.
+   */
+  std::vector<std::intptr_t> handles(bool& has_requests)
+  {
+    std::vector<std::intptr_t> result;
+    has_requests = false;
+    const std::lock_guard lg{mutex_};
+    multiplexers_.erase(remove_if(begin(multiplexers_), end(multiplexers_),
+      [](const auto& m){return m->is_closed();}), end(multiplexers_));
+    result.reserve(multiplexers_.size());
+    for (const auto& m : multiplexers_) {
+      if (m->is_pollable())
+        result.push_back(m->native_handle());
+      if (m->has_requests())
+        has_requests = true;
+    }
+    return result;
+  }
+
+  /// Removes all the multiplexers.
+  void clear() noexcept
+  {
+    decltype(multiplexers_) multiplexers;
+    {
+      const std::lock_guard lg{mutex_};
+      multiplexers.swap(multiplexers_);
+    }
+  }
+
+private:
+  mutable std::mutex mutex_;
+  std::shared_ptr<Multiplexer_context> context_;
+  std::vector<std::shared_ptr<Multiplexer>> multiplexers_;
+};
+
+} // namespace dmitigr::fcgi::detail
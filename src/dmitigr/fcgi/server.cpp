@@ -0,0 +1,808 @@
+// -*- C++ -*-
+//
+// Copyright 2023 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "../base/assert.hpp"
+#include "../base/thread.hpp"
+#include "../net/descriptor.hpp"
+#include "../net/listener.hpp"
+#include "../net/reactor.hpp"
+#include "basics.hpp"
+#include "exceptions.hpp"
+#include "server.hpp"
+#include "server_connection_pooled.cpp"
+
+#ifdef __linux__
+
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+
+#include <poll.h>
+#include <sys/sendfile.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace dmitigr::fcgi::detail {
+
+/// A request which input is entirely received.
+struct Received_request final {
+  /// The request ID.
+  int request_id{};
+
+  /// The role.
+  Role role{};
+
+  /// The value of Begin_request_body::Flags::keep_conn flag.
+  bool is_keep_conn{};
+
+  /// The records of the parameters and the input streams of the request.
+  std::string records;
+};
+
+/**
+ * @brief The counter of the concurrent requests of the Server.
+ *
+ * @remarks Thread-safe.
+ */
+class Request_counter final {
+public:
+  /// The constructor.
+  explicit Request_counter(const std::size_t max_count)
+    : max_count_{max_count}
+  {
+    DMITIGR_ASSERT(max_count_ > 0);
+  }
+
+  /// @returns The maximum number of the concurrent requests.
+  std::size_t max_count() const noexcept
+  {
+    return max_count_;
+  }
+
+  /**
+   * @brief Counts the new request.
+   *
+   * @returns `false` if the maximum number of the concurrent requests is
+   * already reached.
+   */
+  bool increment() noexcept
+  {
+    auto count = count_.load();
+    do {
+      if (count >= max_count_)
+        return false;
+    } while (!count_.compare_exchange_weak(count, count + 1));
+    return true;
+  }
+
+  /// Uncounts the `count` requests.
+  void decrement(const std::size_t count = 1) noexcept
+  {
+    DMITIGR_ASSERT(count_.load() >= count);
+    count_ -= count;
+  }
+
+private:
+  const std::size_t max_count_{};
+  std::atomic<std::size_t> count_{};
+};
+
+/**
+ * @brief A connection served by the Reactor.
+ *
+ * @details The input is read and parsed by the Reactor only, while the output
+ * is written by the threads which are processing the requests. The requests
+ * are counted from the begin-request record until the completion.
+ */
+class Reactor_connection final {
+public:
+  /// The destructor.
+  ~Reactor_connection()
+  {
+    // The requests which input is never received entirely.
+    requests_counter_->decrement(requests_.size());
+  }
+
+  /**
+   * @brief The constructor.
+   *
+   * @param socket The accepted socket.
+   * @param requests_counter The counter of the concurrent requests.
+   * @param max_request_input_size The maximum size of the records of the
+   * parameters and the input streams of the request.
+   */
+  Reactor_connection(net::Socket_guard socket,
+    std::shared_ptr<Request_counter> requests_counter,
+    const std::size_t max_request_input_size)
+    : socket_{std::move(socket)}
+    , requests_counter_{std::move(requests_counter)}
+    , max_request_input_size_{max_request_input_size}
+  {
+    DMITIGR_ASSERT(net::is_socket_valid(socket_) && requests_counter_ &&
+      max_request_input_size_);
+  }
+
+  /// Non copy-constructible.
+  Reactor_connection(const Reactor_connection&) = delete;
+
+  /// Non copy-assignable.
+  Reactor_connection& operator=(const Reactor_connection&) = delete;
+
+  /// Non move-constructible.
+  Reactor_connection(Reactor_connection&&) = delete;
+
+  /// Non move-assignable.
+  Reactor_connection& operator=(Reactor_connection&&) = delete;
+
+  /// @returns The underlying socket.
+  net::Socket_native socket() const noexcept
+  {
+    return socket_;
+  }
+
+  /**
+   * @brief Reads the available input (until the read would block) and
+   * parses the records.
+   *
+   * @param buffer The buffer to read into.
+   * @param size The size of `buffer`.
+   * @param[out] received The requests which input is entirely received.
+   *
+   * @returns `false` at the end of input.
+   */
+  bool read(char* const buffer, const std::size_t size,
+    std::vector<Received_request>& received)
+  {
+    DMITIGR_ASSERT(buffer && size);
+    while (true) {
+      const auto count = ::recv(socket_, buffer, size, 0);
+      if (count < 0) {
+        if (errno == EINTR)
+          continue;
+        else if (errno == EAGAIN)
+          return true;
+        throw DMITIGR_NET_EXCEPTION{"cannot read from socket"};
+      } else if (!count)
+        return false;
+
+      /*
+       * Only the incomplete record is kept between the reads, so the size of
+       * `input_` never exceeds the sum of the maximum record size and `size`.
+       */
+      std::string_view input{buffer, static_cast<std::size_t>(count)};
+      if (!input_.empty()) {
+        input_.append(input);
+        input = input_;
+      }
+      while (input.size() >= sizeof(Header)) {
+        Header header;
+        std::memcpy(&header, input.data(), sizeof(header));
+        header.check_validity();
+        const auto record_size = sizeof(header) + header.content_length() +
+          header.padding_length();
+        if (input.size() < record_size)
+          break;
+
+        process_record(header, input.substr(0, record_size), received);
+        input.remove_prefix(record_size);
+      }
+      input_ = std::string{input};
+    }
+  }
+
+  /// Writes the records of `len` bytes.
+  void write(const char* const buf, const std::streamsize len)
+  {
+    DMITIGR_ASSERT(buf && len >= 0);
+    const std::lock_guard lg{write_mutex_};
+    write__(buf, len, 0);
+  }
+
+  /// Writes the records of `count` buffers.
+  void writev(const std::string_view* bufs, std::size_t count)
+  {
+    DMITIGR_ASSERT(bufs || !count);
+    const std::lock_guard lg{write_mutex_};
+    std::array<::iovec, 64> iov;
+    while (count) {
+      std::size_t iov_count{};
+      for (; iov_count < iov.size() && iov_count < count; ++iov_count)
+        iov[iov_count] = {const_cast<char*>(bufs[iov_count].data()),
+          bufs[iov_count].size()};
+      bufs += iov_count;
+      count -= iov_count;
+
+      for (auto* iov_begin = iov.data(); iov_count;) {
+        if (!iov_begin->iov_len) {
+          ++iov_begin;
+          --iov_count;
+          continue;
+        }
+
+        ::msghdr msg{};
+        msg.msg_iov = iov_begin;
+        msg.msg_iovlen = iov_count;
+        const auto sent = ::sendmsg(socket_, &msg, MSG_NOSIGNAL);
+        if (sent >= 0) {
+          for (auto n = static_cast<std::size_t>(sent); n;) {
+            if (n >= iov_begin->iov_len) {
+              n -= iov_begin->iov_len;
+              ++iov_begin;
+              --iov_count;
+            } else {
+              iov_begin->iov_base = static_cast<char*>(iov_begin->iov_base) + n;
+              iov_begin->iov_len -= n;
+              n = 0;
+            }
+          }
+        } else
+          wait_writable();
+      }
+    }
+  }
+
+  /// Writes the record with the content from the file.
+  void send_file(const int fd, const std::int64_t offset, std::size_t size,
+    const std::string_view header, const std::string_view trailer)
+  {
+    const std::lock_guard lg{write_mutex_};
+    write__(header.data(), static_cast<std::streamsize>(header.size()),
+      size || !trailer.empty() ? MSG_MORE : 0);
+    for (auto off = static_cast<off_t>(offset); size;) {
+      const auto sent = ::sendfile(socket_, fd, &off, size);
+      if (sent > 0)
+        size -= static_cast<std::size_t>(sent);
+      else if (!sent)
+        throw Exception{"cannot send file to socket: unexpected end of file"};
+      else
+        wait_writable();
+    }
+    write__(trailer.data(), static_cast<std::streamsize>(trailer.size()), 0);
+  }
+
+  /**
+   * @brief Completes the request dispatched by the Reactor.
+   *
+   * @details Shutdowns the sending side of the connection if the request
+   * without the flag Begin_request_body::Flags::keep_conn is completed and
+   * there are no other requests being processed. (The connection is closed
+   * by the Reactor as soon as the FastCGI client closes it.)
+   */
+  void complete(const bool is_keep_conn) noexcept
+  {
+    requests_counter_->decrement();
+    const std::lock_guard lg{mutex_};
+    DMITIGR_ASSERT(active_request_count_ > 0);
+    --active_request_count_;
+    if (!is_keep_conn)
+      is_closing_ = true;
+    if (is_closing_ && !active_request_count_)
+      ::shutdown(socket_, SHUT_WR);
+  }
+
+private:
+  /// A request which input is being received.
+  struct Request final {
+    Role role{};
+    bool is_keep_conn{};
+    unsigned ended_streams{}; // the bits of the ended streams
+    std::string records;
+
+    static unsigned bit(const Record_type type) noexcept
+    {
+      return 1U << static_cast<unsigned>(type);
+    }
+
+    bool is_received() const noexcept
+    {
+      const auto is_ended = [this](const Record_type type)
+      {
+        return (ended_streams & bit(type)) != 0;
+      };
+      return is_ended(Record_type::params) &&
+        (role == Role::authorizer || is_ended(Record_type::in)) &&
+        (role != Role::filter || is_ended(Record_type::data));
+    }
+  };
+
+  net::Socket_guard socket_;
+  std::shared_ptr<Request_counter> requests_counter_;
+  const std::size_t max_request_input_size_{};
+  std::string input_;
+  std::map<int, Request> requests_;
+  std::mutex write_mutex_;
+  std::mutex mutex_;
+  int active_request_count_{};
+  bool is_closing_{};
+
+  /// Writes `len` bytes. (The `write_mutex_` must be locked.)
+  void write__(const char* buf, std::streamsize len, const int flags)
+  {
+    while (len > 0) {
+      const auto count = ::send(socket_, buf, static_cast<std::size_t>(len),
+        MSG_NOSIGNAL | flags);
+      if (count >= 0) {
+        buf += count;
+        len -= count;
+      } else
+        wait_writable();
+    }
+  }
+
+  /**
+   * @brief Waits for the socket to be ready for writing after the failed
+   * write attempt.
+   *
+   * @throws Exception if the write attempt is failed not because the socket
+   * buffer is full.
+   */
+  void wait_writable()
+  {
+    if (errno == EAGAIN) {
+      ::pollfd pfd{socket_, POLLOUT, 0};
+      if (::poll(&pfd, 1, -1) < 0 && errno != EINTR)
+        throw DMITIGR_NET_EXCEPTION{"cannot poll socket"};
+    } else if (errno != EINTR)
+      throw DMITIGR_NET_EXCEPTION{"cannot write to socket"};
+  }
+
+  void process_record(const Header& header, const std::string_view record,
+    std::vector<Received_request>& received)
+  {
+    if (header.is_management_record()) {
+      if (header.record_type() == Record_type::get_values) {
+        std::istringstream stream{std::string{record.substr(sizeof(header),
+          header.content_length())}};
+        const auto max_count = requests_counter_->max_count();
+        const auto result = get_values_result(Names_values{stream, 3},
+          max_count, max_count, true);
+        write(result.data(), static_cast<std::streamsize>(result.size()));
+      } else {
+        const Unknown_type_record result{header.record_type()};
+        write(reinterpret_cast<const char*>(&result), sizeof(result));
+      }
+      return;
+    }
+
+    const auto end_request = [this, &header](const Protocol_status status)
+    {
+      const End_request_record result{header.request_id(), 0, status};
+      write(reinterpret_cast<const char*>(&result), sizeof(result));
+    };
+
+    const auto request_id = header.request_id();
+    switch (header.record_type()) {
+    case Record_type::begin_request: {
+      if (header.content_length() != sizeof(Begin_request_body))
+        throw Exception{"FastCGI protocol violation"};
+
+      Begin_request_body body;
+      std::memcpy(&body, record.data() + sizeof(header), sizeof(body));
+      const auto role = body.role();
+      if (role != Role::responder &&
+        role != Role::authorizer && role != Role::filter)
+        end_request(Protocol_status::unknown_role);
+      else if (!is_closing() && !requests_.count(request_id)) {
+        // Begin-request with ID of a request being received is ignored.
+        if (requests_counter_->increment())
+          requests_.emplace(request_id, Request{role, body.is_keep_conn(), 0, {}});
+        else
+          end_request(Protocol_status::overloaded);
+      }
+      break;
+    }
+    case Record_type::abort_request:
+      if (requests_.erase(request_id)) {
+        requests_counter_->decrement();
+        end_request(Protocol_status::request_complete);
+      }
+      break;
+    case Record_type::params:
+      [[fallthrough]];
+    case Record_type::in:
+      [[fallthrough]];
+    case Record_type::data:
+      if (const auto i = requests_.find(request_id); i != end(requests_)) {
+        auto& request = i->second;
+        if (record.size() > max_request_input_size_ - request.records.size()) {
+          // The rest of the records of the request are ignored.
+          requests_.erase(i);
+          requests_counter_->decrement();
+          end_request(Protocol_status::overloaded);
+          break;
+        }
+        request.records.append(record);
+        if (!header.content_length())
+          request.ended_streams |= Request::bit(header.record_type());
+        if (request.is_received()) {
+          {
+            const std::lock_guard lg{mutex_};
+            ++active_request_count_;
+          }
+          received.push_back(Received_request{request_id, request.role,
+            request.is_keep_conn, std::move(request.records)});
+          requests_.erase(i);
+        }
+      }
+      break;
+    default:
+      break; // Ignoring.
+    }
+  }
+
+  bool is_closing() noexcept
+  {
+    const std::lock_guard lg{mutex_};
+    return is_closing_;
+  }
+};
+
+/**
+ * @brief The descriptor of the request dispatched by the Reactor.
+ *
+ * @details Reads the received records of the request, and completes the
+ * request upon close.
+ */
+class reactor_Descriptor final : public net::detail::iDescriptor {
+public:
+  ~reactor_Descriptor() override
+  {
+    close();
+  }
+
+  /// The constructor.
+  reactor_Descriptor(std::shared_ptr<Reactor_connection> connection,
+    Received_request request)
+    : connection_{std::move(connection)}
+    , request_{std::move(request)}
+  {
+    DMITIGR_ASSERT(connection_);
+  }
+
+  std::streamsize read(char* const buf, const std::streamsize len) override
+  {
+    DMITIGR_ASSERT(buf && len >= 0);
+    const auto count = std::min(request_.records.size() - offset_,
+      static_cast<std::size_t>(len));
+    std::memcpy(buf, request_.records.data() + offset_, count);
+    offset_ += count;
+    return static_cast<std::streamsize>(count);
+  }
+
+  std::streamsize write(const char* const buf, const std::streamsize len) override
+  {
+    if (!connection_)
+      throw Exception{"cannot write to completed FastCGI request"};
+    connection_->write(buf, len);
+    return len;
+  }
+
+  std::streamsize writev(const std::string_view* const bufs,
+    const std::size_t count) override
+  {
+    if (!connection_)
+      throw Exception{"cannot write to completed FastCGI request"};
+    connection_->writev(bufs, count);
+    std::streamsize result{};
+    for (std::size_t i{}; i < count; ++i)
+      result += static_cast<std::streamsize>(bufs[i].size());
+    return result;
+  }
+
+  void send_file(const int fd, const std::int64_t offset,
+    const std::size_t size, const std::string_view header,
+    const std::string_view trailer) override
+  {
+    if (!connection_)
+      throw Exception{"cannot write to completed FastCGI request"};
+    connection_->send_file(fd, offset, size, header, trailer);
+  }
+
+  void close() noexcept override
+  {
+    if (connection_) {
+      const auto connection = std::move(connection_);
+      connection->complete(request_.is_keep_conn);
+    }
+  }
+
+  std::intptr_t native_handle() noexcept override
+  {
+    return connection_ ? connection_->socket() : net::invalid_socket;
+  }
+
+private:
+  std::shared_ptr<Reactor_connection> connection_;
+  Received_request request_;
+  std::size_t offset_{};
+};
+
+/// An event loop which serves the connections.
+class Reactor final {
+public:
+  /// The dispatcher of the received requests.
+  using Dispatcher = std::function<void(std::shared_ptr<Reactor_connection>,
+    Received_request)>;
+
+  /**
+   * @brief The constructor.
+   *
+   * @param listener The listening socket.
+   * @param is_listener_shared Specifies whether the `listener` is shared
+   * among several reactors.
+   * @param is_no_delay Specifies whether the Nagle's algorithm should be
+   * disabled on the accepted sockets.
+   * @param requests_counter The counter of the concurrent requests.
+   * @param max_request_input_size The maximum size of the input of request.
+   * @param dispatcher The dispatcher of the received requests.
+   */
+  Reactor(const net::Socket_native listener, const bool is_listener_shared,
+    const bool is_no_delay, std::shared_ptr<Request_counter> requests_counter,
+    const std::size_t max_request_input_size, Dispatcher dispatcher)
+    : dispatcher_{std::move(dispatcher)}
+    , buffer_{new char[buffer_size]}
+  {
+    DMITIGR_ASSERT(requests_counter && dispatcher_);
+    reactor_.add_listener(listener, [this, is_no_delay,
+      requests_counter = std::move(requests_counter),
+      max_request_input_size](net::Socket_guard socket)
+    {
+      // The failure to set up the connection must not stop the reactor.
+      const int fd = socket;
+      try {
+        if (is_no_delay)
+          net::set_no_delay(socket, true);
+        connections_[fd] = std::make_shared<Reactor_connection>(
+          std::move(socket), requests_counter, max_request_input_size);
+        reactor_.add(fd, net::Socket_readiness::read_ready,
+          [this, fd](net::Socket_readiness){read(fd);});
+      } catch (const std::exception& e) {
+        connections_.erase(fd); // closes the socket
+        std::clog << "error upon accepting FastCGI connection: " << e.what() << '\n';
+      } catch (...) {
+        connections_.erase(fd);
+        std::clog << "unknown error upon accepting FastCGI connection\n";
+      }
+    }, is_listener_shared);
+  }
+
+  /// Runs the event loop until stop() is called.
+  void run()
+  {
+    reactor_.run();
+  }
+
+  /// Stops the event loop. (Thread-safe.)
+  void stop() noexcept
+  {
+    reactor_.stop();
+  }
+
+private:
+  static constexpr std::size_t buffer_size{65536};
+  Dispatcher dispatcher_;
+  std::unique_ptr<char[]> buffer_;
+  std::unordered_map<int, std::shared_ptr<Reactor_connection>> connections_;
+  std::vector<Received_request> received_;
+  net::Reactor reactor_;
+
+  void read(const int fd)
+  {
+    const auto i = connections_.find(fd);
+    DMITIGR_ASSERT(i != end(connections_));
+    auto connection = i->second;
+    bool is_open{};
+    try {
+      is_open = connection->read(buffer_.get(), buffer_size, received_);
+    } catch (const std::exception& e) {
+      std::clog << "error upon reading FastCGI connection: " << e.what() << '\n';
+    }
+
+    for (auto& request : received_)
+      dispatcher_(connection, std::move(request));
+    received_.clear();
+
+    if (!is_open) {
+      reactor_.remove(fd);
+      connections_.erase(i);
+    }
+  }
+};
+
+} // namespace dmitigr::fcgi::detail
+
+namespace dmitigr::fcgi {
+
+DMITIGR_FCGI_INLINE Server::~Server()
+{
+  try {
+    stop();
+  } catch (const std::exception& e) {
+    std::clog << "error upon stopping FastCGI server: " << e.what() << '\n';
+  } catch (...) {
+    std::clog << "unknown error upon stopping FastCGI server\n";
+  }
+}
+
+DMITIGR_FCGI_INLINE Server::Server(Listener_options options, Handler handler,
+  const std::size_t thread_count, const std::size_t reactor_count)
+  : options_{std::move(options)}
+  , handler_{std::move(handler)}
+  , thread_count_{thread_count}
+  , reactor_count_{reactor_count}
+{
+  if (!handler_)
+    throw Exception{"cannot create FastCGI server: invalid handler"};
+  else if (!thread_count_)
+    throw Exception{"cannot create FastCGI server: zero thread count"};
+  else if (!reactor_count_)
+    throw Exception{"cannot create FastCGI server: zero reactor count"};
+}
+
+DMITIGR_FCGI_INLINE const Listener_options& Server::options() const noexcept
+{
+  return options_;
+}
+
+DMITIGR_FCGI_INLINE bool Server::is_running() const noexcept
+{
+  const std::lock_guard lg{mutex_};
+  return is_running_;
+}
+
+DMITIGR_FCGI_INLINE void Server::start()
+{
+  const std::lock_guard run_lg{run_mutex_};
+  {
+    const std::lock_guard lg{mutex_};
+    if (is_running_)
+      throw Exception{"cannot start FastCGI server which is already running"};
+  }
+  stop__(); // cleans up after the failed reactor, if any
+
+  buffer_pools_ = std::make_shared<detail::Buffer_pools>(options_);
+  pool_ = std::make_unique<thread::Pool>(thread_count_,
+    [](const std::string_view what)
+    {
+      std::clog << "error upon processing FastCGI request: " << what << '\n';
+    });
+
+  // The listening socket is shared among the reactors of UDS.
+  const bool is_listener_shared = reactor_count_ == 1 ||
+    options_.endpoint().communication_mode() != net::Communication_mode::net;
+  for (std::size_t i{}; i < (is_listener_shared ? 1 : reactor_count_); ++i) {
+    auto net_options = options_.options_;
+    net_options.set_reuse_port_enabled(!is_listener_shared);
+    auto& listener = listeners_.emplace_back(net::Listener::make(net_options));
+    listener->listen();
+  }
+
+  const auto dispatch = [this](std::shared_ptr<detail::Reactor_connection> connection,
+    detail::Received_request request)
+  {
+    pool_->submit([this, connection = std::move(connection),
+      request = std::move(request)]() mutable
+    {
+      const auto role = request.role;
+      const auto request_id = request.request_id;
+      const auto conn = std::make_unique<detail::pooled_buffers_Server_connection>(
+        std::make_unique<detail::reactor_Descriptor>(std::move(connection),
+          std::move(request)), role, request_id, false, *buffer_pools_);
+      handler_(*conn);
+    });
+  };
+
+  const bool is_no_delay = options_.is_no_delay_enabled() &&
+    options_.endpoint().communication_mode() == net::Communication_mode::net;
+  const auto requests_counter = std::make_shared<detail::Request_counter>(
+    options_.max_request_count());
+  for (std::size_t i{}; i < reactor_count_; ++i) {
+    const auto& listener = listeners_[is_listener_shared ? 0 : i];
+    reactors_.push_back(std::make_unique<detail::Reactor>(
+      static_cast<net::Socket_native>(listener->native_handle()),
+      is_listener_shared && reactor_count_ > 1, is_no_delay, requests_counter,
+      options_.max_request_input_size(), dispatch));
+  }
+
+  // Set before the reactors are run, since any of them may fail immediately.
+  {
+    const std::lock_guard lg{mutex_};
+    is_running_ = true;
+  }
+  for (std::size_t i{}; i < reactors_.size(); ++i) {
+    threads_.emplace_back([this, reactor = reactors_[i].get(),
+      listener = is_listener_shared ? nullptr : listeners_[i].get()]
+    {
+      try {
+        reactor->run();
+        return;
+      } catch (const std::exception& e) {
+        std::clog << "error upon running FastCGI reactor: " << e.what() << '\n';
+      } catch (...) {
+        std::clog << "unknown error upon running FastCGI reactor\n";
+      }
+      fail__(listener);
+    });
+  }
+}
+
+DMITIGR_FCGI_INLINE void Server::wait()
+{
+  std::unique_lock lock{mutex_};
+  stopped_.wait(lock, [this]{return !is_running_;});
+}
+
+DMITIGR_FCGI_INLINE void Server::stop()
+{
+  const std::lock_guard run_lg{run_mutex_};
+  stop__();
+  const std::lock_guard lg{mutex_};
+  if (is_running_) {
+    is_running_ = false;
+    stopped_.notify_all();
+  }
+}
+
+DMITIGR_FCGI_INLINE void Server::stop__()
+{
+  for (const auto& reactor : reactors_)
+    reactor->stop();
+  for (auto& thread : threads_)
+    thread.join();
+  threads_.clear();
+  reactors_.clear();
+  listeners_.clear();
+  pool_.reset(); // waits for the requests being processed
+}
+
+DMITIGR_FCGI_INLINE void Server::fail__(net::Listener* const listener) noexcept
+{
+  /*
+   * The reactors and the listeners are not destroyed until the threads are
+   * joined, so it's safe to access them without locking. The own listener
+   * of the failed reactor (SO_REUSEPORT) is closed at once, otherwise the
+   * kernel would continue to distribute the connections to it.
+   */
+  for (const auto& reactor : reactors_)
+    reactor->stop();
+  if (listener) {
+    try {
+      listener->close();
+    } catch (const std::exception& e) {
+      std::clog << "error upon closing FastCGI listener: " << e.what() << '\n';
+    }
+  }
+
+  const std::lock_guard lg{mutex_};
+  if (is_running_) {
+    is_running_ = false;
+    stopped_.notify_all();
+  }
+}
+
+} // namespace dmitigr::fcgi
+
+#endif  // __linux__
@@ -0,0 +1,169 @@
+// -*- C++ -*-
+//
+// Copyright 2023 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DMITIGR_FCGI_SERVER_HPP
+#define DMITIGR_FCGI_SERVER_HPP
+
+#include "dll.hpp"
+#include "listener_options.hpp"
+#include "types_fwd.hpp"
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+
+namespace dmitigr::thread {
+class Pool;
+} // namespace dmitigr::thread
+
+namespace dmitigr::fcgi {
+
+/**
+ * @brief A multi-threaded FastCGI server.
+ *
+ * @details The server runs the reactors (the event loops based on epoll(7))
+ * which are accepting the connections and reading the records without
+ * blocking. As soon as the entire input of the request is received, the
+ * request is dispatched to the thread pool to be processed by the handler.
+ * Thus, the threads are occupied by the requests being processed only, while
+ * the idle connections (e.g. kept alive by the FastCGI client) cost just a
+ * socket. The concurrent requests over the same connection are supported.
+ *
+ * If there are several reactors, each of them is listening on its own socket
+ * with SO_REUSEPORT option set, so the incoming connections are distributed
+ * among the reactors by the kernel. (The reactors of Unix Domain Sockets are
+ * sharing the same listening socket.)
+ *
+ * Example:
+ * @code
+ * fcgi::Server server{fcgi::Listener_options{"0.0.0.0", 9000, 512},
+ *   [](fcgi::Server_connection& conn)
+ *   {
+ *     conn.out() << "Content-Type: text/plain" << fcgi::crlfcrlf;
+ *     conn.out() << "Hello!";
+ *   }};
+ * server.start();
+ * server.wait();
+ * @endcode
+ *
+ * @remarks The input of the request is buffered in memory entirely before
+ * the processing, so both the number of the concurrent requests and the size
+ * of the input of each of them are limited.
+ *
+ * @see Listener_options::set_max_request_count(),
+ * Listener_options::set_max_request_input_size().
+ *
+ * @remarks Available on Linux only.
+ */
+class Server final {
+public:
+  /// The handler of requests.
+  using Handler = std::function<void(Server_connection&)>;
+
+  /// Stops the server.
+  DMITIGR_FCGI_API ~Server();
+
+  /// Non copy-constructible.
+  Server(const Server&) = delete;
+
+  /// Non copy-assignable.
+  Server& operator=(const Server&) = delete;
+
+  /// Non move-constructible.
+  Server(Server&&) = delete;
+
+  /// Non move-assignable.
+  Server& operator=(Server&&) = delete;
+
+  /**
+   * @brief The constructor.
+   *
+   * @param options The options of listening.
+   * @param handler The handler of requests. (Called concurrently.)
+   * @param thread_count The size of the thread pool to run the `handler`.
+   * @param reactor_count The number of reactors.
+   *
+   * @par Requires
+   * `handler && thread_count && reactor_count`.
+   */
+  DMITIGR_FCGI_API Server(Listener_options options, Handler handler,
+    std::size_t thread_count = std::thread::hardware_concurrency(),
+    std::size_t reactor_count = 1);
+
+  /// @returns Options of the server.
+  DMITIGR_FCGI_API const Listener_options& options() const noexcept;
+
+  /// @returns `true` if the server is running.
+  DMITIGR_FCGI_API bool is_running() const noexcept;
+
+  /**
+   * @brief Starts listening and runs the reactors in the background threads.
+   *
+   * @par Requires
+   * `!is_running()`.
+   */
+  DMITIGR_FCGI_API void start();
+
+  /**
+   * @brief Blocks the calling thread until the server is stopped.
+   *
+   * @details Returns also if any of the reactors is failed, in which case
+   * the others are stopped too. (stop() should be called to clean up then.)
+   */
+  DMITIGR_FCGI_API void wait();
+
+  /**
+   * @brief Stops the reactors, closes the connections and waits for the
+   * requests being processed to be completed.
+   *
+   * @remarks Must not be called from the handler.
+   */
+  DMITIGR_FCGI_API void stop();
+
+private:
+  Listener_options options_;
+  Handler handler_;
+  std::size_t thread_count_{};
+  std::size_t reactor_count_{};
+  std::mutex run_mutex_; // serializes start() and stop()
+  mutable std::mutex mutex_;
+  std::condition_variable stopped_;
+  bool is_running_{};
+  std::shared_ptr<detail::Buffer_pools> buffer_pools_;
+  std::unique_ptr<thread::Pool> pool_;
+  std::vector<std::unique_ptr<net::Listener>> listeners_;
+  std::vector<std::unique_ptr<detail::Reactor>> reactors_;
+  std::vector<std::thread> threads_;
+
+  void stop__();
+  void fail__(net::Listener* listener) noexcept;
+};
+
+} // namespace dmitigr::fcgi
+
+#endif  // __linux__
+
+#ifndef DMITIGR_FCGI_NOT_HEADER_ONLY
+#include "server.cpp"
+#endif
+
+#endif  // DMITIGR_FCGI_SERVER_HPP
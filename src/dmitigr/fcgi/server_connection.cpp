@@ -19,17 +19,220 @@
 #include "exceptions.hpp"
 #include "server_connection.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#ifdef __linux__
+#include <sys/eventfd.h>
+#endif
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
 namespace dmitigr::fcgi::detail {
 
+#ifndef _WIN32
+/**
+ * @brief A wakeup of the Listener waiting for the readiness of the sockets.
+ *
+ * @details The handle is polled by the Listener along with the sockets, and
+ * becomes readable upon signal() if the wakeup is armed. Only one thread of
+ * the Listener is waiting at a time (under mutex()), so arm() can discard the
+ * pending signals without losing the wakeup of other threads, which would be
+ * left polling the stale set of sockets otherwise. The implementation is
+ * based on eventfd on Linux and on the self-pipe on other platforms.
+ *
+ * @remarks Thread-safe.
+ */
+class Wakeup final {
+public:
+  /// The destructor.
+  ~Wakeup()
+  {
+    if (fds_[1] >= 0 && fds_[1] != fds_[0])
+      ::close(fds_[1]);
+    if (fds_[0] >= 0)
+      ::close(fds_[0]);
+  }
+
+  /// The constructor.
+  Wakeup()
+  {
+#ifdef __linux__
+    if ((fds_[0] = fds_[1] = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)) < 0)
+      throw DMITIGR_NET_EXCEPTION{"cannot create eventfd"};
+#else
+    if (::pipe(fds_))
+      throw DMITIGR_NET_EXCEPTION{"cannot create pipe"};
+    for (const int fd : fds_) {
+      if (::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK) ||
+        ::fcntl(fd, F_SETFD, FD_CLOEXEC))
+        throw DMITIGR_NET_EXCEPTION{"cannot set pipe flags"};
+    }
+#endif
+  }
+
+  /// Non copy-constructible.
+  Wakeup(const Wakeup&) = delete;
+
+  /// Non copy-assignable.
+  Wakeup& operator=(const Wakeup&) = delete;
+
+  /// Non move-constructible.
+  Wakeup(Wakeup&&) = delete;
+
+  /// Non move-assignable.
+  Wakeup& operator=(Wakeup&&) = delete;
+
+  /// @returns The mutex of the waiting thread.
+  std::timed_mutex& mutex() noexcept
+  {
+    return mutex_;
+  }
+
+  /// @returns The handle to poll for readability.
+  int native_handle() const noexcept
+  {
+    return fds_[0];
+  }
+
+  /**
+   * @brief Discards the pending signals and arms the wakeup.
+   *
+   * @details Must be called before examining the state to wait for, so the
+   * changes of the state made after this call are not missed.
+   */
+  void arm() noexcept
+  {
+#ifdef __linux__
+    std::uint64_t value{};
+    [[maybe_unused]] const auto r = ::read(fds_[0], &value, sizeof(value));
+#else
+    char buf[64];
+    while (::read(fds_[0], buf, sizeof(buf)) > 0);
+#endif
+    is_armed_ = true;
+  }
+
+  /// Makes the handle readable if the wakeup is armed, and disarms it.
+  void signal() noexcept
+  {
+    if (!is_armed_.exchange(false))
+      return;
+#ifdef __linux__
+    const std::uint64_t value{1};
+#else
+    const char value{};
+#endif
+    [[maybe_unused]] const auto r = ::write(fds_[1], &value, sizeof(value));
+  }
+
+private:
+  std::timed_mutex mutex_;
+  std::atomic_bool is_armed_{};
+  int fds_[2]{-1, -1};
+};
+#endif
+
+
+/**
+ * @brief The idle connections kept alive for the next requests.
+ *
+ * @details The connections of the requests with Begin_request_body::Flags::keep_conn
+ * flag set are put here upon the completion of the request, and taken back
+ * by the Listener as soon as the next request arrives. The Listener which is
+ * waiting for the readiness of the sockets is woken up upon put().
+ *
+ * @remarks Thread-safe.
+ */
+class Kept_connections final {
+public:
+  /// Puts the `io` to this instance.
+  void put(std::unique_ptr<net::Descriptor> io)
+  {
+    DMITIGR_ASSERT(io);
+    {
+      const std::lock_guard lg{mutex_};
+      descriptors_.push_back(std::move(io));
+    }
+#ifndef _WIN32
+    wakeup_.signal();
+#endif
+  }
+
+  /**
+   * @returns The descriptor with the specified native `handle`, or `nullptr`
+   * if there is no such a descriptor (it might be taken by another thread).
+   */
+  std::unique_ptr<net::Descriptor> take(const std::intptr_t handle)
+  {
+    const std::lock_guard lg{mutex_};
+    const auto e = end(descriptors_);
+    const auto i = find_if(begin(descriptors_), e, [handle](const auto& io)
+    {
+      return io->native_handle() == handle;
+    });
+    if (i == e)
+      return nullptr;
+
+    auto result = std::move(*i);
+    descriptors_.erase(i);
+    return result;
+  }
+
+  /// @returns The native handles of the descriptors.
+  std::vector<std::intptr_t> handles() const
+  {
+    std::vector<std::intptr_t> result;
+    const std::lock_guard lg{mutex_};
+    result.reserve(descriptors_.size());
+    for (const auto& io : descriptors_)
+      result.push_back(io->native_handle());
+    return result;
+  }
+
+  /// Closes all the descriptors.
+  void clear() noexcept
+  {
+    decltype(descriptors_) descriptors;
+    {
+      const std::lock_guard lg{mutex_};
+      descriptors.swap(descriptors_);
+    }
+  }
+
+#ifndef _WIN32
+  /// @returns The wakeup of the Listener.
+  Wakeup& wakeup() noexcept
+  {
+    return wakeup_;
+  }
+#endif
+
+private:
+  mutable std::mutex mutex_;
+  std::vector<std::unique_ptr<net::Descriptor>> descriptors_;
+#ifndef _WIN32
+  Wakeup wakeup_;
+#endif
+};
+
 /// The base implementation of the Server_connection.
 class iServer_connection : public Server_connection {
 public:
   /// The constructor.
   explicit iServer_connection(std::unique_ptr<net::Descriptor> io,
-    const Role role, const int request_id, const bool is_keep_connection)
+    const Role role, const int request_id, const bool is_keep_connection,
+    std::weak_ptr<Kept_connections> kept_connections)
     : is_keep_connection_{is_keep_connection}
     , role_{role}
     , request_id_{request_id}
+    , kept_connections_{std::move(kept_connections)}
   {
     io_ = std::move(io);
     DMITIGR_ASSERT(io_);
@@ -94,6 +297,23 @@ public:
     return is_keep_connection_;
   }
 
+protected:
+  /**
+   * @brief Passes the underlying descriptor back to the Listener for reuse
+   * by the next request.
+   *
+   * @par Requires
+   * The request must be completed.
+   *
+   * @par Effects
+   * The underlying descriptor is closed if the Listener is no longer exists.
+   */
+  void keep_connection_alive()
+  {
+    if (const auto kept = kept_connections_.lock())
+      kept->put(std::move(io_));
+  }
+
 private:
   friend server_Istream;
   friend server_Streambuf;
@@ -103,6 +323,7 @@ private:
   int request_id_{};
   int application_status_{};
   std::unique_ptr<net::Descriptor> io_;
+  std::weak_ptr<Kept_connections> kept_connections_;
   detail::Names_values parameters_;
 };
 
@@ -0,0 +1,312 @@
+// -*- C++ -*-
+//
+// Copyright 2023 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Included by several implementation files.
+#ifndef DMITIGR_FCGI_SERVER_CONNECTION_POOLED_CPP
+#define DMITIGR_FCGI_SERVER_CONNECTION_POOLED_CPP
+
+#include "../base/assert.hpp"
+#include "basics.hpp"
+#include "exceptions.hpp"
+#include "server_connection.hpp"
+#include "streams.hpp"
+
+#include <array>
+#include <cstdio>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace dmitigr::fcgi::detail {
+
+/**
+ * @brief A pool of the buffers of the same size.
+ *
+ * @details The buffers are returned to the pool upon the destruction and
+ * reused by the subsequent requests, so the number of the allocated buffers
+ * is limited to the peak number of the concurrent requests.
+ *
+ * @remarks Thread-safe.
+ */
+class Buffer_pool final : public std::enable_shared_from_this<Buffer_pool> {
+public:
+  /// A buffer which is returned to the pool upon the destruction.
+  class Buffer final {
+  public:
+    /// The destructor.
+    ~Buffer()
+    {
+      if (pool_)
+        pool_->release(std::move(data_));
+    }
+
+    /// The default constructor.
+    Buffer() = default;
+
+    /// Non copy-constructible.
+    Buffer(const Buffer&) = delete;
+
+    /// Non copy-assignable.
+    Buffer& operator=(const Buffer&) = delete;
+
+    /// Move-constructible.
+    Buffer(Buffer&&) = default;
+
+    /// Move-assignable.
+    Buffer& operator=(Buffer&& rhs) noexcept
+    {
+      if (this != &rhs) {
+        Buffer tmp{std::move(rhs)};
+        std::swap(pool_, tmp.pool_);
+        std::swap(data_, tmp.data_);
+      }
+      return *this;
+    }
+
+    /// @returns The data.
+    char* data() const noexcept
+    {
+      return data_.get();
+    }
+
+    /// @returns The size.
+    std::streamsize size() const noexcept
+    {
+      return pool_ ? static_cast<std::streamsize>(pool_->buffer_size()) : 0;
+    }
+
+  private:
+    friend Buffer_pool;
+
+    std::shared_ptr<Buffer_pool> pool_;
+    std::unique_ptr<char[]> data_;
+
+    Buffer(std::shared_ptr<Buffer_pool> pool, std::unique_ptr<char[]> data)
+      : pool_{std::move(pool)}
+      , data_{std::move(data)}
+    {}
+  };
+
+  /// The constructor.
+  explicit Buffer_pool(const std::size_t buffer_size)
+    : buffer_size_{buffer_size}
+  {
+    DMITIGR_ASSERT(buffer_size_ <= std::numeric_limits<std::streamsize>::max());
+  }
+
+  /// @returns The size of the buffers.
+  std::size_t buffer_size() const noexcept
+  {
+    return buffer_size_;
+  }
+
+  /// @returns The free buffer, allocating it if necessary.
+  Buffer acquire()
+  {
+    std::unique_ptr<char[]> data;
+    {
+      const std::lock_guard lg{mutex_};
+      if (!free_.empty()) {
+        data = std::move(free_.back());
+        free_.pop_back();
+      }
+    }
+    if (!data)
+      data.reset(new char[buffer_size_]);
+    return Buffer{shared_from_this(), std::move(data)};
+  }
+
+private:
+  std::size_t buffer_size_{};
+  std::mutex mutex_;
+  std::vector<std::unique_ptr<char[]>> free_;
+
+  void release(std::unique_ptr<char[]> data) noexcept
+  {
+    try {
+      const std::lock_guard lg{mutex_};
+      free_.push_back(std::move(data));
+    } catch (...) {} // the buffer is just deallocated
+  }
+};
+
+/// The pools of the buffers of the streams.
+class Buffer_pools final {
+public:
+  /// The constructor.
+  explicit Buffer_pools(const Listener_options& options)
+    : in_{std::make_shared<Buffer_pool>(options.in_buffer_size())}
+    , out_{std::make_shared<Buffer_pool>(options.out_buffer_size())}
+    , err_{options.err_buffer_size() == options.out_buffer_size() ? out_ :
+      std::make_shared<Buffer_pool>(options.err_buffer_size())}
+  {}
+
+  /// @returns The pool of the buffers of Stream_type::in.
+  const std::shared_ptr<Buffer_pool>& in() const noexcept
+  {
+    return in_;
+  }
+
+  /// @returns The pool of the buffers of Stream_type::out.
+  const std::shared_ptr<Buffer_pool>& out() const noexcept
+  {
+    return out_;
+  }
+
+  /// @returns The pool of the buffers of Stream_type::err.
+  const std::shared_ptr<Buffer_pool>& err() const noexcept
+  {
+    return err_;
+  }
+
+private:
+  std::shared_ptr<Buffer_pool> in_;
+  std::shared_ptr<Buffer_pool> out_;
+  std::shared_ptr<Buffer_pool> err_;
+};
+
+/**
+ * @brief The Server_connection implementation based on the buffers acquired
+ * from the pools.
+ *
+ * @details The buffer of Stream_type::err is acquired upon the first access
+ * to the stream, since the most of the requests are never write to it. Until
+ * then (or if the acquisition fails) the stream uses the small reserve buffer
+ * embedded into the connection.
+ */
+class pooled_buffers_Server_connection final : public iServer_connection {
+public:
+  ~pooled_buffers_Server_connection() override
+  {
+    try {
+      close();
+
+      /*
+       * Begin_request_body::Flags::keep_conn flag has no effect if any output
+       * stream is with failbit set, or if the input has not been drained.
+       */
+      if (is_input_drained_ && !err_.fail() && !out_.fail())
+        keep_connection_alive();
+    } catch (const std::exception& e) {
+      std::clog << "error upon closing FastCGI connection: " << e.what() << '\n';
+    } catch (...) {
+      std::clog << "unknown error upon closing FastCGI connection\n";
+    }
+  }
+
+  explicit pooled_buffers_Server_connection(std::unique_ptr<net::Descriptor> io,
+    const Role role,
+    const int request_id,
+    const bool is_keep_connection,
+    const Buffer_pools& buffer_pools,
+    std::weak_ptr<Kept_connections> kept_connections = {})
+    : iServer_connection{std::move(io), role, request_id, is_keep_connection,
+      std::move(kept_connections)}
+    , err_buffer_pool_{buffer_pools.err()}
+    , in_buffer_{buffer_pools.in()->acquire()}
+    , out_buffer_{buffer_pools.out()->acquire()}
+    , in_{this, in_buffer_.data(), in_buffer_.size()}
+    , out_{this, out_buffer_.data(), out_buffer_.size(), Stream_type::out}
+    , err_{this, err_reserve_buffer_.data(),
+      static_cast<std::streamsize>(err_reserve_buffer_.size()), Stream_type::err}
+  {}
+
+  // ---------------------------------------------------------------------------
+  // Connection overridings
+  // ---------------------------------------------------------------------------
+
+  void close() override
+  {
+    if (is_closed())
+      return;
+
+    is_input_drained_ = is_keep_connection() && drain_input();
+
+    // Attention: the order is important!
+    err_.streambuf().close();
+    out_.streambuf().close();
+    in_.streambuf().close();
+  }
+
+  bool is_closed() const noexcept override
+  {
+    return err_.is_closed() && out_.is_closed() && in_.is_closed();
+  }
+
+  // ---------------------------------------------------------------------------
+  // Server_connection overridings
+  // ---------------------------------------------------------------------------
+
+  server_Istream& in() noexcept override
+  {
+    return in_;
+  }
+
+  server_Ostream& out() noexcept override
+  {
+    return out_;
+  }
+
+  server_Ostream& err() noexcept override
+  {
+    if (err_buffer_pool_ && !err_.is_closed()) {
+      // The stream is untouched yet, so its buffer can be replaced.
+      try {
+        err_buffer_ = err_buffer_pool_->acquire();
+        err_.streambuf().pubsetbuf(err_buffer_.data(), err_buffer_.size());
+      } catch (...) {} // the reserve buffer is used
+      err_buffer_pool_.reset();
+    }
+    return err_;
+  }
+
+private:
+  std::shared_ptr<Buffer_pool> err_buffer_pool_;
+  Buffer_pool::Buffer in_buffer_;
+  Buffer_pool::Buffer out_buffer_;
+  Buffer_pool::Buffer err_buffer_;
+  std::array<server_Streambuf::char_type, 2048> err_reserve_buffer_;
+
+  server_Istream in_;
+  server_Ostream out_;
+  server_Ostream err_;
+  bool is_input_drained_{};
+
+  /**
+   * @brief Discards the unread input of the request.
+   *
+   * @returns `true` if the input is drained completely, so the connection can
+   * be reused for the next request.
+   */
+  bool drain_input()
+  {
+    auto& inbuf = in_.streambuf();
+    // Filter reads both the stdin and the data streams.
+    for (int i{}; i < 2 && !inbuf.is_end_of_stream() && !in_.bad(); ++i) {
+      in_.clear();
+      in_.ignore(std::numeric_limits<std::streamsize>::max());
+    }
+    return !in_.bad() && inbuf.is_end_of_stream() &&
+      !inbuf.has_unconsumed_input();
+  }
+};
+
+} // namespace dmitigr::fcgi::detail
+
+#endif  // DMITIGR_FCGI_SERVER_CONNECTION_POOLED_CPP
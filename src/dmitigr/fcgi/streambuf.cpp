@@ -23,8 +23,10 @@
 
 #include <algorithm>
 #include <array>
+#include <cstdint>
 #include <iostream>
 #include <limits>
+#include <string_view>
 
 /*
  * By defining DMITIGR_FCGI_DEBUG some convenient stuff for debugging
@@ -59,7 +61,7 @@ public:
     try {
       close();
     } catch (const std::exception& e) {
-      std::clog << "error upon closing FastCGI stream buffer: %s\n" << e.what();
+      std::clog << "error upon closing FastCGI stream buffer: " << e.what() << '\n';
     } catch (...) {
       std::clog << "uknown error upon closing FastCGI stream buffer\n";
     }
@@ -159,6 +161,182 @@ public:
     return type_;
   }
 
+  /// @returns `true` if the end of stream of the current type is reached.
+  bool is_end_of_stream() const noexcept
+  {
+    return is_end_of_stream_;
+  }
+
+  /**
+   * @returns `true` if this instance is the reader which has the data read
+   * from the FastCGI client past the get area.
+   */
+  bool has_unconsumed_input() const noexcept
+  {
+    return is_reader() && !is_closed() && egptr() != buffer_end_;
+  }
+
+  /**
+   * @returns The view of the content in the get area, or empty view if
+   * the end of stream is reached.
+   *
+   * @details The get area is filled if it's empty.
+   *
+   * @par Requires
+   * `is_reader() && !is_closed()`.
+   */
+  std::string_view buffered_input()
+  {
+    DMITIGR_ASSERT(is_reader() && !is_closed());
+    if (gptr() == egptr() &&
+      traits_type::eq_int_type(underflow(), traits_type::eof()))
+      return {};
+    return {gptr(), static_cast<std::size_t>(egptr() - gptr())};
+  }
+
+  /**
+   * @brief Consumes `size` bytes of the get area.
+   *
+   * @par Requires
+   * `is_reader() && !is_closed() && (size <= egptr() - gptr())`.
+   */
+  void consume_input(const std::size_t size)
+  {
+    DMITIGR_ASSERT(is_reader() && !is_closed());
+    if (size > static_cast<std::size_t>(egptr() - gptr()))
+      throw Exception{"cannot consume more FastCGI input than buffered"};
+    gbump(static_cast<int>(size));
+  }
+
+  /// @returns The maximum size of the space which can be reserved in the put area.
+  std::size_t max_output_reserve_size() const noexcept
+  {
+    return static_cast<std::size_t>(buffer_size_) - sizeof(detail::Header) - 1;
+  }
+
+  /**
+   * @returns The pointer to at least `size` bytes of the put area. The put
+   * area is transmitted first if there is not enough space in it.
+   *
+   * @par Requires
+   * `!is_reader() && !is_closed() && (size <= max_output_reserve_size())`.
+   */
+  char* reserve_output(const std::size_t size)
+  {
+    DMITIGR_ASSERT(!is_reader() && !is_closed());
+    if (is_end_of_stream_)
+      throw Exception{"cannot write to ended FastCGI stream"};
+    else if (size > max_output_reserve_size())
+      throw Exception{"cannot reserve more FastCGI output than buffer size"};
+
+    if (static_cast<std::size_t>(epptr() - pptr()) < size)
+      sync();
+    DMITIGR_ASSERT(static_cast<std::size_t>(epptr() - pptr()) >= size);
+    return pptr();
+  }
+
+  /**
+   * @brief Commits `size` bytes of the put area written to the space returned
+   * by reserve_output().
+   *
+   * @par Requires
+   * `!is_reader() && !is_closed() && (size <= epptr() - pptr())`.
+   */
+  void commit_output(const std::size_t size)
+  {
+    DMITIGR_ASSERT(!is_reader() && !is_closed());
+    if (size > static_cast<std::size_t>(epptr() - pptr()))
+      throw Exception{"cannot commit more FastCGI output than reserved"};
+    pbump(static_cast<int>(size));
+  }
+
+  /**
+   * @brief Transmits `data` as the content of the records of the stream
+   * without copying it into the put area.
+   *
+   * @details The put area is transmitted first. Then the records are
+   * transmitted by the gather output operations, each of which consists of
+   * the headers, the fragments of `data` and the paddings of several records.
+   *
+   * @par Requires
+   * `!is_reader() && !is_closed()`.
+   */
+  void write_direct(std::string_view data)
+  {
+    DMITIGR_ASSERT(!is_reader() && !is_closed());
+    if (is_end_of_stream_)
+      throw Exception{"cannot write to ended FastCGI stream"};
+    else if (data.empty())
+      return; // the record of zero length would end the stream
+
+    sync();
+
+    static const std::array<char, 8> padding{};
+    constexpr std::size_t max_record_count{16};
+    std::array<detail::Header, max_record_count> headers;
+    std::array<std::string_view, 3*max_record_count> bufs;
+    while (!data.empty()) {
+      std::size_t buf_count{};
+      for (auto& header : headers) {
+        if (data.empty())
+          break;
+
+        const auto content_length = std::min(data.size(),
+          detail::Header::max_content_length);
+        header = detail::Header{static_cast<detail::Record_type>(type_),
+          connection_->request_id(), content_length};
+        bufs[buf_count++] = {reinterpret_cast<const char*>(&header),
+          sizeof(header)};
+        bufs[buf_count++] = data.substr(0, content_length);
+        if (const auto padding_length = header.padding_length())
+          bufs[buf_count++] = {padding.data(), padding_length};
+        data.remove_prefix(content_length);
+      }
+      write_all(bufs.data(), buf_count);
+    }
+    is_put_area_at_least_once_consumed_ = true;
+
+    DMITIGR_ASSERT(is_invariant_ok());
+  }
+
+  /**
+   * @brief Transmits `size` bytes of the file `fd` starting at `offset` as
+   * the content of the records of the stream.
+   *
+   * @details The put area is transmitted first. Then each record is
+   * transmitted by the Descriptor::send_file(), so the content of the file
+   * is not copied into the user space when possible.
+   *
+   * @par Requires
+   * `!is_reader() && !is_closed()`.
+   */
+  void send_file(const int fd, std::int64_t offset, std::size_t size)
+  {
+    DMITIGR_ASSERT(!is_reader() && !is_closed());
+    if (is_end_of_stream_)
+      throw Exception{"cannot write to ended FastCGI stream"};
+    else if (!size)
+      return; // the record of zero length would end the stream
+
+    sync();
+
+    static const std::array<char, 8> padding{};
+    while (size) {
+      const auto content_length = std::min(size,
+        detail::Header::max_content_length);
+      const detail::Header header{static_cast<detail::Record_type>(type_),
+        connection_->request_id(), content_length};
+      connection_->io_->send_file(fd, offset, content_length,
+        {reinterpret_cast<const char*>(&header), sizeof(header)},
+        {padding.data(), header.padding_length()});
+      offset += static_cast<std::int64_t>(content_length);
+      size -= content_length;
+    }
+    is_put_area_at_least_once_consumed_ = true;
+
+    DMITIGR_ASSERT(is_invariant_ok());
+  }
+
 protected:
 
   // std::streambuf overridings:
@@ -321,6 +499,7 @@ protected:
     const bool is_eof = traits_type::eq_int_type(ch, traits_type::eof());
 
     DMITIGR_ASSERT(pbase() == (buffer_ + sizeof(detail::Header)));
+    std::string_view record; // the record of the put area to send
     if (std::streamsize content_length = pptr() - pbase()) {
       /*
        * If `ch` is not EOF we need to place `ch` at the location pointed to by
@@ -353,11 +532,10 @@ protected:
         static_cast<std::size_t>(content_length),
         static_cast<std::size_t>(padding_length)};
 
-      // Sending the record.
+      // Preparing the record to send.
       if (const auto record_size = pptr() - buffer_;
         static_cast<std::size_t>(record_size) > sizeof(detail::Header)) {
-        const std::streamsize count = connection_->io_->write(static_cast<const char*>(buffer_), record_size);
-        DMITIGR_ASSERT(count == record_size);
+        record = {buffer_, static_cast<std::size_t>(record_size)};
         is_put_area_at_least_once_consumed_ = true;
       }
     }
@@ -365,17 +543,15 @@ protected:
 
     if (is_end_records_must_be_transmitted_) {
       /*
-       * We'll use buffer_ directly here. (Space before pbase() will be used.)
-       * data_size is a size of data in the buffer_ to send.
+       * The end records are sent along with the last record of the put area by
+       * the single gather output operation, so the small end records are not
+       * delayed by the Nagle's algorithm.
        */
-      std::streamsize data_size{};
+      std::array<char, sizeof(detail::Header) +
+        sizeof(detail::End_request_record)> end_records;
+      std::size_t data_size{};
 
-      const auto is_empty = [this]()
-      {
-        return pptr() == pbase() && !is_put_area_at_least_once_consumed_;
-      };
-
-      if (type_ != Type::err || !is_empty()) {
+      if (type_ != Type::err || is_put_area_at_least_once_consumed_) {
         /*
          * When transmitting a stream other than stderr, at least one record of
          * the stream type must be trasmitted, even if the stream is empty.
@@ -384,10 +560,10 @@ protected:
          * must be transmitted. (As optimization, no stderr records are
          * transmitted if the stream is empty.)
          */
-        auto* const header = reinterpret_cast<detail::Header*>(buffer_ + data_size);
-        *header = detail::Header{static_cast<detail::Record_type>(type_),
+        const detail::Header header{static_cast<detail::Record_type>(type_),
           connection_->request_id(), 0, 0};
-        data_size += sizeof(detail::Header);
+        std::memcpy(end_records.data() + data_size, &header, sizeof(header));
+        data_size += sizeof(header);
       }
 
       /*
@@ -395,23 +571,25 @@ protected:
        * guaranteed by the implementation of Listener.)
        */
       if (type_ == Type::out) {
-        auto* const record = reinterpret_cast<detail::End_request_record*>(
-          buffer_ + data_size);
-        *record = detail::End_request_record{
+        const detail::End_request_record end_request{
           connection_->request_id(),
           connection_->application_status(),
           detail::Protocol_status::request_complete};
-        data_size += sizeof(detail::End_request_record);
+        std::memcpy(end_records.data() + data_size, &end_request,
+          sizeof(end_request));
+        data_size += sizeof(end_request);
       }
 
-      if (data_size > 0) {
-        const std::streamsize count = connection_->io_->write(
-          static_cast<const char*>(buffer_), data_size);
-        DMITIGR_ASSERT(count == data_size);
-      }
+      const std::array<std::string_view, 2> bufs{record,
+        std::string_view{end_records.data(), data_size}};
+      write_all(bufs.data(), bufs.size());
 
       is_end_records_must_be_transmitted_ = false;
       is_end_of_stream_ = true;
+    } else if (!record.empty()) {
+      const auto record_size = static_cast<std::streamsize>(record.size());
+      const std::streamsize count = connection_->io_->write(record.data(), record_size);
+      DMITIGR_ASSERT(count == record_size);
     }
 
     DMITIGR_ASSERT(is_invariant_ok());
@@ -422,6 +600,42 @@ protected:
 private:
   friend server_Istream;
 
+  /// Writes all of the data of `count` buffers to the FastCGI client.
+  void write_all(const std::string_view* bufs, std::size_t count)
+  {
+    auto* const io = connection_->io_.get();
+    while (count) {
+      if (bufs->empty()) {
+        ++bufs;
+        --count;
+        continue;
+      }
+
+      auto written = io->writev(bufs, count);
+      if (written <= 0)
+        throw Exception{"cannot write to FastCGI client"};
+
+      // Skipping the buffers which are written entirely.
+      for (; count && static_cast<std::size_t>(written) >= bufs->size();
+           ++bufs, --count)
+        written -= static_cast<std::streamsize>(bufs->size());
+
+      // Writing the rest of the buffer which is written partially.
+      if (count && written) {
+        for (auto rest = bufs->substr(static_cast<std::size_t>(written));
+             !rest.empty();) {
+          const auto n = io->write(rest.data(),
+            static_cast<std::streamsize>(rest.size()));
+          if (n <= 0)
+            throw Exception{"cannot write to FastCGI client"};
+          rest.remove_prefix(static_cast<std::size_t>(n));
+        }
+        ++bufs;
+        --count;
+      }
+    }
+  }
+
   /**
    * @brief A result of process_header().
    */
@@ -457,12 +671,11 @@ private:
       (!is_reader() || (buffer_end_ && (buffer_end_ <= buffer_ + buffer_size_)));
     const bool buffer_size_ok = (buffer_size_ >= 2048) &&
       (buffer_size_ <= 65528) && (buffer_size_ % 8 == 0);
-    const bool unread_content_length_ok = (unread_content_length_ <= buffer_size_ &&
-      unread_content_length_ <= static_cast<std::streamsize>(
-        detail::Header::max_content_length));
-    const bool unread_padding_length_ok = (unread_padding_length_ <= buffer_size_ &&
-      unread_padding_length_ <= static_cast<std::streamsize>(
-        detail::Header::max_padding_length));
+    // The record content can be larger than the buffer.
+    const bool unread_content_length_ok = (unread_content_length_ <=
+      static_cast<std::streamsize>(detail::Header::max_content_length));
+    const bool unread_padding_length_ok = (unread_padding_length_ <=
+      static_cast<std::streamsize>(detail::Header::max_padding_length));
     const bool reader_ok = (!is_reader() ||
       (type_ == Type::params) ||
       (connection_->role() == Role{0}) || // unread yet
@@ -545,18 +758,7 @@ private:
 
     const auto process_management_record = [&]()
     {
-      namespace math = dmitigr::math;
       if (header.record_type() == detail::Record_type::get_values) {
-        // The length of "FCGI_MPXS_CONNS" == 15.
-        constexpr std::size_t max_variable_name_length{15};
-        constexpr std::size_t max_body_length{3 * (sizeof(char) + sizeof(char)
-          + max_variable_name_length + sizeof(char))};
-        constexpr std::streamsize max_record_length{sizeof(detail::Header)
-          + max_body_length};
-        std::array<unsigned char,
-          math::aligned<std::size_t>(max_record_length, 8)> record;
-        static_assert((record.size() % 8 == 0));
-
         // Reading the requested variables.
         const auto variables = [&]()
         {
@@ -566,46 +768,9 @@ private:
         if (unread_content_length_ > 0)
           end_request_protocol_violation();
 
-        // Filling up the content of get-values-result.
-        const auto content_offset = std::begin(record) + sizeof(detail::Header);
-        auto p = content_offset;
-        const auto variables_count = variables.pair_count();
-        for (std::size_t i = 0; i < variables_count; ++i) {
-          const auto name = variables.pair(i).name();
-          char value{};
-          if (name == "FCGI_MAX_CONNS")
-            value = '1';
-          else if (name == "FCGI_MAX_REQS")
-            value = '1';
-          else if (name == "FCGI_MPXS_CONNS")
-            value = '0';
-          else
-            continue; // Ignoring other variables specified in the get-values record.
-
-          const auto name_size = name.size();
-          if (name_size > std::numeric_limits<unsigned char>::max())
-            end_request_protocol_violation();
-
-          // Note: name_size + 3 - is a space required to store: {char(name_size), char(1), name.data(), char(value)} string.
-          DMITIGR_ASSERT(name_size + 3 <= static_cast<std::size_t>(
-              std::cend(record) - p));
-          *p++ = static_cast<unsigned char>(name_size); // name_size
-          *p++ = static_cast<unsigned char>(1);         // 1
-          p = std::copy(cbegin(name), cend(name), p);   // name.data()
-          *p++ = static_cast<unsigned char>(value);     // value
-        }
-
-        using detail::Header;
-        const auto content_length = p - content_offset;
-        const auto padding_length = math::padding<std::streamsize>(content_length, 8);
-        const auto record_length = static_cast<int>(sizeof(Header)) +
-          content_length + padding_length;
-        auto* const h = reinterpret_cast<Header*>(record.data());
-        *h = detail::Header{detail::Record_type::get_values_result,
-          Header::null_request_id, static_cast<std::size_t>(content_length),
-          static_cast<std::size_t>(padding_length)};
-        const auto count = connection_->io_->write(
-          reinterpret_cast<const char*>(record.data()), record_length);
+        const auto record = detail::get_values_result(variables, 1, 1, false);
+        const auto record_length = static_cast<std::streamsize>(record.size());
+        const auto count = connection_->io_->write(record.data(), record_length);
         DMITIGR_ASSERT(count == record_length);
       } else {
         const detail::Unknown_type_record r{header.record_type()};
@@ -20,6 +20,15 @@
 #include "streambuf.hpp"
 #include "streams.hpp"
 
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
 namespace dmitigr::fcgi::detail {
 
 /// The base implementation of Istream.
@@ -73,6 +82,24 @@ public:
     return streambuf_.stream_type();
   }
 
+  std::string_view buffered() override
+  {
+    try {
+      const auto result = streambuf_.buffered_input();
+      if (result.empty())
+        setstate(eofbit);
+      return result;
+    } catch (...) {
+      setstate(badbit);
+      throw;
+    }
+  }
+
+  void consume(const std::size_t size) override
+  {
+    streambuf_.consume_input(size);
+  }
+
 private:
   server_Streambuf streambuf_;
 };
@@ -119,6 +146,49 @@ public:
     return streambuf_.stream_type();
   }
 
+  std::size_t max_reserve_size() const noexcept override
+  {
+    return streambuf_.max_output_reserve_size();
+  }
+
+  char* reserve(const std::size_t size) override
+  {
+    try {
+      return streambuf_.reserve_output(size);
+    } catch (...) {
+      setstate(badbit);
+      throw;
+    }
+  }
+
+  void commit(const std::size_t size) override
+  {
+    streambuf_.commit_output(size);
+  }
+
+  using iOstream::send_file;
+
+  void write_direct(const std::string_view data) override
+  {
+    try {
+      streambuf_.write_direct(data);
+    } catch (...) {
+      setstate(badbit);
+      throw;
+    }
+  }
+
+  void send_file(const int fd, const std::int64_t offset,
+    const std::size_t size) override
+  {
+    try {
+      streambuf_.send_file(fd, offset, size);
+    } catch (...) {
+      setstate(badbit);
+      throw;
+    }
+  }
+
 private:
   server_Streambuf streambuf_;
 };
@@ -127,6 +197,40 @@ private:
 
 namespace dmitigr::fcgi {
 
+DMITIGR_FCGI_INLINE void Ostream::send_file(const std::filesystem::path& path)
+{
+#ifdef _WIN32
+  const int fd{::_wopen(path.c_str(), _O_RDONLY | _O_BINARY)};
+#else
+  const int fd{::open(path.c_str(), O_RDONLY | O_CLOEXEC)};
+#endif
+  if (fd < 0)
+    throw Exception{"cannot open file " + path.string()};
+
+  const struct Fd_guard final {
+    ~Fd_guard()
+    {
+#ifdef _WIN32
+      ::_close(fd);
+#else
+      ::close(fd);
+#endif
+    }
+    int fd{};
+  } guard{fd};
+
+#ifdef _WIN32
+  struct _stat64 st{};
+  if (::_fstat64(fd, &st))
+#else
+  struct stat st{};
+  if (::fstat(fd, &st))
+#endif
+    throw Exception{"cannot get size of file " + path.string()};
+
+  send_file(fd, 0, static_cast<std::size_t>(st.st_size));
+}
+
 DMITIGR_FCGI_INLINE std::ostream& crlf(std::ostream& ostr)
 {
   return ostr.write("\r\n", 2);
@@ -20,8 +20,12 @@
 #include "dll.hpp"
 #include "types_fwd.hpp"
 
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
 #include <istream>
 #include <ostream>
+#include <string_view>
 
 namespace dmitigr::fcgi {
 
@@ -60,8 +64,44 @@ private:
   Stream() = default;
 };
 
-/// An input data stream.
+/**
+ * @brief An input data stream.
+ *
+ * @details Besides the `std::istream` interface, the buffered data can be
+ * accessed directly, without the overhead of the formatted input:
+ * @code
+ * for (auto data = in.buffered(); !data.empty(); data = in.buffered()) {
+ *   parser.feed(data);
+ *   in.consume(data.size());
+ * }
+ * @endcode
+ */
 class Istream : public Stream, public std::istream {
+public:
+  /**
+   * @returns The view of the buffered data which is not yet consumed, or
+   * empty view if the end of stream is reached. (The `eofbit` is set in the
+   * latter case.)
+   *
+   * @details If there is no buffered data, the data is read from the FastCGI
+   * client first. The view is contiguous, but may contain only a part of the
+   * stream data.
+   *
+   * @par Requires
+   * `!is_closed()`.
+   *
+   * @remarks The view is invalidated by any subsequent input operation.
+   */
+  virtual std::string_view buffered() = 0;
+
+  /**
+   * @brief Consumes the `size` bytes of the view returned by `buffered()`.
+   *
+   * @par Requires
+   * `!is_closed() && (size <= buffered().size())`.
+   */
+  virtual void consume(std::size_t size) = 0;
+
 private:
   friend detail::iIstream;
 
@@ -70,6 +110,72 @@ private:
 
 /// An output data stream.
 class Ostream : public Stream, public std::ostream {
+public:
+  /// @returns The maximum size of the space which can be reserved at once.
+  virtual std::size_t max_reserve_size() const noexcept = 0;
+
+  /**
+   * @returns The pointer to at least `size` bytes of the stream buffer to
+   * write the data directly, i.e. without the overhead of the formatted
+   * output. The data is not transmitted until it's committed.
+   *
+   * @details The buffered output is transmitted first if there is not enough
+   * space in the buffer.
+   *
+   * @par Requires
+   * `!is_closed() && (size <= max_reserve_size())`.
+   *
+   * @throws Exception on error. In this case the `badbit` is set.
+   *
+   * @see commit().
+   */
+  virtual char* reserve(std::size_t size) = 0;
+
+  /**
+   * @brief Commits the `size` bytes written to the space returned by the last
+   * call of `reserve()`.
+   *
+   * @par Requires
+   * `!is_closed()` and `size` must not exceed the size passed to `reserve()`.
+   */
+  virtual void commit(std::size_t size) = 0;
+
+  /**
+   * @brief Writes `data` without copying it into the stream buffer.
+   *
+   * @details The buffered output is transmitted first. Then `data` is split
+   * into the records of the maximum size which are transmitted by the gather
+   * output operations (i.e. `writev()`), so this is the preferred way to
+   * transmit large response bodies.
+   *
+   * @par Requires
+   * `!is_closed()`.
+   *
+   * @throws Exception on error. In this case the `badbit` is set.
+   */
+  virtual void write_direct(std::string_view data) = 0;
+
+  /**
+   * @brief Writes `size` bytes of the file `fd` starting at `offset`.
+   *
+   * @details The buffered output is transmitted first. Then the content of
+   * the file is transmitted without copying into the user space when possible
+   * (i.e. by using `sendfile()` on Linux).
+   *
+   * @par Requires
+   * `!is_closed()` and `fd` must be a file descriptor opened for reading.
+   *
+   * @throws Exception on error. In this case the `badbit` is set.
+   */
+  virtual void send_file(int fd, std::int64_t offset, std::size_t size) = 0;
+
+  /**
+   * @brief Writes the entire content of the file at `path`.
+   *
+   * @see send_file(int, std::int64_t, std::size_t).
+   */
+  DMITIGR_FCGI_API void send_file(const std::filesystem::path& path);
+
 private:
   friend detail::iOstream;
 
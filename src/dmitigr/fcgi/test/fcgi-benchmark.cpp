@@ -0,0 +1,137 @@
+// -*- C++ -*-
+//
+// Copyright 2023 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Usage:
+//   dmitigr_fcgi-benchmark [--host=127.0.0.1] [--port=9000] [--uds=path]
+//     [--connections=8] [--requests=10000] [--request-size=0]
+//     [--response-size=N] [--keep-conn=1]
+//
+// Sends the requests to the FastCGI application (e.g. dmitigr_fcgi-echo) over
+// the specified number of concurrent connections and reports the number of
+// requests per second and the latency percentiles.
+
+#include "../../fcgi/fcgi.hpp"
+#include "../../prg/command.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+int main(int argc, const char* const argv[])
+{
+  namespace fcgi = dmitigr::fcgi;
+  namespace net = dmitigr::net;
+  namespace prg = dmitigr::prg;
+  using Clock = std::chrono::steady_clock;
+  using std::chrono::duration_cast;
+  using std::chrono::microseconds;
+
+  try {
+    const auto cmd = prg::make_command(&argc, &argv, false);
+    const auto [host, port, uds, connections, requests, request_size,
+      response_size, keep_conn] = cmd.options_strict("host", "port", "uds",
+        "connections", "requests", "request-size", "response-size",
+        "keep-conn");
+    const auto value = [](const prg::Command::Optref& opt,
+      const unsigned long default_value)
+    {
+      return opt.is_valid_throw_if_no_value() ?
+        std::stoul(opt.value_not_empty()) : default_value;
+    };
+
+    const net::Client_options options = uds.is_valid_throw_if_no_value() ?
+      net::Client_options{std::filesystem::path{uds.value_not_empty()}} :
+      net::Client_options{host.is_valid_throw_if_no_value() ?
+        host.value_not_empty() : "127.0.0.1", static_cast<int>(value(port, 9000))};
+    const auto connection_count = std::max(value(connections, 8), 1UL);
+    const auto request_count = value(requests, 10000);
+    const std::string content(value(request_size, 0), 'x');
+    const bool is_keep_conn = value(keep_conn, 1);
+
+    fcgi::Client_connection::Parameters parameters{
+      {"SCRIPT_NAME", "/benchmark"},
+      {"REQUEST_METHOD", "POST"},
+      {"CONTENT_LENGTH", std::to_string(content.size())}};
+    if (response_size.is_valid_throw_if_no_value())
+      parameters.emplace_back("RESPONSE_SIZE", response_size.value_not_empty());
+
+    std::atomic<unsigned long> next_request{};
+    std::atomic<unsigned long> error_count{};
+    std::mutex latencies_mutex;
+    std::vector<Clock::duration> latencies;
+    latencies.reserve(request_count);
+
+    const auto started = Clock::now();
+    std::vector<std::thread> threads;
+    for (unsigned long i{}; i < connection_count; ++i) {
+      threads.emplace_back([&]
+      {
+        std::vector<Clock::duration> thread_latencies;
+        try {
+          fcgi::Client_connection conn{options};
+          while (next_request++ < request_count) {
+            const auto request_started = Clock::now();
+            try {
+              conn.request(parameters, content, is_keep_conn);
+              thread_latencies.push_back(Clock::now() - request_started);
+            } catch (const std::exception& e) {
+              if (!error_count++)
+                std::cerr << "request failed: " << e.what() << std::endl;
+            }
+          }
+        } catch (const std::exception& e) {
+          std::cerr << "cannot connect: " << e.what() << std::endl;
+        }
+        const std::lock_guard lg{latencies_mutex};
+        latencies.insert(latencies.end(),
+          thread_latencies.begin(), thread_latencies.end());
+      });
+    }
+    for (auto& thread : threads)
+      thread.join();
+    const auto elapsed = Clock::now() - started;
+
+    if (latencies.empty())
+      throw std::runtime_error{"no requests completed"};
+
+    std::sort(latencies.begin(), latencies.end());
+    const auto percentile = [&latencies](const double p)
+    {
+      const auto index = static_cast<std::size_t>(p / 100 * (latencies.size() - 1));
+      return duration_cast<microseconds>(latencies[index]).count();
+    };
+    const auto seconds = std::chrono::duration<double>(elapsed).count();
+    std::printf("requests: %zu (errors: %lu)\n", latencies.size(),
+      error_count.load());
+    std::printf("elapsed: %.3f s\n", seconds);
+    std::printf("rps: %.0f\n", static_cast<double>(latencies.size()) / seconds);
+    std::printf("latency (us): p50 %lld, p90 %lld, p99 %lld, p99.9 %lld, max %lld\n",
+      static_cast<long long>(percentile(50)),
+      static_cast<long long>(percentile(90)),
+      static_cast<long long>(percentile(99)),
+      static_cast<long long>(percentile(99.9)),
+      static_cast<long long>(percentile(100)));
+  } catch (const std::exception& e) {
+    std::cerr << "Oops: " << e.what() << std::endl;
+    return 1;
+  }
+}
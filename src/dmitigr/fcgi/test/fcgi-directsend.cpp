@@ -0,0 +1,47 @@
+// -*- C++ -*-
+//
+// Copyright 2023 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "../../base/rnd.hpp"
+#include "../../fcgi/fcgi.hpp"
+
+#include <iostream>
+#include <string>
+
+int main(int, char* argv[])
+{
+  namespace fcgi = dmitigr::fcgi;
+  namespace rnd = dmitigr::rnd;
+
+  rnd::seed_by_now();
+  try {
+    const auto port = 9000;
+    const auto backlog = 64;
+    fcgi::Listener server{fcgi::Listener_options{"0.0.0.0", port, backlog}};
+    server.listen();
+    while (true) {
+      if (const auto conn = server.accept()) {
+        conn->out() << "Content-Type: application/octet-stream" << fcgi::crlfcrlf;
+        const auto str = rnd::str("abc", 300000);
+        conn->out().write_direct(str);
+        conn->out() << "\n" << str.size() << "\n";
+        conn->out().send_file(argv[0]); // the executable itself
+      }
+    }
+  } catch (const std::exception& e) {
+    std::cerr << "Oops: " << e.what() << std::endl;
+    return 1;
+  }
+}
@@ -0,0 +1,64 @@
+// -*- C++ -*-
+//
+// Copyright 2023 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "../../fcgi/fcgi.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+int main()
+{
+  namespace fcgi = dmitigr::fcgi;
+  try {
+    const auto port = 9000;
+    const auto backlog = 64;
+    fcgi::Listener server{fcgi::Listener_options{"0.0.0.0", port, backlog}};
+    server.listen();
+    while (true) {
+      if (const auto conn = server.accept()) {
+        auto& in = conn->in();
+        auto& out = conn->out();
+        out << "Content-Type: application/octet-stream" << fcgi::crlfcrlf;
+        if (conn->parameter_index("RESPONSE_SIZE")) {
+          // Responding with the requested number of bytes.
+          for (auto data = in.buffered(); !data.empty(); data = in.buffered())
+            in.consume(data.size());
+          auto response_size = std::stoul(std::string{
+              conn->parameter("RESPONSE_SIZE")});
+          while (response_size) {
+            const auto size = std::min(response_size, out.max_reserve_size());
+            std::memset(out.reserve(size), 'x', size);
+            out.commit(size);
+            response_size -= size;
+          }
+        } else {
+          // Echoing the request content.
+          for (auto data = in.buffered(); !data.empty(); data = in.buffered()) {
+            const auto size = std::min(data.size(), out.max_reserve_size());
+            std::memcpy(out.reserve(size), data.data(), size);
+            out.commit(size);
+            in.consume(size);
+          }
+        }
+      }
+    }
+  } catch (const std::exception& e) {
+    std::cerr << "Oops: " << e.what() << std::endl;
+    return 1;
+  }
+}
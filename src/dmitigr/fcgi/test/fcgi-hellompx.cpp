@@ -0,0 +1,66 @@
+// -*- C++ -*-
+//
+// Copyright 2023 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "../../fcgi/fcgi.hpp"
+
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr std::size_t pool_size{8};
+
+} // namespace
+
+int main()
+{
+  namespace fcgi = dmitigr::fcgi;
+  try {
+    const auto serve = [](auto* const server)
+    {
+      while (true) {
+        const auto conn = server->accept();
+        const std::string content{std::istreambuf_iterator<char>{conn->in()}, {}};
+        conn->out() << "Content-Type: text/plain" << fcgi::crlfcrlf;
+        conn->out() << "Hello from dmitigr::fcgi request " << conn->request_id()
+                    << " with " << content.size() << " bytes of content!";
+      }
+    };
+
+    const auto port = 9000;
+    const auto backlog = 64;
+    std::clog << "Multi-threaded FastCGI server with multiplexing started:\n"
+              << "  port = " << port << "\n"
+              << "  backlog = " << backlog << "\n"
+              << "  thread pool size = " << pool_size << std::endl;
+
+    fcgi::Listener server{fcgi::Listener_options{"0.0.0.0", port, backlog}
+      .set_multiplexing_enabled(true)};
+    server.listen();
+    std::vector<std::thread> threads(pool_size);
+    for (auto& t : threads)
+      t = std::thread{serve, &server};
+
+    for (auto& t : threads)
+      t.join();
+  } catch (const std::exception& e) {
+    std::cerr << "error: " << e.what() << std::endl;
+    return 1;
+  }
+}
@@ -0,0 +1,47 @@
+// -*- C++ -*-
+//
+// Copyright 2023 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "../../fcgi/fcgi.hpp"
+
+#include <iostream>
+
+int main()
+{
+  namespace fcgi = dmitigr::fcgi;
+  try {
+    const auto port = 9000;
+    const auto backlog = 512;
+    const auto thread_count = 16;
+    const auto reactor_count = 2;
+    std::clog << "Multi-threaded FastCGI server based on reactors started:\n"
+              << "  port = " << port << "\n"
+              << "  backlog = " << backlog << "\n"
+              << "  thread pool size = " << thread_count << "\n"
+              << "  reactor count = " << reactor_count << std::endl;
+
+    fcgi::Server server{fcgi::Listener_options{"0.0.0.0", port, backlog},
+      [](fcgi::Server_connection& conn)
+      {
+        conn.out() << "Content-Type: text/plain" << fcgi::crlfcrlf;
+        conn.out() << "Hello from dmitigr::fcgi!";
+      }, thread_count, reactor_count};
+    server.start();
+    server.wait();
+  } catch (const std::exception& e) {
+    std::cerr << "error: " << e.what() << std::endl;
+    return 1;
+  }
+}
@@ -25,8 +25,12 @@ enum class Stream_type;
 
 class Exception;
 
+struct Response;
+class Client_connection;
+
 class Listener;
 class Listener_options;
+class Server;
 
 class Connection_parameter;
 class Connection;
@@ -54,6 +58,13 @@ class Names_values;
 class iListener;
 class iListener_options;
 class iServer_connection;
+class Buffer_pool;
+class Buffer_pools;
+class Kept_connections;
+class Multiplexer;
+class Multiplexers;
+class Reactor;
+class Reactor_connection;
 class iStreambuf;
 class server_Streambuf;
 class iIstream;
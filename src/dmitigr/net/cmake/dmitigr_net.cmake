@@ -35,6 +35,9 @@ set(dmitigr_net_headers
   exceptions.hpp
   last_error.hpp
   listener.hpp
+  listener_shards.hpp
+  poller.hpp
+  reactor.hpp
   socket.hpp
   types_fwd.hpp
   util.hpp
@@ -63,7 +66,7 @@ endif()
 
 if(DMITIGR_LIBS_TESTS)
   if(UNIX AND NOT CMAKE_SYSTEM_NAME MATCHES MSYS|MinGW|Cygwin)
-    set(dmitigr_net_tests net)
+    set(dmitigr_net_tests net descriptor listener_shards poll reactor)
     set(dmitigr_net_tests_target_link_libraries dmitigr_base)
   endif()
 endif()
@@ -23,16 +23,48 @@
 
 #include <algorithm>
 #include <array>
+#include <chrono>
+#include <cstdint>
 #include <cstdio>
+#include <cstring>
+#include <deque>
 #include <ios> // std::streamsize
+#include <memory>
+#include <optional>
+#include <string_view>
 #include <utility> // std::move()
 
 #ifdef _WIN32
 #include "../os/windows.hpp"
+
+#include <io.h>
+#else
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <linux/errqueue.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/sendfile.h>
+#endif
+#endif
+
+#if defined(__linux__) && defined(MSG_ZEROCOPY) && defined(SO_ZEROCOPY)
+#define DMITIGR_NET_ZEROCOPY
 #endif
 
 namespace dmitigr::net {
 
+/// A buffer to read into.
+struct Mutable_buffer final {
+  /// The data.
+  char* data{};
+
+  /// The size of data.
+  std::size_t size{};
+};
+
 /// A descriptor to perform low-level I/O operations.
 class Descriptor {
 public:
@@ -52,6 +84,16 @@ public:
    */
   virtual std::streamsize read(char* buf, std::streamsize len) = 0;
 
+  /**
+   * @brief Reads from this descriptor synchronously into `count` buffers
+   * in order (scatter input).
+   *
+   * @returns Number of bytes read. (Can be less than the total size of
+   * the buffers.)
+   */
+  virtual std::streamsize readv(const Mutable_buffer* bufs,
+    std::size_t count) = 0;
+
   /**
    * @brief Writes to this descriptor synchronously.
    *
@@ -59,7 +101,76 @@ public:
    */
   virtual std::streamsize write(const char* buf, std::streamsize len) = 0;
 
-  /// Closes the descriptor.
+  /**
+   * @brief Writes the data of `count` buffers to this descriptor synchronously
+   * in order (gather output).
+   *
+   * @returns Number of bytes written. (Can be less than the total size of
+   * the buffers.)
+   */
+  virtual std::streamsize writev(const std::string_view* bufs,
+    std::size_t count) = 0;
+
+  /**
+   * @brief Writes `header`, then `size` bytes of the file `fd` starting at
+   * `offset`, then `trailer` to this descriptor synchronously.
+   *
+   * @details The content of the file is transmitted without copying into the
+   * user space when possible (e.g. by using `sendfile()` on Linux).
+   *
+   * @par Requires
+   * `fd` must be a file descriptor opened for reading.
+   *
+   * @throws An instance of Exception if not all the data are written.
+   */
+  virtual void send_file(int fd, std::int64_t offset, std::size_t size,
+    std::string_view header, std::string_view trailer) = 0;
+
+  /// @overload
+  void send_file(const int fd, const std::int64_t offset, const std::size_t size)
+  {
+    send_file(fd, offset, size, {}, {});
+  }
+
+  /**
+   * @brief Writes the `data` to this descriptor synchronously without copying
+   * it into the kernel when possible (e.g. by using `MSG_ZEROCOPY` on Linux).
+   *
+   * @details The data is transmitted without copying only if its size is not
+   * less than the threshold set by set_zerocopy_threshold(). In this case the
+   * `keeper` is retained by this instance until the kernel no longer references
+   * the `data`, so the caller must neither modify nor free the `data` other
+   * than by releasing the `keeper`. Otherwise, the `data` is copied as by
+   * write() and the `keeper` is released upon return.
+   *
+   * @returns Number of bytes written.
+   *
+   * @par Requires
+   * `keeper` must own (or share the ownership of) the storage of `data`.
+   */
+  virtual std::streamsize write_zerocopy(std::string_view data,
+    std::shared_ptr<const void> keeper) = 0;
+
+  /**
+   * @brief Sets the minimum size of the data written by a single call of
+   * write_zerocopy() to be transmitted without copying into the kernel, or
+   * disables the zero-copy transmission if `threshold` is `std::nullopt`.
+   *
+   * @details The zero-copy transmission is worth only for very large writes,
+   * since the pages of the data are pinned and the completion notifications
+   * must be processed.
+   *
+   * @returns `false` if the zero-copy transmission is not supported.
+   */
+  virtual bool set_zerocopy_threshold(std::optional<std::size_t> threshold) = 0;
+
+  /**
+   * @brief Closes the descriptor.
+   *
+   * @details Blocks until the kernel no longer references the data written by
+   * write_zerocopy(), i.e. until it's acknowledged by the peer or the
+   * connection is aborted.
+   */
   virtual void close() = 0;
 
   /// @returns Native handle (i.e. socket or named pipe).
@@ -80,6 +191,103 @@ public:
   {
     return 2147479552; // as on Linux
   }
+
+  std::streamsize readv(const Mutable_buffer* const bufs,
+    const std::size_t count) override
+  {
+    if (!bufs && count)
+      throw Exception{"cannot read from descriptor to null buffers"};
+
+    std::streamsize result{};
+    for (std::size_t i{}; i < count; ++i) {
+      const auto len = static_cast<std::streamsize>(bufs[i].size);
+      const auto n = len ? read(bufs[i].data, len) : 0;
+      result += n;
+      if (n < len)
+        break;
+    }
+    return result;
+  }
+
+  std::streamsize writev(const std::string_view* const bufs,
+    const std::size_t count) override
+  {
+    if (!bufs && count)
+      throw Exception{"cannot write to descriptor from null buffers"};
+
+    std::streamsize result{};
+    for (std::size_t i{}; i < count; ++i) {
+      const auto len = static_cast<std::streamsize>(bufs[i].size());
+      const auto n = len ? write(bufs[i].data(), len) : 0;
+      result += n;
+      if (n < len)
+        break;
+    }
+    return result;
+  }
+
+  void send_file(const int fd, std::int64_t offset, std::size_t size,
+    const std::string_view header, const std::string_view trailer) override
+  {
+    write_all(header);
+    if (size) {
+      const auto buf_size = std::min<std::size_t>(size, 65536);
+      const std::unique_ptr<char[]> buf{new char[buf_size]};
+      while (size) {
+        const auto n = read_file(fd, buf.get(), std::min(size, buf_size), offset);
+        write_all({buf.get(), n});
+        offset += static_cast<std::int64_t>(n);
+        size -= n;
+      }
+    }
+    write_all(trailer);
+  }
+
+  std::streamsize write_zerocopy(const std::string_view data,
+    std::shared_ptr<const void>) override
+  {
+    return write(data.data(), static_cast<std::streamsize>(data.size()));
+  }
+
+  bool set_zerocopy_threshold(const std::optional<std::size_t> threshold) override
+  {
+    return !threshold;
+  }
+
+protected:
+  /// Writes all of the `data` to this descriptor.
+  void write_all(std::string_view data)
+  {
+    while (!data.empty()) {
+      const auto n = write(data.data(), static_cast<std::streamsize>(data.size()));
+      if (n <= 0)
+        throw Exception{"cannot write to descriptor"};
+      data.remove_prefix(static_cast<std::size_t>(n));
+    }
+  }
+
+  /**
+   * @brief Reads up to `len` bytes of the file `fd` starting at `offset`.
+   *
+   * @returns Number of bytes read which is never zero.
+   */
+  static std::size_t read_file(const int fd, char* const buf,
+    std::size_t len, const std::int64_t offset)
+  {
+#ifdef _WIN32
+    if (::_lseeki64(fd, offset, SEEK_SET) < 0)
+      throw os::Sys_exception{errno, "cannot seek file"};
+    len = std::min<std::size_t>(len, 2147479552);
+    const auto result = ::_read(fd, buf, static_cast<unsigned>(len));
+#else
+    const auto result = ::pread(fd, buf, len, static_cast<off_t>(offset));
+#endif
+    if (result < 0)
+      throw os::Sys_exception{errno, "cannot read file"};
+    else if (!result)
+      throw Exception{"cannot read file: unexpected end of file"};
+    return static_cast<std::size_t>(result);
+  }
 };
 
 /// The implementation of Descriptor based on sockets.
@@ -95,6 +303,9 @@ public:
       } catch (...) {
         std::fprintf(stderr, "bug\n");
       }
+#ifdef DMITIGR_NET_ZEROCOPY
+      release_zerocopy_keepers(); // if close() is failed
+#endif
     }
   }
 
@@ -123,6 +334,29 @@ public:
     return static_cast<std::streamsize>(result);
   }
 
+#ifndef _WIN32
+  std::streamsize readv(const Mutable_buffer* const bufs,
+    std::size_t count) override
+  {
+    if (!bufs && count)
+      throw Exception{"cannot read from socket to null buffers"};
+
+    std::array<::iovec, 64> iov;
+    count = std::min(count, iov.size());
+    for (std::size_t i{}; i < count; ++i)
+      iov[i] = {bufs[i].data, bufs[i].size};
+
+    ::msghdr msg{};
+    msg.msg_iov = iov.data();
+    msg.msg_iovlen = static_cast<decltype(msg.msg_iovlen)>(count);
+    const auto result = ::recvmsg(socket_, &msg, 0);
+    if (net::is_socket_error(result))
+      throw DMITIGR_NET_EXCEPTION{"cannot read from socket"};
+
+    return static_cast<std::streamsize>(result);
+  }
+#endif
+
   std::streamsize write(const char* const buf, std::streamsize len) override
   {
     if (!buf)
@@ -134,6 +368,9 @@ public:
 #else
     constexpr int flags{MSG_NOSIGNAL};
 #endif
+#ifdef DMITIGR_NET_ZEROCOPY
+    reap_zerocopy_completions();
+#endif
 #ifdef _WIN32
     const auto buf_len = static_cast<int>(len);
 #else
@@ -146,6 +383,99 @@ public:
     return static_cast<std::streamsize>(result);
   }
 
+#ifndef _WIN32
+  std::streamsize writev(const std::string_view* const bufs,
+    std::size_t count) override
+  {
+    if (!bufs && count)
+      throw Exception{"cannot write to socket from null buffers"};
+
+    std::array<::iovec, 64> iov;
+    count = std::min(count, iov.size());
+    for (std::size_t i{}; i < count; ++i)
+      iov[i] = {const_cast<char*>(bufs[i].data()), bufs[i].size()};
+
+    ::msghdr msg{};
+    msg.msg_iov = iov.data();
+    msg.msg_iovlen = static_cast<decltype(msg.msg_iovlen)>(count);
+#ifdef DMITIGR_NET_ZEROCOPY
+    reap_zerocopy_completions();
+#endif
+#ifdef __APPLE__
+    constexpr int flags{};
+#else
+    constexpr int flags{MSG_NOSIGNAL};
+#endif
+    const auto result = ::sendmsg(socket_, &msg, flags);
+    if (net::is_socket_error(result))
+      throw DMITIGR_NET_EXCEPTION{"cannot write to socket"};
+
+    return static_cast<std::streamsize>(result);
+  }
+#endif
+
+#ifdef __linux__
+  void send_file(const int fd, const std::int64_t offset, std::size_t size,
+    const std::string_view header, const std::string_view trailer) override
+  {
+    // Let the header to be coalesced with the beginning of the file.
+    for (auto data = header; !data.empty();) {
+      const auto n = ::send(socket_, data.data(), data.size(),
+        MSG_NOSIGNAL | (size || !trailer.empty() ? MSG_MORE : 0));
+      if (net::is_socket_error(n))
+        throw DMITIGR_NET_EXCEPTION{"cannot write to socket"};
+      data.remove_prefix(static_cast<std::size_t>(n));
+    }
+
+    auto off = static_cast<off_t>(offset);
+    while (size) {
+      const auto n = ::sendfile(socket_, fd, &off,
+        std::min<std::size_t>(size, 2147479552));
+      if (n < 0)
+        throw os::Sys_exception{errno, "cannot send file to socket"};
+      else if (!n)
+        throw Exception{"cannot send file to socket: unexpected end of file"};
+      size -= static_cast<std::size_t>(n);
+    }
+
+    write_all(trailer);
+  }
+#endif
+
+  std::streamsize write_zerocopy(const std::string_view data,
+    std::shared_ptr<const void> keeper) override
+  {
+#ifdef DMITIGR_NET_ZEROCOPY
+    if (zerocopy_threshold_ && data.size() >= *zerocopy_threshold_) {
+      if (data.empty())
+        return 0;
+      const auto len = std::min<std::size_t>(data.size(),
+        static_cast<std::size_t>(max_write_size()));
+      ::iovec iov{const_cast<char*>(data.data()), len};
+      ::msghdr msg{};
+      msg.msg_iov = &iov;
+      msg.msg_iovlen = 1;
+      return send_zerocopy(msg, std::move(keeper));
+    }
+#endif
+    return write(data.data(), static_cast<std::streamsize>(data.size()));
+  }
+
+  bool set_zerocopy_threshold(const std::optional<std::size_t> threshold) override
+  {
+#ifdef DMITIGR_NET_ZEROCOPY
+    if (threshold && !zerocopy_threshold_) {
+      const int optval = 1;
+      if (::setsockopt(socket_, SOL_SOCKET, SO_ZEROCOPY, &optval, sizeof(optval)))
+        return false;
+    }
+    zerocopy_threshold_ = threshold;
+    return true;
+#else
+    return !threshold;
+#endif
+  }
+
   void close() override
   {
     if (!is_shutted_down_) {
@@ -153,6 +483,10 @@ public:
       is_shutted_down_ = true;
     }
 
+#ifdef DMITIGR_NET_ZEROCOPY
+    release_zerocopy_keepers();
+#endif
+
     if (socket_.close() != 0)
       throw os::Sys_exception{"cannot close socket"};
   }
@@ -165,6 +499,145 @@ public:
 private:
   bool is_shutted_down_{};
   net::Socket_guard socket_;
+#ifdef DMITIGR_NET_ZEROCOPY
+  /// The maximum number of the pending zero-copy sends.
+  static constexpr std::size_t zerocopy_pending_max_{1024};
+
+  std::optional<std::size_t> zerocopy_threshold_;
+  std::uint32_t zerocopy_sent_{};
+  /// The keepers of the pending zero-copy sends in order of their sequences.
+  std::deque<std::pair<std::shared_ptr<const void>, bool>> zerocopy_pending_;
+
+  /**
+   * @brief Sends the `msg` with `MSG_ZEROCOPY` and retains the `keeper` until
+   * the completion.
+   *
+   * @details Falls back to copying if the kernel is out of memory to pin the
+   * pages (`ENOBUFS`), or if there are too many pending sends which are not
+   * completed in a reasonable time.
+   */
+  std::streamsize send_zerocopy(::msghdr& msg, std::shared_ptr<const void> keeper)
+  {
+    reap_zerocopy_completions();
+    const bool is_zerocopy{zerocopy_pending_.size() < zerocopy_pending_max_ ||
+      wait_zerocopy_completion(std::chrono::seconds{1}, zerocopy_pending_max_ / 2)};
+    auto result = is_zerocopy ?
+      ::sendmsg(socket_, &msg, MSG_NOSIGNAL | MSG_ZEROCOPY) : -1;
+    if (!net::is_socket_error(result)) {
+      // Each successful send consumes the next sequence number.
+      ++zerocopy_sent_;
+      zerocopy_pending_.emplace_back(std::move(keeper), false);
+    } else if (!is_zerocopy || errno == ENOBUFS)
+      result = ::sendmsg(socket_, &msg, MSG_NOSIGNAL);
+    if (net::is_socket_error(result))
+      throw DMITIGR_NET_EXCEPTION{"cannot write to socket"};
+
+    return static_cast<std::streamsize>(result);
+  }
+
+  /**
+   * @brief Reads the available completion notifications of the zero-copy
+   * sends from the error queue of the socket without blocking and releases
+   * the keepers of the completed sends.
+   *
+   * @details Each notification denotes the range of sequences of the completed
+   * sends. (The sequence of the first pending send is `zerocopy_sent_ - size`.)
+   */
+  void reap_zerocopy_completions()
+  {
+    while (!zerocopy_pending_.empty()) {
+      alignas(::cmsghdr) char control[128];
+      ::msghdr msg{};
+      msg.msg_control = control;
+      msg.msg_controllen = sizeof(control);
+      if (net::is_socket_error(::recvmsg(socket_, &msg,
+            MSG_ERRQUEUE | MSG_DONTWAIT))) {
+        if (errno == EAGAIN || errno == EINTR)
+          break;
+        throw DMITIGR_NET_EXCEPTION{"cannot read error queue of socket"};
+      }
+
+      for (auto* cm = CMSG_FIRSTHDR(&msg); cm; cm = CMSG_NXTHDR(&msg, cm)) {
+        if (!((cm->cmsg_level == SOL_IP && cm->cmsg_type == IP_RECVERR) ||
+            (cm->cmsg_level == SOL_IPV6 && cm->cmsg_type == IPV6_RECVERR)))
+          continue;
+
+        ::sock_extended_err err;
+        std::memcpy(&err, CMSG_DATA(cm), sizeof(err));
+        if (err.ee_origin != SO_EE_ORIGIN_ZEROCOPY || err.ee_errno)
+          continue;
+
+        const auto first = static_cast<std::uint32_t>(zerocopy_sent_ -
+          zerocopy_pending_.size());
+        const std::uint32_t count = err.ee_data - err.ee_info + 1;
+        for (std::uint32_t j{}; j < count; ++j) {
+          const std::uint32_t i = err.ee_info + j - first;
+          if (i < zerocopy_pending_.size())
+            zerocopy_pending_[i].second = true;
+        }
+      }
+
+      while (!zerocopy_pending_.empty() && zerocopy_pending_.front().second)
+        zerocopy_pending_.pop_front();
+    }
+  }
+
+  /**
+   * @brief Waits until the number of the pending zero-copy sends is not
+   * greater than `max_pending`, but no longer than `timeout`.
+   *
+   * @returns `true` on success.
+   *
+   * @remarks `(timeout < 0)` means *no timeout*.
+   */
+  bool wait_zerocopy_completion(const std::chrono::milliseconds timeout,
+    const std::size_t max_pending = 0)
+  {
+    namespace chrono = std::chrono;
+    const auto deadline = chrono::steady_clock::now() + timeout;
+    while (reap_zerocopy_completions(), zerocopy_pending_.size() > max_pending) {
+      auto rest = timeout;
+      if (!(timeout.count() < 0)) {
+        rest = chrono::ceil<chrono::milliseconds>(
+          deadline - chrono::steady_clock::now());
+        if (rest <= chrono::milliseconds::zero())
+          return false;
+      }
+
+      ::pollfd pfd{socket_, 0, 0}; // POLLERR is always reported
+      if (::poll(&pfd, 1, detail::to_poll_timeout(rest)) < 0 && errno != EINTR)
+        throw DMITIGR_NET_EXCEPTION{"cannot poll socket"};
+    }
+    return true;
+  }
+
+  /**
+   * @brief Waits for the completions of all of the pending zero-copy sends
+   * and releases their keepers.
+   *
+   * @details The kernel transmits right from the pages of the data until the
+   * send is completed, so if the keeper were released earlier, the storage
+   * could be reused and the (re)transmitted segments would carry the foreign
+   * data. The completion is received as soon as the data is acknowledged by
+   * the peer or the connection is aborted, thus there is no timeout. If the
+   * completions cannot be received at all, the storage is leaked deliberately.
+   */
+  void release_zerocopy_keepers() noexcept
+  {
+    if (zerocopy_pending_.empty())
+      return;
+
+    try {
+      wait_zerocopy_completion(std::chrono::milliseconds{-1});
+      return;
+    } catch (const std::exception& e) {
+      std::fprintf(stderr, "%s\n", e.what());
+    } catch (...) {}
+    for (auto& pending : zerocopy_pending_)
+      new std::shared_ptr<const void>{std::move(pending.first)};
+    zerocopy_pending_.clear();
+  }
+#endif
 
   /**
    * @brief Gracefully shutting down the socket.
@@ -203,6 +676,233 @@ private:
   }
 };
 
+/**
+ * @brief The implementation of Descriptor based on non-blocking sockets.
+ *
+ * @details Intended to be used along with an event loop (e.g. net::Reactor),
+ * so read(), readv(), write() and writev() never blocks and return `-1` if
+ * the operation would block. (read() and readv() return `0` at the end of
+ * input.)
+ *
+ * @remarks send_file() waits for the socket to be ready for writing as
+ * many times as needed to transmit all of the data.
+ */
+class nonblocking_socket_Descriptor final : public iDescriptor {
+public:
+  ~nonblocking_socket_Descriptor() override
+  {
+    if (net::is_socket_valid(socket_)) {
+      try {
+        close();
+      } catch (const std::exception& e) {
+        std::fprintf(stderr, "%s\n", e.what());
+      } catch (...) {
+        std::fprintf(stderr, "bug\n");
+      }
+    }
+  }
+
+  /// Switches the `socket` to the non-blocking mode.
+  explicit nonblocking_socket_Descriptor(net::Socket_guard socket)
+    : socket_{std::move(socket)}
+  {
+    DMITIGR_ASSERT(net::is_socket_valid(socket_));
+    net::set_nonblocking(socket_, true);
+  }
+
+  std::streamsize read(char* const buf, std::streamsize len) override
+  {
+    if (!buf)
+      throw Exception{"cannot read from socket to null buffer"};
+
+    len = std::min(len, max_read_size());
+#ifdef _WIN32
+    const auto buf_len = static_cast<int>(len);
+#else
+    const auto buf_len = static_cast<std::size_t>(len);
+#endif
+    while (true) {
+      const auto result = ::recv(socket_, buf, buf_len, 0);
+      if (!net::is_socket_error(result))
+        return static_cast<std::streamsize>(result);
+      else if (net::is_would_block(net::last_error()))
+        return -1;
+      else if (!is_interrupted())
+        throw DMITIGR_NET_EXCEPTION{"cannot read from socket"};
+    }
+  }
+
+#ifndef _WIN32
+  std::streamsize readv(const Mutable_buffer* const bufs,
+    std::size_t count) override
+  {
+    if (!bufs && count)
+      throw Exception{"cannot read from socket to null buffers"};
+
+    std::array<::iovec, 64> iov;
+    count = std::min(count, iov.size());
+    for (std::size_t i{}; i < count; ++i)
+      iov[i] = {bufs[i].data, bufs[i].size};
+
+    ::msghdr msg{};
+    msg.msg_iov = iov.data();
+    msg.msg_iovlen = static_cast<decltype(msg.msg_iovlen)>(count);
+    while (true) {
+      const auto result = ::recvmsg(socket_, &msg, 0);
+      if (!net::is_socket_error(result))
+        return static_cast<std::streamsize>(result);
+      else if (net::is_would_block(net::last_error()))
+        return -1;
+      else if (!is_interrupted())
+        throw DMITIGR_NET_EXCEPTION{"cannot read from socket"};
+    }
+  }
+#endif
+
+  std::streamsize write(const char* const buf, std::streamsize len) override
+  {
+    if (!buf)
+      throw Exception{"cannot write to socket from null buffer"};
+
+    len = std::min(len, max_write_size());
+#ifdef _WIN32
+    const auto buf_len = static_cast<int>(len);
+#else
+    const auto buf_len = static_cast<std::size_t>(len);
+#endif
+    while (true) {
+      const auto result = ::send(socket_, buf, buf_len, send_flags);
+      if (!net::is_socket_error(result))
+        return static_cast<std::streamsize>(result);
+      else if (net::is_would_block(net::last_error()))
+        return -1;
+      else if (!is_interrupted())
+        throw DMITIGR_NET_EXCEPTION{"cannot write to socket"};
+    }
+  }
+
+#ifndef _WIN32
+  std::streamsize writev(const std::string_view* const bufs,
+    std::size_t count) override
+  {
+    if (!bufs && count)
+      throw Exception{"cannot write to socket from null buffers"};
+
+    std::array<::iovec, 64> iov;
+    count = std::min(count, iov.size());
+    for (std::size_t i{}; i < count; ++i)
+      iov[i] = {const_cast<char*>(bufs[i].data()), bufs[i].size()};
+
+    ::msghdr msg{};
+    msg.msg_iov = iov.data();
+    msg.msg_iovlen = static_cast<decltype(msg.msg_iovlen)>(count);
+    while (true) {
+      const auto result = ::sendmsg(socket_, &msg, send_flags);
+      if (!net::is_socket_error(result))
+        return static_cast<std::streamsize>(result);
+      else if (net::is_would_block(net::last_error()))
+        return -1;
+      else if (!is_interrupted())
+        throw DMITIGR_NET_EXCEPTION{"cannot write to socket"};
+    }
+  }
+#endif
+
+  void send_file(const int fd, std::int64_t offset, std::size_t size,
+    const std::string_view header, const std::string_view trailer) override
+  {
+    send_all(header);
+#ifdef __linux__
+    for (auto off = static_cast<off_t>(offset); size;) {
+      const auto n = ::sendfile(socket_, fd, &off,
+        std::min<std::size_t>(size, 2147479552));
+      if (n > 0)
+        size -= static_cast<std::size_t>(n);
+      else if (!n)
+        throw Exception{"cannot send file to socket: unexpected end of file"};
+      else if (net::is_would_block(errno))
+        wait_writable();
+      else if (errno != EINTR)
+        throw os::Sys_exception{errno, "cannot send file to socket"};
+    }
+#else
+    if (size) {
+      const auto buf_size = std::min<std::size_t>(size, 65536);
+      const std::unique_ptr<char[]> buf{new char[buf_size]};
+      while (size) {
+        const auto n = read_file(fd, buf.get(), std::min(size, buf_size), offset);
+        send_all({buf.get(), n});
+        offset += static_cast<std::int64_t>(n);
+        size -= n;
+      }
+    }
+#endif
+    send_all(trailer);
+  }
+
+  /**
+   * @details Shutdowns the sending side of the socket, discards the input
+   * which is already received (without waiting for the rest of it) and
+   * closes the socket.
+   */
+  void close() override
+  {
+    if (!is_shutted_down_) {
+      is_shutted_down_ = true;
+      if (net::is_socket_error(::shutdown(socket_, net::sd_send)) && errno != ENOTCONN)
+        throw DMITIGR_NET_EXCEPTION{"cannot shutdown socket"};
+      std::array<char, 1024> trashcan;
+      while (read(trashcan.data(),
+          static_cast<std::streamsize>(trashcan.size())) > 0);
+    }
+
+    if (socket_.close() != 0)
+      throw os::Sys_exception{"cannot close socket"};
+  }
+
+  std::intptr_t native_handle() noexcept override
+  {
+    return socket_;
+  }
+
+private:
+#if defined(_WIN32) || defined(__APPLE__)
+  static constexpr int send_flags{};
+#else
+  static constexpr int send_flags{MSG_NOSIGNAL};
+#endif
+  bool is_shutted_down_{};
+  net::Socket_guard socket_;
+
+  static bool is_interrupted() noexcept
+  {
+#ifdef _WIN32
+    return net::last_error() == WSAEINTR;
+#else
+    return errno == EINTR;
+#endif
+  }
+
+  /// Waits for the socket to be ready for writing.
+  void wait_writable()
+  {
+    using Sr = net::Socket_readiness;
+    net::poll(socket_, Sr::write_ready, std::chrono::milliseconds{-1});
+  }
+
+  /// Writes all of the `data` by waiting for the socket as needed.
+  void send_all(std::string_view data)
+  {
+    while (!data.empty()) {
+      const auto n = write(data.data(), static_cast<std::streamsize>(data.size()));
+      if (n < 0)
+        wait_writable();
+      else
+        data.remove_prefix(static_cast<std::size_t>(n));
+    }
+  }
+};
+
 #ifdef _WIN32
 
 /// The implementation of Descriptor based on Windows Named Pipes.
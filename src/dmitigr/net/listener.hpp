@@ -118,9 +118,101 @@ public:
     return backlog_;
   }
 
+  /**
+   * @brief Sets the option which allows several listeners to be bound to the
+   * same address and port (SO_REUSEPORT socket option), so the incoming
+   * connections are distributed among them by the operating system.
+   *
+   * @remarks Has effect only for `Communication_mode::net` on the platforms
+   * which are supports SO_REUSEPORT.
+   */
+  Listener_options& set_reuse_port_enabled(const bool value) noexcept
+  {
+    is_reuse_port_enabled_ = value;
+    return *this;
+  }
+
+  /// @returns `true` if SO_REUSEPORT socket option is requested.
+  bool is_reuse_port_enabled() const noexcept
+  {
+    return is_reuse_port_enabled_;
+  }
+
+  /**
+   * @brief Sets the option which disables the Nagle's algorithm (TCP_NODELAY
+   * socket option) on the accepted sockets, so the small writes are sent
+   * without delay.
+   *
+   * @remarks Has effect only for `Communication_mode::net`.
+   */
+  Listener_options& set_no_delay_enabled(const bool value) noexcept
+  {
+    is_no_delay_enabled_ = value;
+    return *this;
+  }
+
+  /// @returns `true` if TCP_NODELAY socket option is requested.
+  bool is_no_delay_enabled() const noexcept
+  {
+    return is_no_delay_enabled_;
+  }
+
+  /**
+   * @brief Sets the option which defers the readiness of the connection to be
+   * accepted until the data arrives, but no longer than `timeout`
+   * (TCP_DEFER_ACCEPT socket option).
+   *
+   * @details This reduces the number of wakeups of the acceptor for protocols
+   * where the client sends first (e.g. HTTP or FastCGI).
+   *
+   * @remarks Has effect only for `Communication_mode::net` on Linux.
+   */
+  Listener_options& set_defer_accept(
+    const std::optional<std::chrono::seconds> timeout) noexcept
+  {
+    defer_accept_ = timeout;
+    return *this;
+  }
+
+  /// @returns The timeout of TCP_DEFER_ACCEPT socket option.
+  std::optional<std::chrono::seconds> defer_accept() const noexcept
+  {
+    return defer_accept_;
+  }
+
+  /**
+   * @brief Sets the option which enables the TCP Fast Open with the given
+   * maximum `size` of the queue of pending TFO requests (TCP_FASTOPEN socket
+   * option), so the data of the first request can be received with SYN.
+   *
+   * @par Requires
+   * `!size || *size > 0`.
+   *
+   * @remarks Has effect only for `Communication_mode::net` on the platforms
+   * which are supports TCP_FASTOPEN.
+   */
+  Listener_options& set_fast_open_queue_size(const std::optional<int> size)
+  {
+    if (size && !(*size > 0))
+      throw Exception{"invalid size of TCP Fast Open queue for network "
+        "listener options"};
+    fast_open_queue_size_ = size;
+    return *this;
+  }
+
+  /// @returns The size of the queue of TCP_FASTOPEN socket option.
+  std::optional<int> fast_open_queue_size() const noexcept
+  {
+    return fast_open_queue_size_;
+  }
+
 private:
   Endpoint endpoint_;
   std::optional<int> backlog_;
+  bool is_reuse_port_enabled_{};
+  bool is_no_delay_enabled_{};
+  std::optional<std::chrono::seconds> defer_accept_;
+  std::optional<int> fast_open_queue_size_;
 
   bool is_invariant_ok() const
   {
@@ -189,6 +281,9 @@ public:
   /// Stops the listening.
   virtual void close() = 0;
 
+  /// @returns Native handle (i.e. socket or named pipe).
+  virtual std::intptr_t native_handle() noexcept = 0;
+
 private:
   friend detail::iListener;
 
@@ -253,6 +348,30 @@ public:
           reinterpret_cast<const char*>(&optval), optlen) != 0)
         throw DMITIGR_NET_EXCEPTION{"cannot set SO_REUSEADDR socket option"};
 
+#ifdef SO_REUSEPORT
+      if (options_.is_reuse_port_enabled() &&
+        ::setsockopt(socket_, SOL_SOCKET, SO_REUSEPORT,
+          reinterpret_cast<const char*>(&optval), optlen) != 0)
+        throw DMITIGR_NET_EXCEPTION{"cannot set SO_REUSEPORT socket option"};
+#endif
+
+#ifdef TCP_DEFER_ACCEPT
+      if (const auto timeout = options_.defer_accept()) {
+        const int seconds = static_cast<int>(timeout->count());
+        if (::setsockopt(socket_, IPPROTO_TCP, TCP_DEFER_ACCEPT,
+            reinterpret_cast<const char*>(&seconds), optlen) != 0)
+          throw DMITIGR_NET_EXCEPTION{"cannot set TCP_DEFER_ACCEPT socket option"};
+      }
+#endif
+
+#ifdef TCP_FASTOPEN
+      if (const auto size = options_.fast_open_queue_size()) {
+        if (::setsockopt(socket_, IPPROTO_TCP, TCP_FASTOPEN,
+            reinterpret_cast<const char*>(&*size), optlen) != 0)
+          throw DMITIGR_NET_EXCEPTION{"cannot set TCP_FASTOPEN socket option"};
+      }
+#endif
+
       bind_socket(socket_, {net::Ip_address::from_text(*eid.net_address()),
         *eid.net_port()});
     };
@@ -300,11 +419,13 @@ public:
 #else
     constexpr ::socklen_t* addrlen{};
 #endif
-    if (net::Socket_guard sock{::accept(socket_, addr, addrlen)};
-      !net::is_socket_valid(sock))
+    net::Socket_guard sock{::accept(socket_, addr, addrlen)};
+    if (!net::is_socket_valid(sock))
       throw DMITIGR_NET_EXCEPTION{"cannot accept on socket"};
-    else
-      return std::make_unique<socket_Descriptor>(std::move(sock));
+    else if (options_.is_no_delay_enabled() &&
+      options_.endpoint().communication_mode() == Communication_mode::net)
+      set_no_delay(sock, true);
+    return std::make_unique<socket_Descriptor>(std::move(sock));
   }
 
   void close() override
@@ -313,6 +434,11 @@ public:
       throw DMITIGR_NET_EXCEPTION{"cannot close socket"};
   }
 
+  std::intptr_t native_handle() noexcept override
+  {
+    return socket_;
+  }
+
 private:
   net::Socket_guard socket_;
   Listener_options options_;
@@ -461,6 +587,11 @@ public:
     }
   }
 
+  std::intptr_t native_handle() noexcept override
+  {
+    return reinterpret_cast<std::intptr_t>(pipe_.handle());
+  }
+
 private:
   bool is_listening_{};
   os::windows::Handle_guard pipe_{INVALID_HANDLE_VALUE};
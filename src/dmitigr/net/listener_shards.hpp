@@ -0,0 +1,231 @@
+// -*- C++ -*-
+//
+// Copyright 2023 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DMITIGR_NET_LISTENER_SHARDS_HPP
+#define DMITIGR_NET_LISTENER_SHARDS_HPP
+
+#ifdef __linux__
+
+#include "../base/thread.hpp"
+#include "exceptions.hpp"
+#include "listener.hpp"
+#include "reactor.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace dmitigr::net {
+
+/**
+ * @brief A set of listeners (shards) bound to the same endpoint, each of which
+ * accepts the connections in its own event loop running on its own thread.
+ *
+ * @details For `Communication_mode::net` each shard has its own listening
+ * socket (SO_REUSEPORT), so the connections are load-balanced among the shards
+ * by the kernel rather than contend on the same accept queue. For other modes
+ * the single listening socket is shared by the shards. The thread of the
+ * shard `i` is pinned to the CPU `i % std::thread::hardware_concurrency()`
+ * if possible.
+ *
+ * The exceptions thrown by the Accept_handler are caught and reported to the
+ * standard error, and the shard continues to accept the connections. If the
+ * event loop of a shard fails, its own listening socket is closed.
+ *
+ * @remarks Not thread-safe.
+ */
+class Listener_shards final {
+public:
+  /**
+   * @brief The handler of the accepted non-blocking socket.
+   *
+   * @details Called on the thread of the shard which accepted the `socket`,
+   * so the `socket` can be registered in the `reactor` of this shard.
+   */
+  using Accept_handler = std::function<void(Socket_guard socket,
+    Reactor& reactor, std::size_t shard)>;
+
+  /// The destructor.
+  ~Listener_shards()
+  {
+    stop();
+  }
+
+  /**
+   * @brief The constructor.
+   *
+   * @par Requires
+   * `count > 0 && handler`.
+   */
+  Listener_shards(Listener_options options, const std::size_t count,
+    Accept_handler handler)
+    : options_{std::move(options)}
+    , count_{count}
+    , handler_{std::move(handler)}
+  {
+    if (!count_)
+      throw Exception{"cannot create listener shards: zero count"};
+    else if (!handler_)
+      throw Exception{"cannot create listener shards: invalid handler"};
+  }
+
+  /// Non copy-constructible.
+  Listener_shards(const Listener_shards&) = delete;
+
+  /// Non copy-assignable.
+  Listener_shards& operator=(const Listener_shards&) = delete;
+
+  /// Non move-constructible.
+  Listener_shards(Listener_shards&&) = delete;
+
+  /// Non move-assignable.
+  Listener_shards& operator=(Listener_shards&&) = delete;
+
+  /// @returns The options of the listeners.
+  const Listener_options& options() const noexcept
+  {
+    return options_;
+  }
+
+  /// @returns The number of shards.
+  std::size_t size() const noexcept
+  {
+    return count_;
+  }
+
+  /// @returns `true` if the shards are running.
+  bool is_running() const noexcept
+  {
+    return !threads_.empty();
+  }
+
+  /**
+   * @brief Starts the listening and the threads of the shards.
+   *
+   * @par Requires
+   * `!is_running()`.
+   */
+  void start()
+  {
+    if (is_running())
+      throw Exception{"cannot start listener shards which are already running"};
+
+    try {
+      const bool is_shared = options_.endpoint().communication_mode() !=
+        Communication_mode::net;
+      for (std::size_t i{}; i < (is_shared ? 1 : count_); ++i) {
+        auto options = options_;
+        options.set_reuse_port_enabled(!is_shared);
+        auto& listener = listeners_.emplace_back(Listener::make(options));
+        listener->listen();
+      }
+
+      for (std::size_t i{}; i < count_; ++i) {
+        auto& reactor = *reactors_.emplace_back(std::make_unique<Reactor>());
+        reactor.add_listener(*listeners_[is_shared ? 0 : i],
+          [this, &reactor, i, is_shared](Socket_guard socket)
+          {
+            // The failure to handle the socket must not stop the shard.
+            try {
+              if (options_.is_no_delay_enabled() && !is_shared)
+                set_no_delay(socket, true);
+              handler_(std::move(socket), reactor, i);
+            } catch (const std::exception& e) {
+              std::fprintf(stderr, "listener shard accept error: %s\n", e.what());
+            } catch (...) {
+              std::fprintf(stderr, "listener shard accept error: unknown error\n");
+            }
+          }, is_shared && count_ > 1);
+      }
+
+      const auto cpu_count = std::max(std::thread::hardware_concurrency(), 1U);
+      for (std::size_t i{}; i < count_; ++i) {
+        auto& thread = threads_.emplace_back([reactor = reactors_[i].get(),
+          listener = is_shared ? nullptr : listeners_[i].get()]
+        {
+          try {
+            reactor->run();
+            return;
+          } catch (const std::exception& e) {
+            std::fprintf(stderr, "listener shard error: %s\n", e.what());
+          } catch (...) {
+            std::fprintf(stderr, "listener shard error: unknown error\n");
+          }
+
+          /*
+           * The own listener of the failed shard is closed, otherwise the
+           * kernel would continue to distribute the connections to it.
+           */
+          if (listener) {
+            try {
+              listener->close();
+            } catch (const std::exception& e) {
+              std::fprintf(stderr, "listener shard error: %s\n", e.what());
+            }
+          }
+        });
+        thread::set_affinity(thread, static_cast<unsigned>(i % cpu_count));
+      }
+    } catch (...) {
+      stop();
+      throw;
+    }
+  }
+
+  /// Stops the threads of the shards and closes the listeners.
+  void stop() noexcept
+  {
+    for (const auto& reactor : reactors_)
+      reactor->stop();
+    for (auto& thread : threads_)
+      thread.join();
+    threads_.clear();
+    reactors_.clear();
+    listeners_.clear();
+  }
+
+  /**
+   * @returns The event loop of the `shard`.
+   *
+   * @par Requires
+   * `is_running() && shard < size()`.
+   */
+  Reactor& reactor(const std::size_t shard)
+  {
+    if (!(shard < reactors_.size()))
+      throw Exception{"cannot get reactor of listener shard: invalid index"};
+    return *reactors_[shard];
+  }
+
+private:
+  Listener_options options_;
+  std::size_t count_{};
+  Accept_handler handler_;
+  std::vector<std::unique_ptr<Listener>> listeners_;
+  std::vector<std::unique_ptr<Reactor>> reactors_;
+  std::vector<std::thread> threads_;
+};
+
+} // namespace dmitigr::net
+
+#endif  // __linux__
+
+#endif  // DMITIGR_NET_LISTENER_SHARDS_HPP
@@ -28,6 +28,9 @@
 #include "exceptions.hpp"
 #include "last_error.hpp"
 #include "listener.hpp"
+#include "listener_shards.hpp"
+#include "poller.hpp"
+#include "reactor.hpp"
 #include "socket.hpp"
 #include "util.hpp"
 #include "version.hpp"
@@ -0,0 +1,288 @@
+// -*- C++ -*-
+//
+// Copyright 2023 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DMITIGR_NET_POLLER_HPP
+#define DMITIGR_NET_POLLER_HPP
+
+#include "exceptions.hpp"
+#include "socket.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#ifdef __linux__
+#include <sys/epoll.h>
+#include <unistd.h>
+#endif
+
+namespace dmitigr::net {
+
+/**
+ * @brief A poller of the readiness of multiple sockets.
+ *
+ * @details Unlike net::poll(), the sockets are registered once and then
+ * polled together. The implementation is based on epoll (level-triggered)
+ * on Linux, so the cost of wait() doesn't depends on the number of the
+ * registered sockets. On other platforms poll() (WSAPoll() on Windows) is
+ * used.
+ *
+ * @remarks Not thread-safe.
+ */
+class Poller final {
+public:
+  /// The readiness of the registered socket.
+  struct Event final {
+    /// The socket.
+    Socket_native socket{};
+
+    /// The readiness of the socket.
+    Socket_readiness readiness{};
+  };
+
+  /// The destructor.
+  ~Poller()
+  {
+#ifdef __linux__
+    if (epoll_ >= 0)
+      ::close(epoll_);
+#endif
+  }
+
+  /// The constructor.
+  Poller()
+  {
+#ifdef __linux__
+    epoll_ = ::epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_ < 0)
+      throw DMITIGR_NET_EXCEPTION{"cannot create epoll instance"};
+#endif
+  }
+
+  /// Non copy-constructible.
+  Poller(const Poller&) = delete;
+
+  /// Non copy-assignable.
+  Poller& operator=(const Poller&) = delete;
+
+  /// Non move-constructible.
+  Poller(Poller&&) = delete;
+
+  /// Non move-assignable.
+  Poller& operator=(Poller&&) = delete;
+
+  /// @returns The number of the registered sockets.
+  std::size_t size() const noexcept
+  {
+    return size_;
+  }
+
+  /**
+   * @brief Registers the `socket` to poll it for readiness specified by `mask`.
+   *
+   * @par Requires
+   * `is_socket_valid(socket)` and the `socket` must not be registered.
+   */
+  void add(const Socket_native socket, const Socket_readiness mask)
+  {
+    if (!is_socket_valid(socket))
+      throw Exception{"cannot add an invalid socket to poller"};
+
+#ifdef __linux__
+    ::epoll_event event{to_epoll_events(mask), {}};
+    event.data.u64 = to_epoll_data(socket, mask);
+    if (::epoll_ctl(epoll_, EPOLL_CTL_ADD, socket, &event))
+      throw DMITIGR_NET_EXCEPTION{"cannot add socket to poller"};
+#else
+    if (find(socket) != fds_.end())
+      throw Exception{"cannot add socket to poller: already added"};
+    detail::Pollfd fd{};
+    fd.fd = socket;
+    fd.events = detail::to_poll_events(mask);
+    fds_.push_back(fd);
+    masks_.push_back(mask);
+#endif
+    ++size_;
+  }
+
+  /**
+   * @brief Changes the readiness to poll the registered `socket` for.
+   *
+   * @par Requires
+   * The `socket` must be registered.
+   */
+  void modify(const Socket_native socket, const Socket_readiness mask)
+  {
+#ifdef __linux__
+    ::epoll_event event{to_epoll_events(mask), {}};
+    event.data.u64 = to_epoll_data(socket, mask);
+    if (::epoll_ctl(epoll_, EPOLL_CTL_MOD, socket, &event))
+      throw DMITIGR_NET_EXCEPTION{"cannot modify socket of poller"};
+#else
+    const auto i = find(socket);
+    if (i == fds_.end())
+      throw Exception{"cannot modify socket of poller: not added"};
+    i->events = detail::to_poll_events(mask);
+    masks_[static_cast<std::size_t>(i - fds_.begin())] = mask;
+#endif
+  }
+
+  /**
+   * @brief Unregisters the `socket`.
+   *
+   * @par Requires
+   * The `socket` must be registered.
+   */
+  void remove(const Socket_native socket)
+  {
+#ifdef __linux__
+    if (::epoll_ctl(epoll_, EPOLL_CTL_DEL, socket, nullptr))
+      throw DMITIGR_NET_EXCEPTION{"cannot remove socket from poller"};
+#else
+    const auto i = find(socket);
+    if (i == fds_.end())
+      throw Exception{"cannot remove socket from poller: not added"};
+    masks_.erase(masks_.begin() + (i - fds_.begin()));
+    fds_.erase(i);
+#endif
+    --size_;
+  }
+
+  /**
+   * @brief Waits for the readiness of the registered sockets.
+   *
+   * @returns The events of the ready sockets, or empty vector if the `timeout`
+   * elapsed. The returned reference is valid until the next call of wait().
+   *
+   * @remarks `(timeout < 0)` means *no timeout*.
+   * @remarks The wait is resumed (with the rest of the `timeout`) if
+   * interrupted by a signal.
+   */
+  const std::vector<Event>& wait(std::chrono::milliseconds timeout)
+  {
+    namespace chrono = std::chrono;
+    using Clock = chrono::steady_clock;
+    const auto deadline = Clock::now() + timeout;
+    events_.clear();
+#ifdef __linux__
+    ready_.resize(std::max<std::size_t>(size_, 1));
+    int r{};
+    while ((r = ::epoll_wait(epoll_, ready_.data(),
+          static_cast<int>(ready_.size()), detail::to_poll_timeout(timeout))) < 0
+      && errno == EINTR) {
+      if (timeout > chrono::milliseconds::zero())
+        timeout = std::max(chrono::ceil<chrono::milliseconds>(
+            deadline - Clock::now()), chrono::milliseconds::zero());
+    }
+    if (r < 0)
+      throw DMITIGR_NET_EXCEPTION{"cannot wait for sockets readiness"};
+    for (int i{}; i < r; ++i) {
+      const auto& e = ready_[static_cast<std::size_t>(i)];
+      const auto [socket, mask] = from_epoll_data(e.data.u64);
+      events_.push_back({socket, to_socket_readiness(e.events, mask)});
+    }
+#else
+    int r{};
+    while (true) {
+#ifdef _WIN32
+      r = fds_.empty() ? 0 : ::WSAPoll(fds_.data(),
+        static_cast<ULONG>(fds_.size()), detail::to_poll_timeout(timeout));
+      break;
+#else
+      r = ::poll(fds_.data(), static_cast<nfds_t>(fds_.size()),
+        detail::to_poll_timeout(timeout));
+      if (!(r < 0 && errno == EINTR))
+        break;
+      else if (timeout > chrono::milliseconds::zero())
+        timeout = std::max(chrono::ceil<chrono::milliseconds>(
+            deadline - Clock::now()), chrono::milliseconds::zero());
+#endif
+    }
+    if (is_socket_error(r))
+      throw DMITIGR_NET_EXCEPTION{"cannot wait for sockets readiness"};
+    for (std::size_t i{}; r > 0 && i < fds_.size(); ++i) {
+      if (fds_[i].revents)
+        events_.push_back({fds_[i].fd,
+          detail::to_socket_readiness(fds_[i].revents, masks_[i])});
+    }
+#endif
+    return events_;
+  }
+
+private:
+  std::size_t size_{};
+  std::vector<Event> events_;
+#ifdef __linux__
+  int epoll_{-1};
+  std::vector<::epoll_event> ready_;
+
+  static std::uint32_t to_epoll_events(const Socket_readiness mask) noexcept
+  {
+    std::uint32_t result{};
+    if (bool(mask & Socket_readiness::read_ready))
+      result |= EPOLLIN;
+    if (bool(mask & Socket_readiness::write_ready))
+      result |= EPOLLOUT;
+    if (bool(mask & Socket_readiness::exceptions))
+      result |= EPOLLPRI;
+    return result;
+  }
+
+  static std::uint64_t to_epoll_data(const Socket_native socket,
+    const Socket_readiness mask) noexcept
+  {
+    return static_cast<std::uint64_t>(static_cast<std::uint32_t>(socket)) |
+      static_cast<std::uint64_t>(mask) << 32;
+  }
+
+  static std::pair<Socket_native, Socket_readiness>
+  from_epoll_data(const std::uint64_t data) noexcept
+  {
+    return {static_cast<Socket_native>(static_cast<std::uint32_t>(data)),
+      static_cast<Socket_readiness>(data >> 32)};
+  }
+
+  static Socket_readiness to_socket_readiness(const std::uint32_t events,
+    const Socket_readiness mask) noexcept
+  {
+    auto result = Socket_readiness::unready;
+    if (events & (EPOLLIN | EPOLLHUP | EPOLLERR))
+      result |= Socket_readiness::read_ready;
+    if (events & (EPOLLOUT | EPOLLHUP | EPOLLERR))
+      result |= Socket_readiness::write_ready;
+    if (events & EPOLLPRI)
+      result |= Socket_readiness::exceptions;
+    return result & mask;
+  }
+#else
+  std::vector<detail::Pollfd> fds_;
+  std::vector<Socket_readiness> masks_;
+
+  auto find(const Socket_native socket)
+  {
+    return find_if(fds_.begin(), fds_.end(),
+      [socket](const auto& fd){return fd.fd == socket;});
+  }
+#endif
+};
+
+} // namespace dmitigr::net
+
+#endif  // DMITIGR_NET_POLLER_HPP
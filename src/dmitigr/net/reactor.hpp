@@ -0,0 +1,443 @@
+// -*- C++ -*-
+//
+// Copyright 2023 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DMITIGR_NET_REACTOR_HPP
+#define DMITIGR_NET_REACTOR_HPP
+
+#ifdef __linux__
+
+#include "../base/assert.hpp"
+#include "exceptions.hpp"
+#include "listener.hpp"
+#include "socket.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace dmitigr::net {
+
+/**
+ * @brief An event loop based on edge-triggered epoll.
+ *
+ * @details The handler of the registered socket is called when the socket
+ * becomes ready, so it must perform I/O until the operation would block
+ * (e.g. by using detail::nonblocking_socket_Descriptor), otherwise it will
+ * not be called again until the new data arrives. Timers and tasks posted
+ * from other threads are executed on the thread running the loop.
+ *
+ * @remarks Only post() and stop() are thread-safe. Other functions must be
+ * called either before run() or from the handlers.
+ *
+ * @remarks Exceptions thrown by the handlers are propagated to the caller
+ * of run().
+ */
+class Reactor final {
+public:
+  /// The handler of the socket readiness.
+  using Handler = std::function<void(Socket_readiness)>;
+
+  /// The handler of the accepted non-blocking socket.
+  using Accept_handler = std::function<void(Socket_guard)>;
+
+  /// The task to execute on the thread running the loop.
+  using Task = std::function<void()>;
+
+  /// The clock of the timers.
+  using Clock = std::chrono::steady_clock;
+
+  /// The timer identifier.
+  using Timer_id = std::uint64_t;
+
+  /// The destructor.
+  ~Reactor()
+  {
+    if (event_ >= 0)
+      ::close(event_);
+    if (epoll_ >= 0)
+      ::close(epoll_);
+  }
+
+  /// The constructor.
+  Reactor()
+  {
+    if ((epoll_ = ::epoll_create1(EPOLL_CLOEXEC)) < 0)
+      throw DMITIGR_NET_EXCEPTION{"cannot create epoll instance"};
+    else if ((event_ = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)) < 0)
+      throw DMITIGR_NET_EXCEPTION{"cannot create eventfd"};
+    ctl(EPOLL_CTL_ADD, event_, EPOLLIN | EPOLLET, wakeup_key);
+  }
+
+  /// Non copy-constructible.
+  Reactor(const Reactor&) = delete;
+
+  /// Non copy-assignable.
+  Reactor& operator=(const Reactor&) = delete;
+
+  /// Non move-constructible.
+  Reactor(Reactor&&) = delete;
+
+  /// Non move-assignable.
+  Reactor& operator=(Reactor&&) = delete;
+
+  /**
+   * @brief Registers the `socket` and its `handler` to be called each time
+   * the `socket` becomes ready as specified by `mask`.
+   *
+   * @par Requires
+   * `is_socket_valid(socket) && handler` and the `socket` must not be
+   * registered.
+   *
+   * @remarks The `socket` should be non-blocking.
+   */
+  void add(const Socket_native socket, const Socket_readiness mask,
+    Handler handler)
+  {
+    add(socket, to_epoll_events(mask), std::move(handler));
+  }
+
+  /**
+   * @brief Changes the readiness of the registered `socket` to be notified on.
+   *
+   * @par Requires
+   * The `socket` must be registered by add().
+   */
+  void modify(const Socket_native socket, const Socket_readiness mask)
+  {
+    const auto i = keys_.find(socket);
+    if (i == keys_.end())
+      throw Exception{"cannot modify socket of reactor: not added"};
+    ctl(EPOLL_CTL_MOD, socket, to_epoll_events(mask), i->second);
+  }
+
+  /**
+   * @brief Unregisters the `socket`.
+   *
+   * @details The handler of the `socket` will not be called after this call
+   * even if the event of the `socket` is already received.
+   *
+   * @returns `true` if the `socket` was registered.
+   */
+  bool remove(const Socket_native socket) noexcept
+  {
+    const auto i = keys_.find(socket);
+    if (i == keys_.end())
+      return false;
+    ::epoll_ctl(epoll_, EPOLL_CTL_DEL, socket, nullptr);
+    handlers_.erase(i->second);
+    keys_.erase(i);
+    return true;
+  }
+
+  /**
+   * @brief Registers the listening `socket` to accept the connections.
+   *
+   * @details Each time the `socket` becomes ready, all of the pending
+   * connections are accepted (by calling `accept4()` in a loop) and passed
+   * to the `handler` as non-blocking sockets. If the accepting fails because
+   * of lack of resources (e.g. descriptors) it's retried in 100 ms.
+   *
+   * @param socket The listening socket. It's switched to the non-blocking mode.
+   * @param handler The handler of the accepted sockets.
+   * @param is_exclusive Specifies whether only one of the reactors sharing
+   * the `socket` is woken up on the incoming connection (`EPOLLEXCLUSIVE`).
+   *
+   * @remarks The `socket` can be unregistered by remove().
+   */
+  void add_listener(const Socket_native socket, Accept_handler handler,
+    const bool is_exclusive = false)
+  {
+    if (!handler)
+      throw Exception{"cannot add listener to reactor: invalid handler"};
+
+    set_nonblocking(socket, true);
+    auto accept = std::make_shared<Task>();
+    *accept = [this, socket, handler = std::move(handler),
+      weak = std::weak_ptr<Task>{accept}]
+    {
+      while (true) {
+        Socket_guard result{::accept4(socket, nullptr, nullptr,
+          SOCK_NONBLOCK | SOCK_CLOEXEC)};
+        if (is_socket_valid(result)) {
+          handler(std::move(result));
+          continue;
+        }
+
+        switch (errno) {
+        case EINTR: [[fallthrough]];
+        case ECONNABORTED: [[fallthrough]];
+        case EPROTO:
+          continue;
+        case EMFILE: [[fallthrough]];
+        case ENFILE: [[fallthrough]];
+        case ENOBUFS: [[fallthrough]];
+        case ENOMEM:
+          // The socket is ready, so the next edge may never come.
+          add_timer(std::chrono::milliseconds{100}, [weak]
+          {
+            if (const auto accept = weak.lock())
+              (*accept)();
+          });
+          return;
+        default:
+          if (!is_would_block(errno))
+            throw DMITIGR_NET_EXCEPTION{"cannot accept connection"};
+          return;
+        }
+      }
+    };
+    add(socket, EPOLLIN | (is_exclusive ? std::uint32_t{EPOLLEXCLUSIVE} : 0),
+      [accept](Socket_readiness){(*accept)();});
+  }
+
+  /// @overload
+  void add_listener(Listener& listener, Accept_handler handler,
+    const bool is_exclusive = false)
+  {
+    add_listener(static_cast<Socket_native>(listener.native_handle()),
+      std::move(handler), is_exclusive);
+  }
+
+  /**
+   * @brief Schedules the one-shot `task` to be executed after `delay`.
+   *
+   * @details The negative `delay` is treated as zero.
+   *
+   * @returns The identifier of the timer.
+   */
+  Timer_id add_timer(const std::chrono::milliseconds delay, Task task)
+  {
+    if (!task)
+      throw Exception{"cannot add timer to reactor: invalid task"};
+
+    const auto id = ++last_timer_id_;
+    const auto time = Clock::now() +
+      std::max(delay, std::chrono::milliseconds::zero());
+    timers_.emplace(std::make_pair(time, id), std::move(task));
+    timer_times_.emplace(id, time);
+    return id;
+  }
+
+  /**
+   * @brief Cancels the timer.
+   *
+   * @returns `true` if the timer was pending.
+   */
+  bool cancel_timer(const Timer_id id) noexcept
+  {
+    const auto i = timer_times_.find(id);
+    if (i == timer_times_.end())
+      return false;
+    timers_.erase(std::make_pair(i->second, id));
+    timer_times_.erase(i);
+    return true;
+  }
+
+  /// Schedules the `task` to be executed on the thread running the loop.
+  void post(Task task)
+  {
+    if (!task)
+      throw Exception{"cannot post task to reactor: invalid task"};
+
+    {
+      const std::lock_guard lg{tasks_mutex_};
+      tasks_.push_back(std::move(task));
+    }
+    wakeup();
+  }
+
+  /**
+   * @brief Runs one iteration of the loop.
+   *
+   * @details Waits for the events up to `timeout` (or the expiration of the
+   * nearest timer) and calls the corresponding handlers, timers and posted
+   * tasks.
+   *
+   * @returns `false` if stop() has been called.
+   *
+   * @remarks `(timeout < 0)` means *no timeout*.
+   */
+  bool run_once(std::chrono::milliseconds timeout)
+  {
+    namespace chrono = std::chrono;
+    if (!timers_.empty()) {
+      const auto until = chrono::ceil<chrono::milliseconds>(
+        timers_.begin()->first.first - Clock::now());
+      timeout = timeout.count() < 0 ? until : std::min(timeout, until);
+      timeout = std::max(timeout, chrono::milliseconds::zero());
+    }
+
+    std::array<::epoll_event, 256> events;
+    const int count = ::epoll_wait(epoll_, events.data(),
+      static_cast<int>(events.size()), detail::to_poll_timeout(timeout));
+    if (count < 0 && errno != EINTR)
+      throw DMITIGR_NET_EXCEPTION{"cannot wait for events on epoll instance"};
+
+    for (int i{}; i < count; ++i) {
+      const auto& event = events[static_cast<std::size_t>(i)];
+      if (event.data.u64 == wakeup_key) {
+        std::uint64_t value{};
+        [[maybe_unused]] const auto r = ::read(event_, &value, sizeof(value));
+      } else if (const auto h = handlers_.find(event.data.u64);
+        h != handlers_.end()) {
+        const auto handler = h->second; // the handler may remove itself
+        (*handler)(to_socket_readiness(event.events));
+      }
+    }
+
+    /*
+     * Only the timers which are due at the moment of this snapshot are run,
+     * so the timers scheduled by the timers themselves (which are always
+     * later than the snapshot, or have greater identifiers) cannot starve
+     * the event processing.
+     */
+    const auto due = std::make_pair(Clock::now(), last_timer_id_);
+    while (!timers_.empty() && timers_.begin()->first <= due) {
+      const auto i = timers_.begin();
+      const auto task = std::move(i->second);
+      timer_times_.erase(i->first.second);
+      timers_.erase(i);
+      task();
+    }
+
+    std::vector<Task> tasks;
+    {
+      const std::lock_guard lg{tasks_mutex_};
+      tasks.swap(tasks_);
+    }
+    for (const auto& task : tasks)
+      task();
+
+    return !is_stopped_.load();
+  }
+
+  /// Runs the loop until stop() is called.
+  void run()
+  {
+    while (run_once(std::chrono::milliseconds{-1}));
+  }
+
+  /**
+   * @brief Stops the loop.
+   *
+   * @details run() returns as soon as the current iteration completes, or
+   * immediately if it's called after this call.
+   */
+  void stop() noexcept
+  {
+    is_stopped_ = true;
+    wakeup();
+  }
+
+  /// @returns `true` if stop() has been called.
+  bool is_stopped() const noexcept
+  {
+    return is_stopped_.load();
+  }
+
+private:
+  static constexpr std::uint64_t wakeup_key{};
+  int epoll_{-1};
+  int event_{-1};
+  std::atomic_bool is_stopped_{};
+  std::uint64_t last_key_{wakeup_key};
+  std::unordered_map<Socket_native, std::uint64_t> keys_;
+  std::unordered_map<std::uint64_t, std::shared_ptr<Handler>> handlers_;
+  Timer_id last_timer_id_{};
+  std::map<std::pair<Clock::time_point, Timer_id>, Task> timers_;
+  std::unordered_map<Timer_id, Clock::time_point> timer_times_;
+  std::mutex tasks_mutex_;
+  std::vector<Task> tasks_;
+
+  void add(const Socket_native socket, const std::uint32_t events,
+    Handler handler)
+  {
+    if (!is_socket_valid(socket))
+      throw Exception{"cannot add an invalid socket to reactor"};
+    else if (!handler)
+      throw Exception{"cannot add socket to reactor: invalid handler"};
+    else if (keys_.count(socket))
+      throw Exception{"cannot add socket to reactor: already added"};
+
+    // Keys are never reused, so the stale events of the removed sockets
+    // are not delivered to the handlers of the sockets added later.
+    const auto key = ++last_key_;
+    ctl(EPOLL_CTL_ADD, socket, events, key);
+    handlers_.emplace(key, std::make_shared<Handler>(std::move(handler)));
+    keys_.emplace(socket, key);
+  }
+
+  void ctl(const int op, const int fd, const std::uint32_t events,
+    const std::uint64_t key)
+  {
+    ::epoll_event event{};
+    event.events = events | EPOLLET;
+    event.data.u64 = key;
+    if (::epoll_ctl(epoll_, op, fd, &event))
+      throw DMITIGR_NET_EXCEPTION{"cannot control epoll instance"};
+  }
+
+  void wakeup() noexcept
+  {
+    const std::uint64_t value{1};
+    [[maybe_unused]] const auto r = ::write(event_, &value, sizeof(value));
+  }
+
+  static std::uint32_t to_epoll_events(const Socket_readiness mask) noexcept
+  {
+    std::uint32_t result{EPOLLRDHUP};
+    if (bool(mask & Socket_readiness::read_ready))
+      result |= EPOLLIN;
+    if (bool(mask & Socket_readiness::write_ready))
+      result |= EPOLLOUT;
+    if (bool(mask & Socket_readiness::exceptions))
+      result |= EPOLLPRI;
+    return result;
+  }
+
+  static Socket_readiness to_socket_readiness(const std::uint32_t events) noexcept
+  {
+    auto result = Socket_readiness::unready;
+    if (events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR))
+      result |= Socket_readiness::read_ready;
+    if (events & (EPOLLOUT | EPOLLHUP | EPOLLERR))
+      result |= Socket_readiness::write_ready;
+    if (events & EPOLLPRI)
+      result |= Socket_readiness::exceptions;
+    return result;
+  }
+};
+
+} // namespace dmitigr::net
+
+#endif  // __linux__
+
+#endif  // DMITIGR_NET_REACTOR_HPP
@@ -39,8 +39,12 @@
 
 #include <sys/time.h> // timeval
 #include <sys/types.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
 #include <sys/socket.h>
 #include <sys/select.h>
+#include <poll.h>
 #include <unistd.h>
 #endif
 
@@ -152,6 +156,55 @@ inline void set_timeout(const Socket_native socket,
     throw DMITIGR_NET_EXCEPTION{"cannot set timeout on a socket"};
 }
 
+/// Enables or disables the non-blocking mode of the `socket`.
+inline void set_nonblocking(const Socket_native socket, const bool value)
+{
+#ifdef _WIN32
+  u_long mode = value;
+  const auto r = ::ioctlsocket(socket, FIONBIO, &mode);
+#else
+  const int flags = ::fcntl(socket, F_GETFL);
+  const auto r = flags < 0 ? flags : ::fcntl(socket, F_SETFL,
+    value ? (flags | O_NONBLOCK) : (flags & ~O_NONBLOCK));
+#endif
+  if (net::is_socket_error(r))
+    throw DMITIGR_NET_EXCEPTION{"cannot set non-blocking mode of a socket"};
+}
+
+/**
+ * @brief Enables or disables the Nagle's algorithm of the TCP `socket`
+ * (TCP_NODELAY socket option).
+ */
+inline void set_no_delay(const Socket_native socket, const bool value)
+{
+  const int optval = value;
+#ifdef _WIN32
+  const auto optlen = static_cast<int>(sizeof(optval));
+#else
+  const auto optlen = static_cast<::socklen_t>(sizeof(optval));
+#endif
+  if (::setsockopt(socket, IPPROTO_TCP, TCP_NODELAY,
+      reinterpret_cast<const char*>(&optval), optlen) != 0)
+    throw DMITIGR_NET_EXCEPTION{"cannot set TCP_NODELAY socket option"};
+}
+
+/**
+ * @returns `true` if the `error` is represents an indication that the
+ * operation on a non-blocking socket would block.
+ */
+inline bool is_would_block(const int error) noexcept
+{
+#ifdef _WIN32
+  return error == WSAEWOULDBLOCK;
+#else
+#if EAGAIN != EWOULDBLOCK
+  return error == EAGAIN || error == EWOULDBLOCK;
+#else
+  return error == EAGAIN;
+#endif
+#endif
+}
+
 // =============================================================================
 
 #ifdef _WIN32
@@ -311,24 +364,26 @@ inline void shutdown_socket(const Socket_native socket, const int how)
     throw DMITIGR_NET_EXCEPTION{"cannot shutdown a socket"};
 }
 
+namespace detail {
+
 /**
- * @brief Performs the polling of the `socket`.
- *
- * @returns The readiness of the socket according to the specified `mask`.
+ * @brief Performs the polling of the `socket` by using select().
  *
- * @par Requires
- * `is_socket_valid(socket)`.
- *
- * @remarks
- * `(timeout < 0)` means *no timeout* and the function can block indefinitely!
+ * @remarks This is a fallback implementation of net::poll(), which works
+ * only with sockets which values are less than `FD_SETSIZE` on POSIX.
  *
- * @remarks The current implementation is based only on select().
+ * @see net::poll().
  */
-inline Socket_readiness poll(const Socket_native socket,
+inline Socket_readiness poll_by_select(const Socket_native socket,
   const Socket_readiness mask, const std::chrono::milliseconds timeout)
 {
   if (!is_socket_valid(socket))
     throw Exception{"cannot poll an invalid socket"};
+#ifndef _WIN32
+  else if (socket >= FD_SETSIZE)
+    throw Exception{"cannot poll a socket by using select(): "
+      "socket value exceeds FD_SETSIZE"};
+#endif
 
   using std::chrono::seconds;
   using std::chrono::milliseconds;
@@ -389,6 +444,119 @@ inline Socket_readiness poll(const Socket_native socket,
   return result;
 }
 
+#ifdef _WIN32
+using Pollfd = WSAPOLLFD;
+constexpr short poll_read{POLLRDNORM};
+constexpr short poll_write{POLLWRNORM};
+constexpr short poll_except{POLLRDBAND};
+#else
+using Pollfd = pollfd;
+constexpr short poll_read{POLLIN};
+constexpr short poll_write{POLLOUT};
+constexpr short poll_except{POLLPRI};
+#endif
+
+/// @returns The events of poll() which corresponds to the `mask`.
+inline short to_poll_events(const Socket_readiness mask) noexcept
+{
+  short result{};
+  if (bool(mask & Socket_readiness::read_ready))
+    result |= poll_read;
+  if (bool(mask & Socket_readiness::write_ready))
+    result |= poll_write;
+  if (bool(mask & Socket_readiness::exceptions))
+    result |= poll_except;
+  return result;
+}
+
+/**
+ * @returns The readiness which corresponds to the `revents` of poll()
+ * according to the requested `mask`.
+ *
+ * @details The errors and hangups are reported as the readiness for both
+ * reading and writing (as select() does), so the subsequent I/O operation
+ * reports the actual error.
+ */
+inline Socket_readiness to_socket_readiness(const short revents,
+  const Socket_readiness mask) noexcept
+{
+  auto result = Socket_readiness::unready;
+  if (revents & (poll_read | POLLHUP | POLLERR))
+    result |= Socket_readiness::read_ready;
+  if (revents & (poll_write | POLLHUP | POLLERR))
+    result |= Socket_readiness::write_ready;
+  if (revents & poll_except)
+    result |= Socket_readiness::exceptions;
+  return result & mask;
+}
+
+/// @returns The timeout value for poll().
+inline int to_poll_timeout(const std::chrono::milliseconds timeout) noexcept
+{
+  return timeout < std::chrono::milliseconds::zero() ? -1 :
+    static_cast<int>(std::min<std::chrono::milliseconds::rep>(timeout.count(),
+      std::numeric_limits<int>::max()));
+}
+
+} // namespace detail
+
+/**
+ * @brief Performs the polling of the `socket`.
+ *
+ * @returns The readiness of the socket according to the specified `mask`.
+ *
+ * @par Requires
+ * `is_socket_valid(socket)`.
+ *
+ * @remarks
+ * `(timeout < 0)` means *no timeout* and the function can block indefinitely!
+ *
+ * @remarks The wait is resumed (with the rest of the `timeout`) if
+ * interrupted by a signal.
+ *
+ * @remarks The implementation is based on poll() (WSAPoll() on Windows), so
+ * there is no limitation on the value of the socket. The implementation based
+ * on select() is used instead if `DMITIGR_NET_POLL_BY_SELECT` is defined.
+ *
+ * @see Poller.
+ */
+inline Socket_readiness poll(const Socket_native socket,
+  const Socket_readiness mask, const std::chrono::milliseconds timeout)
+{
+#ifdef DMITIGR_NET_POLL_BY_SELECT
+  return detail::poll_by_select(socket, mask, timeout);
+#else
+  if (!is_socket_valid(socket))
+    throw Exception{"cannot poll an invalid socket"};
+
+  detail::Pollfd fd{};
+  fd.fd = socket;
+  fd.events = detail::to_poll_events(mask);
+#ifdef _WIN32
+  const int r = ::WSAPoll(&fd, 1, detail::to_poll_timeout(timeout));
+#else
+  namespace chrono = std::chrono;
+  using Clock = chrono::steady_clock;
+  const auto deadline = Clock::now() + timeout;
+  auto rest = timeout;
+  int r{};
+  while ((r = ::poll(&fd, 1, detail::to_poll_timeout(rest))) < 0 &&
+    errno == EINTR) {
+    if (rest > chrono::milliseconds::zero())
+      rest = std::max(chrono::ceil<chrono::milliseconds>(
+          deadline - Clock::now()), chrono::milliseconds::zero());
+  }
+#endif
+  if (is_socket_error(r))
+    throw DMITIGR_NET_EXCEPTION{"socket error upon polling"};
+  else if (r > 0 && (fd.revents & POLLNVAL))
+    throw Exception{"cannot poll an invalid socket"};
+
+  return r > 0 ? detail::to_socket_readiness(fd.revents, mask) :
+    Socket_readiness::unready;
+#endif
+}
+
 } // namespace dmitigr::net
 
 #endif  // DMITIGR_NET_SOCKET_HPP
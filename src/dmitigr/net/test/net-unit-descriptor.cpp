@@ -0,0 +1,165 @@
+// -*- C++ -*-
+//
+// Copyright 2023 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "../../base/assert.hpp"
+#include "../../net/net.hpp"
+
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace net = dmitigr::net;
+
+namespace {
+
+/// Reads exactly `size` bytes from `socket`.
+std::string read_all(const net::Socket_native socket, const std::size_t size)
+{
+  std::string result(size, '\0');
+  for (std::size_t offset{}; offset < size;) {
+    const auto n = ::read(socket, result.data() + offset, size - offset);
+    DMITIGR_ASSERT(n > 0);
+    offset += static_cast<std::size_t>(n);
+  }
+  return result;
+}
+
+} // namespace
+
+int main()
+{
+  try {
+    using net::detail::socket_Descriptor;
+
+    // Scatter/gather.
+    {
+      int fds[2];
+      DMITIGR_ASSERT(!::socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+      socket_Descriptor a{net::Socket_guard{fds[0]}};
+      net::Socket_guard b{fds[1]};
+
+      const std::string_view out[]{"header", "", "body", "trailer"};
+      DMITIGR_ASSERT(a.writev(out, std::size(out)) == 17);
+      DMITIGR_ASSERT(read_all(b, 17) == "headerbodytrailer");
+
+      DMITIGR_ASSERT(::write(b, "headerbodytrailer", 17) == 17);
+      char header[6];
+      char body[11];
+      const net::Mutable_buffer in[]{{header, sizeof(header)},
+        {body, sizeof(body)}};
+      DMITIGR_ASSERT(a.readv(in, std::size(in)) == 17);
+      DMITIGR_ASSERT(std::string_view(header, sizeof(header)) == "header");
+      DMITIGR_ASSERT(std::string_view(body, sizeof(body)) == "bodytrailer");
+
+      // Zero-copy is not supported by AF_UNIX.
+      DMITIGR_ASSERT(a.set_zerocopy_threshold(std::nullopt));
+    }
+
+    // File sending.
+    {
+      std::FILE* const file = std::tmpfile();
+      DMITIGR_ASSERT(file);
+      const std::string content(200000, 'f');
+      DMITIGR_ASSERT(std::fwrite(content.data(), 1, content.size(), file) ==
+        content.size());
+      DMITIGR_ASSERT(!std::fflush(file));
+      const int fd = ::fileno(file);
+
+      int fds[2];
+      DMITIGR_ASSERT(!::socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+      socket_Descriptor a{net::Socket_guard{fds[0]}};
+      net::Socket_guard b{fds[1]};
+
+      std::string received;
+      std::thread reader{[&]
+      {
+        received = read_all(b, 2 + 100000 + 2 + 10);
+      }};
+      net::Descriptor& d = a;
+      d.send_file(fd, 100000, 100000, "<<", ">>");
+      d.send_file(fd, 5, 10);
+      reader.join();
+      DMITIGR_ASSERT(received == "<<" + content.substr(100000) + ">>" +
+        content.substr(5, 10));
+      std::fclose(file);
+    }
+
+    // Zero-copy over TCP.
+    {
+      net::Socket_guard listener{::socket(AF_INET, SOCK_STREAM, 0)};
+      DMITIGR_ASSERT(net::is_socket_valid(listener));
+      ::sockaddr_in addr{};
+      addr.sin_family = AF_INET;
+      addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+      ::socklen_t addr_size = sizeof(addr);
+      DMITIGR_ASSERT(!::bind(listener,
+        reinterpret_cast<const ::sockaddr*>(&addr), addr_size));
+      DMITIGR_ASSERT(!::listen(listener, 1));
+      DMITIGR_ASSERT(!::getsockname(listener,
+        reinterpret_cast<::sockaddr*>(&addr), &addr_size));
+
+      net::Socket_guard client{::socket(AF_INET, SOCK_STREAM, 0)};
+      DMITIGR_ASSERT(!::connect(client,
+        reinterpret_cast<const ::sockaddr*>(&addr), addr_size));
+      socket_Descriptor server{net::Socket_guard{
+        ::accept(listener, nullptr, nullptr)}};
+
+      if (server.set_zerocopy_threshold(65536)) {
+        auto data = std::make_shared<std::string>(4 << 20, '\0');
+        for (std::size_t i{}; i < data->size(); ++i)
+          (*data)[i] = static_cast<char>(i % 251);
+        const auto expected = *data + "small";
+        const std::weak_ptr<const void> keeper{data};
+
+        std::string received;
+        std::thread reader{[&]
+        {
+          received = read_all(client, expected.size());
+        }};
+        std::string_view rest{*data};
+        while (!rest.empty()) {
+          const auto n = server.write_zerocopy(rest, data);
+          DMITIGR_ASSERT(n > 0);
+          rest.remove_prefix(static_cast<std::size_t>(n));
+        }
+        rest = {};
+        data.reset(); // the keeper is retained by the descriptor
+        const auto small = std::make_shared<std::string>("small");
+        DMITIGR_ASSERT(server.write_zerocopy(*small, small) == 5); // copied
+        reader.join();
+        DMITIGR_ASSERT(received == expected);
+        DMITIGR_ASSERT(server.set_zerocopy_threshold(std::nullopt));
+        client.close();
+        server.close();
+        DMITIGR_ASSERT(keeper.expired());
+      }
+      client.close();
+    }
+  } catch (const std::exception& e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  } catch (...) {
+    std::cerr << "unknown error" << std::endl;
+    return 2;
+  }
+}
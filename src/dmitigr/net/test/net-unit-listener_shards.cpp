@@ -0,0 +1,123 @@
+// -*- C++ -*-
+//
+// Copyright 2023 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "../../base/assert.hpp"
+#include "../../net/net.hpp"
+
+#include <atomic>
+#include <memory>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+
+int main()
+{
+  try {
+    namespace net = dmitigr::net;
+    using std::chrono::seconds;
+
+    const auto test = [](net::Listener_options options,
+      const net::Client_options& client_options)
+    {
+      const std::size_t shard_count{4};
+      const std::size_t connection_count{32};
+      std::atomic_size_t accepted_count{};
+      std::atomic_size_t no_delay_count{};
+      net::Listener_shards shards{options, shard_count,
+        [&](net::Socket_guard socket, net::Reactor& reactor,
+          const std::size_t shard)
+        {
+          DMITIGR_ASSERT(shard < shard_count);
+          int value{};
+          ::socklen_t size = sizeof(value);
+          if (!::getsockopt(socket, IPPROTO_TCP, TCP_NODELAY, &value, &size) &&
+            value)
+            ++no_delay_count;
+
+          // Close the connection in the reactor of the shard.
+          const auto fd = socket.socket();
+          reactor.add(fd, net::Socket_readiness::read_ready,
+            [&reactor, fd, s = std::make_shared<net::Socket_guard>(
+              std::move(socket))](net::Socket_readiness)
+            {
+              reactor.remove(fd);
+            });
+          ++accepted_count;
+        }};
+      DMITIGR_ASSERT(shards.size() == shard_count);
+      DMITIGR_ASSERT(!shards.is_running());
+      shards.start();
+      DMITIGR_ASSERT(shards.is_running());
+
+      std::vector<std::unique_ptr<net::Descriptor>> clients;
+      for (std::size_t i{}; i < connection_count; ++i)
+        clients.push_back(net::make_tcp_connection(client_options));
+      while (accepted_count < connection_count)
+        std::this_thread::yield();
+      clients.clear();
+
+      shards.stop();
+      DMITIGR_ASSERT(!shards.is_running());
+      return no_delay_count.load();
+    };
+
+    // TCP.
+    {
+      net::Listener_options options{"127.0.0.1", 39617, 64};
+      options.set_no_delay_enabled(true)
+        .set_defer_accept(std::nullopt)
+        .set_fast_open_queue_size(16);
+      DMITIGR_ASSERT(options.is_no_delay_enabled());
+      DMITIGR_ASSERT(!options.defer_accept());
+      DMITIGR_ASSERT(options.fast_open_queue_size() == 16);
+      DMITIGR_ASSERT(test(options, {"127.0.0.1", 39617}) == 32);
+    }
+
+    // The failure of the handler doesn't stop the shard.
+    {
+      std::atomic_size_t call_count{};
+      net::Listener_shards shards{net::Listener_options{"127.0.0.1", 39618, 64},
+        1, [&](net::Socket_guard, net::Reactor&, std::size_t)
+        {
+          if (++call_count == 1)
+            throw std::runtime_error{"test failure of the handler"};
+        }};
+      shards.start();
+      const auto client1 = net::make_tcp_connection({"127.0.0.1", 39618});
+      const auto client2 = net::make_tcp_connection({"127.0.0.1", 39618});
+      while (call_count < 2)
+        std::this_thread::yield();
+      shards.stop();
+    }
+
+    // UDS.
+    {
+      const std::filesystem::path path{"/tmp/dmitigr_net_listener_shards"};
+      std::filesystem::remove(path);
+      test(net::Listener_options{path, 64}, {path});
+    }
+  } catch (const std::exception& e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  } catch (...) {
+    std::cerr << "unknown error" << std::endl;
+    return 2;
+  }
+}
@@ -0,0 +1,149 @@
+// -*- C++ -*-
+//
+// Copyright 2023 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "../../base/assert.hpp"
+#include "../../net/net.hpp"
+
+#include <signal.h>
+#include <sys/resource.h>
+#include <sys/time.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+int main()
+{
+  try {
+    namespace net = dmitigr::net;
+    using net::Socket_readiness;
+    using std::chrono::milliseconds;
+
+    int fds[2];
+    DMITIGR_ASSERT(!::socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+    net::Socket_guard a{fds[0]};
+    net::Socket_guard b{fds[1]};
+    const auto rw = Socket_readiness::read_ready | Socket_readiness::write_ready;
+
+    // net::poll()
+    {
+      auto r = net::poll(a, Socket_readiness::read_ready, milliseconds{0});
+      DMITIGR_ASSERT(r == Socket_readiness::unready);
+      r = net::poll(a, rw, milliseconds{0});
+      DMITIGR_ASSERT(r == Socket_readiness::write_ready);
+
+      DMITIGR_ASSERT(::write(b, "x", 1) == 1);
+      r = net::poll(a, rw, milliseconds{-1});
+      DMITIGR_ASSERT(r == rw);
+      char c{};
+      DMITIGR_ASSERT(::read(a, &c, 1) == 1 && c == 'x');
+    }
+
+    // net::poll() of the socket beyond FD_SETSIZE.
+    {
+      ::rlimit lim{};
+      DMITIGR_ASSERT(!::getrlimit(RLIMIT_NOFILE, &lim));
+      const int big = FD_SETSIZE + 100;
+      if (lim.rlim_cur <= static_cast<rlim_t>(big) &&
+        static_cast<rlim_t>(big) < lim.rlim_max) {
+        lim.rlim_cur = big + 1;
+        DMITIGR_ASSERT(!::setrlimit(RLIMIT_NOFILE, &lim));
+      }
+      if (lim.rlim_cur > static_cast<rlim_t>(big)) {
+        net::Socket_guard c{::dup2(a, big)};
+        DMITIGR_ASSERT(c == big);
+        DMITIGR_ASSERT(::write(b, "y", 1) == 1);
+        const auto r = net::poll(c, Socket_readiness::read_ready,
+          milliseconds{-1});
+        DMITIGR_ASSERT(r == Socket_readiness::read_ready);
+        char ch{};
+        DMITIGR_ASSERT(::read(c, &ch, 1) == 1 && ch == 'y');
+      }
+    }
+
+    // net::Poller
+    {
+      net::Poller poller;
+      DMITIGR_ASSERT(!poller.size());
+      DMITIGR_ASSERT(poller.wait(milliseconds{0}).empty());
+
+      poller.add(a, Socket_readiness::read_ready);
+      poller.add(b, Socket_readiness::read_ready);
+      DMITIGR_ASSERT(poller.size() == 2);
+      DMITIGR_ASSERT(poller.wait(milliseconds{0}).empty());
+
+      DMITIGR_ASSERT(::write(b, "z", 1) == 1);
+      {
+        const auto& events = poller.wait(milliseconds{-1});
+        DMITIGR_ASSERT(events.size() == 1);
+        DMITIGR_ASSERT(events[0].socket == a);
+        DMITIGR_ASSERT(events[0].readiness == Socket_readiness::read_ready);
+      }
+
+      poller.modify(b, rw);
+      {
+        const auto& events = poller.wait(milliseconds{0});
+        DMITIGR_ASSERT(events.size() == 2);
+      }
+
+      poller.remove(a);
+      DMITIGR_ASSERT(poller.size() == 1);
+      {
+        const auto& events = poller.wait(milliseconds{0});
+        DMITIGR_ASSERT(events.size() == 1);
+        DMITIGR_ASSERT(events[0].socket == b);
+        DMITIGR_ASSERT(events[0].readiness == Socket_readiness::write_ready);
+      }
+    }
+
+    // net::Poller: the hangup is reported according to the registered mask.
+    {
+      int fds2[2];
+      DMITIGR_ASSERT(!::socketpair(AF_UNIX, SOCK_STREAM, 0, fds2));
+      net::Socket_guard c{fds2[0]};
+      net::Poller poller;
+      poller.add(c, Socket_readiness::read_ready);
+      DMITIGR_ASSERT(!::close(fds2[1]));
+      const auto& events = poller.wait(milliseconds{-1});
+      DMITIGR_ASSERT(events.size() == 1);
+      DMITIGR_ASSERT(events[0].readiness == Socket_readiness::read_ready);
+    }
+
+    // net::Poller: the wait is resumed if interrupted by a signal.
+    {
+      struct sigaction sa{};
+      sa.sa_handler = [](int){};
+      DMITIGR_ASSERT(!::sigaction(SIGALRM, &sa, nullptr)); // no SA_RESTART
+      ::itimerval timer{};
+      timer.it_value.tv_usec = 20000;
+      DMITIGR_ASSERT(!::setitimer(ITIMER_REAL, &timer, nullptr));
+      int fds2[2];
+      DMITIGR_ASSERT(!::socketpair(AF_UNIX, SOCK_STREAM, 0, fds2));
+      net::Socket_guard c{fds2[0]};
+      net::Socket_guard d{fds2[1]};
+      net::Poller poller;
+      poller.add(c, Socket_readiness::read_ready);
+      const auto started = std::chrono::steady_clock::now();
+      DMITIGR_ASSERT(poller.wait(milliseconds{100}).empty());
+      DMITIGR_ASSERT(std::chrono::steady_clock::now() - started >=
+        milliseconds{100});
+    }
+  } catch (const std::exception& e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  } catch (...) {
+    std::cerr << "unknown error" << std::endl;
+    return 2;
+  }
+}
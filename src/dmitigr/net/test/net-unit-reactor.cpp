@@ -0,0 +1,165 @@
+// -*- C++ -*-
+//
+// Copyright 2023 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "../../base/assert.hpp"
+#include "../../net/net.hpp"
+
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+int main()
+{
+  try {
+    namespace net = dmitigr::net;
+    using net::Socket_readiness;
+    using std::chrono::milliseconds;
+
+    net::Reactor reactor;
+
+    // Timers.
+    {
+      std::vector<int> fired;
+      reactor.add_timer(milliseconds{20}, [&]{fired.push_back(2);});
+      reactor.add_timer(milliseconds{10}, [&]{fired.push_back(1);});
+      const auto canceled = reactor.add_timer(milliseconds{5},
+        [&]{fired.push_back(0);});
+      DMITIGR_ASSERT(reactor.cancel_timer(canceled));
+      DMITIGR_ASSERT(!reactor.cancel_timer(canceled));
+      while (fired.size() < 2)
+        DMITIGR_ASSERT(reactor.run_once(milliseconds{-1}));
+      DMITIGR_ASSERT((fired == std::vector<int>{1, 2}));
+    }
+
+    // Timers which reschedule themselves are run once per iteration.
+    {
+      int count{};
+      std::function<void()> task;
+      task = [&]
+      {
+        ++count;
+        reactor.add_timer(milliseconds{0}, task);
+      };
+      const auto id = reactor.add_timer(milliseconds{0}, task);
+      DMITIGR_ASSERT(reactor.run_once(milliseconds{0}));
+      DMITIGR_ASSERT(count == 1);
+      DMITIGR_ASSERT(reactor.run_once(milliseconds{0}));
+      DMITIGR_ASSERT(count == 2);
+      DMITIGR_ASSERT(!reactor.cancel_timer(id));
+      DMITIGR_ASSERT(reactor.cancel_timer(id + 2));
+    }
+
+    // Non-blocking descriptors.
+    {
+      int fds[2];
+      DMITIGR_ASSERT(!::socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+      net::detail::nonblocking_socket_Descriptor a{net::Socket_guard{fds[0]}};
+      net::detail::nonblocking_socket_Descriptor b{net::Socket_guard{fds[1]}};
+      const auto a_socket = static_cast<net::Socket_native>(a.native_handle());
+
+      char buf[16];
+      DMITIGR_ASSERT(a.read(buf, sizeof(buf)) == -1);
+
+      std::string received;
+      bool is_eof{};
+      reactor.add(a_socket, Socket_readiness::read_ready,
+        [&](const Socket_readiness readiness)
+        {
+          DMITIGR_ASSERT(bool(readiness & Socket_readiness::read_ready));
+          while (true) {
+            const auto n = a.read(buf, sizeof(buf));
+            if (n > 0)
+              received.append(buf, static_cast<std::size_t>(n));
+            else if (!n) {
+              is_eof = true;
+              DMITIGR_ASSERT(reactor.remove(a_socket));
+              break;
+            } else
+              break;
+          }
+        });
+
+      const std::string data(100, 'x');
+      DMITIGR_ASSERT(b.write(data.data(), 50) == 50);
+      while (received.size() < 50)
+        reactor.run_once(milliseconds{-1});
+      DMITIGR_ASSERT(b.write(data.data() + 50, 50) == 50);
+      b.close();
+      while (!is_eof)
+        reactor.run_once(milliseconds{-1});
+      DMITIGR_ASSERT(received == data);
+      DMITIGR_ASSERT(!reactor.remove(a_socket));
+    }
+
+    // Multi-accept.
+    {
+      net::Socket_guard listener{::socket(AF_INET, SOCK_STREAM, 0)};
+      DMITIGR_ASSERT(net::is_socket_valid(listener));
+      ::sockaddr_in addr{};
+      addr.sin_family = AF_INET;
+      addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+      ::socklen_t addr_size = sizeof(addr);
+      DMITIGR_ASSERT(!::bind(listener,
+        reinterpret_cast<const ::sockaddr*>(&addr), addr_size));
+      DMITIGR_ASSERT(!::listen(listener, 16));
+      DMITIGR_ASSERT(!::getsockname(listener,
+        reinterpret_cast<::sockaddr*>(&addr), &addr_size));
+
+      std::vector<net::Socket_guard> accepted;
+      reactor.add_listener(listener, [&](net::Socket_guard socket)
+      {
+        accepted.push_back(std::move(socket));
+      });
+
+      std::vector<net::Socket_guard> clients;
+      for (int i{}; i < 3; ++i) {
+        auto& client = clients.emplace_back(::socket(AF_INET, SOCK_STREAM, 0));
+        DMITIGR_ASSERT(!::connect(client,
+          reinterpret_cast<const ::sockaddr*>(&addr), addr_size));
+      }
+      while (accepted.size() < clients.size())
+        reactor.run_once(milliseconds{-1});
+      DMITIGR_ASSERT(reactor.remove(listener));
+    }
+
+    // Posting and stopping from another thread.
+    {
+      int executed{};
+      std::thread thread{[&]
+      {
+        reactor.post([&]{++executed;});
+        reactor.post([&]{++executed; reactor.stop();});
+      }};
+      reactor.run();
+      thread.join();
+      DMITIGR_ASSERT(executed == 2);
+      DMITIGR_ASSERT(reactor.is_stopped());
+      DMITIGR_ASSERT(!reactor.run_once(milliseconds{0}));
+    }
+  } catch (const std::exception& e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  } catch (...) {
+    std::cerr << "unknown error" << std::endl;
+    return 2;
+  }
+}
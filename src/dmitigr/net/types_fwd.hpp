@@ -27,10 +27,14 @@ enum class Socket_readiness;
 enum class Protocol_family;
 
 class Descriptor;
+struct Mutable_buffer;
 class Ip_address;
 class Endpoint;
 class Listener_options;
 class Listener;
+class Listener_shards;
+class Poller;
+class Reactor;
 
 class Wsa_exception;
 class Wsa_error_category;
@@ -40,6 +44,7 @@ namespace detail {
 
 class iDescriptor;
 class socket_Descriptor;
+class nonblocking_socket_Descriptor;
 class pipe_Descriptor;
 
 class iListener;
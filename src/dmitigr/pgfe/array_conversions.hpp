@@ -24,9 +24,11 @@
 #include "conversions_api.hpp"
 #include "data.hpp"
 #include "exceptions.hpp"
+#include "simd.hpp"
 
 #include <algorithm>
 #include <cassert>
+#include <cstring>
 #include <memory>
 #include <optional>
 #include <string>
@@ -446,6 +448,23 @@ const char* parse_array_literal(const char* literal, const char delimiter,
   char previous_char{};
   char previous_nonspace_char{};
   std::string element;
+
+  // Appends the characters of `[literal, run_end)` to the element at once.
+  const char* const end = literal + std::strlen(literal);
+  const auto consume_run = [&](const char* const run_end)
+  {
+    DMITIGR_ASSERT(literal < run_end);
+    element.append(literal, run_end);
+    previous_char = run_end[-1];
+    for (const char* p{run_end}; p != literal;) {
+      if (str::is_not_space(*--p)) {
+        previous_nonspace_char = *p;
+        break;
+      }
+    }
+    literal = run_end;
+  };
+
   while (const char c = *literal) {
     switch (state) {
     case in_beginning: {
@@ -497,8 +516,14 @@ const char* parse_array_literal(const char* literal, const char delimiter,
         // Skip escape character '\\'.
       } else if (c == '"' && previous_char != '\\')
         goto element_extracted;
-      else
+      else if (c == '"' || c == '\\')
         element += c;
+      else {
+        // Consume the characters up to the next quote or escape in bulk.
+        consume_run(detail::simd::find_first_of(literal + 1, end,
+            '"', '\\', '\\'));
+        continue;
+      }
 
       goto preparing_to_the_next_iteration;
     }
@@ -506,10 +531,12 @@ const char* parse_array_literal(const char* literal, const char delimiter,
     case in_unquoted_element: {
       if (c == delimiter || c == '{' || c == '}')
         goto element_extracted;
-      else
-        element += c;
-
-      goto preparing_to_the_next_iteration;
+      else {
+        // Consume the characters up to the next delimiter in bulk.
+        consume_run(detail::simd::find_first_of(literal + 1, end,
+            delimiter, '{', '}'));
+        continue;
+      }
     }
     } // switch (state)
 
@@ -19,6 +19,7 @@
 
 #include "../base/enum.hpp"
 
+#include <cstdint>
 #include <optional>
 #include <string_view>
 
@@ -38,6 +39,13 @@ using Oid = unsigned int;
  */
 constexpr Oid invalid_oid{};
 
+/**
+ * @ingroup main
+ *
+ * @brief An alias for Log Sequence Number (a position in the WAL).
+ */
+using Lsn = std::uint64_t;
+
 // =============================================================================
 
 /**
@@ -344,6 +352,24 @@ inline std::string_view to_string_view(const Session_mode cm)
 
 // =============================================================================
 
+/**
+ * @ingroup main
+ *
+ * @brief Replication mode.
+ *
+ * @details A connection in replication mode talks to the WAL sender process
+ * and accepts only the commands of the replication protocol.
+ */
+enum class Replication_mode {
+  /// Physical replication. (The connection isn't bound to a database.)
+  physical = 0,
+
+  /// Logical replication. (The connection is bound to a database.)
+  logical = 100
+};
+
+// =============================================================================
+
 /**
  * @ingroup main
  *
@@ -465,7 +491,10 @@ enum class Data_direction {
   to_server = 0,
 
   /// Data directed from the server.
-  from_server = 100
+  from_server = 100,
+
+  /// Data directed both to and from the server.
+  bidirectional = 200
 };
 
 // =============================================================================
@@ -30,6 +30,8 @@ set(dmitigr_pgfe_headers
   basic_conversions.hpp
   basics.hpp
   copier.hpp
+  copy_loader.hpp
+  cursor.hpp
   completion.hpp
   compositional.hpp
   composite.hpp
@@ -40,6 +42,7 @@ set(dmitigr_pgfe_headers
   conversions_api.hpp
   conversions.hpp
   data.hpp
+  deadline_guard.hpp
   errc.hpp
   errctg.hpp
   error.hpp
@@ -49,16 +52,26 @@ set(dmitigr_pgfe_headers
   misc.hpp
   notice.hpp
   notification.hpp
+  parallel_row_processor.hpp
   parameterizable.hpp
+  pgoutput_message.hpp
   pq.hpp
   prepared_statement.hpp
   problem.hpp
   ready_for_query.hpp
+  record_view.hpp
+  replication_stream.hpp
   response.hpp
+  result_cache.hpp
+  result_set.hpp
   row.hpp
   row_info.hpp
+  scatter_gather_executor.hpp
   signal.hpp
+  simd.hpp
   statement.hpp
+  statement_description_cache.hpp
+  statement_reader.hpp
   statement_vector.hpp
   transaction_guard.hpp
   tuple.hpp
@@ -67,6 +80,8 @@ set(dmitigr_pgfe_headers
 
 set(dmitigr_pgfe_implementations
   copier.cpp
+  copy_loader.cpp
+  cursor.cpp
   completion.cpp
   composite.cpp
   compositional.cpp
@@ -82,13 +97,22 @@ set(dmitigr_pgfe_implementations
   misc.cpp
   notice.cpp
   notification.cpp
+  parallel_row_processor.cpp
   parameterizable.cpp
+  pgoutput_message.cpp
   prepared_statement.cpp
   problem.cpp
   ready_for_query.cpp
+  record_view.cpp
+  replication_stream.cpp
+  result_cache.cpp
+  result_set.cpp
   row.cpp
   row_info.cpp
+  scatter_gather_executor.cpp
   statement.cpp
+  statement_description_cache.cpp
+  statement_reader.cpp
   statement_vector.cpp
   tuple.cpp
   )
@@ -129,6 +153,7 @@ if(DMITIGR_LIBS_TESTS)
     array_dimension
     benchmark_array_client
     benchmark_array_server
+    benchmark_simd
     benchmark_statement_replace
     bug
     composite
@@ -142,17 +167,29 @@ if(DMITIGR_LIBS_TESTS)
     conversions
     conversions_online
     copier
+    copy_loader
+    cursor
     data
+    deadline_guard
     exceptions
     hello_world
     named_argument
+    parallel_row_processor
+    pgoutput_message
     pipeline
     pq_vs_pgfe
     ps
+    record_view
+    replication_stream
+    result_cache
+    result_set
     lob
     row
+    scatter_gather_executor
     service
     statement
+    statement_description_cache
+    statement_reader
     statement_vector
     transaction_guard
     )
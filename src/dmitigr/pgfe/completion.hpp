@@ -77,6 +77,7 @@ public:
 
 private:
   friend Connection;
+  friend Result_cache;
 
   long row_count_{-2}; // -1 - no value, -2 - invalid instance
   std::string tag_;
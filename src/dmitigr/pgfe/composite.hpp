@@ -64,6 +64,8 @@ public:
   }
 
 private:
+  friend Record_view;
+  friend Result_set;
   friend Row;
   friend Tuple;
 
@@ -21,10 +21,22 @@
 #include "exceptions.hpp"
 #include "large_object.hpp"
 #include "ready_for_query.hpp"
+#include "simd.hpp"
 #include "statement.hpp"
+#include "statement_reader.hpp"
+#include "statement_vector.hpp"
 
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
 
+#ifdef __linux__
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#endif
+
 namespace dmitigr::pgfe {
 
 namespace detail {
@@ -41,6 +53,58 @@ inline Socket_readiness poll_sock(const int socket, const Socket_readiness mask,
       timeout ? *timeout : std::chrono::milliseconds{-1}));
 }
 
+#ifdef __linux__
+/**
+ * @brief The leading part of the kernel's `struct tcp_info` (since Linux 4.2)
+ * up to and including the byte counters.
+ *
+ * @details The glibc's `tcp_info` ends before the byte counters and
+ * `<linux/tcp.h>` cannot be included along with `<netinet/tcp.h>`, so the
+ * layout of the kernel ABI is spelled out explicitly here.
+ */
+struct Kernel_tcp_info final {
+  unsigned char head[104];
+  std::uint64_t tcpi_pacing_rate;
+  std::uint64_t tcpi_max_pacing_rate;
+  std::uint64_t tcpi_bytes_acked;
+  std::uint64_t tcpi_bytes_received;
+};
+static_assert(sizeof(tcp_info) <= offsetof(Kernel_tcp_info, tcpi_pacing_rate));
+static_assert(offsetof(Kernel_tcp_info, tcpi_pacing_rate) == 104);
+static_assert(offsetof(Kernel_tcp_info, tcpi_bytes_acked) == 120);
+static_assert(offsetof(Kernel_tcp_info, tcpi_bytes_received) == 128);
+static_assert(sizeof(Kernel_tcp_info) == 136);
+#endif
+
+/**
+ * @brief Obtains the byte counters of the TCP socket from the kernel.
+ *
+ * @param acked The number of bytes sent and acknowledged by the peer.
+ * @param received The number of bytes received from the peer.
+ *
+ * @returns `false` if the counters are not available (not a TCP socket, or
+ * the kernel is too old).
+ */
+inline bool tcp_bytes(const int socket, std::uint_fast64_t& acked,
+  std::uint_fast64_t& received) noexcept
+{
+#ifdef __linux__
+  Kernel_tcp_info ti{};
+  socklen_t size{sizeof(ti)};
+  if (socket < 0 || ::getsockopt(socket, IPPROTO_TCP, TCP_INFO, &ti, &size) ||
+    size < sizeof(ti))
+    return false;
+  acked = ti.tcpi_bytes_acked;
+  received = ti.tcpi_bytes_received;
+  return true;
+#else
+  (void)socket;
+  (void)acked;
+  (void)received;
+  return false;
+#endif
+}
+
 } // namespace detail
 
 DMITIGR_PGFE_INLINE Server_status ping(const Connection_options& options)
@@ -138,6 +202,9 @@ DMITIGR_PGFE_INLINE void Connection::swap(Connection& rhs) noexcept
   swap(notice_handler_, rhs.notice_handler_);
   swap(notification_handler_, rhs.notification_handler_);
   swap(default_result_format_, rhs.default_result_format_);
+  swap(description_cache_, rhs.description_cache_);
+  swap(deadline_, rhs.deadline_);
+  swap(stats_, rhs.stats_);
   //
   swap(execute_ps_state_, rhs.execute_ps_state_);
   swap(execute_ps_state_->connection_, rhs.execute_ps_state_->connection_);
@@ -514,6 +581,8 @@ Connection::connect(std::optional<std::chrono::milliseconds> timeout)
 
 DMITIGR_PGFE_INLINE void Connection::disconnect() noexcept
 {
+  // Preserve the byte counters of the socket being closed.
+  add_tcp_bytes__(stats_.bytes_acked, stats_.bytes_received);
   reset_session();
   conn_.reset(); // discarding unhandled notifications btw.
   DMITIGR_ASSERT(status() == Status::disconnected);
@@ -543,7 +612,10 @@ Connection::wait_socket_readiness(Socket_readiness mask,
   while (true) {
     const auto timepoint1 = system_clock::now();
     try {
-      return detail::poll_sock(socket(), mask, timeout);
+      const auto result = detail::poll_sock(socket(), mask, timeout);
+      if (result != Socket_readiness::unready && timeout != milliseconds::zero())
+        ++stats_.socket_wakeup_count;
+      return result;
     } catch (const std::system_error& e) {
       // Retry on EINTR.
       if (e.code() == std::errc::interrupted) {
@@ -694,7 +766,8 @@ Connection::handle_input(const bool wait_response)
     if (rstatus == PGRES_TUPLES_OK) {
       DMITIGR_ASSERT(last_processed_request_.id_ == Request::Id::execute);
       is_single_row_mode_enabled_ = false;
-    } else if (rstatus == PGRES_COPY_OUT || rstatus == PGRES_COPY_IN) {
+    } else if (rstatus == PGRES_COPY_OUT || rstatus == PGRES_COPY_IN ||
+      rstatus == PGRES_COPY_BOTH) {
       // is_copy_in_progress() now returns `true`, copier() returns Copier.
       copier_state_ = std::make_shared<Connection*>(nullptr); // can throw
     } else if (rstatus == PGRES_FATAL_ERROR) {
@@ -726,6 +799,15 @@ Connection::handle_input(const bool wait_response)
         }
         register_ps(std::move(ps)); // can throw (ps will not be affected)
         DMITIGR_ASSERT(last_prepared_statement_);
+        if (const auto& state = *last_prepared_statement_.state_;
+          description_cache_ && !state.query_.empty()) {
+          try {
+            description_cache_->insert(description_cache_key__(state.query_),
+              state.description_.pq_result_, state.parameter_type_oids_);
+          } catch (...) {
+            // The caching is optional.
+          }
+        }
       } else if (lpr.id_ == Request::Id::unprepare) {
         DMITIGR_ASSERT(lpr.prepared_statement_name_ &&
           !std::strcmp(response_.command_tag(), "DEALLOCATE"));
@@ -772,6 +854,7 @@ DMITIGR_PGFE_INLINE bool Connection::flush_output(const bool wait)
     throw Generic_exception{"cannot flush queued output data to the server: "
       "nonblocking output mode is disabled on connection"};
 
+  ++stats_.flush_count;
   if (const int r{PQflush(conn())}; r == 1) {
     if (wait) {
       using Sr = Socket_readiness;
@@ -810,6 +893,28 @@ Connection::wait_response(std::optional<std::chrono::milliseconds> timeout)
   if (timeout < milliseconds::zero()) // even if timeout < -1
     timeout = options().wait_response_timeout();
 
+  // Account the time of waiting even if it's interrupted by exception.
+  struct Stopwatch final {
+    Connection_stats& stats;
+    const Deadline_clock::time_point started{Deadline_clock::now()};
+    ~Stopwatch()
+    {
+      ++stats.wait_response_count;
+      stats.wait_response_time += Deadline_clock::now() - started;
+    }
+  } const stopwatch{stats_};
+
+  // The deadline takes precedence over the timeout if it comes earlier.
+  bool is_deadline{};
+  if (deadline_) {
+    const auto left = std::max(milliseconds::zero(),
+      duration_cast<milliseconds>(*deadline_ - Deadline_clock::now()));
+    if (!timeout || left <= *timeout) {
+      timeout = left;
+      is_deadline = true;
+    }
+  }
+
   Response_status rs{Response_status::unready};
   if (timeout) {
     read_input();
@@ -821,6 +926,10 @@ Connection::wait_response(std::optional<std::chrono::milliseconds> timeout)
         timeout = *timeout - duration_cast<milliseconds>(system_clock::now() - moment_of_wait);
         read_input();
         rs = handle_input(false);
+      } else if (is_deadline) {
+        cancel_and_drain__();
+        throw Generic_exception{Errc::deadline_exceeded,
+          "wait response deadline exceeded"};
       } else // timeout expired
         throw Generic_exception{Errc::timed_out, "wait response timeout expired"};
     }
@@ -890,7 +999,8 @@ DMITIGR_PGFE_INLINE bool Connection::has_response() const noexcept
 DMITIGR_PGFE_INLINE Copier Connection::copier() noexcept
 {
   const auto s = response_.status();
-  return (s == PGRES_COPY_IN || s == PGRES_COPY_OUT) && !*copier_state_ ?
+  return (s == PGRES_COPY_IN || s == PGRES_COPY_OUT || s == PGRES_COPY_BOTH)
+    && !*copier_state_ ?
     Copier{*this, release_response()} : Copier{};
 }
 
@@ -966,6 +1076,55 @@ DMITIGR_PGFE_INLINE bool Connection::has_uncompleted_request() const noexcept
   return !requests_.empty();
 }
 
+DMITIGR_PGFE_INLINE void Connection::set_description_cache(
+  std::shared_ptr<Statement_description_cache> cache) noexcept
+{
+  description_cache_ = std::move(cache);
+}
+
+DMITIGR_PGFE_INLINE const std::shared_ptr<Statement_description_cache>&
+Connection::description_cache() const noexcept
+{
+  return description_cache_;
+}
+
+DMITIGR_PGFE_INLINE void Connection::set_deadline(
+  const std::optional<Deadline_clock::time_point> deadline) noexcept
+{
+  deadline_ = deadline;
+}
+
+DMITIGR_PGFE_INLINE auto Connection::deadline() const noexcept
+  -> std::optional<Deadline_clock::time_point>
+{
+  return deadline_;
+}
+
+DMITIGR_PGFE_INLINE void Connection::cancel_request()
+{
+  if (!is_connected())
+    throw Generic_exception{"cannot send cancel request: not connected"};
+
+  const std::unique_ptr<PGcancel, void(*)(PGcancel*)> cancel{
+    PQgetCancel(conn()), &PQfreeCancel};
+  if (!cancel)
+    throw Generic_exception{"cannot send cancel request: "
+      "cannot create cancel object"};
+
+  char errbuf[256];
+  if (!PQcancel(cancel.get(), errbuf, sizeof(errbuf)))
+    throw Generic_exception{std::string{"cannot send cancel request: "}
+      .append(errbuf)};
+}
+
+DMITIGR_PGFE_INLINE Connection_stats Connection::stats() const noexcept
+{
+  auto result = stats_;
+  if (conn_)
+    add_tcp_bytes__(result.bytes_acked, result.bytes_received);
+  return result;
+}
+
 DMITIGR_PGFE_INLINE void
 Connection::prepare_nio(const Statement& statement, const std::string& name)
 {
@@ -1041,6 +1200,7 @@ DMITIGR_PGFE_INLINE void Connection::describe_nio(const std::string& name)
     requests_.pop(); // rollback
     throw;
   }
+  count_request__();
 
   assert(is_invariant_ok());
 }
@@ -1137,6 +1297,134 @@ DMITIGR_PGFE_INLINE void Connection::send_flush()
 #endif
 }
 
+DMITIGR_PGFE_INLINE std::size_t
+Connection::execute_pipelined__(const Statement_vector& statements,
+  const Row_handler& handler, const std::size_t max_in_flight)
+{
+  const auto& vec = statements.vector();
+  auto i = cbegin(vec);
+  const auto e = cend(vec);
+  return execute_pipelined__([&i, e]() noexcept
+  {
+    return i != e ? &*i++ : nullptr;
+  }, handler, max_in_flight);
+}
+
+DMITIGR_PGFE_INLINE std::size_t
+Connection::execute_pipelined__(Statement_reader& reader,
+  const Row_handler& handler, const std::size_t max_in_flight)
+{
+  std::optional<Statement> statement;
+  return execute_pipelined__([&reader, &statement]
+  {
+    statement = reader.next();
+    return statement ? &*statement : nullptr;
+  }, handler, max_in_flight);
+}
+
+DMITIGR_PGFE_INLINE std::size_t
+Connection::execute_pipelined__(const Statement_source& next_statement,
+  const Row_handler& handler, const std::size_t max_in_flight)
+{
+  if (!max_in_flight)
+    throw Generic_exception{"cannot execute statements in pipeline: "
+      "invalid maximum number of statements in flight"};
+  else if (!is_ready_for_request())
+    throw Generic_exception{"cannot execute statements in pipeline: "
+      "not ready for request"};
+
+  /*
+   * The output is nonblocking to prevent the deadlock when the server cannot
+   * send the results (since the client doesn't read them) and therefore stops
+   * reading the statements (which the client cannot finish to send).
+   * flush_output(true) reads the input while waiting for the output to drain.
+   */
+  const bool was_nio_output_enabled{is_nio_output_enabled()};
+  set_nio_output_enabled(true);
+  set_pipeline_enabled(true);
+
+  const std::size_t refill_threshold{max_in_flight / 2};
+  std::size_t in_flight{};
+  std::size_t result{};
+  bool is_source_exhausted{};
+  bool is_sync_sent{};
+  Error error;
+  try {
+    while (true) {
+      if (!error && !is_source_exhausted && in_flight <= refill_threshold) {
+        while (in_flight < max_in_flight) {
+          if (const auto* const statement = next_statement(); !statement) {
+            is_source_exhausted = true;
+            break;
+          } else if (!statement->is_query_empty()) {
+            execute_nio(*statement);
+            ++in_flight;
+          }
+        }
+        if (is_source_exhausted) {
+          send_sync();
+          is_sync_sent = true;
+        } else
+          send_flush();
+        flush_output(true);
+      }
+
+      if (!in_flight)
+        break;
+
+      wait_response();
+      if (auto r = row()) {
+        if (!error)
+          handler(std::move(r));
+      } else if (auto err = this->error()) {
+        if (!error) {
+          error = std::move(err);
+          if (!is_sync_sent) {
+            send_sync();
+            is_sync_sent = true;
+            flush_output(true);
+          }
+        }
+        --in_flight;
+      } else {
+        // Either completion or the result of statement skipped in pipeline.
+        if (completion())
+          ++result;
+        release_response();
+        --in_flight;
+      }
+    }
+
+    DMITIGR_ASSERT(is_sync_sent);
+    wait_response();
+    DMITIGR_ASSERT(ready_for_query());
+    set_pipeline_enabled(false);
+    set_nio_output_enabled(was_nio_output_enabled);
+  } catch (...) {
+    try {
+      if (is_connected() && pipeline_status() != Pipeline_status::disabled) {
+        if (!is_sync_sent)
+          send_sync();
+        flush_output(true);
+        while (wait_response())
+          release_response();
+        set_pipeline_enabled(false);
+      }
+      if (is_connected())
+        set_nio_output_enabled(was_nio_output_enabled);
+    } catch (...) {
+      disconnect();
+    }
+    throw;
+  }
+
+  if (error)
+    throw Sqlstate_exception{std::make_shared<Error>(std::move(error))};
+
+  assert(is_invariant_ok());
+  return result;
+}
+
 DMITIGR_PGFE_INLINE void
 Connection::set_result_format(const Data_format format)
 {
@@ -1404,6 +1692,14 @@ Connection::prepare_nio__(const char* const query, const char* const name,
 
   auto state = std::make_shared<Prepared_statement::State>(name, this);
   Prepared_statement ps{std::move(state), preparsed, true};
+  if (description_cache_) {
+    auto key = description_cache_key__(query);
+    if (const auto description = description_cache_->find(key)) {
+      ps.set_description(Statement_description_cache::to_result(*description),
+        description->parameter_type_oids);
+    } else
+      ps.state_->query_ = query;
+  }
   requests_.emplace(Request::Id::prepare, std::move(ps));
   try {
     constexpr int n_params{};
@@ -1415,6 +1711,7 @@ Connection::prepare_nio__(const char* const query, const char* const name,
     requests_.pop(); // rollback
     throw;
   }
+  count_request__();
 
   assert(is_invariant_ok());
 }
@@ -1429,6 +1726,26 @@ DMITIGR_PGFE_INLINE Prepared_statement Connection::wait_prepared_statement__()
   return prepared_statement();
 }
 
+DMITIGR_PGFE_INLINE std::string Connection::server_identity__() const
+{
+  const auto str = [](const char* const s)
+  {
+    return s ? std::string_view{s} : std::string_view{};
+  };
+  std::string result{str(PQhost(conn()))};
+  result.append(":").append(str(PQport(conn())))
+    .append("/").append(str(PQdb(conn())))
+    .append("?user=").append(str(PQuser(conn())))
+    .append("&version=").append(std::to_string(PQserverVersion(conn())));
+  return result;
+}
+
+DMITIGR_PGFE_INLINE std::string
+Connection::description_cache_key__(const std::string_view query) const
+{
+  return Statement_description_cache::key(server_identity__(), query);
+}
+
 DMITIGR_PGFE_INLINE void
 Connection::register_ps(Prepared_statement&& ps)
 {
@@ -1452,11 +1769,82 @@ Connection::unregister_ps(decltype(ps_states_)::const_iterator p) noexcept
   unregister(ps_states_, p);
 }
 
+DMITIGR_PGFE_INLINE void Connection::count_request__() noexcept
+{
+  ++stats_.request_count;
+  if (!is_nio_output_enabled())
+    ++stats_.flush_count; // flushed implicitly
+}
+
+DMITIGR_PGFE_INLINE void Connection::add_tcp_bytes__(std::uint_fast64_t& acked,
+  std::uint_fast64_t& received) const noexcept
+{
+  std::uint_fast64_t a{}, r{};
+  if (conn_ && detail::tcp_bytes(socket(), a, r)) {
+    acked += a;
+    received += r;
+  }
+}
+
 DMITIGR_PGFE_INLINE int Connection::socket() const noexcept
 {
   return PQsocket(conn());
 }
 
+DMITIGR_PGFE_INLINE void Connection::cancel_and_drain__()
+{
+  using std::chrono::ceil;
+  using std::chrono::milliseconds;
+  const auto until = Deadline_clock::now() + cancel_grace_period__;
+  try {
+    cancel_request();
+    // Discard the responses of the uncompleted requests, but no longer than
+    // the grace period, since the cancel request can be lost.
+    while (has_uncompleted_request()) {
+      read_input();
+      auto rs = handle_input(false);
+      while (rs == Response_status::unready) {
+        const auto left = ceil<milliseconds>(until - Deadline_clock::now());
+        if (left <= milliseconds::zero() ||
+          wait_socket_readiness(Socket_readiness::read_ready, left) !=
+          Socket_readiness::read_ready)
+          break;
+        read_input();
+        rs = handle_input(false);
+      }
+      if (rs != Response_status::ready)
+        break;
+      release_response();
+    }
+  } catch (...) {}
+
+  // Drop the connection in a mess.
+  if (has_uncompleted_request())
+    disconnect();
+}
+
+/*
+ * Sends the query by using the simple query protocol, since the WAL sender
+ * doesn't accept the commands of the replication protocol otherwise.
+ */
+DMITIGR_PGFE_INLINE void Connection::execute_simple_nio__(const std::string& query)
+{
+  if (!is_ready_for_nio_request())
+    throw Generic_exception{"cannot execute query: not ready for request"};
+
+  requests_.emplace(Request::Id::execute); // can throw
+  try {
+    if (!PQsendQuery(conn(), query.c_str()))
+      throw Generic_exception{error_message()};
+  } catch (...) {
+    requests_.pop(); // rollback
+    throw;
+  }
+  count_request__();
+
+  assert(is_invariant_ok());
+}
+
 DMITIGR_PGFE_INLINE void Connection::throw_if_error()
 {
   if (auto err = error())
@@ -1496,8 +1884,26 @@ Connection::to_hex_storage(const pgfe::Data& data) const
 
   const auto from_length = data.size();
   const auto* const from = static_cast<const unsigned char*>(data.bytes());
-  std::size_t result_length{};
   using Uptr = std::unique_ptr<void, void(*)(void*)>;
+
+  // Encode in bulk to the hex format (which is supported since PostgreSQL 9.0).
+  if (PQserverVersion(conn()) >= 90000) {
+    const char* const std_strings{PQparameterStatus(conn(),
+        "standard_conforming_strings")};
+    const std::string_view prefix{std_strings && !std::strcmp(std_strings, "on")
+      ? "\\x" : "\\\\x"};
+    const std::size_t result_length{prefix.size() + 2*from_length};
+    Uptr storage{std::malloc(result_length + 1), &std::free};
+    if (!storage)
+      throw std::bad_alloc{};
+    auto* const result = static_cast<char*>(storage.get());
+    std::memcpy(result, prefix.data(), prefix.size());
+    detail::simd::hex_encode(from, result + prefix.size(), from_length);
+    result[result_length] = '\0';
+    return std::make_pair(std::move(storage), result_length);
+  }
+
+  std::size_t result_length{};
   if (auto storage = Uptr{PQescapeByteaConn(conn(), from, from_length,
         &result_length), &PQfreemem})
     // The result_length includes the terminating zero byte of the result.
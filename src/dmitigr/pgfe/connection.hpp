@@ -33,6 +33,7 @@
 #include "pq.hpp"
 #include "prepared_statement.hpp"
 #include "row.hpp"
+#include "statement_description_cache.hpp"
 #include "types_fwd.hpp"
 
 #include <cassert>
@@ -58,6 +59,107 @@ namespace dmitigr::pgfe {
  */
 DMITIGR_PGFE_API Server_status ping(const Connection_options& options);
 
+/**
+ * @ingroup main
+ *
+ * @brief The network counters of a connection.
+ *
+ * @details The counters are cumulative over the lifetime of the Connection
+ * instance (including reconnects). Thus, the cost of the code path can be
+ * measured as the difference of the counters taken before and after it.
+ *
+ * @see Connection::stats(), Connection_pool::stats().
+ */
+struct Connection_stats final {
+  /**
+   * @brief The number of bytes sent to the server and acknowledged by it.
+   *
+   * @details This is not the number of bytes written to the socket: the
+   * bytes still in flight (or in the send buffer) are not accounted until
+   * acknowledged by the server.
+   *
+   * @remarks Only maintained for TCP connections on Linux. Always zero for
+   * connections via Unix-domain sockets and on other platforms.
+   */
+  std::uint_fast64_t bytes_acked{};
+
+  /**
+   * @brief The number of bytes received from the server.
+   *
+   * @remarks Only maintained for TCP connections on Linux. Always zero for
+   * connections via Unix-domain sockets and on other platforms.
+   */
+  std::uint_fast64_t bytes_received{};
+
+  /// The number of requests sent to the server.
+  std::uint_fast64_t request_count{};
+
+  /**
+   * @brief The number of flushes of the output.
+   *
+   * @details If the nonblocking output mode is disabled, each request sent is
+   * accounted as one flush, since the output is flushed implicitly.
+   */
+  std::uint_fast64_t flush_count{};
+
+  /// The number of times the readiness of the socket was awaited and reached.
+  std::uint_fast64_t socket_wakeup_count{};
+
+  /// The number of times the response was awaited.
+  std::uint_fast64_t wait_response_count{};
+
+  /// The total time spent in awaiting the responses.
+  std::chrono::nanoseconds wait_response_time{};
+
+  /// Adds the counters of `rhs` to this instance.
+  Connection_stats& operator+=(const Connection_stats& rhs) noexcept
+  {
+    bytes_acked += rhs.bytes_acked;
+    bytes_received += rhs.bytes_received;
+    request_count += rhs.request_count;
+    flush_count += rhs.flush_count;
+    socket_wakeup_count += rhs.socket_wakeup_count;
+    wait_response_count += rhs.wait_response_count;
+    wait_response_time += rhs.wait_response_time;
+    return *this;
+  }
+
+  /// Subtracts the counters of `rhs` from this instance.
+  Connection_stats& operator-=(const Connection_stats& rhs) noexcept
+  {
+    bytes_acked -= rhs.bytes_acked;
+    bytes_received -= rhs.bytes_received;
+    request_count -= rhs.request_count;
+    flush_count -= rhs.flush_count;
+    socket_wakeup_count -= rhs.socket_wakeup_count;
+    wait_response_count -= rhs.wait_response_count;
+    wait_response_time -= rhs.wait_response_time;
+    return *this;
+  }
+};
+
+/**
+ * @ingroup main
+ *
+ * @returns The sum of the counters of `lhs` and `rhs`.
+ */
+inline Connection_stats operator+(Connection_stats lhs,
+  const Connection_stats& rhs) noexcept
+{
+  return lhs += rhs;
+}
+
+/**
+ * @ingroup main
+ *
+ * @returns The difference of the counters of `lhs` and `rhs`.
+ */
+inline Connection_stats operator-(Connection_stats lhs,
+  const Connection_stats& rhs) noexcept
+{
+  return lhs -= rhs;
+}
+
 /**
  * @ingroup main
  *
@@ -441,6 +543,8 @@ public:
    *
    * @throws Generic_exception with code Errc::timed_out if the expression
    * `has_response()` will not evaluates to `true` within the specified `timeout`.
+   * @throws Generic_exception with code Errc::deadline_exceeded if the expression
+   * `has_response()` will not evaluates to `true` before deadline().
    *
    * @par Exception safety guarantee
    * Basic.
@@ -691,6 +795,75 @@ public:
    */
   DMITIGR_PGFE_API bool has_uncompleted_request() const noexcept;
 
+  /**
+   * @brief Sets the cache of the descriptions of prepared statements.
+   *
+   * @param cache A cache to set. The value of `nullptr` disables the caching.
+   *
+   * @details The statements described by this connection are stored to the
+   * cache, and the statements being prepared by this connection are described
+   * from the cache if possible, without a round-trip to the server.
+   *
+   * @remarks The same cache can be shared by any number of connections.
+   *
+   * @see Statement_description_cache.
+   */
+  DMITIGR_PGFE_API void
+  set_description_cache(std::shared_ptr<Statement_description_cache> cache) noexcept;
+
+  /// @returns The cache of the descriptions of prepared statements.
+  DMITIGR_PGFE_API const std::shared_ptr<Statement_description_cache>&
+  description_cache() const noexcept;
+
+  /// A clock of deadlines.
+  using Deadline_clock = std::chrono::steady_clock;
+
+  /**
+   * @brief Sets the deadline of the requests.
+   *
+   * @details If the response is not available by the `deadline`, the
+   * wait_response() sends the cancel request to the server, drains the
+   * responses of the uncompleted requests and throws Generic_exception with
+   * code Errc::deadline_exceeded. Thus, unlike of the expiration of the
+   * timeout, the backend doesn't keep executing and the connection remains
+   * usable. If the responses are not drained within one second after the
+   * cancel request (e.g. the cancel request is lost, or the network is
+   * stuck), the connection is closed before throwing.
+   *
+   * @param deadline The value of `std::nullopt` means *no deadline*.
+   *
+   * @see Deadline_guard, cancel_request().
+   */
+  DMITIGR_PGFE_API void
+  set_deadline(std::optional<Deadline_clock::time_point> deadline) noexcept;
+
+  /// @returns The deadline of the requests.
+  DMITIGR_PGFE_API std::optional<Deadline_clock::time_point>
+  deadline() const noexcept;
+
+  /**
+   * @brief Requests the server to abandon the processing of the current
+   * command.
+   *
+   * @details The successful dispatch doesn't guarantee that the request will
+   * have any effect. If the cancellation is effective, the current command
+   * will be terminated early and return an error result.
+   *
+   * @par Requires
+   * `is_connected()`.
+   *
+   * @remarks This function blocks until the cancel request is sent.
+   */
+  DMITIGR_PGFE_API void cancel_request();
+
+  /**
+   * @returns The network counters of this instance.
+   *
+   * @details Allows to find the chatty code paths and to verify that the
+   * pipelining and batching are actually reduces the round-trips.
+   */
+  DMITIGR_PGFE_API Connection_stats stats() const noexcept;
+
   /**
    * @brief Submits a request to a server to prepare the statement.
    *
@@ -1025,6 +1198,89 @@ public:
       procedure, std::forward<Types>(arguments)...);
   }
 
+  /**
+   * @brief Executes the non-empty statements of `statements` in pipeline.
+   *
+   * @details At most `max_in_flight` statements are awaiting responses at any
+   * given moment. New statements are sent in batches each time the number of
+   * statements in flight drops to a half of `max_in_flight`, so the round-trip
+   * latency is paid once per batch rather than once per statement. When the
+   * first error occurs no more statements are sent, the results of statements
+   * already in flight are skipped, the pipeline is synchronized and the error
+   * is thrown.
+   *
+   * @param callback The callback of form `callback(Row&&)` to handle the rows
+   * of all the executed statements in order of execution.
+   * @param statements Statements to execute.
+   * @param max_in_flight The maximum number of statements in flight.
+   *
+   * @returns The number of successfully executed statements.
+   *
+   * @par Requires
+   * `is_ready_for_request() && max_in_flight && !statements[i].has_missing_parameter()`
+   * for each `i`.
+   *
+   * @par Effects
+   * `is_ready_for_request()`, unless the connection has been lost.
+   *
+   * @throws Sqlstate_exception on the first error returned by the server.
+   *
+   * @par Exception safety guarantee
+   * Basic.
+   *
+   * @remarks All the statements are executed in a single implicit transaction
+   * (unless explicit transaction control statements are used), therefore the
+   * statements which cannot be executed inside a transaction block (such as
+   * `VACUUM`) and `COPY` are not allowed.
+   *
+   * @remarks Requires libpq from PostgreSQL 14 or more recent version.
+   *
+   * @see set_pipeline_enabled(), Statement_reader.
+   */
+  template<typename F>
+  std::enable_if_t<std::is_invocable_v<F, Row&&>, std::size_t>
+  execute_pipelined(F&& callback, const Statement_vector& statements,
+    const std::size_t max_in_flight = 64)
+  {
+    return execute_pipelined__(statements,
+      std::forward<F>(callback), max_in_flight);
+  }
+
+  /// @overload
+  std::size_t execute_pipelined(const Statement_vector& statements,
+    const std::size_t max_in_flight = 64)
+  {
+    return execute_pipelined(ignore_row, statements, max_in_flight);
+  }
+
+  /**
+   * @brief Executes the non-empty statements read by `reader` in pipeline.
+   *
+   * @details Statements are parsed lazily, only when there is a room for them
+   * in the pipeline, and are discarded as soon as they are sent, so the whole
+   * script is never held in the memory.
+   *
+   * @par Effects
+   * `reader.is_exhausted()` if no error occurred.
+   *
+   * @see execute_pipelined(F&&, const Statement_vector&, std::size_t).
+   */
+  template<typename F>
+  std::enable_if_t<std::is_invocable_v<F, Row&&>, std::size_t>
+  execute_pipelined(F&& callback, Statement_reader& reader,
+    const std::size_t max_in_flight = 64)
+  {
+    return execute_pipelined__(reader,
+      std::forward<F>(callback), max_in_flight);
+  }
+
+  /// @overload
+  std::size_t execute_pipelined(Statement_reader& reader,
+    const std::size_t max_in_flight = 64)
+  {
+    return execute_pipelined(ignore_row, reader, max_in_flight);
+  }
+
   /**
    * @brief Enables or disables the pipeline on this instance.
    *
@@ -1262,6 +1518,9 @@ private:
   friend Copier;
   friend Large_object;
   friend Prepared_statement;
+  friend Replication_stream;
+  friend Result_cache;
+  friend Scatter_gather_executor;
 
   /// A request.
   struct Request final {
@@ -1345,6 +1604,9 @@ private:
   Notice_handler notice_handler_{&default_notice_handler};
   Notification_handler notification_handler_;
   Data_format default_result_format_{Data_format::text};
+  std::shared_ptr<Statement_description_cache> description_cache_;
+  std::optional<Deadline_clock::time_point> deadline_;
+  mutable Connection_stats stats_; // updated by wait_socket_readiness() too
 
   // Persistent data / private-modifiable data
   std::shared_ptr<Prepared_statement::State> execute_ps_state_;
@@ -1378,6 +1640,10 @@ private:
 
   bool is_invariant_ok() const noexcept;
 
+  void count_request__() noexcept;
+  void add_tcp_bytes__(std::uint_fast64_t& acked,
+    std::uint_fast64_t& received) const noexcept;
+
   void dismiss_request() noexcept
   {
     if (!requests_.empty()) {
@@ -1436,6 +1702,16 @@ private:
   static constexpr void ignore_row(Row&&) noexcept
   {}
 
+  using Row_handler = std::function<void(Row&&)>;
+  using Statement_source = std::function<const Statement*()>;
+
+  std::size_t execute_pipelined__(const Statement_vector& statements,
+    const Row_handler& handler, std::size_t max_in_flight);
+  std::size_t execute_pipelined__(Statement_reader& reader,
+    const Row_handler& handler, std::size_t max_in_flight);
+  std::size_t execute_pipelined__(const Statement_source& next_statement,
+    const Row_handler& handler, std::size_t max_in_flight);
+
   void prepare_nio__(const char* const query, const char* const name,
     const Statement* const preparsed);
 
@@ -1451,6 +1727,8 @@ private:
   }
 
   Prepared_statement wait_prepared_statement__();
+  std::string server_identity__() const;
+  std::string description_cache_key__(std::string_view query) const;
 
 #ifdef DMITIGR_PGFE_AIO
   void prepare_describe_aio__(Aio_handler handler,
@@ -1469,7 +1747,12 @@ private:
   // Utilities helpers
   // ---------------------------------------------------------------------------
 
+  /// The maximum time to drain the responses after the cancel request.
+  static constexpr std::chrono::milliseconds cancel_grace_period__{1000};
+
   int socket() const noexcept;
+  void cancel_and_drain__();
+  void execute_simple_nio__(const std::string& query);
   void throw_if_error();
   static Completion&& completion_or_throw(Completion&& comp);
   std::string error_message() const;
@@ -75,6 +75,7 @@ Connection_options::swap(Connection_options& rhs) noexcept
   using std::swap;
   swap(communication_mode_, rhs.communication_mode_);
   swap(session_mode_, rhs.session_mode_);
+  swap(replication_mode_, rhs.replication_mode_);
   swap(connect_timeout_, rhs.connect_timeout_);
   swap(wait_response_timeout_, rhs.wait_response_timeout_);
   swap(uds_directory_, rhs.uds_directory_);
@@ -149,6 +150,26 @@ Connection_options::session_mode() const noexcept
   return session_mode_;
 }
 
+DMITIGR_PGFE_INLINE Connection_options&
+Connection_options::set_replication_mode(
+  const std::optional<Replication_mode> value)
+{
+  replication_mode_ = value;
+  return *this;
+}
+
+DMITIGR_PGFE_INLINE Connection_options&
+Connection_options::set(const std::optional<Replication_mode> value)
+{
+  return set_replication_mode(value);
+}
+
+DMITIGR_PGFE_INLINE std::optional<Replication_mode>
+Connection_options::replication_mode() const noexcept
+{
+  return replication_mode_;
+}
+
 DMITIGR_PGFE_INLINE Connection_options&
 Connection_options::set_connect_timeout(
   const std::optional<std::chrono::milliseconds> value)
@@ -633,6 +654,7 @@ operator==(const Connection_options& lhs, const Connection_options& rhs) noexcep
     // numerics
     lhs.communication_mode_ == rhs.communication_mode_ &&
     lhs.session_mode_ == rhs.session_mode_ &&
+    lhs.replication_mode_ == rhs.replication_mode_ &&
     lhs.channel_binding_ == rhs.channel_binding_ &&
     lhs.connect_timeout_ == rhs.connect_timeout_ &&
     lhs.wait_response_timeout_ == rhs.wait_response_timeout_ &&
@@ -714,6 +736,9 @@ public:
     else
       values_[target_session_attrs] = to_literal(Session_mode::any);
 
+    if (const auto v = o.replication_mode())
+      values_[replication] = to_literal(*v);
+
     if (const auto& v = o.database())
       values_[dbname] = *v;
     if (const auto& v = o.username())
@@ -874,6 +899,7 @@ private:
     sslsni, requirepeer, ssl_min_protocol_version, ssl_max_protocol_version,
 
     target_session_attrs,
+    replication,
     service,
 
     // Options that are unavailable from Pgfe API (at least for now):
@@ -921,6 +947,7 @@ private:
     case gsslib: return "gsslib";
     case service: return "service";
     case target_session_attrs: return "target_session_attrs";
+    case replication: return "replication";
     case Keyword_count_:;
     }
     DMITIGR_ASSERT(false);
@@ -965,6 +992,17 @@ private:
     DMITIGR_ASSERT(false);
   }
 
+  /// @returns The value literal for libpq.
+  static const char* to_literal(const Replication_mode value) noexcept
+  {
+    using Rm = Replication_mode;
+    switch (value) {
+    case Rm::physical: return "true";
+    case Rm::logical: return "database";
+    }
+    DMITIGR_ASSERT(false);
+  }
+
   /**
    * @brief Updates the cache of libpq keywords.
    *
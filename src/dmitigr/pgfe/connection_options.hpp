@@ -84,6 +84,27 @@ public:
 
   // ---------------------------------------------------------------------------
 
+  /**
+   * @brief Sets the replication mode.
+   *
+   * @param value A value of replication mode. `std::nullopt` means a regular
+   * (non-replication) connection.
+   *
+   * @see Replication_stream.
+   */
+  DMITIGR_PGFE_API Connection_options&
+  set_replication_mode(std::optional<Replication_mode> value);
+
+  /// Shortcut of set_replication_mode().
+  DMITIGR_PGFE_API Connection_options&
+  set(const std::optional<Replication_mode> value);
+
+  /// @returns The current value of the option.
+  DMITIGR_PGFE_API std::optional<Replication_mode>
+  replication_mode() const noexcept;
+
+  // ---------------------------------------------------------------------------
+
   /**
    * @brief Sets the timeout of the connect operation.
    *
@@ -643,6 +664,7 @@ private:
 
   std::optional<Communication_mode> communication_mode_;
   std::optional<Session_mode> session_mode_;
+  std::optional<Replication_mode> replication_mode_;
   std::optional<std::chrono::milliseconds> connect_timeout_;
   std::optional<std::chrono::milliseconds> wait_response_timeout_;
   std::optional<std::string> service_name_;
@@ -115,6 +115,7 @@ DMITIGR_PGFE_INLINE Connection_pool::Connection_pool(std::size_t count,
   const auto self = std::make_shared<Connection_pool*>(this);
   for (; count > 0; --count)
     states_.emplace_back(std::make_unique<Connection>(options), self);
+  borrowed_stats_.resize(states_.size());
 }
 
 DMITIGR_PGFE_INLINE bool Connection_pool::is_valid() const noexcept
@@ -148,6 +149,19 @@ Connection_pool::release_handler() const noexcept
   return release_handler_;
 }
 
+DMITIGR_PGFE_INLINE void Connection_pool::set_description_cache(
+  std::shared_ptr<Statement_description_cache> cache)
+{
+  const std::lock_guard lg{mutex_};
+  description_cache_ = std::move(cache);
+}
+
+DMITIGR_PGFE_INLINE const std::shared_ptr<Statement_description_cache>&
+Connection_pool::description_cache() const noexcept
+{
+  return description_cache_;
+}
+
 DMITIGR_PGFE_INLINE void Connection_pool::connect()
 {
   const std::lock_guard lg{mutex_};
@@ -205,7 +219,10 @@ DMITIGR_PGFE_INLINE auto Connection_pool::connection() -> Handle
     auto& self = i->second;
     conn->connect();
     DMITIGR_ASSERT(conn->is_ready_for_request());
-    return {self, std::move(conn), static_cast<std::size_t>(i - b)};
+    conn->set_description_cache(description_cache_);
+    const auto index = static_cast<std::size_t>(i - b);
+    borrowed_stats_[index] = conn->stats();
+    return {self, std::move(conn), index};
   } else
     return {};
 }
@@ -254,4 +271,15 @@ DMITIGR_PGFE_INLINE std::size_t Connection_pool::size() const noexcept
   return states_.size();
 }
 
+DMITIGR_PGFE_INLINE Connection_stats Connection_pool::stats() const noexcept
+{
+  const std::lock_guard lg{mutex_};
+  Connection_stats result;
+  for (std::size_t i{}; i < states_.size(); ++i) {
+    const auto& conn = states_[i].first;
+    result += conn ? conn->stats() : borrowed_stats_[i];
+  }
+  return result;
+}
+
 } // namespace dmitigr::pgfe
@@ -195,6 +195,25 @@ public:
   DMITIGR_PGFE_API const std::function<void(Connection&)>&
   release_handler() const noexcept;
 
+  /**
+   * @brief Sets the cache of the descriptions of prepared statements for each
+   * connection of the pool.
+   *
+   * @details The cache is set for the connection upon obtaining it.
+   *
+   * @see description_cache(), Connection::set_description_cache().
+   */
+  DMITIGR_PGFE_API void
+  set_description_cache(std::shared_ptr<Statement_description_cache> cache);
+
+  /**
+   * @returns The cache of the descriptions of prepared statements.
+   *
+   * @see set_description_cache().
+   */
+  DMITIGR_PGFE_API const std::shared_ptr<Statement_description_cache>&
+  description_cache() const noexcept;
+
   /**
    * @brief Opens the connections to the server.
    *
@@ -246,6 +265,16 @@ public:
   /// @returns The size of the pool.
   DMITIGR_PGFE_API std::size_t size() const noexcept;
 
+  /**
+   * @returns The sum of the network counters of the connections of the pool.
+   *
+   * @remarks The connections which are currently in use are accounted as of
+   * the moment they were obtained.
+   *
+   * @see Connection::stats().
+   */
+  DMITIGR_PGFE_API Connection_stats stats() const noexcept;
+
 private:
   friend Handle;
 
@@ -256,8 +285,10 @@ private:
   mutable std::mutex mutex_;
   bool is_connected_{};
   std::vector<State> states_;
+  std::vector<Connection_stats> borrowed_stats_; // snapshots of states_
   std::function<void(Connection&)> connect_handler_;
   std::function<void(Connection&)> release_handler_;
+  std::shared_ptr<Statement_description_cache> description_cache_;
 };
 
 } // namespace dmitigr::pgfe
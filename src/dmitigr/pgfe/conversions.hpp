@@ -23,6 +23,7 @@
 #include "basics.hpp"
 #include "data.hpp"
 #include "exceptions.hpp"
+#include "record_view.hpp"
 #include "row.hpp"
 #include "types_fwd.hpp"
 
@@ -482,6 +483,21 @@ template<> struct Conversions<Row> {
   }
 };
 
+/**
+ * @ingroup conversions
+ *
+ * @brief Full specialization of Conversions for `Record_view`.
+ *
+ * @details Instances of the type `Record_view` can only be created from
+ * Data_format::binary format. The resulting view points to the `data`.
+ */
+template<> struct Conversions<Record_view> {
+  static Record_view to_type(const Data& data)
+  {
+    return Record_view{data};
+  }
+};
+
 /**
  * @ingroup conversions
  *
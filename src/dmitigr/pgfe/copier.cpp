@@ -87,6 +87,7 @@ DMITIGR_PGFE_INLINE Data_direction Copier::data_direction() const noexcept
   switch (pq_result_.status()) {
   case PGRES_COPY_IN: return Data_direction::to_server;
   case PGRES_COPY_OUT: return Data_direction::from_server;
+  case PGRES_COPY_BOTH: return Data_direction::bidirectional;
   default: break;
   }
   DMITIGR_ASSERT(false);
@@ -134,13 +135,14 @@ DMITIGR_PGFE_INLINE Data_view Copier::receive(const bool wait) const
     buffer_ = decltype(buffer_){buffer, &PQfreemem};
   DMITIGR_ASSERT(!buffer_ || size > 0);
 
+  // CopyBothResponse of the replication protocol has no fields.
+  const auto format = field_count() ? data_format(0) : Data_format::binary;
   if (size == -1)
     return Data_view{};
   else if (size == 0)
-    return Data_view{"", 0, data_format(0)};
+    return Data_view{"", 0, format};
   else if (size > 0)
-    return Data_view{buffer_.get(),
-      static_cast<std::size_t>(size), data_format(0)};
+    return Data_view{buffer_.get(), static_cast<std::size_t>(size), format};
   else if (size == -2)
     throw Generic_exception{connection().error_message()};
 
@@ -162,14 +164,14 @@ DMITIGR_PGFE_INLINE Connection& Copier::connection()
 
 void Copier::check_send() const
 {
-  if (data_direction() != Data_direction::to_server)
+  if (data_direction() == Data_direction::from_server)
     throw Generic_exception{"cannot COPY data to the server: "
       "wrong data direction"};
 }
 
 void Copier::check_receive() const
 {
-  if (data_direction() != Data_direction::from_server)
+  if (data_direction() == Data_direction::to_server)
     throw Generic_exception{"cannot COPY data from the server: "
       "wrong data direction"};
 }
@@ -98,7 +98,7 @@ public:
    * @brief Sends data to the server.
    *
    * @par Requires
-   * `data_direction() == Data_direction::to_server`.
+   * `data_direction() != Data_direction::from_server`.
    *
    * @returns `true` if the `data` was queued. Returns `false` if the output
    * buffers are full and needs to be flushed (it's possible only if
@@ -115,7 +115,7 @@ public:
    * value of this parameter as the error message.
    *
    * @par Requires
-   * `data_direction() == Data_direction::to_server`.
+   * `data_direction() != Data_direction::from_server`.
    *
    * @returns `true` if either:
    *   - the indication was sent (Connection::is_nio_output_enabled()
@@ -135,7 +135,7 @@ public:
    * @brief Receives data from the server.
    *
    * @par Requires
-   * `data_direction() == Data_direction::from_server`.
+   * `data_direction() != Data_direction::to_server`.
    *
    * @returns Either:
    *   - invalid instance if the `COPY` command is done;
@@ -143,7 +143,8 @@ public:
    *   is yet available (this is only possible when `wait` is `false`);
    *   - the non-empty instance received from the server.
    *
-   *  @remarks The format of returned data is equals to `data_format(0)`.
+   *  @remarks The format of returned data is equals to `data_format(0)`, or
+   *  to Data_format::binary if `!field_count()`.
    */
   DMITIGR_PGFE_API Data_view receive(bool wait = true) const;
 
@@ -0,0 +1,406 @@
+// -*- C++ -*-
+//
+// Copyright 2023 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "../base/assert.hpp"
+#include "../os/pid.hpp"
+#include "copier.hpp"
+#include "copy_loader.hpp"
+#include "exceptions.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <fstream>
+#include <mutex>
+#include <thread>
+
+namespace dmitigr::pgfe {
+
+namespace detail {
+
+/// A bounded queue of chunks shared between the producer and the workers.
+class Copy_chunk_queue final {
+public:
+  explicit Copy_chunk_queue(const std::size_t capacity)
+    : capacity_{capacity}
+  {
+    DMITIGR_ASSERT(capacity_);
+  }
+
+  /// @returns `false` if the queue is aborted.
+  bool push(std::string&& chunk)
+  {
+    std::unique_lock lk{mutex_};
+    not_full_.wait(lk, [this]
+    {
+      return chunks_.size() < capacity_ || is_aborted_;
+    });
+    if (is_aborted_)
+      return false;
+    chunks_.push_back(std::move(chunk));
+    not_empty_.notify_one();
+    return true;
+  }
+
+  /// @returns `false` if the queue is either closed and empty, or aborted.
+  bool pop(std::string& chunk)
+  {
+    std::unique_lock lk{mutex_};
+    not_empty_.wait(lk, [this]
+    {
+      return !chunks_.empty() || is_closed_ || is_aborted_;
+    });
+    if (is_aborted_ || chunks_.empty())
+      return false;
+    chunk.swap(chunks_.front());
+    chunks_.pop_front();
+    not_full_.notify_one();
+    return true;
+  }
+
+  /// Indicates that nothing will be pushed anymore.
+  void close() noexcept
+  {
+    {
+      const std::lock_guard lg{mutex_};
+      is_closed_ = true;
+    }
+    not_empty_.notify_all();
+  }
+
+  /// Discards the chunks and wakes up everyone.
+  void abort() noexcept
+  {
+    {
+      const std::lock_guard lg{mutex_};
+      is_aborted_ = true;
+      chunks_.clear();
+    }
+    not_empty_.notify_all();
+    not_full_.notify_all();
+  }
+
+  bool is_aborted() const noexcept
+  {
+    const std::lock_guard lg{mutex_};
+    return is_aborted_;
+  }
+
+private:
+  mutable std::mutex mutex_;
+  std::condition_variable not_empty_;
+  std::condition_variable not_full_;
+  std::deque<std::string> chunks_;
+  std::size_t capacity_{};
+  bool is_closed_{};
+  bool is_aborted_{};
+};
+
+} // namespace detail
+
+DMITIGR_PGFE_INLINE Copy_loader::Copy_loader(Connection_pool& pool,
+  std::string statement, const std::size_t worker_count)
+  : pool_{pool}
+  , statement_{std::move(statement)}
+  , worker_count_{worker_count}
+{
+  if (statement_.empty())
+    throw Generic_exception{"cannot create COPY loader: empty statement"};
+  else if (!worker_count_)
+    throw Generic_exception{"cannot create COPY loader: no workers"};
+}
+
+DMITIGR_PGFE_INLINE const std::string& Copy_loader::statement() const noexcept
+{
+  return statement_;
+}
+
+DMITIGR_PGFE_INLINE std::size_t Copy_loader::worker_count() const noexcept
+{
+  return worker_count_;
+}
+
+DMITIGR_PGFE_INLINE void Copy_loader::set_commit_mode(const Commit_mode mode) noexcept
+{
+  commit_mode_ = mode;
+}
+
+DMITIGR_PGFE_INLINE auto Copy_loader::commit_mode() const noexcept -> Commit_mode
+{
+  return commit_mode_;
+}
+
+DMITIGR_PGFE_INLINE void
+Copy_loader::set_input_format(const Input_format format) noexcept
+{
+  input_format_ = format;
+}
+
+DMITIGR_PGFE_INLINE auto Copy_loader::input_format() const noexcept -> Input_format
+{
+  return input_format_;
+}
+
+DMITIGR_PGFE_INLINE void Copy_loader::set_chunk_size(const std::size_t size)
+{
+  if (!size)
+    throw Generic_exception{"cannot set chunk size of COPY loader: "
+      "invalid size"};
+  chunk_size_ = size;
+}
+
+DMITIGR_PGFE_INLINE std::size_t Copy_loader::chunk_size() const noexcept
+{
+  return chunk_size_;
+}
+
+DMITIGR_PGFE_INLINE void Copy_loader::load(const Source& source)
+{
+  if (!source)
+    throw Generic_exception{"cannot load by COPY: invalid source"};
+
+  std::string tail;
+  bool is_quoted{};
+  bool is_eof{};
+  load__([this, &source, &tail, &is_quoted, &is_eof](std::string& chunk)
+  {
+    // Start the chunk from the incomplete row left from the previous one.
+    chunk.clear();
+    chunk.swap(tail);
+    while (!is_eof) {
+      const auto offset = chunk.size();
+      chunk.resize(offset + chunk_size_);
+      const auto size = source(chunk.data() + offset, chunk_size_);
+      DMITIGR_ASSERT(size <= chunk_size_);
+      chunk.resize(offset + size);
+      if (!size) {
+        is_eof = true;
+        break;
+      }
+
+      // Find the last row boundary in the data just read.
+      auto boundary = std::string::npos;
+      if (input_format_ == Input_format::text) {
+        const auto pos = std::string_view{chunk}.substr(offset).rfind('\n');
+        if (pos != std::string_view::npos)
+          boundary = offset + pos;
+      } else {
+        for (auto i = offset; i < chunk.size(); ++i) {
+          if (chunk[i] == '"')
+            is_quoted = !is_quoted;
+          else if (chunk[i] == '\n' && !is_quoted)
+            boundary = i;
+        }
+      }
+      if (boundary != std::string::npos) {
+        tail.assign(chunk, boundary + 1);
+        chunk.resize(boundary + 1);
+        return true;
+      }
+    }
+    return !chunk.empty();
+  });
+}
+
+DMITIGR_PGFE_INLINE void Copy_loader::load(std::istream& input)
+{
+  load([&input](char* const buffer, const std::size_t size)
+  {
+    input.read(buffer, static_cast<std::streamsize>(size));
+    if (input.bad())
+      throw Generic_exception{"cannot load by COPY: input stream read error"};
+    return static_cast<std::size_t>(input.gcount());
+  });
+}
+
+DMITIGR_PGFE_INLINE void Copy_loader::load(const std::filesystem::path& path)
+{
+  std::ifstream input{path, std::ios_base::in | std::ios_base::binary};
+  if (!input)
+    throw Generic_exception{"cannot load by COPY: cannot open file "
+      + path.string()};
+  load(input);
+}
+
+DMITIGR_PGFE_INLINE auto Copy_loader::worker_stats() const noexcept
+  -> const std::vector<Worker_stats>&
+{
+  return worker_stats_;
+}
+
+DMITIGR_PGFE_INLINE void
+Copy_loader::load__(const std::function<bool(std::string&)>& next_chunk)
+{
+  using Clock = std::chrono::steady_clock;
+
+  std::vector<Connection_pool::Handle> handles;
+  handles.reserve(worker_count_);
+  for (std::size_t i{}; i < worker_count_; ++i) {
+    auto handle = pool_.connection();
+    if (!handle)
+      throw Generic_exception{"cannot load by COPY: not enough free "
+        "connections in pool"};
+    handles.push_back(std::move(handle));
+  }
+
+  const bool is_two_phase{commit_mode_ == Commit_mode::two_phase};
+  /*
+   * The GIDs must be unique cluster-wide, and the prepared transactions might
+   * outlive this process (and even the reboot of the host), so the prefix is
+   * built from the wall clock, the process identifier and the counter of the
+   * loads started by this process.
+   */
+  static std::atomic_uint_fast64_t load_counter;
+  const std::string gid_prefix{"pgfe_copy_loader_"
+    + std::to_string(std::chrono::system_clock::now().time_since_epoch().count())
+    + "_" + std::to_string(os::pid()) + "_" + std::to_string(++load_counter) + "_"};
+  std::vector<Worker_stats> stats(worker_count_);
+  std::vector<std::exception_ptr> errors(worker_count_);
+  std::vector<char> is_prepared(worker_count_);
+  detail::Copy_chunk_queue queue{2*worker_count_};
+
+  const auto work = [&](const std::size_t index) noexcept
+  {
+    auto& conn = *handles[index];
+    auto& st = stats[index];
+    try {
+      conn.execute("begin");
+      const auto start = Clock::now();
+      conn.execute(statement_);
+      auto copier = conn.copier();
+      if (!copier || copier.data_direction() != Data_direction::to_server)
+        throw Generic_exception{"cannot load by COPY: not a COPY FROM STDIN "
+          "statement"};
+
+      std::string chunk;
+      while (queue.pop(chunk)) {
+        copier.send(chunk);
+        st.byte_count += chunk.size();
+        ++st.chunk_count;
+      }
+      if (queue.is_aborted()) {
+        // The error is expected here.
+        copier.end("COPY loading is aborted");
+        conn.wait_response();
+        (void)conn.error();
+        return;
+      }
+      copier.end();
+      conn.wait_response_throw();
+      st.row_count = static_cast<std::size_t>(
+        conn.completion().row_count().value_or(0));
+      st.duration = Clock::now() - start;
+
+      if (is_two_phase) {
+        conn.execute("prepare transaction " +
+          conn.to_quoted_literal(gid_prefix + std::to_string(index)));
+        is_prepared[index] = true;
+      }
+    } catch (...) {
+      errors[index] = std::current_exception();
+      queue.abort();
+    }
+  };
+
+  // Run the workers and feed them.
+  std::exception_ptr error;
+  {
+    std::vector<std::thread> workers;
+    workers.reserve(worker_count_);
+    try {
+      for (std::size_t i{}; i < worker_count_; ++i)
+        workers.emplace_back(work, i);
+      std::string chunk;
+      while (next_chunk(chunk) && queue.push(std::move(chunk)));
+    } catch (...) {
+      error = std::current_exception();
+      queue.abort();
+    }
+    queue.close();
+    for (auto& worker : workers)
+      worker.join();
+  }
+  if (!error) {
+    for (const auto& e : errors) {
+      if (e) {
+        error = e;
+        break;
+      }
+    }
+  }
+
+  // Finish the transactions.
+  const bool is_commit_decided{!error};
+  if (is_commit_decided) {
+    std::string unresolved_gids;
+    std::string commit_error;
+    for (std::size_t i{}; i < worker_count_; ++i) {
+      auto& conn = *handles[i];
+      const auto gid = gid_prefix + std::to_string(i);
+      try {
+        if (is_two_phase)
+          conn.execute("commit prepared " + conn.to_quoted_literal(gid));
+        else
+          conn.execute("commit");
+      } catch (const std::exception& e) {
+        if (!is_two_phase) {
+          error = std::current_exception();
+          break;
+        }
+        // The prepared transactions of the rest must be committed anyway.
+        stats[i].unresolved_gid = gid;
+        if (!unresolved_gids.empty())
+          unresolved_gids.append(", ");
+        unresolved_gids.append(gid);
+        if (commit_error.empty())
+          commit_error = e.what();
+      }
+    }
+    if (!unresolved_gids.empty())
+      error = std::make_exception_ptr(Generic_exception{
+          "cannot commit prepared transactions (must be resolved manually) "
+          + unresolved_gids + ": " + commit_error});
+    if (!error) {
+      worker_stats_ = std::move(stats);
+      return;
+    }
+  }
+  for (std::size_t i{}; i < worker_count_; ++i) {
+    auto& conn = *handles[i];
+    const auto gid = gid_prefix + std::to_string(i);
+    // The prepared transaction survives the disconnection.
+    const bool is_rollback_prepared{is_prepared[i] && !is_commit_decided};
+    try {
+      if (!conn.is_connected()) {
+        if (is_rollback_prepared)
+          stats[i].unresolved_gid = gid;
+      } else if (is_rollback_prepared)
+        conn.execute("rollback prepared " + conn.to_quoted_literal(gid));
+      else if (conn.is_transaction_uncommitted() || !conn.is_ready_for_request())
+        conn.execute("rollback");
+    } catch (...) {
+      if (is_rollback_prepared)
+        stats[i].unresolved_gid = gid;
+      // Failed rollback might indicate a total mess.
+      conn.disconnect();
+    }
+  }
+  worker_stats_ = std::move(stats);
+  std::rethrow_exception(error);
+}
+
+} // namespace dmitigr::pgfe
@@ -0,0 +1,259 @@
+// -*- C++ -*-
+//
+// Copyright 2023 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DMITIGR_PGFE_COPY_LOADER_HPP
+#define DMITIGR_PGFE_COPY_LOADER_HPP
+
+#include "connection_pool.hpp"
+#include "dll.hpp"
+#include "types_fwd.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <filesystem>
+#include <functional>
+#include <istream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace dmitigr::pgfe {
+
+/**
+ * @ingroup utilities
+ *
+ * @brief A parallel loader of data by the `COPY FROM STDIN` command.
+ *
+ * @details The input is split into chunks on the row boundaries and the chunks
+ * are distributed between the workers, each of which sends them by using its
+ * own connection of the pool. Thus, the load is spread across the multiple
+ * backends of the server.
+ *
+ * Example:
+ * @code
+ * pgfe::Connection_pool pool{8, options};
+ * pool.connect();
+ * pgfe::Copy_loader loader{pool, "copy tab from stdin (format csv)", 8};
+ * loader.set_input_format(pgfe::Copy_loader::Input_format::csv);
+ * loader.load(std::filesystem::path{"tab.csv"});
+ * for (const auto& stats : loader.worker_stats())
+ *   std::cout << stats.throughput() << " bytes/s\n";
+ * @endcode
+ *
+ * @remarks The order of the rows loaded is not preserved.
+ */
+class Copy_loader final {
+public:
+  /// A commit mode.
+  enum class Commit_mode {
+    /**
+     * Each worker loads in its own transaction, and the transactions are
+     * committed one by one after all of the workers succeeded. (The data
+     * committed is not rolled back if committing of the rest is failed.)
+     */
+    independent,
+
+    /**
+     * Each worker loads in its own transaction which is prepared for the
+     * two-phase commit, and the prepared transactions are committed after
+     * all of the workers succeeded. (Requires `max_prepared_transactions`
+     * of the server to be not less than the number of workers.) If committing
+     * (or rolling back) of the prepared transaction is failed, it's left
+     * prepared and its identifier is reported by Worker_stats::unresolved_gid.
+     * The identifiers of all the prepared transactions which are failed to
+     * commit are also reported by the exception thrown.
+     *
+     * @warning The prepared transactions which are left prepared hold the
+     * locks and prevent the vacuum, so the operator must resolve them by
+     * either `COMMIT PREPARED` or `ROLLBACK PREPARED` (see the system view
+     * `pg_prepared_xacts`).
+     */
+    two_phase
+  };
+
+  /// An input format.
+  enum class Input_format {
+    /// The rows are terminated by the newline character.
+    text,
+
+    /**
+     * The rows are terminated by the newline character which is not enclosed
+     * in double quotes. (The escape character must be a double quote.)
+     */
+    csv
+  };
+
+  /// A worker statistics.
+  struct Worker_stats final {
+    /// The number of rows loaded.
+    std::size_t row_count{};
+
+    /// The number of bytes sent.
+    std::size_t byte_count{};
+
+    /// The number of chunks sent.
+    std::size_t chunk_count{};
+
+    /// The duration of the `COPY` command.
+    std::chrono::nanoseconds duration{};
+
+    /**
+     * The identifier of the prepared transaction which is left neither
+     * committed nor rolled back, or empty string.
+     *
+     * @see Commit_mode::two_phase.
+     */
+    std::string unresolved_gid;
+
+    /// @returns The number of bytes sent per second.
+    double throughput() const noexcept
+    {
+      const std::chrono::duration<double> seconds{duration};
+      return seconds.count() > 0 ? byte_count / seconds.count() : 0;
+    }
+  };
+
+  /**
+   * @brief A source of the input.
+   *
+   * @details Reads at most `size` bytes to `buffer`.
+   *
+   * @returns The number of bytes read, or `0` at the end of input.
+   */
+  using Source = std::function<std::size_t(char* buffer, std::size_t size)>;
+
+  /// Not copy-constructible.
+  Copy_loader(const Copy_loader&) = delete;
+
+  /// Not copy-assignable.
+  Copy_loader& operator=(const Copy_loader&) = delete;
+
+  /// Not move-constructible.
+  Copy_loader(Copy_loader&&) = delete;
+
+  /// Not move-assignable.
+  Copy_loader& operator=(Copy_loader&&) = delete;
+
+  /**
+   * @brief The constructor.
+   *
+   * @param pool A connection pool to borrow the connections from.
+   * @param statement A `COPY FROM STDIN` statement.
+   * @param worker_count A number of workers.
+   *
+   * @par Requires
+   * `!statement.empty() && worker_count > 0`.
+   */
+  DMITIGR_PGFE_API Copy_loader(Connection_pool& pool, std::string statement,
+    std::size_t worker_count);
+
+  /// @returns The `COPY` statement.
+  DMITIGR_PGFE_API const std::string& statement() const noexcept;
+
+  /// @returns The number of workers.
+  DMITIGR_PGFE_API std::size_t worker_count() const noexcept;
+
+  /// Sets the commit mode.
+  DMITIGR_PGFE_API void set_commit_mode(Commit_mode mode) noexcept;
+
+  /// @returns The commit mode. The default is Commit_mode::independent.
+  DMITIGR_PGFE_API Commit_mode commit_mode() const noexcept;
+
+  /// Sets the input format.
+  DMITIGR_PGFE_API void set_input_format(Input_format format) noexcept;
+
+  /// @returns The input format. The default is Input_format::text.
+  DMITIGR_PGFE_API Input_format input_format() const noexcept;
+
+  /**
+   * @brief Sets the approximate size of the chunk of the input.
+   *
+   * @par Requires
+   * `size > 0`.
+   */
+  DMITIGR_PGFE_API void set_chunk_size(std::size_t size);
+
+  /// @returns The approximate size of chunk. The default is 1 MiB.
+  DMITIGR_PGFE_API std::size_t chunk_size() const noexcept;
+
+  /**
+   * @brief Loads the input from the `source`.
+   *
+   * @details Borrows worker_count() connections from the pool, runs the
+   * `COPY` command on each of them and waits until the whole input is
+   * loaded. If either of the workers or the `source` fails, the `COPY` of the
+   * rest of the workers is aborted and all of the transactions are rolled
+   * back.
+   *
+   * @par Requires
+   * `source`.
+   *
+   * @par Effects
+   * `worker_stats()` are updated.
+   *
+   * @throws Generic_exception if there are not enough free connections in the
+   * pool, or if committing of some of the prepared transactions is failed
+   * (see Commit_mode::two_phase), or the first exception thrown by either the
+   * worker or `source`.
+   */
+  DMITIGR_PGFE_API void load(const Source& source);
+
+  /// @overload
+  DMITIGR_PGFE_API void load(std::istream& input);
+
+  /// @overload
+  DMITIGR_PGFE_API void load(const std::filesystem::path& path);
+
+  /**
+   * @overload
+   *
+   * @details Each element of the range is a row without the terminating
+   * newline character.
+   */
+  template<typename InputIterator>
+  void load(InputIterator first, const InputIterator last)
+  {
+    load__([this, &first, &last](std::string& chunk)
+    {
+      chunk.clear();
+      for (; first != last && chunk.size() < chunk_size_; ++first)
+        chunk.append(std::string_view{*first}).push_back('\n');
+      return !chunk.empty();
+    });
+  }
+
+  /// @returns The statistics of each worker of the last load.
+  DMITIGR_PGFE_API const std::vector<Worker_stats>& worker_stats() const noexcept;
+
+private:
+  Connection_pool& pool_;
+  std::string statement_;
+  std::size_t worker_count_{};
+  Commit_mode commit_mode_{Commit_mode::independent};
+  Input_format input_format_{Input_format::text};
+  std::size_t chunk_size_{1024*1024};
+  std::vector<Worker_stats> worker_stats_;
+
+  DMITIGR_PGFE_API void load__(const std::function<bool(std::string&)>& next_chunk);
+};
+
+} // namespace dmitigr::pgfe
+
+#ifndef DMITIGR_PGFE_NOT_HEADER_ONLY
+#include "copy_loader.cpp"
+#endif
+
+#endif  // DMITIGR_PGFE_COPY_LOADER_HPP
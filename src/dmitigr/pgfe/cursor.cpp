@@ -0,0 +1,235 @@
+// -*- C++ -*-
+//
+// Copyright 2023 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "../base/assert.hpp"
+#include "cursor.hpp"
+#include "exceptions.hpp"
+
+#include <algorithm>
+#include <iostream>
+#include <memory>
+
+namespace dmitigr::pgfe {
+
+DMITIGR_PGFE_INLINE Cursor::~Cursor() noexcept
+{
+  if (is_closed_)
+    return;
+
+  try {
+    try {
+      close();
+    } catch (...) {
+      conn_.disconnect();
+      throw;
+    }
+  } catch (const std::exception& e) {
+    std::clog << "cursor close error: " << e.what() << '\n';
+  } catch (...) {
+    std::clog << "cursor close error: unknown error\n";
+  }
+}
+
+DMITIGR_PGFE_INLINE Connection& Cursor::connection() noexcept
+{
+  return conn_;
+}
+
+DMITIGR_PGFE_INLINE const std::string& Cursor::name() const noexcept
+{
+  return name_;
+}
+
+DMITIGR_PGFE_INLINE bool Cursor::owns_transaction() const noexcept
+{
+  return owns_transaction_;
+}
+
+DMITIGR_PGFE_INLINE void Cursor::set_batch_size_target(const std::size_t bytes)
+{
+  if (!bytes)
+    throw Generic_exception{"cannot set batch size target of cursor: "
+      "invalid size"};
+  batch_size_target_ = bytes;
+}
+
+DMITIGR_PGFE_INLINE std::size_t Cursor::batch_size_target() const noexcept
+{
+  return batch_size_target_;
+}
+
+DMITIGR_PGFE_INLINE void
+Cursor::set_fetch_count_limits(const std::size_t min, const std::size_t max)
+{
+  if (!(0 < min && min <= max))
+    throw Generic_exception{"cannot set fetch count limits of cursor: "
+      "invalid limits"};
+  min_fetch_count_ = min;
+  max_fetch_count_ = max;
+  fetch_count_ = std::clamp(fetch_count_, min_fetch_count_, max_fetch_count_);
+}
+
+DMITIGR_PGFE_INLINE std::size_t Cursor::fetch_count() const noexcept
+{
+  return fetch_count_;
+}
+
+DMITIGR_PGFE_INLINE Row Cursor::next()
+{
+  if (is_closed_)
+    throw Generic_exception{"cannot fetch from closed cursor"};
+  else if (is_exhausted_)
+    return Row{};
+
+  try {
+    if (!is_started_)
+      start__();
+
+    while (true) {
+      DMITIGR_ASSERT(!fetches_.empty());
+      conn_.wait_response();
+      if (auto row = conn_.row()) {
+        ++batch_row_count_;
+        const std::size_t field_count{row.field_count()};
+        for (std::size_t i{}; i < field_count; ++i)
+          batch_size_ += row.data(i).size();
+        return row;
+      } else if (auto err = conn_.error())
+        throw Sqlstate_exception{std::make_shared<Error>(std::move(err))};
+
+      // The batch is complete.
+      conn_.completion();
+      const bool is_last_batch{batch_row_count_ < fetches_.front()};
+      fetches_.pop_front();
+      adapt_fetch_count__();
+      if (is_last_batch) {
+        drain__();
+        is_exhausted_ = true;
+        return Row{};
+      } else
+        send_fetch__(); // keep the next batch in flight
+    }
+  } catch (...) {
+    abort__();
+    throw;
+  }
+}
+
+DMITIGR_PGFE_INLINE bool Cursor::is_exhausted() const noexcept
+{
+  return is_exhausted_;
+}
+
+DMITIGR_PGFE_INLINE void Cursor::close()
+{
+  if (is_closed_)
+    return;
+  else if (!conn_.is_connected()) {
+    is_closed_ = true;
+    return;
+  }
+
+  try {
+    drain__();
+    conn_.execute(Statement{R"(close :"name")"}.bind("name", name_));
+    if (owns_transaction_)
+      conn_.execute("commit");
+  } catch (...) {
+    abort__();
+    throw;
+  }
+  is_closed_ = true;
+}
+
+DMITIGR_PGFE_INLINE bool Cursor::is_closed() const noexcept
+{
+  return is_closed_;
+}
+
+DMITIGR_PGFE_INLINE void Cursor::begin_transaction__()
+{
+  if (!conn_.is_transaction_uncommitted()) {
+    conn_.execute("begin");
+    owns_transaction_ = true;
+  }
+}
+
+DMITIGR_PGFE_INLINE void Cursor::start__()
+{
+  DMITIGR_ASSERT(!is_started_);
+  quoted_name_ = conn_.to_quoted_identifier(name_);
+  was_nio_output_enabled_ = conn_.is_nio_output_enabled();
+  conn_.set_nio_output_enabled(true);
+  conn_.set_pipeline_enabled(true);
+  is_started_ = true;
+  send_fetch__();
+  send_fetch__();
+}
+
+DMITIGR_PGFE_INLINE void Cursor::send_fetch__()
+{
+  std::string query{"fetch forward "};
+  query.append(std::to_string(fetch_count_))
+    .append(" from ").append(quoted_name_);
+  conn_.execute_nio(Statement{query});
+  fetches_.push_back(fetch_count_);
+  conn_.send_flush();
+  conn_.flush_output(true);
+}
+
+DMITIGR_PGFE_INLINE void Cursor::adapt_fetch_count__() noexcept
+{
+  if (batch_row_count_) {
+    const std::size_t row_size{std::max<std::size_t>(
+        batch_size_ / batch_row_count_, 1)};
+    fetch_count_ = std::clamp(batch_size_target_ / row_size,
+      min_fetch_count_, max_fetch_count_);
+  }
+  batch_row_count_ = 0;
+  batch_size_ = 0;
+}
+
+DMITIGR_PGFE_INLINE void Cursor::drain__()
+{
+  if (is_started_ && conn_.pipeline_status() != Pipeline_status::disabled) {
+    conn_.send_sync();
+    conn_.flush_output(true);
+    while (conn_.wait_response()) {
+      if (!conn_.row() && !conn_.error() && !conn_.ready_for_query())
+        conn_.completion();
+    }
+    conn_.set_pipeline_enabled(false);
+    conn_.set_nio_output_enabled(was_nio_output_enabled_);
+  }
+  fetches_.clear();
+}
+
+DMITIGR_PGFE_INLINE void Cursor::abort__() noexcept
+{
+  is_closed_ = true;
+  try {
+    if (conn_.is_connected()) {
+      drain__();
+      if (owns_transaction_ &&
+        conn_.transaction_status() != Transaction_status::unstarted)
+        conn_.execute("rollback");
+    }
+  } catch (...) {
+    conn_.disconnect();
+  }
+}
+
+} // namespace dmitigr::pgfe
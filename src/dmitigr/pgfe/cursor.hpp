@@ -0,0 +1,228 @@
+// -*- C++ -*-
+//
+// Copyright 2023 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DMITIGR_PGFE_CURSOR_HPP
+#define DMITIGR_PGFE_CURSOR_HPP
+
+#include "connection.hpp"
+#include "dll.hpp"
+#include "row.hpp"
+#include "statement.hpp"
+#include "types_fwd.hpp"
+
+#include <cstddef>
+#include <deque>
+#include <string>
+#include <utility>
+
+namespace dmitigr::pgfe {
+
+/**
+ * @ingroup main
+ *
+ * @brief A server-side cursor which streams the rows of a query.
+ *
+ * @details The cursor is declared inside a transaction (which is started if
+ * there is no one). Rows are fetched in batches by `FETCH n` commands sent in
+ * pipeline, and the next batch is always requested before the rows of the
+ * current batch are consumed, so the network latency is hidden. The number of
+ * rows requested by each `FETCH` is adapted to the average size of the rows
+ * already received, keeping the size of a batch close to the target size.
+ * Thus, the memory consumption is bounded even for very large results.
+ *
+ * Example:
+ * @code
+ * pgfe::Cursor cursor{conn, "export", "select * from huge"};
+ * while (const auto row = cursor.next())
+ *   write(row);
+ * cursor.close();
+ * @endcode
+ *
+ * @remarks While the cursor is streaming (i.e. after the first call of next()
+ * and until `is_exhausted()`) the connection is in pipeline mode and must not
+ * be used for other requests.
+ *
+ * @remarks Requires libpq from PostgreSQL 14 or more recent version.
+ */
+class Cursor final {
+public:
+  /**
+   * @brief Closes the cursor if it's not closed yet.
+   *
+   * @details If the closing fails, closes the connection, since failed closing
+   * might indicate a total mess.
+   *
+   * @see close().
+   */
+  DMITIGR_PGFE_API ~Cursor() noexcept;
+
+  /// Not copy-constructible.
+  Cursor(const Cursor&) = delete;
+
+  /// Not copy-assignable.
+  Cursor& operator=(const Cursor&) = delete;
+
+  /// Not move-constructible.
+  Cursor(Cursor&&) = delete;
+
+  /// Not move-assignable.
+  Cursor& operator=(Cursor&&) = delete;
+
+  /**
+   * @brief Declares the cursor `name` for `query`.
+   *
+   * @details Begins the transaction if `!conn.is_transaction_uncommitted()`.
+   * Such a transaction is owned by this instance and is committed by close().
+   *
+   * @param conn A connection to use.
+   * @param name A name of the cursor.
+   * @param query A query to declare the cursor for.
+   * @param parameters Parameters to bind with a parameterized `query`.
+   *
+   * @par Requires
+   * `conn.is_ready_for_request() && !name.empty()`.
+   *
+   * @par Exception safety guarantee
+   * Basic.
+   */
+  template<typename ... Types>
+  Cursor(Connection& conn, std::string name, const Statement& query,
+    Types&& ... parameters)
+    : conn_{conn}
+    , name_{std::move(name)}
+  {
+    if (name_.empty())
+      throw Generic_exception{"cannot declare cursor: empty name"};
+    else if (!conn_.is_ready_for_request())
+      throw Generic_exception{"cannot declare cursor: not ready for request"};
+
+    begin_transaction__();
+    try {
+      Statement declare{R"(declare :"name" no scroll cursor for )"};
+      declare.bind("name", name_);
+      declare.append(query);
+      conn_.execute(declare, std::forward<Types>(parameters)...);
+    } catch (...) {
+      abort__();
+      throw;
+    }
+  }
+
+  /// @returns The connection of this cursor.
+  DMITIGR_PGFE_API Connection& connection() noexcept;
+
+  /// @returns The name of this cursor.
+  DMITIGR_PGFE_API const std::string& name() const noexcept;
+
+  /// @returns `true` if the transaction is started by this instance.
+  DMITIGR_PGFE_API bool owns_transaction() const noexcept;
+
+  /**
+   * @brief Sets the target size of a batch of rows in bytes.
+   *
+   * @par Requires
+   * `bytes > 0`.
+   */
+  DMITIGR_PGFE_API void set_batch_size_target(std::size_t bytes);
+
+  /// @returns The target size of a batch of rows in bytes.
+  DMITIGR_PGFE_API std::size_t batch_size_target() const noexcept;
+
+  /**
+   * @brief Sets the limits of the number of rows requested by `FETCH`.
+   *
+   * @par Requires
+   * `0 < min && min <= max`.
+   *
+   * @par Effects
+   * `min <= fetch_count() && fetch_count() <= max`.
+   */
+  DMITIGR_PGFE_API void set_fetch_count_limits(std::size_t min, std::size_t max);
+
+  /// @returns The number of rows to be requested by the next `FETCH`.
+  DMITIGR_PGFE_API std::size_t fetch_count() const noexcept;
+
+  /**
+   * @returns The next row, or invalid instance if `is_exhausted()`.
+   *
+   * @par Requires
+   * `!is_closed()`.
+   *
+   * @par Effects
+   * If the returned row is invalid, then `is_exhausted()` and the connection
+   * is ready for request again.
+   *
+   * @throws Sqlstate_exception on error returned by the server. In this case
+   * the transaction owned by this instance is rolled back, and `is_closed()`.
+   *
+   * @par Exception safety guarantee
+   * Basic.
+   */
+  DMITIGR_PGFE_API Row next();
+
+  /// @returns `true` if all the rows are received.
+  DMITIGR_PGFE_API bool is_exhausted() const noexcept;
+
+  /**
+   * @brief Closes the cursor and commits the transaction if owned.
+   *
+   * @details The batches in flight (if any) are discarded.
+   *
+   * @par Effects
+   * `is_closed()`.
+   *
+   * @par Exception safety guarantee
+   * Basic.
+   */
+  DMITIGR_PGFE_API void close();
+
+  /// @returns `true` if the cursor is closed.
+  DMITIGR_PGFE_API bool is_closed() const noexcept;
+
+private:
+  Connection& conn_;
+  std::string name_;
+  std::string quoted_name_;
+  bool owns_transaction_{};
+  bool is_started_{};
+  bool is_exhausted_{};
+  bool is_closed_{};
+  bool was_nio_output_enabled_{};
+
+  std::size_t batch_size_target_{1024*1024};
+  std::size_t min_fetch_count_{16};
+  std::size_t max_fetch_count_{64*1024};
+  std::size_t fetch_count_{1024};
+
+  std::deque<std::size_t> fetches_; // the counts requested by FETCH in flight
+  std::size_t batch_row_count_{};
+  std::size_t batch_size_{};
+
+  void begin_transaction__();
+  void start__();
+  void send_fetch__();
+  void adapt_fetch_count__() noexcept;
+  void drain__();
+  void abort__() noexcept;
+};
+
+} // namespace dmitigr::pgfe
+
+#ifndef DMITIGR_PGFE_NOT_HEADER_ONLY
+#include "cursor.cpp"
+#endif
+
+#endif  // DMITIGR_PGFE_CURSOR_HPP
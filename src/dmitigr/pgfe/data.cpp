@@ -17,9 +17,11 @@
 #include "data.hpp"
 #include "exceptions.hpp"
 #include "pq.hpp"
+#include "simd.hpp"
 
 #include <algorithm> // swap
 #include <cassert>
+#include <cstdlib>
 #include <cstring>
 #include <new> // bad_alloc
 
@@ -222,9 +224,25 @@ Data::to_bytea(const char* const text_data)
   if (!text_data)
     throw Generic_exception{"cannot convert data to bytea: null input data"};
 
+  using Uptr = std::unique_ptr<void, void(*)(void*)>;
+
+  // Decode the hex format in bulk.
+  if (text_data[0] == '\\' && text_data[1] == 'x') {
+    const char* const hex = text_data + 2;
+    if (const auto length = std::strlen(hex); !(length % 2)) {
+      const std::size_t size{length / 2};
+      Uptr storage{std::malloc(size ? size : 1), &std::free};
+      if (!storage)
+        throw std::bad_alloc{};
+      if (detail::simd::hex_decode(hex,
+          static_cast<unsigned char*>(storage.get()), size))
+        return make(std::move(storage), size, pgfe::Data_format::binary);
+    }
+    // Fall back to libpq which is lenient to the malformed input.
+  }
+
   const auto* const bytes = reinterpret_cast<const unsigned char*>(text_data);
   std::size_t storage_size{};
-  using Uptr = std::unique_ptr<void, void(*)(void*)>;
   if (auto storage = Uptr{PQunescapeBytea(bytes, &storage_size), &PQfreemem})
     return make(std::move(storage), storage_size, pgfe::Data_format::binary);
   else
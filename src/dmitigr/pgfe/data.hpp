@@ -295,6 +295,9 @@ public:
 
 private:
   friend Copier;
+  friend Prepared_statement;
+  friend Record_view;
+  friend Result_set;
   friend Row;
 
   Format format_{-1};
@@ -0,0 +1,107 @@
+// -*- C++ -*-
+//
+// Copyright 2023 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DMITIGR_PGFE_DEADLINE_GUARD_HPP
+#define DMITIGR_PGFE_DEADLINE_GUARD_HPP
+
+#include "connection.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <optional>
+
+namespace dmitigr::pgfe {
+
+/**
+ * @brief A deadline guard.
+ *
+ * @details Sets the deadline of the requests of the connection for the scope
+ * of the guard. The nested guards can only shorten the deadline of the outer
+ * ones, so the deadline of the request context propagates to the inner calls.
+ *
+ * Example:
+ * @code
+ * void handle_request(pgfe::Connection& conn)
+ * {
+ *   pgfe::Deadline_guard dg{conn, std::chrono::milliseconds{200}};
+ *   conn.execute("select ..."); // cancelled by the server upon the deadline
+ * }
+ * @endcode
+ *
+ * @see Connection::set_deadline().
+ */
+class Deadline_guard final {
+public:
+  /// A clock.
+  using Clock = Connection::Deadline_clock;
+
+  /// Not copy-constructible.
+  Deadline_guard(const Deadline_guard&) = delete;
+
+  /// Not copy-assignable.
+  Deadline_guard& operator=(const Deadline_guard&) = delete;
+
+  /// Not move-constructible.
+  Deadline_guard(Deadline_guard&&) = delete;
+
+  /// Not move-assignable.
+  Deadline_guard& operator=(Deadline_guard&&) = delete;
+
+  /// Restores the previous deadline of the controlled connection.
+  ~Deadline_guard()
+  {
+    conn_.set_deadline(previous_);
+  }
+
+  /**
+   * @brief Sets the deadline of `conn` to the earliest of the `deadline`
+   * and the current deadline of `conn`.
+   */
+  Deadline_guard(Connection& conn, const Clock::time_point deadline) noexcept
+    : conn_{conn}
+    , previous_{conn_.deadline()}
+  {
+    conn_.set_deadline(previous_ ? std::min(*previous_, deadline) : deadline);
+  }
+
+  /// Sets the deadline of `conn` to `Clock::now() + timeout`.
+  Deadline_guard(Connection& conn, const std::chrono::milliseconds timeout) noexcept
+    : Deadline_guard{conn, Clock::now() + timeout}
+  {}
+
+  /// @returns The deadline in effect.
+  Clock::time_point deadline() const noexcept
+  {
+    return *conn_.deadline();
+  }
+
+  /// @returns The remaining time until the deadline.
+  std::chrono::milliseconds time_left() const noexcept
+  {
+    using std::chrono::duration_cast;
+    using std::chrono::milliseconds;
+    return std::max(milliseconds::zero(),
+      duration_cast<milliseconds>(deadline() - Clock::now()));
+  }
+
+private:
+  Connection& conn_;
+  std::optional<Clock::time_point> previous_;
+};
+
+} // namespace dmitigr::pgfe
+
+#endif  // DMITIGR_PGFE_DEADLINE_GUARD_HPP
@@ -37,6 +37,8 @@ DMITIGR_PGFE_INLINE const char* to_literal(const Errc errc) noexcept
     return "timed_out";
   case Errc::invalid_response:
     return "invalid_response";
+  case Errc::deadline_exceeded:
+    return "deadline_exceeded";
   }
   return nullptr;
 }
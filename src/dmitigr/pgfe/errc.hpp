@@ -49,7 +49,10 @@ enum class Errc {
   timed_out = 500,
 
   /// Denotes the server's response that was not understood.
-  invalid_response = 600
+  invalid_response = 600,
+
+  /// Denotes an operation which was cancelled upon the deadline exceeded.
+  deadline_exceeded = 700
 };
 
 /**
@@ -0,0 +1,257 @@
+// -*- C++ -*-
+//
+// Copyright 2023 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "../base/assert.hpp"
+#include "exceptions.hpp"
+#include "parallel_row_processor.hpp"
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <map>
+#include <mutex>
+
+namespace dmitigr::pgfe {
+
+namespace detail {
+
+/// The state shared between the reader and the workers.
+template<typename Batch, typename Delivery>
+struct Parallel_row_processor_state final {
+  std::mutex mutex;
+  std::condition_variable changed;
+  std::deque<std::pair<std::size_t, Batch>> queue;
+  std::map<std::size_t, Delivery> ready; // the ordered mode only
+  std::size_t next_delivery{};
+  std::size_t in_flight_count{};
+  std::size_t active_worker_count{};
+  bool is_closed{};
+  bool is_aborted{};
+  std::exception_ptr error;
+};
+
+} // namespace detail
+
+DMITIGR_PGFE_INLINE
+Parallel_row_processor::Parallel_row_processor(thread::Pool& pool,
+  const std::size_t worker_count)
+  : pool_{pool}
+  , worker_count_{worker_count}
+{
+  if (!worker_count_)
+    throw Generic_exception{"cannot create parallel row processor: "
+      "invalid worker count"};
+}
+
+DMITIGR_PGFE_INLINE std::size_t
+Parallel_row_processor::worker_count() const noexcept
+{
+  return worker_count_;
+}
+
+DMITIGR_PGFE_INLINE void Parallel_row_processor::set_batch_size(const std::size_t size)
+{
+  if (!size)
+    throw Generic_exception{"cannot set batch size of parallel row processor: "
+      "invalid size"};
+  batch_size_ = size;
+}
+
+DMITIGR_PGFE_INLINE std::size_t
+Parallel_row_processor::batch_size() const noexcept
+{
+  return batch_size_;
+}
+
+DMITIGR_PGFE_INLINE void
+Parallel_row_processor::set_queue_capacity(const std::size_t capacity)
+{
+  if (!capacity)
+    throw Generic_exception{"cannot set queue capacity of parallel row processor: "
+      "invalid capacity"};
+  queue_capacity_ = capacity;
+}
+
+DMITIGR_PGFE_INLINE std::size_t
+Parallel_row_processor::queue_capacity() const noexcept
+{
+  return queue_capacity_;
+}
+
+DMITIGR_PGFE_INLINE Completion
+Parallel_row_processor::process_responses__(Connection& conn,
+  const Batch_handler& handler, const bool is_ordered)
+{
+  using State = detail::Parallel_row_processor_state<Batch, Delivery>;
+  const auto state = std::make_shared<State>();
+
+  // Note, the worker owns the state since it may outlive this call for a bit.
+  const auto worker = [state, &handler, is_ordered]
+  {
+    while (true) {
+      std::pair<std::size_t, Batch> item;
+      {
+        std::unique_lock lk{state->mutex};
+        state->changed.wait(lk, [&state]
+        {
+          return !state->queue.empty() || state->is_closed || state->is_aborted;
+        });
+        if (state->is_aborted || state->queue.empty())
+          break;
+        item = std::move(state->queue.front());
+        state->queue.pop_front();
+      }
+
+      Delivery delivery;
+      try {
+        delivery = handler(std::move(item.second));
+      } catch (...) {
+        const std::lock_guard lg{state->mutex};
+        if (!state->error)
+          state->error = std::current_exception();
+        state->is_aborted = true;
+        break;
+      }
+
+      {
+        const std::lock_guard lg{state->mutex};
+        if (is_ordered)
+          state->ready.emplace(item.first, std::move(delivery));
+        else
+          --state->in_flight_count;
+      }
+      state->changed.notify_all();
+    }
+
+    {
+      const std::lock_guard lg{state->mutex};
+      --state->active_worker_count;
+    }
+    state->changed.notify_all();
+  };
+
+  // Delivers the values of ready batches in order. (Called on this thread.)
+  const auto deliver = [&state](std::unique_lock<std::mutex>& lk)
+  {
+    while (!state->is_aborted) {
+      const auto i = state->ready.find(state->next_delivery);
+      if (i == end(state->ready))
+        break;
+      const auto delivery = std::move(i->second);
+      state->ready.erase(i);
+      ++state->next_delivery;
+      --state->in_flight_count;
+      lk.unlock();
+      if (delivery)
+        delivery();
+      lk.lock();
+    }
+  };
+
+  // Waits for the workers to finish.
+  const auto wait = [&state, &deliver, is_ordered](const bool is_delivery)
+  {
+    std::unique_lock lk{state->mutex};
+    while (true) {
+      if (is_ordered && is_delivery)
+        deliver(lk);
+      if (!state->active_worker_count)
+        break;
+      state->changed.wait(lk);
+    }
+    if (is_ordered && is_delivery)
+      deliver(lk);
+  };
+
+  const auto abort = [&state, &wait]() noexcept
+  {
+    {
+      const std::lock_guard lg{state->mutex};
+      state->is_aborted = true;
+      state->queue.clear();
+    }
+    state->changed.notify_all();
+    wait(false);
+  };
+
+  std::size_t sequence{};
+  const auto push = [this, &state, &deliver, &sequence, is_ordered](Batch&& batch)
+  {
+    {
+      std::unique_lock lk{state->mutex};
+      while (true) {
+        if (is_ordered)
+          deliver(lk);
+        if (state->error)
+          std::rethrow_exception(state->error);
+        else if (state->in_flight_count < queue_capacity_)
+          break;
+        state->changed.wait(lk);
+      }
+      state->queue.emplace_back(sequence++, std::move(batch));
+      ++state->in_flight_count;
+    }
+    state->changed.notify_all();
+  };
+
+  Completion result;
+  try {
+    for (std::size_t i{}; i < worker_count_; ++i) {
+      {
+        const std::lock_guard lg{state->mutex};
+        ++state->active_worker_count;
+      }
+      try {
+        pool_.submit(worker);
+      } catch (...) {
+        const std::lock_guard lg{state->mutex};
+        --state->active_worker_count;
+        throw;
+      }
+    }
+
+    Batch batch;
+    batch.reserve(batch_size_);
+    result = conn.process_responses([this, &batch, &push](Row&& row)
+    {
+      batch.push_back(std::move(row));
+      if (batch.size() >= batch_size_) {
+        push(std::move(batch));
+        batch.clear();
+        batch.reserve(batch_size_);
+      }
+    });
+    if (!batch.empty())
+      push(std::move(batch));
+
+    {
+      const std::lock_guard lg{state->mutex};
+      state->is_closed = true;
+    }
+    state->changed.notify_all();
+    wait(true);
+  } catch (...) {
+    abort();
+    throw;
+  }
+
+  if (state->error)
+    std::rethrow_exception(state->error);
+  DMITIGR_ASSERT(!state->in_flight_count);
+  return result;
+}
+
+} // namespace dmitigr::pgfe
@@ -0,0 +1,275 @@
+// -*- C++ -*-
+//
+// Copyright 2023 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DMITIGR_PGFE_PARALLEL_ROW_PROCESSOR_HPP
+#define DMITIGR_PGFE_PARALLEL_ROW_PROCESSOR_HPP
+
+#include "../base/thread.hpp"
+#include "completion.hpp"
+#include "connection.hpp"
+#include "dll.hpp"
+#include "exceptions.hpp"
+#include "row.hpp"
+#include "statement.hpp"
+#include "types_fwd.hpp"
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace dmitigr::pgfe {
+
+namespace detail {
+
+/// @returns `true` if `D` is the decoder of rows and `C` is its consumer.
+template<typename D, typename C>
+constexpr bool is_ordered_row_callbacks() noexcept
+{
+  if constexpr (std::is_invocable_v<D, Row&&>) {
+    using R = std::invoke_result_t<D, Row&&>;
+    if constexpr (!std::is_void_v<R>)
+      return std::is_invocable_v<C, std::decay_t<R>&&>;
+    else
+      return false;
+  } else
+    return false;
+}
+
+} // namespace detail
+
+/**
+ * @ingroup utilities
+ *
+ * @brief A processor of the rows which runs the row callbacks concurrently on
+ * the threads of the thread pool.
+ *
+ * @details The calling thread keeps reading the rows from the connection and
+ * groups them into batches which are put into the bounded queue. The workers
+ * run on the thread pool and process the batches taken from the queue. Thus,
+ * the network reading and parsing are overlapped with the CPU-heavy decoding
+ * of the rows.
+ *
+ * The rows can be delivered either:
+ *   - unordered: the callback is called on the workers concurrently;
+ *   - ordered: the decoder is called on the workers concurrently, and the
+ *   consumer is called on the calling thread with the decoded values in the
+ *   original order of rows.
+ *
+ * Example:
+ * @code
+ * dmitigr::thread::Pool threads{4};
+ * pgfe::Parallel_row_processor processor{threads, 4};
+ * processor.execute(conn, [](auto&& row)
+ * {
+ *   return decode(row); // on the thread pool
+ * }, [&](auto&& value)
+ * {
+ *   values.push_back(std::move(value)); // in order on this thread
+ * }, "select * from huge");
+ * @endcode
+ *
+ * @remarks The callbacks which are called on the workers must be thread-safe.
+ * None of the callbacks may use the connection.
+ */
+class Parallel_row_processor final {
+public:
+  /// Not copy-constructible.
+  Parallel_row_processor(const Parallel_row_processor&) = delete;
+
+  /// Not copy-assignable.
+  Parallel_row_processor& operator=(const Parallel_row_processor&) = delete;
+
+  /// Not move-constructible.
+  Parallel_row_processor(Parallel_row_processor&&) = delete;
+
+  /// Not move-assignable.
+  Parallel_row_processor& operator=(Parallel_row_processor&&) = delete;
+
+  /**
+   * @brief The constructor.
+   *
+   * @param pool A thread pool to run the workers on.
+   * @param worker_count A number of workers.
+   *
+   * @par Requires
+   * `worker_count > 0`.
+   *
+   * @remarks The `pool` must outlive this instance. The workers occupy the
+   * threads of `pool` while the responses are processed.
+   */
+  DMITIGR_PGFE_API Parallel_row_processor(thread::Pool& pool,
+    std::size_t worker_count);
+
+  /// @returns The number of workers.
+  DMITIGR_PGFE_API std::size_t worker_count() const noexcept;
+
+  /**
+   * @brief Sets the number of rows per batch.
+   *
+   * @par Requires
+   * `size > 0`.
+   */
+  DMITIGR_PGFE_API void set_batch_size(std::size_t size);
+
+  /// @returns The number of rows per batch. The default is 256.
+  DMITIGR_PGFE_API std::size_t batch_size() const noexcept;
+
+  /**
+   * @brief Sets the maximum number of batches in flight, i.e. the batches
+   * which are either queued, being processed, or waiting for the ordered
+   * delivery.
+   *
+   * @par Requires
+   * `capacity > 0`.
+   */
+  DMITIGR_PGFE_API void set_queue_capacity(std::size_t capacity);
+
+  /// @returns The maximum number of batches in flight. The default is 16.
+  DMITIGR_PGFE_API std::size_t queue_capacity() const noexcept;
+
+  /**
+   * @brief Processes the responses of `conn` by calling `callback` for each
+   * row concurrently on the workers.
+   *
+   * @returns The completion.
+   *
+   * @par Requires
+   * `callback` must be invocable with `Row&&`.
+   *
+   * @par Exception safety guarantee
+   * Basic. If the callback throws, the remaining rows are discarded and the
+   * first exception thrown is rethrown after the workers are finished.
+   *
+   * @see Connection::process_responses().
+   */
+  template<typename F>
+  std::enable_if_t<std::is_invocable_v<F, Row&&>, Completion>
+  process_responses(Connection& conn, F&& callback)
+  {
+    return process_responses__(conn, [&callback](Batch&& batch)
+    {
+      for (auto& row : batch)
+        callback(std::move(row));
+      return Delivery{};
+    }, false);
+  }
+
+  /**
+   * @brief Processes the responses of `conn` by calling `decoder` for each
+   * row concurrently on the workers, and `consumer` for each decoded value
+   * in the original order of rows on the calling thread.
+   *
+   * @returns The completion.
+   *
+   * @par Requires
+   * `decoder` must be invocable with `Row&&` and return the non-void value
+   * which must be passable to `consumer` as rvalue.
+   *
+   * @par Exception safety guarantee
+   * Basic. If either callback throws, the remaining rows are discarded and the
+   * first exception thrown is rethrown after the workers are finished.
+   *
+   * @see Connection::process_responses().
+   */
+  template<typename D, typename C>
+  std::enable_if_t<detail::is_ordered_row_callbacks<D, C>(), Completion>
+  process_responses(Connection& conn, D&& decoder, C&& consumer)
+  {
+    using T = std::decay_t<std::invoke_result_t<D, Row&&>>;
+    return process_responses__(conn, [&decoder, &consumer](Batch&& batch)
+    {
+      auto values = std::make_shared<std::vector<T>>();
+      values->reserve(batch.size());
+      for (auto& row : batch)
+        values->push_back(decoder(std::move(row)));
+      return Delivery{[values = std::move(values), &consumer]
+      {
+        for (auto& value : *values)
+          consumer(std::move(value));
+      }};
+    }, true);
+  }
+
+  /**
+   * @brief Executes the `statement` on `conn` and processes the responses by
+   * using `callback` concurrently on the workers.
+   *
+   * @par Requires
+   * `conn.is_ready_for_request()`.
+   *
+   * @see process_responses(Connection&, F&&).
+   */
+  template<typename F, typename ... Types>
+  std::enable_if_t<std::is_invocable_v<F, Row&&>, Completion>
+  execute(Connection& conn, F&& callback, const Statement& statement,
+    Types&& ... parameters)
+  {
+    execute_nio__(conn, statement, std::forward<Types>(parameters)...);
+    return process_responses(conn, std::forward<F>(callback));
+  }
+
+  /**
+   * @brief Executes the `statement` on `conn` and processes the responses by
+   * using `decoder` concurrently on the workers and `consumer` in order.
+   *
+   * @par Requires
+   * `conn.is_ready_for_request()`.
+   *
+   * @see process_responses(Connection&, D&&, C&&).
+   */
+  template<typename D, typename C, typename ... Types>
+  std::enable_if_t<detail::is_ordered_row_callbacks<D, C>(), Completion>
+  execute(Connection& conn, D&& decoder, C&& consumer,
+    const Statement& statement, Types&& ... parameters)
+  {
+    execute_nio__(conn, statement, std::forward<Types>(parameters)...);
+    return process_responses(conn, std::forward<D>(decoder),
+      std::forward<C>(consumer));
+  }
+
+private:
+  using Batch = std::vector<Row>;
+  using Delivery = std::function<void()>;
+  using Batch_handler = std::function<Delivery(Batch&&)>;
+
+  thread::Pool& pool_;
+  std::size_t worker_count_{};
+  std::size_t batch_size_{256};
+  std::size_t queue_capacity_{16};
+
+  template<typename ... Types>
+  static void execute_nio__(Connection& conn, const Statement& statement,
+    Types&& ... parameters)
+  {
+    if (!conn.is_ready_for_request())
+      throw Generic_exception{"cannot execute statement: not ready for request"};
+    conn.execute_nio(statement, std::forward<Types>(parameters)...);
+  }
+
+  DMITIGR_PGFE_API Completion process_responses__(Connection& conn,
+    const Batch_handler& handler, bool is_ordered);
+};
+
+} // namespace dmitigr::pgfe
+
+#ifndef DMITIGR_PGFE_NOT_HEADER_ONLY
+#include "parallel_row_processor.cpp"
+#endif
+
+#endif  // DMITIGR_PGFE_PARALLEL_ROW_PROCESSOR_HPP
@@ -32,7 +32,10 @@
 #include "conversions.hpp"
 #include "conversions_api.hpp"
 #include "copier.hpp"
+#include "copy_loader.hpp"
+#include "cursor.hpp"
 #include "data.hpp"
+#include "deadline_guard.hpp"
 #include "errc.hpp"
 #include "errctg.hpp"
 #include "error.hpp"
@@ -42,15 +45,24 @@
 #include "misc.hpp"
 #include "notice.hpp"
 #include "notification.hpp"
+#include "parallel_row_processor.hpp"
 #include "parameterizable.hpp"
+#include "pgoutput_message.hpp"
 #include "prepared_statement.hpp"
 #include "problem.hpp"
 #include "ready_for_query.hpp"
+#include "record_view.hpp"
+#include "replication_stream.hpp"
 #include "response.hpp"
+#include "result_cache.hpp"
+#include "result_set.hpp"
 #include "row.hpp"
 #include "row_info.hpp"
+#include "scatter_gather_executor.hpp"
 #include "signal.hpp"
 #include "statement.hpp"
+#include "statement_description_cache.hpp"
+#include "statement_reader.hpp"
 #include "statement_vector.hpp"
 #include "transaction_guard.hpp"
 #include "tuple.hpp"
@@ -0,0 +1,299 @@
+// -*- C++ -*-
+//
+// Copyright 2023 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "exceptions.hpp"
+#include "pgoutput_message.hpp"
+
+#include <cstring>
+#include <type_traits>
+
+namespace dmitigr::pgfe {
+
+namespace detail {
+
+/// A reader of the fields of the logical replication protocol messages.
+class Pgoutput_reader final {
+public:
+  explicit Pgoutput_reader(const std::string_view bytes) noexcept
+    : bytes_{bytes}
+  {}
+
+  template<typename T>
+  T integer()
+  {
+    static_assert(std::is_integral_v<T>);
+    require(sizeof(T));
+    std::make_unsigned_t<T> result{};
+    for (std::size_t i{}; i < sizeof(T); ++i)
+      result = static_cast<decltype(result)>((result << 8) |
+        static_cast<unsigned char>(bytes_[position_ + i]));
+    position_ += sizeof(T);
+    return static_cast<T>(result);
+  }
+
+  char byte()
+  {
+    return integer<char>();
+  }
+
+  char peek() const noexcept
+  {
+    return position_ < bytes_.size() ? bytes_[position_] : 0;
+  }
+
+  std::string_view string()
+  {
+    const auto* const begin = bytes_.data() + position_;
+    const auto* const end = static_cast<const char*>(
+      std::memchr(begin, 0, bytes_.size() - position_));
+    if (!end)
+      throw_malformed();
+    const auto size = static_cast<std::size_t>(end - begin);
+    position_ += size + 1;
+    return {begin, size};
+  }
+
+  std::string_view bytes(const std::size_t size)
+  {
+    require(size);
+    const std::string_view result{bytes_.data() + position_, size};
+    position_ += size;
+    return result;
+  }
+
+  void tuple(std::vector<Pgoutput_value>& result)
+  {
+    using Kind = Pgoutput_value::Kind;
+    result.clear();
+    const auto count = integer<std::int16_t>();
+    if (count < 0)
+      throw_malformed();
+    for (std::int16_t i{}; i < count; ++i) {
+      auto& value = result.emplace_back();
+      switch (const char kind = byte()) {
+      case static_cast<char>(Kind::null):
+        [[fallthrough]];
+      case static_cast<char>(Kind::unchanged_toast):
+        value.kind = Kind{kind};
+        break;
+      case static_cast<char>(Kind::text):
+        [[fallthrough]];
+      case static_cast<char>(Kind::binary): {
+        value.kind = Kind{kind};
+        const auto size = integer<std::int32_t>();
+        if (size < 0)
+          throw_malformed();
+        value.data = bytes(static_cast<std::size_t>(size));
+        break;
+      }
+      default:
+        throw_malformed();
+      }
+    }
+  }
+
+  [[noreturn]] static void throw_malformed()
+  {
+    throw Generic_exception{"cannot decode pgoutput message: malformed message"};
+  }
+
+private:
+  std::string_view bytes_;
+  std::size_t position_{};
+
+  void require(const std::size_t size) const
+  {
+    if (bytes_.size() - position_ < size)
+      throw_malformed();
+  }
+};
+
+} // namespace detail
+
+DMITIGR_PGFE_INLINE Pgoutput_message::Pgoutput_message(const std::string_view bytes)
+{
+  assign(bytes);
+}
+
+DMITIGR_PGFE_INLINE void Pgoutput_message::assign(const std::string_view bytes)
+{
+  using Type = Pgoutput_message_type;
+  reset();
+  try {
+    detail::Pgoutput_reader reader{bytes};
+    switch (Type{reader.byte()}) {
+    case Type::begin:
+      commit_lsn_ = reader.integer<Lsn>();
+      commit_timestamp_ = reader.integer<std::int64_t>();
+      xid_ = reader.integer<std::uint32_t>();
+      break;
+    case Type::commit:
+      (void)reader.byte(); // flags (currently unused)
+      commit_lsn_ = reader.integer<Lsn>();
+      end_lsn_ = reader.integer<Lsn>();
+      commit_timestamp_ = reader.integer<std::int64_t>();
+      break;
+    case Type::relation: {
+      relation_oid_ = reader.integer<std::uint32_t>();
+      relation_namespace_ = reader.string();
+      relation_name_ = reader.string();
+      replica_identity_ = reader.byte();
+      const auto count = reader.integer<std::int16_t>();
+      if (count < 0)
+        reader.throw_malformed();
+      for (std::int16_t i{}; i < count; ++i) {
+        auto& column = columns_.emplace_back();
+        column.is_key = reader.byte() & 1;
+        column.name = reader.string();
+        column.type_oid = reader.integer<std::uint32_t>();
+        column.type_modifier = reader.integer<std::int32_t>();
+      }
+      break;
+    }
+    case Type::insert:
+      relation_oid_ = reader.integer<std::uint32_t>();
+      if (reader.byte() != 'N')
+        reader.throw_malformed();
+      reader.tuple(new_tuple_);
+      break;
+    case Type::update:
+      relation_oid_ = reader.integer<std::uint32_t>();
+      if (const char kind = reader.peek(); kind == 'K' || kind == 'O') {
+        old_tuple_kind_ = reader.byte();
+        reader.tuple(old_tuple_);
+      }
+      if (reader.byte() != 'N')
+        reader.throw_malformed();
+      reader.tuple(new_tuple_);
+      break;
+    case Type::delete_:
+      relation_oid_ = reader.integer<std::uint32_t>();
+      old_tuple_kind_ = reader.byte();
+      if (old_tuple_kind_ != 'K' && old_tuple_kind_ != 'O')
+        reader.throw_malformed();
+      reader.tuple(old_tuple_);
+      break;
+    default:
+      break; // not decoded
+    }
+  } catch (...) {
+    reset();
+    throw;
+  }
+  bytes_ = bytes;
+}
+
+DMITIGR_PGFE_INLINE void Pgoutput_message::reset() noexcept
+{
+  bytes_ = {};
+  commit_lsn_ = {};
+  end_lsn_ = {};
+  commit_timestamp_ = {};
+  xid_ = {};
+  relation_oid_ = invalid_oid;
+  relation_namespace_ = {};
+  relation_name_ = {};
+  replica_identity_ = {};
+  old_tuple_kind_ = {};
+  columns_.clear();
+  old_tuple_.clear();
+  new_tuple_.clear();
+}
+
+DMITIGR_PGFE_INLINE bool Pgoutput_message::is_valid() const noexcept
+{
+  return !bytes_.empty();
+}
+
+DMITIGR_PGFE_INLINE Pgoutput_message_type
+Pgoutput_message::type() const noexcept
+{
+  return is_valid() ? Pgoutput_message_type{bytes_[0]} :
+    Pgoutput_message_type::invalid;
+}
+
+DMITIGR_PGFE_INLINE std::string_view Pgoutput_message::bytes() const noexcept
+{
+  return bytes_;
+}
+
+DMITIGR_PGFE_INLINE Lsn Pgoutput_message::commit_lsn() const noexcept
+{
+  return commit_lsn_;
+}
+
+DMITIGR_PGFE_INLINE Lsn Pgoutput_message::end_lsn() const noexcept
+{
+  return end_lsn_;
+}
+
+DMITIGR_PGFE_INLINE std::int64_t
+Pgoutput_message::commit_timestamp() const noexcept
+{
+  return commit_timestamp_;
+}
+
+DMITIGR_PGFE_INLINE std::uint32_t Pgoutput_message::xid() const noexcept
+{
+  return xid_;
+}
+
+DMITIGR_PGFE_INLINE Oid Pgoutput_message::relation_oid() const noexcept
+{
+  return relation_oid_;
+}
+
+DMITIGR_PGFE_INLINE std::string_view
+Pgoutput_message::relation_namespace() const noexcept
+{
+  return relation_namespace_;
+}
+
+DMITIGR_PGFE_INLINE std::string_view
+Pgoutput_message::relation_name() const noexcept
+{
+  return relation_name_;
+}
+
+DMITIGR_PGFE_INLINE char Pgoutput_message::replica_identity() const noexcept
+{
+  return replica_identity_;
+}
+
+DMITIGR_PGFE_INLINE const std::vector<Pgoutput_column>&
+Pgoutput_message::columns() const noexcept
+{
+  return columns_;
+}
+
+DMITIGR_PGFE_INLINE char Pgoutput_message::old_tuple_kind() const noexcept
+{
+  return old_tuple_kind_;
+}
+
+DMITIGR_PGFE_INLINE const std::vector<Pgoutput_value>&
+Pgoutput_message::old_tuple() const noexcept
+{
+  return old_tuple_;
+}
+
+DMITIGR_PGFE_INLINE const std::vector<Pgoutput_value>&
+Pgoutput_message::new_tuple() const noexcept
+{
+  return new_tuple_;
+}
+
+} // namespace dmitigr::pgfe
@@ -0,0 +1,264 @@
+// -*- C++ -*-
+//
+// Copyright 2023 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DMITIGR_PGFE_PGOUTPUT_MESSAGE_HPP
+#define DMITIGR_PGFE_PGOUTPUT_MESSAGE_HPP
+
+#include "basics.hpp"
+#include "dll.hpp"
+#include "types_fwd.hpp"
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace dmitigr::pgfe {
+
+/**
+ * @ingroup main
+ *
+ * @brief A type of the message of the logical replication protocol.
+ *
+ * @see https://www.postgresql.org/docs/current/protocol-logicalrep-message-formats.html
+ */
+enum class Pgoutput_message_type : char {
+  /// Invalid message.
+  invalid = 0,
+
+  /// Begin of transaction.
+  begin = 'B',
+
+  /// Commit of transaction.
+  commit = 'C',
+
+  /// Origin of transaction.
+  origin = 'O',
+
+  /// Description of relation.
+  relation = 'R',
+
+  /// Description of data type.
+  type = 'Y',
+
+  /// Insert of the row.
+  insert = 'I',
+
+  /// Update of the row.
+  update = 'U',
+
+  /// Delete of the row.
+  delete_ = 'D',
+
+  /// Truncate of relations.
+  truncate = 'T',
+
+  /// Logical decoding message.
+  message = 'M'
+};
+
+/**
+ * @ingroup main
+ *
+ * @brief A column of the relation described by the pgoutput Relation message.
+ */
+struct Pgoutput_column final {
+  /// `true` if the column is a part of the key.
+  bool is_key{};
+
+  /// The name of the column.
+  std::string_view name;
+
+  /// The Oid of the data type of the column.
+  Oid type_oid{invalid_oid};
+
+  /// The type modifier of the column.
+  std::int32_t type_modifier{-1};
+};
+
+/**
+ * @ingroup main
+ *
+ * @brief A column value of the pgoutput TupleData.
+ */
+struct Pgoutput_value final {
+  /// A kind of the value.
+  enum class Kind : char {
+    /// NULL value.
+    null = 'n',
+
+    /// Unchanged TOASTed value. (The actual value is not sent.)
+    unchanged_toast = 'u',
+
+    /// The value in the text format.
+    text = 't',
+
+    /// The value in the binary format.
+    binary = 'b'
+  };
+
+  /// The kind of the value.
+  Kind kind{Kind::null};
+
+  /// The value data. (Empty unless the kind is `text` or `binary`.)
+  std::string_view data;
+};
+
+/**
+ * @ingroup main
+ *
+ * @brief A decoded message of the `pgoutput` logical decoding plugin.
+ *
+ * @details The message doesn't own the data it was decoded from, all the
+ * string views (names, values) refer to the decoded bytes directly. When
+ * received via Replication_stream these bytes are owned by the stream and
+ * remain valid until the next call of Replication_stream::receive(). The
+ * containers of columns and values are reused between the messages, so the
+ * decoding of a steady stream of messages does not allocate memory.
+ *
+ * The accessors are valid only for the message types denoted in their
+ * descriptions, and return the default values otherwise.
+ *
+ * @see Replication_stream.
+ */
+class Pgoutput_message final {
+public:
+  /// Constructs invalid instance.
+  Pgoutput_message() = default;
+
+  /**
+   * @brief Decodes the message from `bytes`.
+   *
+   * @see assign().
+   */
+  explicit DMITIGR_PGFE_API Pgoutput_message(std::string_view bytes);
+
+  /**
+   * @brief Decodes the message from `bytes`, reusing the allocated memory.
+   *
+   * @details Types of messages unknown to this class are not decoded, and
+   * only type() and bytes() are available for them.
+   *
+   * @par Lifetime
+   * The memory referenced by `bytes` must outlive the use of the views
+   * returned by this instance.
+   *
+   * @throws Generic_exception if the message is malformed. In this case
+   * the instance becomes invalid.
+   *
+   * @par Exception safety guarantee
+   * Basic.
+   */
+  DMITIGR_PGFE_API void assign(std::string_view bytes);
+
+  /**
+   * @brief Makes this instance invalid.
+   *
+   * @par Effects
+   * `!is_valid()`.
+   */
+  DMITIGR_PGFE_API void reset() noexcept;
+
+  /// @returns `true` if the instance is valid.
+  DMITIGR_PGFE_API bool is_valid() const noexcept;
+
+  /// @returns `is_valid()`.
+  explicit operator bool() const noexcept
+  {
+    return is_valid();
+  }
+
+  /// @returns The type of the message.
+  DMITIGR_PGFE_API Pgoutput_message_type type() const noexcept;
+
+  /// @returns The encoded message.
+  DMITIGR_PGFE_API std::string_view bytes() const noexcept;
+
+  /// @name Begin and Commit
+  /// @{
+
+  /// @returns The LSN of the transaction commit record. (Begin and Commit.)
+  DMITIGR_PGFE_API Lsn commit_lsn() const noexcept;
+
+  /// @returns The end LSN of the transaction. (Commit only.)
+  DMITIGR_PGFE_API Lsn end_lsn() const noexcept;
+
+  /**
+   * @returns The commit timestamp of the transaction in microseconds since
+   * 2000-01-01 00:00:00 UTC. (Begin and Commit.)
+   */
+  DMITIGR_PGFE_API std::int64_t commit_timestamp() const noexcept;
+
+  /// @returns The transaction id. (Begin only.)
+  DMITIGR_PGFE_API std::uint32_t xid() const noexcept;
+
+  /// @}
+
+  /// @name Relation, Insert, Update and Delete
+  /// @{
+
+  /// @returns The Oid of the relation.
+  DMITIGR_PGFE_API Oid relation_oid() const noexcept;
+
+  /// @returns The namespace of the relation. (Relation only.)
+  DMITIGR_PGFE_API std::string_view relation_namespace() const noexcept;
+
+  /// @returns The name of the relation. (Relation only.)
+  DMITIGR_PGFE_API std::string_view relation_name() const noexcept;
+
+  /// @returns The replica identity setting of the relation. (Relation only.)
+  DMITIGR_PGFE_API char replica_identity() const noexcept;
+
+  /// @returns The columns of the relation. (Relation only.)
+  DMITIGR_PGFE_API const std::vector<Pgoutput_column>& columns() const noexcept;
+
+  /**
+   * @returns The kind of the old tuple: `'K'` if old_tuple() contains only
+   * the columns of the replica identity, `'O'` if old_tuple() contains the
+   * whole row, or `0` if there is no old tuple. (Update and Delete.)
+   */
+  DMITIGR_PGFE_API char old_tuple_kind() const noexcept;
+
+  /// @returns The old tuple. (Update and Delete.)
+  DMITIGR_PGFE_API const std::vector<Pgoutput_value>& old_tuple() const noexcept;
+
+  /// @returns The new tuple. (Insert and Update.)
+  DMITIGR_PGFE_API const std::vector<Pgoutput_value>& new_tuple() const noexcept;
+
+  /// @}
+
+private:
+  std::string_view bytes_;
+  Lsn commit_lsn_{};
+  Lsn end_lsn_{};
+  std::int64_t commit_timestamp_{};
+  std::uint32_t xid_{};
+  Oid relation_oid_{invalid_oid};
+  std::string_view relation_namespace_;
+  std::string_view relation_name_;
+  char replica_identity_{};
+  char old_tuple_kind_{};
+  std::vector<Pgoutput_column> columns_;
+  std::vector<Pgoutput_value> old_tuple_;
+  std::vector<Pgoutput_value> new_tuple_;
+};
+
+} // namespace dmitigr::pgfe
+
+#ifndef DMITIGR_PGFE_NOT_HEADER_ONLY
+#include "pgoutput_message.cpp"
+#endif
+
+#endif  // DMITIGR_PGFE_PGOUTPUT_MESSAGE_HPP
@@ -96,6 +96,10 @@ Prepared_statement::Prepared_statement(Prepared_statement&& rhs) noexcept
   , state_{std::move(rhs.state_)}
   , parameters_{std::move(rhs.parameters_)}
   , result_format_{std::move(rhs.result_format_)}
+  , is_parameter_buffering_enabled_{rhs.is_parameter_buffering_enabled_}
+  , pq_values_{std::move(rhs.pq_values_)}
+  , pq_lengths_{std::move(rhs.pq_lengths_)}
+  , pq_formats_{std::move(rhs.pq_formats_)}
 {}
 
 DMITIGR_PGFE_INLINE Prepared_statement&
@@ -115,6 +119,10 @@ DMITIGR_PGFE_INLINE void Prepared_statement::swap(Prepared_statement& rhs) noexc
   swap(state_, rhs.state_);
   swap(parameters_, rhs.parameters_);
   swap(result_format_, rhs.result_format_);
+  swap(is_parameter_buffering_enabled_, rhs.is_parameter_buffering_enabled_);
+  swap(pq_values_, rhs.pq_values_);
+  swap(pq_lengths_, rhs.pq_lengths_);
+  swap(pq_formats_, rhs.pq_formats_);
 }
 
 DMITIGR_PGFE_INLINE bool Prepared_statement::is_valid() const noexcept
@@ -204,8 +212,23 @@ DMITIGR_PGFE_INLINE Data_view Prepared_statement::bound(const std::size_t index)
 {
   if (!(index < parameter_count()))
     throw_exception("cannot get bound parameter value of");
-  const auto& result = parameters_[index].data;
-  return result ? Data_view{*result} : Data_view{};
+  const auto& param = parameters_[index];
+  if (param.is_buffered)
+    return Data_view{param.buffer.data(), param.buffer.size(), param.buffer_format};
+  else
+    return param.data ? Data_view{*param.data} : Data_view{};
+}
+
+DMITIGR_PGFE_INLINE void
+Prepared_statement::set_parameter_buffering_enabled(const bool value) noexcept
+{
+  is_parameter_buffering_enabled_ = value;
+}
+
+DMITIGR_PGFE_INLINE bool
+Prepared_statement::is_parameter_buffering_enabled() const noexcept
+{
+  return is_parameter_buffering_enabled_;
 }
 
 DMITIGR_PGFE_INLINE Data_view
@@ -245,21 +268,31 @@ Prepared_statement::execute_nio__(const Statement* const statement)
   else if (!(connection().is_ready_for_nio_request()))
     throw_exception("cannot execute");
 
-  // All the values are NULLs initially. (Can throw.)
+  /*
+   * All the values are NULLs initially. The arrays are reused between
+   * executions, so they are not reallocated unless the parameter count
+   * grows. (Can throw.)
+   */
   const int param_count{static_cast<int>(parameter_count())};
-  std::vector<const char*> values(static_cast<unsigned>(param_count), nullptr);
-  std::vector<int> lengths(static_cast<unsigned>(param_count), 0);
-  std::vector<int> formats(static_cast<unsigned>(param_count), 0);
+  const auto param_count_u = static_cast<unsigned>(param_count);
+  pq_values_.assign(param_count_u, nullptr);
+  pq_lengths_.assign(param_count_u, 0);
+  pq_formats_.assign(param_count_u, 0);
 
   auto& conn = connection();
   conn.requests_.emplace(Connection::Request::Id::execute); // can throw
   try {
     // Prepare the input for libpq.
-    for (unsigned i{}; i < static_cast<unsigned>(param_count); ++i) {
-      if (const auto d = bound(i)) {
-        values[i] = static_cast<const char*>(d.bytes());
-        lengths[i] = static_cast<int>(d.size());
-        formats[i] = detail::pq::to_int(d.format());
+    for (unsigned i{}; i < param_count_u; ++i) {
+      const auto& param = parameters_[i];
+      if (param.is_buffered) {
+        pq_values_[i] = param.buffer.data();
+        pq_lengths_[i] = static_cast<int>(param.buffer.size());
+        pq_formats_[i] = detail::pq::to_int(param.buffer_format);
+      } else if (const auto* const d = param.data.get(); d && *d) {
+        pq_values_[i] = static_cast<const char*>(d->bytes());
+        pq_lengths_[i] = static_cast<int>(d->size());
+        pq_formats_[i] = detail::pq::to_int(d->format());
       }
     }
     const int result_format = detail::pq::to_int(result_format_);
@@ -267,12 +300,12 @@ Prepared_statement::execute_nio__(const Statement* const statement)
     const int send_ok = statement
       ? PQsendQueryParams(conn.conn(),
         statement->to_query_string(conn).c_str(),
-        param_count, nullptr, values.data(), lengths.data(),
-        formats.data(), result_format)
+        param_count, nullptr, pq_values_.data(), pq_lengths_.data(),
+        pq_formats_.data(), result_format)
       : PQsendQueryPrepared(conn.conn(),
         name().c_str(),
-        param_count, values.data(), lengths.data(),
-        formats.data(), result_format);
+        param_count, pq_values_.data(), pq_lengths_.data(),
+        pq_formats_.data(), result_format);
 
     if (!send_ok)
       throw Generic_exception{conn.error_message()};
@@ -283,6 +316,7 @@ Prepared_statement::execute_nio__(const Statement* const statement)
     conn.requests_.pop(); // rollback
     throw;
   }
+  conn.count_request__();
 
   assert(is_invariant_ok());
 }
@@ -348,9 +382,8 @@ Prepared_statement::parameter_type_oid(const std::size_t index) const
 {
   if (!(index < parameter_count()))
     throw_exception("cannot get parameter type OID of");
-  return is_described() ?
-    state_->description_.pq_result_.ps_param_type_oid(static_cast<int>(index)) :
-    invalid_oid;
+  const auto& oids = state_->parameter_type_oids_;
+  return index < oids.size() ? oids[index] : invalid_oid;
 }
 
 DMITIGR_PGFE_INLINE std::uint_fast32_t
@@ -438,6 +471,17 @@ Prepared_statement::throw_exception(std::string msg) const
 
 DMITIGR_PGFE_INLINE Prepared_statement&
 Prepared_statement::bind(const std::size_t index, Data_ptr&& data)
+{
+  auto& param = parameter_to_bind__(index);
+  param.data = std::move(data);
+  param.is_buffered = false; // the buffer is kept for reuse
+
+  assert(is_invariant_ok());
+  return *this;
+}
+
+DMITIGR_PGFE_INLINE auto
+Prepared_statement::parameter_to_bind__(const std::size_t index) -> Parameter&
 {
   const bool is_opaque = !is_preparsed() && !is_described();
   if (!(is_opaque || (index < parameter_count())))
@@ -449,10 +493,7 @@ Prepared_statement::bind(const std::size_t index, Data_ptr&& data)
     if (index >= parameters_.size())
       parameters_.resize(index + 1);
   }
-  parameters_[index].data = std::move(data);
-
-  assert(is_invariant_ok());
-  return *this;
+  return parameters_[index];
 }
 
 DMITIGR_PGFE_INLINE Prepared_statement&
@@ -472,10 +513,22 @@ Prepared_statement::bind__(const std::size_t, const Named_argument& na)
 
 DMITIGR_PGFE_INLINE void
 Prepared_statement::set_description(detail::pq::Result&& r)
+{
+  DMITIGR_ASSERT(r);
+  std::vector<std::uint_fast32_t> oids(static_cast<std::size_t>(r.ps_param_count()));
+  for (std::size_t i{}; i < oids.size(); ++i)
+    oids[i] = r.ps_param_type_oid(static_cast<int>(i));
+  set_description(std::move(r), std::move(oids));
+}
+
+DMITIGR_PGFE_INLINE void
+Prepared_statement::set_description(detail::pq::Result&& r,
+  std::vector<std::uint_fast32_t> parameter_type_oids)
 {
   DMITIGR_ASSERT(r);
 
-  parameters_.resize(static_cast<std::size_t>(r.ps_param_count()));
+  parameters_.resize(parameter_type_oids.size());
+  state_->parameter_type_oids_ = std::move(parameter_type_oids);
 
   /*
    * If result contains fields info, initialize Row_info.
@@ -17,6 +17,7 @@
 #ifndef DMITIGR_PGFE_PREPARED_STATEMENT_HPP
 #define DMITIGR_PGFE_PREPARED_STATEMENT_HPP
 
+#include "../base/assert.hpp"
 #include "../base/memory.hpp"
 //#include "aio.hpp"
 #include "basics.hpp"
@@ -28,12 +29,16 @@
 #include "types_fwd.hpp"
 
 #include <cassert>
+#include <charconv>
 #include <chrono>
 #include <cstdint>
 #include <functional>
+#include <limits>
 #include <memory>
 #include <optional>
 #include <string>
+#include <string_view>
+#include <system_error>
 #include <type_traits>
 #include <utility>
 #include <vector>
@@ -296,7 +301,9 @@ public:
       return bind(index, Data_ptr{value, Data_deletion_required{false}});
     } else if constexpr (std::is_same_v<U, std::nullptr_t>) {
       return bind(index, Data_ptr{nullptr, Data_deletion_required{false}});
-    } else
+    } else if (is_parameter_buffering_enabled_)
+      return bind_buffered__(index, std::forward<T>(value));
+    else
       return bind(index, to_data(std::forward<T>(value)));
   }
 
@@ -338,6 +345,35 @@ public:
       std::forward<Types>(values)...);
   }
 
+  /**
+   * @brief Enables or disables the buffering of the parameter values.
+   *
+   * @details When the buffering is enabled, bind() encodes the value which
+   * requires a conversion (i.e. the value of type other than Data or
+   * `std::nullptr_t`) into the buffer owned by the parameter rather than into
+   * the newly allocated Data object. Re-binding of the parameter overwrites
+   * its buffer in place, so once the buffers are grown enough, the repeated
+   * binding and execution of this prepared statement don't allocate memory.
+   * Strings, integers, floating point numbers (if `std::to_chars()` supports
+   * them), `bool` and `char` are encoded directly into the buffers. Values of
+   * other types (including `std::optional`) are converted by using to_data()
+   * (which allocates) and then copied. (The values of types convertible to
+   * `const Data&`, such as Data_view, are never buffered but bound as is.)
+   *
+   * @remarks Binding a null pointer to character string throws, use `nullptr`
+   * to bind the SQL NULL.
+   *
+   * @par Effects
+   * `is_parameter_buffering_enabled() == value`. The values bound before the
+   * call remain bound.
+   *
+   * @see bind().
+   */
+  DMITIGR_PGFE_API void set_parameter_buffering_enabled(bool value) noexcept;
+
+  /// @returns `true` if the buffering of the parameter values is enabled.
+  DMITIGR_PGFE_API bool is_parameter_buffering_enabled() const noexcept;
+
   /// @}
 
   /// @{
@@ -436,7 +472,11 @@ public:
    * @returns `true` if the information inferred by a PostgreSQL server
    * about this prepared statement is available.
    *
-   * @see describe(), parameter_type_oid(), row_info().
+   * @remarks The statement prepared by the connection with the description
+   * cache set might be described without the describe() call.
+   *
+   * @see describe(), parameter_type_oid(), row_info(),
+   * Connection::set_description_cache().
    */
   DMITIGR_PGFE_API bool is_described() const noexcept;
 
@@ -480,6 +520,9 @@ private:
   struct Parameter final {
     Data_ptr data;
     std::string name;
+    std::string buffer; // the value if is_buffered
+    Data_format buffer_format{Data_format::text};
+    bool is_buffered{};
   };
 
   /// A state.
@@ -493,12 +536,20 @@ private:
     Connection* connection_{};
     bool preparsed_{};
     Row_info description_; // may be invalid, see set_description()
+    std::vector<std::uint_fast32_t> parameter_type_oids_;
+    std::string query_; // to cache the description, see set_description()
   };
 
   bool is_registered_{};
   std::shared_ptr<State> state_;
   std::vector<Parameter> parameters_;
   Data_format result_format_{Data_format::text};
+  bool is_parameter_buffering_enabled_{};
+
+  // The arguments of PQsendQuery*() reused between executions.
+  std::vector<const char*> pq_values_;
+  std::vector<int> pq_lengths_;
+  std::vector<int> pq_formats_;
 
   // ---------------------------------------------------------------------------
 
@@ -517,6 +568,62 @@ private:
   // ---------------------------------------------------------------------------
 
   Prepared_statement& bind(std::size_t index, Data_ptr&& data);
+  Parameter& parameter_to_bind__(std::size_t index);
+
+  template<typename U>
+  static constexpr bool is_buffered_integer__ =
+    std::is_same_v<U, short> || std::is_same_v<U, unsigned short> ||
+    std::is_same_v<U, int> || std::is_same_v<U, unsigned int> ||
+    std::is_same_v<U, long> || std::is_same_v<U, unsigned long> ||
+    std::is_same_v<U, long long> || std::is_same_v<U, unsigned long long>;
+
+  template<typename T>
+  Prepared_statement& bind_buffered__(const std::size_t index, T&& value)
+  {
+    using U = std::decay_t<T>;
+    auto& param = parameter_to_bind__(index);
+    if constexpr (std::is_convertible_v<U, std::string_view>) {
+      if constexpr (std::is_pointer_v<std::remove_reference_t<T>>) {
+        if (!value)
+          throw_exception("cannot bind null pointer to parameter of");
+      }
+      const std::string_view str{value};
+      param.buffer.assign(str.data(), str.size());
+      param.buffer_format = Data_format::text;
+    } else if constexpr (is_buffered_integer__<U>) {
+      char str[std::numeric_limits<U>::digits10 + 3];
+      const auto [end, ec] = std::to_chars(str, str + sizeof(str), value);
+      DMITIGR_ASSERT(ec == std::errc{});
+      param.buffer.assign(str, end);
+      param.buffer_format = Data_format::text;
+#ifdef __cpp_lib_to_chars
+    } else if constexpr (std::is_floating_point_v<U>) {
+      // The shortest representation which is parsed back to the same value.
+      char str[std::numeric_limits<U>::max_digits10 + 16];
+      const auto [end, ec] = std::to_chars(str, str + sizeof(str), value);
+      DMITIGR_ASSERT(ec == std::errc{});
+      param.buffer.assign(str, end);
+      param.buffer_format = Data_format::text;
+#endif
+    } else if constexpr (std::is_same_v<U, bool>) {
+      param.buffer.assign(value ? "t" : "f");
+      param.buffer_format = Data_format::text;
+    } else if constexpr (std::is_same_v<U, char>) {
+      param.buffer.assign(1, value);
+      param.buffer_format = Data_format::text;
+    } else {
+      const auto data = to_data(std::forward<T>(value));
+      if (!data)
+        return bind(index, Data_ptr{nullptr, Data_deletion_required{false}});
+      param.buffer.assign(static_cast<const char*>(data->bytes()), data->size());
+      param.buffer_format = data->format();
+    }
+    param.data.reset();
+    param.is_buffered = true;
+    assert(is_invariant_ok());
+    return *this;
+  }
+
   Prepared_statement& bind__(std::size_t, Named_argument&& na);
   Prepared_statement& bind__(std::size_t, const Named_argument& na);
 
@@ -538,6 +645,8 @@ private:
   // ---------------------------------------------------------------------------
 
   void set_description(detail::pq::Result&& r);
+  void set_description(detail::pq::Result&& r,
+    std::vector<std::uint_fast32_t> parameter_type_oids);
   void execute_nio(const Statement& statement);
   void execute_nio__(const Statement* const statement);
 };
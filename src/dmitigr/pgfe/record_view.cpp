@@ -0,0 +1,238 @@
+// -*- C++ -*-
+//
+// Copyright 2023 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "basics.hpp"
+#include "exceptions.hpp"
+#include "record_view.hpp"
+
+#include <cassert>
+
+namespace dmitigr::pgfe {
+
+namespace detail {
+
+/// @returns The 4-byte integer in network byte order at `bytes`.
+inline std::uint_fast32_t record_uint32(const std::string_view bytes) noexcept
+{
+  std::uint_fast32_t result{};
+  for (std::size_t i{}; i < 4; ++i)
+    result = (result << 8) | static_cast<unsigned char>(bytes[i]);
+  return result;
+}
+
+/**
+ * @brief Extracts the field from the beginning of `bytes`.
+ *
+ * @returns `false` if the field is malformed.
+ */
+inline bool record_field(std::string_view& bytes,
+  std::uint_fast32_t& type_oid, const char*& data, std::int_fast32_t& size) noexcept
+{
+  if (bytes.size() < 8)
+    return false;
+
+  type_oid = record_uint32(bytes);
+  size = static_cast<std::int32_t>(record_uint32(bytes.substr(4)));
+  bytes.remove_prefix(8);
+  if (size < 0) {
+    if (size != -1)
+      return false;
+    data = nullptr;
+  } else if (bytes.size() < static_cast<std::size_t>(size))
+    return false;
+  else {
+    data = bytes.data();
+    bytes.remove_prefix(static_cast<std::size_t>(size));
+  }
+  return true;
+}
+
+} // namespace detail
+
+// -----------------------------------------------------------------------------
+// Record_view::Iterator
+// -----------------------------------------------------------------------------
+
+DMITIGR_PGFE_INLINE Record_view::Iterator::Iterator(const std::string_view rest,
+  const std::size_t count) noexcept
+  : rest_{rest}
+  , index_{static_cast<std::size_t>(-1)}
+  , count_{count}
+{
+  ++*this;
+}
+
+DMITIGR_PGFE_INLINE auto Record_view::Iterator::operator++() noexcept -> Iterator&
+{
+  if (++index_ < count_) {
+    const char* data{};
+    std::int_fast32_t size{};
+    [[maybe_unused]] const bool ok = detail::record_field(rest_,
+      field_.type_oid, data, size);
+    assert(ok); // validated by the Record_view constructor
+    field_.data = data ? Data_view{data, static_cast<std::size_t>(size),
+      Data_format::binary} : Data_view{};
+  } else {
+    index_ = count_;
+    rest_ = {};
+    field_ = {};
+  }
+  return *this;
+}
+
+// -----------------------------------------------------------------------------
+// Record_view
+// -----------------------------------------------------------------------------
+
+DMITIGR_PGFE_INLINE Record_view::Record_view(const Data& data)
+{
+  if (!data)
+    throw Generic_exception{"cannot create record view: invalid data"};
+  else if (data.format() != Data_format::binary)
+    throw Generic_exception{"cannot create record view: "
+      "data is not in binary format"};
+
+  std::string_view bytes{static_cast<const char*>(data.bytes()), data.size()};
+  if (bytes.size() < 4)
+    throw Generic_exception{"cannot create record view: malformed data"};
+  const auto count = static_cast<std::int32_t>(detail::record_uint32(bytes));
+  if (count < 0)
+    throw Generic_exception{"cannot create record view: malformed data"};
+  bytes.remove_prefix(4);
+
+  /*
+   * Validate the fields once, so the traversal doesn't need to check anything,
+   * and remember the offsets of the fields for random access.
+   */
+  const auto field_count = static_cast<std::size_t>(count);
+  // Each field takes at least 8 bytes (the type OID and the size).
+  if (field_count > bytes.size() / 8)
+    throw Generic_exception{"cannot create record view: malformed data"};
+  else if (field_count > inline_offset_count_)
+    offsets_.resize(field_count);
+  auto* const offsets = field_count > inline_offset_count_ ?
+    offsets_.data() : inline_offsets_.data();
+  auto rest = bytes;
+  for (std::size_t i{}; i < field_count; ++i) {
+    offsets[i] = static_cast<std::uint32_t>(bytes.size() - rest.size());
+    std::uint_fast32_t type_oid{};
+    const char* fdata{};
+    std::int_fast32_t size{};
+    if (!detail::record_field(rest, type_oid, fdata, size))
+      throw Generic_exception{"cannot create record view: malformed data"};
+  }
+  if (!rest.empty())
+    throw Generic_exception{"cannot create record view: malformed data"};
+
+  bytes_ = bytes;
+  field_count_ = field_count;
+  is_valid_ = true;
+  assert(is_invariant_ok());
+}
+
+DMITIGR_PGFE_INLINE bool Record_view::is_valid() const noexcept
+{
+  return is_valid_;
+}
+
+DMITIGR_PGFE_INLINE std::size_t Record_view::field_count() const noexcept
+{
+  return field_count_;
+}
+
+DMITIGR_PGFE_INLINE bool Record_view::is_empty() const noexcept
+{
+  return !field_count_;
+}
+
+DMITIGR_PGFE_INLINE std::string_view
+Record_view::field_name(const std::size_t index) const
+{
+  if (!(index < field_count()))
+    throw Generic_exception{"cannot get field name of record"};
+  return {};
+}
+
+DMITIGR_PGFE_INLINE std::size_t
+Record_view::field_index(const std::string_view name,
+  const std::size_t offset) const noexcept
+{
+  return name.empty() && offset < field_count() ? offset : field_count();
+}
+
+DMITIGR_PGFE_INLINE std::uint_fast32_t
+Record_view::field_type_oid(const std::size_t index) const
+{
+  if (!(index < field_count()))
+    throw Generic_exception{"cannot get field type OID of record"};
+  return field(index).type_oid;
+}
+
+DMITIGR_PGFE_INLINE Data_view Record_view::data(const std::size_t index) const
+{
+  if (!(index < field_count()))
+    throw Generic_exception{"cannot get field data of record"};
+  return field(index).data;
+}
+
+DMITIGR_PGFE_INLINE Data_view Record_view::data(const std::string_view name,
+  const std::size_t offset) const
+{
+  return data(field_index(name, offset));
+}
+
+DMITIGR_PGFE_INLINE auto Record_view::begin() const noexcept -> Iterator
+{
+  return Iterator{bytes_, field_count_};
+}
+
+DMITIGR_PGFE_INLINE auto Record_view::end() const noexcept -> Iterator
+{
+  Iterator result;
+  result.index_ = result.count_ = field_count_;
+  return result;
+}
+
+DMITIGR_PGFE_INLINE bool Record_view::is_invariant_ok() const noexcept
+{
+  const bool validity_ok = is_valid_ || (bytes_.empty() && !field_count_);
+  return validity_ok && Composite::is_invariant_ok();
+}
+
+DMITIGR_PGFE_INLINE auto Record_view::field(const std::size_t index) const
+  -> Field
+{
+  assert(index < field_count());
+  auto rest = bytes_.substr(offsets()[index]);
+  Field result;
+  const char* data{};
+  std::int_fast32_t size{};
+  [[maybe_unused]] const bool ok = detail::record_field(rest,
+    result.type_oid, data, size);
+  assert(ok); // validated by the constructor
+  if (data)
+    result.data = Data_view{data, static_cast<std::size_t>(size),
+      Data_format::binary};
+  return result;
+}
+
+DMITIGR_PGFE_INLINE const std::uint32_t* Record_view::offsets() const noexcept
+{
+  return field_count_ > inline_offset_count_ ?
+    offsets_.data() : inline_offsets_.data();
+}
+
+} // namespace dmitigr::pgfe
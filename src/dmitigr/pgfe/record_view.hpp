@@ -0,0 +1,253 @@
+// -*- C++ -*-
+//
+// Copyright 2023 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DMITIGR_PGFE_RECORD_VIEW_HPP
+#define DMITIGR_PGFE_RECORD_VIEW_HPP
+
+#include "composite.hpp"
+#include "data.hpp"
+#include "dll.hpp"
+#include "types_fwd.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <string_view>
+#include <vector>
+
+namespace dmitigr::pgfe {
+
+/**
+ * @ingroup main
+ *
+ * @brief A view of the value of composite type (record) received in
+ * Data_format::binary format.
+ *
+ * @details The binary representation of the record consists of the number of
+ * fields followed by the type OID, the size and the value of each field. The
+ * fields are presented as instances of Data_view which are point directly into
+ * the source data, so decoding of the (nested) records doesn't allocates
+ * (except the table of the field offsets of the records with more than 16
+ * fields). The binary representation doesn't contains the field names, thus
+ * all the fields are unnamed.
+ *
+ * Example:
+ * @code
+ * conn.execute([](auto&& row)
+ * {
+ *   const auto rec = pgfe::to<pgfe::Record_view>(row[0]);
+ *   const auto id = pgfe::to<int>(rec[0]);
+ *   const auto nested = pgfe::to<pgfe::Record_view>(rec[1]);
+ * }, "select row(1, row('foo', 2))", pgfe::Data_format::binary);
+ * @endcode
+ *
+ * @remarks Doesn't owns the data. Thus, the source data must outlive the
+ * instance of this class and all the views obtained from it.
+ */
+class Record_view final : public Composite {
+public:
+  /// A field of the record.
+  struct Field final {
+    /// The type OID of the field.
+    std::uint_fast32_t type_oid{};
+
+    /// The data of the field in Data_format::binary format, or invalid if NULL.
+    Data_view data;
+  };
+
+  /// A forward iterator over the fields of the record.
+  class Iterator final {
+  public:
+    /// The iterator category.
+    using iterator_category = std::forward_iterator_tag;
+
+    /// The value type.
+    using value_type = Field;
+
+    /// The difference type.
+    using difference_type = std::ptrdiff_t;
+
+    /// The pointer type.
+    using pointer = const Field*;
+
+    /// The reference type.
+    using reference = const Field&;
+
+    /// Constructs the past-the-end iterator.
+    Iterator() = default;
+
+    /// @returns The current field.
+    reference operator*() const noexcept
+    {
+      return field_;
+    }
+
+    /// @returns The pointer to the current field.
+    pointer operator->() const noexcept
+    {
+      return &field_;
+    }
+
+    /// Advances the iterator to the next field.
+    DMITIGR_PGFE_API Iterator& operator++() noexcept;
+
+    /// Advances the iterator to the next field.
+    Iterator operator++(int) noexcept
+    {
+      auto result = *this;
+      ++*this;
+      return result;
+    }
+
+    /// @returns `true` if `lhs` and `rhs` are points to the same field.
+    friend bool operator==(const Iterator& lhs, const Iterator& rhs) noexcept
+    {
+      return lhs.index_ == rhs.index_ && lhs.count_ == rhs.count_;
+    }
+
+    /// @returns `!(lhs == rhs)`.
+    friend bool operator!=(const Iterator& lhs, const Iterator& rhs) noexcept
+    {
+      return !(lhs == rhs);
+    }
+
+  private:
+    friend Record_view;
+
+    std::string_view rest_;
+    std::size_t index_{};
+    std::size_t count_{};
+    Field field_;
+
+    Iterator(std::string_view rest, std::size_t count) noexcept;
+  };
+
+  /**
+   * @brief Constructs invalid instance.
+   *
+   * @par Effects
+   * `!is_valid() && is_empty()`.
+   */
+  Record_view() = default;
+
+  /**
+   * @brief Constructs the view of the record represented by `data`.
+   *
+   * @par Requires
+   * `data && data.format() == Data_format::binary` and `data` must be the
+   * well-formed binary representation of the record.
+   *
+   * @par Effects
+   * `is_valid()`.
+   *
+   * @par Complexity
+   * Linear in `field_count()` (the representation is validated and the table
+   * of the field offsets is built).
+   */
+  explicit DMITIGR_PGFE_API Record_view(const Data& data);
+
+  /// @returns `true` if this instance is valid.
+  DMITIGR_PGFE_API bool is_valid() const noexcept;
+
+  /// @returns `is_valid()`.
+  explicit operator bool() const noexcept
+  {
+    return is_valid();
+  }
+
+  /// @see Compositional::field_count().
+  DMITIGR_PGFE_API std::size_t field_count() const noexcept override;
+
+  /// @see Compositional::is_empty().
+  DMITIGR_PGFE_API bool is_empty() const noexcept override;
+
+  /**
+   * @returns The empty string, since the fields of the binary record are
+   * unnamed.
+   *
+   * @see Compositional::field_name().
+   */
+  DMITIGR_PGFE_API std::string_view field_name(std::size_t index) const override;
+
+  /**
+   * @returns `offset` if `name.empty() && offset < field_count()`, or
+   * `field_count()` otherwise.
+   *
+   * @see Compositional::field_index().
+   */
+  DMITIGR_PGFE_API std::size_t field_index(std::string_view name,
+    std::size_t offset = 0) const noexcept override;
+
+  /**
+   * @returns The type OID of the field.
+   *
+   * @par Requires
+   * `index < field_count()`.
+   *
+   * @par Complexity
+   * Constant.
+   */
+  DMITIGR_PGFE_API std::uint_fast32_t field_type_oid(std::size_t index) const;
+
+  /**
+   * @returns The field data in Data_format::binary format, or invalid instance
+   * if the field is NULL.
+   *
+   * @par Requires
+   * `index < field_count()`.
+   *
+   * @par Complexity
+   * Constant.
+   *
+   * @see Composite::data().
+   */
+  DMITIGR_PGFE_API Data_view data(std::size_t index) const override;
+
+  /// @see Composite::data().
+  DMITIGR_PGFE_API Data_view data(std::string_view name,
+    std::size_t offset = 0) const override;
+
+  /// @returns The iterator to the first field.
+  DMITIGR_PGFE_API Iterator begin() const noexcept;
+
+  /// @returns The past-the-end iterator.
+  DMITIGR_PGFE_API Iterator end() const noexcept;
+
+private:
+  /// The number of the field offsets stored without dynamic allocation.
+  static constexpr std::size_t inline_offset_count_{16};
+
+  std::string_view bytes_; // fields (without the field count)
+  std::size_t field_count_{};
+  bool is_valid_{};
+  // The offsets of the fields in `bytes_` (the first field_count_ elements).
+  std::array<std::uint32_t, inline_offset_count_> inline_offsets_{};
+  std::vector<std::uint32_t> offsets_; // used if field_count_ > inline count
+
+  const std::uint32_t* offsets() const noexcept;
+
+  bool is_invariant_ok() const noexcept override;
+  Field field(std::size_t index) const;
+};
+
+} // namespace dmitigr::pgfe
+
+#ifndef DMITIGR_PGFE_NOT_HEADER_ONLY
+#include "record_view.cpp"
+#endif
+
+#endif  // DMITIGR_PGFE_RECORD_VIEW_HPP
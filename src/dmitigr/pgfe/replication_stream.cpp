@@ -0,0 +1,302 @@
+// -*- C++ -*-
+//
+// Copyright 2023 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "../base/assert.hpp"
+#include "connection.hpp"
+#include "exceptions.hpp"
+#include "pq.hpp"
+#include "replication_stream.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cstdio>
+#include <iostream>
+
+namespace dmitigr::pgfe {
+
+namespace detail {
+
+inline std::uint64_t read_replication_uint64(const char* const bytes) noexcept
+{
+  std::uint64_t result{};
+  for (int i{}; i < 8; ++i)
+    result = (result << 8) | static_cast<unsigned char>(bytes[i]);
+  return result;
+}
+
+inline void write_replication_uint64(char* const bytes,
+  const std::uint64_t value) noexcept
+{
+  for (int i{}; i < 8; ++i)
+    bytes[i] = static_cast<char>((value >> (56 - 8*i)) & 0xff);
+}
+
+} // namespace detail
+
+DMITIGR_PGFE_INLINE std::optional<Lsn> to_lsn(const std::string_view str) noexcept
+{
+  const auto slash = str.find('/');
+  if (slash == std::string_view::npos)
+    return std::nullopt;
+
+  const auto parse = [](const std::string_view part) noexcept
+    -> std::optional<std::uint32_t>
+  {
+    std::uint32_t result{};
+    const auto* const end = part.data() + part.size();
+    const auto [ptr, ec] = std::from_chars(part.data(), end, result, 16);
+    if (part.empty() || ec != std::errc{} || ptr != end)
+      return std::nullopt;
+    return result;
+  };
+  const auto hi = parse(str.substr(0, slash));
+  const auto lo = parse(str.substr(slash + 1));
+  return hi && lo ? std::optional<Lsn>{Lsn{*hi} << 32 | *lo} : std::nullopt;
+}
+
+DMITIGR_PGFE_INLINE std::string to_lsn_string(const Lsn lsn)
+{
+  char result[18];
+  const int size{std::snprintf(result, sizeof(result), "%X/%X",
+    static_cast<unsigned>(lsn >> 32), static_cast<unsigned>(lsn))};
+  DMITIGR_ASSERT(0 < size && static_cast<std::size_t>(size) < sizeof(result));
+  return std::string(result, static_cast<std::size_t>(size));
+}
+
+DMITIGR_PGFE_INLINE Replication_stream::~Replication_stream() noexcept
+{
+  try {
+    stop();
+  } catch (const std::exception& e) {
+    std::clog << "replication stream stop error: " << e.what() << '\n';
+  } catch (...) {
+    std::clog << "replication stream stop error: unknown error\n";
+  }
+}
+
+DMITIGR_PGFE_INLINE Replication_stream::Replication_stream(Connection& conn,
+  const std::string_view slot, const std::string_view publications,
+  const Lsn start_lsn, const int protocol_version)
+  : conn_{conn}
+{
+  if (slot.empty())
+    throw Generic_exception{"cannot start replication stream: "
+      "empty slot name"};
+  else if (publications.empty())
+    throw Generic_exception{"cannot start replication stream: "
+      "empty publication names"};
+  else if (protocol_version < 1)
+    throw Generic_exception{"cannot start replication stream: "
+      "invalid protocol version"};
+  else if (conn_.options().replication_mode() != Replication_mode::logical)
+    throw Generic_exception{"cannot start replication stream: "
+      "not a logical replication connection"};
+  else if (!conn_.is_ready_for_request())
+    throw Generic_exception{"cannot start replication stream: "
+      "not ready for request"};
+
+  std::string query{"START_REPLICATION SLOT "};
+  query.append(conn_.to_quoted_identifier(slot))
+    .append(" LOGICAL ").append(to_lsn_string(start_lsn))
+    .append(" (proto_version ")
+    .append(conn_.to_quoted_literal(std::to_string(protocol_version)))
+    .append(", publication_names ")
+    .append(conn_.to_quoted_literal(publications)).append(")");
+  conn_.execute_simple_nio__(query);
+  conn_.wait_response_throw();
+  copier_ = conn_.copier();
+  if (!copier_.is_valid())
+    throw Generic_exception{"cannot start replication stream: "
+      "unexpected response"};
+  DMITIGR_ASSERT(copier_.data_direction() == Data_direction::bidirectional);
+  last_status_time_ = Clock::now();
+}
+
+DMITIGR_PGFE_INLINE Connection& Replication_stream::connection() noexcept
+{
+  return conn_;
+}
+
+DMITIGR_PGFE_INLINE const Pgoutput_message&
+Replication_stream::receive(const std::optional<std::chrono::milliseconds> timeout)
+{
+  using std::chrono::ceil;
+  using std::chrono::milliseconds;
+
+  if (timeout && timeout->count() < 0)
+    throw Generic_exception{"cannot receive from replication stream: "
+      "invalid timeout specified"};
+
+  message_.reset();
+  if (is_stopped())
+    return message_;
+
+  const auto deadline = timeout ? Clock::now() + *timeout : Clock::time_point::max();
+  while (true) {
+    if (Clock::now() - last_status_time_ >= status_interval_)
+      send_status__(false);
+
+    const auto data = copier_.receive(false);
+    if (!data) {
+      // The streaming is ended by the server.
+      is_server_done_ = true;
+      stop();
+      return message_;
+    } else if (!data.size()) {
+      // No message is available yet.
+      const auto now = Clock::now();
+      if (now >= deadline)
+        return message_;
+      const auto wait = ceil<milliseconds>(std::min(deadline,
+          last_status_time_ + status_interval_) - now);
+      const auto readiness = conn_.wait_socket_readiness(
+        Socket_readiness::read_ready, std::max(wait, milliseconds{}));
+      if (bool(readiness & Socket_readiness::read_ready))
+        conn_.read_input();
+      continue;
+    }
+
+    const auto* const bytes = static_cast<const char*>(data.bytes());
+    const std::size_t size{data.size()};
+    if (bytes[0] == 'w' && size >= 25) {
+      // XLogData: WAL start, WAL end, send time and the message itself.
+      received_lsn_ = std::max(received_lsn_,
+        detail::read_replication_uint64(bytes + 1));
+      message_.assign(std::string_view{bytes + 25, size - 25});
+      return message_;
+    } else if (bytes[0] == 'k' && size >= 18) {
+      // Primary keepalive: WAL end, send time and the reply flag.
+      if (bytes[17])
+        send_status__(false);
+    } else
+      throw Generic_exception{"cannot receive from replication stream: "
+        "unexpected message"};
+  }
+}
+
+DMITIGR_PGFE_INLINE void Replication_stream::confirm(const Lsn lsn) noexcept
+{
+  confirmed_lsn_ = std::max(confirmed_lsn_, lsn);
+}
+
+DMITIGR_PGFE_INLINE Lsn Replication_stream::confirmed_lsn() const noexcept
+{
+  return confirmed_lsn_;
+}
+
+DMITIGR_PGFE_INLINE Lsn Replication_stream::received_lsn() const noexcept
+{
+  return received_lsn_;
+}
+
+DMITIGR_PGFE_INLINE void
+Replication_stream::set_status_interval(const std::chrono::milliseconds interval)
+{
+  if (interval.count() <= 0)
+    throw Generic_exception{"cannot set status interval of replication stream: "
+      "invalid interval"};
+  status_interval_ = interval;
+}
+
+DMITIGR_PGFE_INLINE std::chrono::milliseconds
+Replication_stream::status_interval() const noexcept
+{
+  return status_interval_;
+}
+
+DMITIGR_PGFE_INLINE void Replication_stream::send_status(const bool reply_requested)
+{
+  if (is_stopped())
+    throw Generic_exception{"cannot send status of replication stream: "
+      "stream is stopped"};
+  send_status__(reply_requested);
+}
+
+DMITIGR_PGFE_INLINE void Replication_stream::stop()
+{
+  if (is_stopped_)
+    return;
+
+  is_stopped_ = true;
+  try {
+    if (!is_server_done_) {
+      send_status__(false);
+      copier_.end();
+      flush__();
+      // Discard the messages in flight until the end of data from the server.
+      char* buffer{};
+      int size{};
+      while ((size = PQgetCopyData(conn_.conn(), &buffer, 0)) > 0)
+        PQfreemem(buffer);
+      if (size == -2)
+        throw Generic_exception{conn_.error_message()};
+    } else {
+      copier_.end();
+      flush__();
+    }
+    copier_ = Copier{};
+    conn_.wait_response_throw();
+    (void)conn_.completion();
+  } catch (...) {
+    // Failed stopping might indicate a total mess.
+    conn_.disconnect();
+    throw;
+  }
+}
+
+DMITIGR_PGFE_INLINE bool Replication_stream::is_stopped() const noexcept
+{
+  return is_stopped_;
+}
+
+DMITIGR_PGFE_INLINE void Replication_stream::send_status__(const bool reply_requested)
+{
+  using std::chrono::duration_cast;
+  using std::chrono::microseconds;
+  using std::chrono::system_clock;
+
+  // Microseconds between the Unix epoch and the PostgreSQL epoch (2000-01-01).
+  constexpr std::int64_t pg_epoch_offset{946684800000000};
+  const auto now = duration_cast<microseconds>(
+    system_clock::now().time_since_epoch()).count() - pg_epoch_offset;
+
+  // Standby status update: written, flushed and applied LSNs, time and flag.
+  char message[34];
+  message[0] = 'r';
+  detail::write_replication_uint64(message + 1,
+    std::max(received_lsn_, confirmed_lsn_));
+  detail::write_replication_uint64(message + 9, confirmed_lsn_);
+  detail::write_replication_uint64(message + 17, confirmed_lsn_);
+  detail::write_replication_uint64(message + 25, static_cast<std::uint64_t>(now));
+  message[33] = reply_requested;
+  copier_.send(std::string_view{message, sizeof(message)});
+  flush__();
+  last_status_time_ = Clock::now();
+}
+
+DMITIGR_PGFE_INLINE void Replication_stream::flush__()
+{
+  while (true) {
+    const int r{PQflush(conn_.conn())};
+    if (!r)
+      break;
+    else if (r < 0)
+      throw Generic_exception{conn_.error_message()};
+    conn_.wait_socket_readiness(Socket_readiness::write_ready);
+  }
+}
+
+} // namespace dmitigr::pgfe
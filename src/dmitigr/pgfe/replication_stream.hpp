@@ -0,0 +1,228 @@
+// -*- C++ -*-
+//
+// Copyright 2023 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DMITIGR_PGFE_REPLICATION_STREAM_HPP
+#define DMITIGR_PGFE_REPLICATION_STREAM_HPP
+
+#include "basics.hpp"
+#include "copier.hpp"
+#include "dll.hpp"
+#include "pgoutput_message.hpp"
+#include "types_fwd.hpp"
+
+#include <chrono>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace dmitigr::pgfe {
+
+/**
+ * @ingroup utilities
+ *
+ * @returns The LSN parsed from the textual representation `str` (such as
+ * `16/B374D848`), or `std::nullopt` if `str` is malformed.
+ */
+DMITIGR_PGFE_API std::optional<Lsn> to_lsn(std::string_view str) noexcept;
+
+/**
+ * @ingroup utilities
+ *
+ * @returns The textual representation of `lsn`.
+ */
+DMITIGR_PGFE_API std::string to_lsn_string(Lsn lsn);
+
+/**
+ * @ingroup main
+ *
+ * @brief A consumer of the logical replication stream of the `pgoutput`
+ * plugin.
+ *
+ * @details The stream is started by `START_REPLICATION` command on the
+ * connection in the logical replication mode, after which the server pushes
+ * the changes through the `COPY BOTH` sub-protocol. The messages received
+ * are decoded into Pgoutput_message which refers to the received bytes
+ * directly. The keepalive messages of the server are handled transparently,
+ * and the standby status updates are sent to the server automatically, both
+ * periodically and upon the server request.
+ *
+ * Example:
+ * @code
+ * pgfe::Connection conn{pgfe::Connection_options{}
+ *   .set(pgfe::Replication_mode::logical)...};
+ * conn.connect();
+ * pgfe::Replication_stream stream{conn, "slot", "publication"};
+ * while (true) {
+ *   const auto& message = stream.receive();
+ *   handle(message);
+ *   if (message.type() == pgfe::Pgoutput_message_type::commit)
+ *     stream.confirm(message.end_lsn());
+ * }
+ * @endcode
+ *
+ * @remarks The slot must be created beforehand, for example, by
+ * `select pg_create_logical_replication_slot('slot', 'pgoutput')`.
+ */
+class Replication_stream final {
+public:
+  /**
+   * @brief Stops the stream if it's not stopped yet.
+   *
+   * @details If the stopping fails, closes the connection.
+   *
+   * @see stop().
+   */
+  DMITIGR_PGFE_API ~Replication_stream() noexcept;
+
+  /// Not copy-constructible.
+  Replication_stream(const Replication_stream&) = delete;
+
+  /// Not copy-assignable.
+  Replication_stream& operator=(const Replication_stream&) = delete;
+
+  /// Not move-constructible.
+  Replication_stream(Replication_stream&&) = delete;
+
+  /// Not move-assignable.
+  Replication_stream& operator=(Replication_stream&&) = delete;
+
+  /**
+   * @brief Starts the streaming of changes from the replication slot.
+   *
+   * @param conn A connection to use.
+   * @param slot A name of the logical replication slot.
+   * @param publications A comma-separated list of the names of publications.
+   * @param start_lsn A LSN to start the streaming from. The value of `0`
+   * means the confirmed position of the slot.
+   * @param protocol_version A version of the logical replication protocol.
+   *
+   * @par Requires
+   * `conn.is_ready_for_request() && conn.options().replication_mode() ==
+   * Replication_mode::logical && !slot.empty() && !publications.empty()`.
+   *
+   * @par Exception safety guarantee
+   * Basic.
+   */
+  DMITIGR_PGFE_API Replication_stream(Connection& conn, std::string_view slot,
+    std::string_view publications, Lsn start_lsn = 0, int protocol_version = 1);
+
+  /// @returns The connection of this stream.
+  DMITIGR_PGFE_API Connection& connection() noexcept;
+
+  /**
+   * @brief Receives the next message.
+   *
+   * @param timeout A maximum amount of time to wait for the message. The
+   * value of `std::nullopt` means *eternity*.
+   *
+   * @returns The message, or invalid instance if either the timeout expired
+   * or `is_stopped()`. The returned message is valid until the next call of
+   * this method.
+   *
+   * @par Requires
+   * `!timeout || timeout->count() >= 0`.
+   *
+   * @par Effects
+   * The standby status update is sent to the server if either the server
+   * requested it or status_interval() passed since the last update.
+   *
+   * @par Exception safety guarantee
+   * Basic.
+   */
+  DMITIGR_PGFE_API const Pgoutput_message&
+  receive(std::optional<std::chrono::milliseconds> timeout = std::nullopt);
+
+  /**
+   * @brief Confirms that the changes up to `lsn` are applied, so the server
+   * can remove the WAL not needed anymore.
+   *
+   * @details The confirmation is reported to the server by the next standby
+   * status update.
+   *
+   * @see send_status().
+   */
+  DMITIGR_PGFE_API void confirm(Lsn lsn) noexcept;
+
+  /// @returns The last confirmed LSN.
+  DMITIGR_PGFE_API Lsn confirmed_lsn() const noexcept;
+
+  /// @returns The LSN of the start of the last received WAL data.
+  DMITIGR_PGFE_API Lsn received_lsn() const noexcept;
+
+  /**
+   * @brief Sets the interval of the standby status updates.
+   *
+   * @par Requires
+   * `interval.count() > 0`.
+   */
+  DMITIGR_PGFE_API void set_status_interval(std::chrono::milliseconds interval);
+
+  /// @returns The interval of the standby status updates.
+  DMITIGR_PGFE_API std::chrono::milliseconds status_interval() const noexcept;
+
+  /**
+   * @brief Sends the standby status update to the server immediately.
+   *
+   * @param reply_requested Indicates if the server should reply immediately.
+   *
+   * @par Requires
+   * `!is_stopped()`.
+   */
+  DMITIGR_PGFE_API void send_status(bool reply_requested = false);
+
+  /**
+   * @brief Stops the streaming.
+   *
+   * @details Sends the final standby status update and the end-of-data
+   * indication to the server, discards the messages in flight and waits for
+   * the completion of the `START_REPLICATION` command. If the stopping fails,
+   * closes the connection, since failed stopping might indicate a total mess.
+   *
+   * @par Effects
+   * `is_stopped()`. The connection is ready for request again.
+   *
+   * @par Exception safety guarantee
+   * Basic.
+   */
+  DMITIGR_PGFE_API void stop();
+
+  /// @returns `true` if the stream is stopped.
+  DMITIGR_PGFE_API bool is_stopped() const noexcept;
+
+private:
+  using Clock = std::chrono::steady_clock;
+
+  Connection& conn_;
+  Copier copier_;
+  Pgoutput_message message_;
+  Lsn received_lsn_{};
+  Lsn confirmed_lsn_{};
+  std::chrono::milliseconds status_interval_{10000};
+  Clock::time_point last_status_time_{};
+  bool is_server_done_{};
+  bool is_stopped_{};
+
+  void send_status__(bool reply_requested);
+  void flush__();
+};
+
+} // namespace dmitigr::pgfe
+
+#ifndef DMITIGR_PGFE_NOT_HEADER_ONLY
+#include "replication_stream.cpp"
+#endif
+
+#endif  // DMITIGR_PGFE_REPLICATION_STREAM_HPP
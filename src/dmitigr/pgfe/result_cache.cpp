@@ -0,0 +1,369 @@
+// -*- C++ -*-
+//
+// Copyright 2023 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "../base/assert.hpp"
+#include "exceptions.hpp"
+#include "notification.hpp"
+#include "result_cache.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <new>
+
+namespace dmitigr::pgfe {
+
+namespace detail {
+
+inline void append_result_cache_value(std::string& result,
+  const std::int32_t size, const void* const bytes = nullptr)
+{
+  char prefix[sizeof(size)];
+  std::memcpy(prefix, &size, sizeof(size));
+  result.append(prefix, sizeof(prefix));
+  if (size > 0)
+    result.append(static_cast<const char*>(bytes), static_cast<std::size_t>(size));
+}
+
+inline std::int32_t read_result_cache_value_size(const char* const bytes) noexcept
+{
+  std::int32_t result;
+  std::memcpy(&result, bytes, sizeof(result));
+  return result;
+}
+
+} // namespace detail
+
+// -----------------------------------------------------------------------------
+// Result_cache::Builder
+// -----------------------------------------------------------------------------
+
+DMITIGR_PGFE_INLINE
+Result_cache::Builder::Builder(const std::size_t capacity) noexcept
+  : capacity_{capacity}
+{}
+
+DMITIGR_PGFE_INLINE void Result_cache::Builder::append(const Row& row)
+{
+  if (is_overflowed_)
+    return;
+
+  const auto& info = row.info();
+  if (!attributes_) {
+    attributes_ = detail::pq::Result{PQcopyResult(
+        info.pq_result_.native_handle(), PG_COPYRES_ATTRS)};
+    if (!attributes_)
+      throw std::bad_alloc{};
+  }
+
+  const std::size_t field_count{info.field_count()};
+  for (std::size_t i{}; i < field_count; ++i) {
+    if (const auto data = row.data(i))
+      detail::append_result_cache_value(values_,
+        static_cast<std::int32_t>(data.size()), data.bytes());
+    else
+      detail::append_result_cache_value(values_, -1);
+  }
+  ++row_count_;
+
+  if (values_.size() > capacity_) {
+    // Will not fit anyway.
+    is_overflowed_ = true;
+    values_ = {};
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Result_cache
+// -----------------------------------------------------------------------------
+
+DMITIGR_PGFE_INLINE Result_cache::Result_cache(const std::size_t capacity,
+  const std::chrono::milliseconds ttl)
+  : capacity_{capacity}
+  , ttl_{ttl}
+{
+  if (!capacity_)
+    throw Generic_exception{"cannot create result cache: invalid capacity"};
+  else if (ttl_.count() <= 0)
+    throw Generic_exception{"cannot create result cache: invalid TTL"};
+}
+
+DMITIGR_PGFE_INLINE std::size_t Result_cache::capacity() const noexcept
+{
+  return capacity_;
+}
+
+DMITIGR_PGFE_INLINE std::chrono::milliseconds Result_cache::ttl() const noexcept
+{
+  return ttl_;
+}
+
+DMITIGR_PGFE_INLINE std::size_t Result_cache::size() const noexcept
+{
+  const std::lock_guard lg{mutex_};
+  return slots_.size();
+}
+
+DMITIGR_PGFE_INLINE bool Result_cache::is_empty() const noexcept
+{
+  return !size();
+}
+
+DMITIGR_PGFE_INLINE std::size_t Result_cache::memory_usage() const noexcept
+{
+  const std::lock_guard lg{mutex_};
+  return memory_usage_;
+}
+
+DMITIGR_PGFE_INLINE std::size_t Result_cache::hit_count() const noexcept
+{
+  const std::lock_guard lg{mutex_};
+  return hit_count_;
+}
+
+DMITIGR_PGFE_INLINE std::size_t Result_cache::miss_count() const noexcept
+{
+  const std::lock_guard lg{mutex_};
+  return miss_count_;
+}
+
+DMITIGR_PGFE_INLINE void Result_cache::map_table(std::string table,
+  std::string channel)
+{
+  if (table.empty())
+    throw Generic_exception{"cannot map table to channel: empty table name"};
+  else if (channel.empty())
+    throw Generic_exception{"cannot map table to channel: empty channel name"};
+
+  const std::lock_guard lg{mutex_};
+  const auto [b, e] = channel_tables_.equal_range(channel);
+  if (std::none_of(b, e, [&table](const auto& p){return p.second == table;}))
+    channel_tables_.emplace(std::move(channel), std::move(table));
+}
+
+DMITIGR_PGFE_INLINE void Result_cache::listen(Connection& conn)
+{
+  if (!conn.is_ready_for_request())
+    throw Generic_exception{"cannot listen for invalidation of result cache: "
+      "not ready for request"};
+
+  std::vector<std::string> channels;
+  {
+    const std::lock_guard lg{mutex_};
+    for (auto i = cbegin(channel_tables_); i != cend(channel_tables_);
+         i = channel_tables_.upper_bound(i->first))
+      channels.push_back(i->first);
+  }
+  for (const auto& channel : channels) {
+    Statement listen{R"(listen :"channel")"};
+    listen.bind("channel", channel);
+    conn.execute(listen);
+  }
+
+  conn.set_notification_handler([this, handler = conn.notification_handler()]
+    (Notification&& notification)
+  {
+    handle_notification(notification);
+    if (handler)
+      handler(std::move(notification));
+  });
+}
+
+DMITIGR_PGFE_INLINE void
+Result_cache::handle_notification(const Notification& notification)
+{
+  invalidate(notification.channel_name());
+}
+
+DMITIGR_PGFE_INLINE std::size_t Result_cache::invalidate(const std::string_view name)
+{
+  const std::lock_guard lg{mutex_};
+  ++generation_;
+  const auto [tb, te] = channel_tables_.equal_range(name);
+  const auto is_dependent = [name, tb = tb, te = te](const std::string& dependency)
+  {
+    return dependency == name || std::any_of(tb, te, [&dependency](const auto& p)
+    {
+      return p.second == dependency;
+    });
+  };
+
+  std::size_t result{};
+  for (auto i = begin(slots_); i != end(slots_);) {
+    const auto& dependencies = i->second.entry->dependencies;
+    if (std::any_of(cbegin(dependencies), cend(dependencies), is_dependent)) {
+      erase__(i++);
+      ++result;
+    } else
+      ++i;
+  }
+  return result;
+}
+
+DMITIGR_PGFE_INLINE void Result_cache::clear() noexcept
+{
+  const std::lock_guard lg{mutex_};
+  ++generation_;
+  slots_.clear();
+  lru_.clear();
+  memory_usage_ = 0;
+}
+
+DMITIGR_PGFE_INLINE std::string Result_cache::make_key(const Connection& conn,
+  const std::string& query, const std::unique_ptr<Data>* const values,
+  const std::size_t value_count)
+{
+  /*
+   * The cache can be shared by the connections to the different servers,
+   * and the rows are cached in the format requested by the connection.
+   */
+  std::string result{conn.server_identity__()};
+  result.push_back('\0');
+  result.push_back(conn.result_format() == Data_format::binary ? 'b' : 't');
+  result.append(query);
+  for (std::size_t i{}; i < value_count; ++i) {
+    if (const auto& value = values[i]) {
+      result.push_back(value->format() == Data_format::binary ? 'b' : 't');
+      detail::append_result_cache_value(result,
+        static_cast<std::int32_t>(value->size()), value->bytes());
+    } else {
+      result.push_back('n');
+      detail::append_result_cache_value(result, -1);
+    }
+  }
+  return result;
+}
+
+DMITIGR_PGFE_INLINE auto Result_cache::find(const std::string& key)
+  -> std::shared_ptr<const Entry>
+{
+  const std::lock_guard lg{mutex_};
+  if (const auto i = slots_.find(key); i != end(slots_)) {
+    if (i->second.entry->expiration > Clock::now()) {
+      lru_.splice(begin(lru_), lru_, i->second.lru);
+      ++hit_count_;
+      return i->second.entry;
+    } else
+      erase__(i);
+  }
+  ++miss_count_;
+  return nullptr;
+}
+
+DMITIGR_PGFE_INLINE std::uint64_t Result_cache::generation() const noexcept
+{
+  const std::lock_guard lg{mutex_};
+  return generation_;
+}
+
+DMITIGR_PGFE_INLINE void Result_cache::insert(std::string key,
+  const Dependencies& dependencies, Builder&& builder,
+  const std::string_view completion_tag, const std::uint64_t generation)
+{
+  if (builder.is_overflowed_)
+    return;
+
+  auto entry = std::make_shared<Entry>();
+  entry->attributes = std::move(builder.attributes_);
+  entry->values = std::move(builder.values_);
+  entry->row_count = builder.row_count_;
+  entry->completion_tag = completion_tag;
+  entry->dependencies = dependencies;
+  entry->expiration = Clock::now() + ttl_;
+
+  // Approximately: the key is stored twice, plus the attributes.
+  std::size_t memory{sizeof(Entry) + sizeof(Slot) + 2*key.size() +
+    entry->values.size() + entry->completion_tag.size()};
+  if (entry->attributes)
+    memory += 64 * static_cast<std::size_t>(entry->attributes.field_count());
+  for (const auto& dependency : entry->dependencies)
+    memory += sizeof(dependency) + dependency.size();
+  if (memory > capacity_)
+    return;
+
+  const std::lock_guard lg{mutex_};
+  if (generation != generation_)
+    return; // the result might be stale
+  else if (const auto i = slots_.find(key); i != end(slots_))
+    erase__(i);
+  while (memory_usage_ + memory > capacity_) {
+    DMITIGR_ASSERT(!lru_.empty());
+    const auto i = slots_.find(lru_.back());
+    DMITIGR_ASSERT(i != end(slots_));
+    erase__(i);
+  }
+  lru_.push_front(key);
+  try {
+    slots_.emplace(std::move(key), Slot{std::move(entry), begin(lru_), memory});
+  } catch (...) {
+    lru_.pop_front();
+    throw;
+  }
+  memory_usage_ += memory;
+}
+
+DMITIGR_PGFE_INLINE void Result_cache::for_each_row(const Entry& entry,
+  const std::function<void(Row&&)>& callback) const
+{
+  if (!entry.row_count)
+    return;
+
+  DMITIGR_ASSERT(entry.attributes);
+  const auto& attrs = entry.attributes;
+  const int field_count{attrs.field_count()};
+  std::vector<PGresAttDesc> attributes;
+  attributes.reserve(static_cast<std::size_t>(field_count));
+  for (int f{}; f < field_count; ++f) {
+    attributes.push_back(PGresAttDesc{
+      const_cast<char*>(attrs.field_name(f)),
+      attrs.field_table_oid(f),
+      attrs.field_table_column(f),
+      detail::pq::to_int(attrs.field_format(f)),
+      attrs.field_type_oid(f),
+      attrs.field_type_size(f),
+      attrs.field_type_modifier(f)});
+  }
+
+  const char* bytes{entry.values.data()};
+  for (std::size_t r{}; r < entry.row_count; ++r) {
+    // Note, Row requires the result of PGRES_SINGLE_TUPLE status.
+    detail::pq::Result result{PQmakeEmptyPGresult(nullptr, PGRES_SINGLE_TUPLE)};
+    if (!result || !result.set_attributes(attributes.data(), field_count))
+      throw std::bad_alloc{};
+    for (int f{}; f < field_count; ++f) {
+      const auto size = detail::read_result_cache_value_size(bytes);
+      bytes += sizeof(size);
+      if (!PQsetvalue(const_cast<PGresult*>(result.native_handle()), 0, f,
+          const_cast<char*>(bytes), size))
+        throw std::bad_alloc{};
+      if (size > 0)
+        bytes += size;
+    }
+    callback(Row{std::move(result)});
+  }
+  DMITIGR_ASSERT(bytes == entry.values.data() + entry.values.size());
+}
+
+DMITIGR_PGFE_INLINE void
+Result_cache::erase__(const std::unordered_map<std::string, Slot>::iterator i) noexcept
+{
+  DMITIGR_ASSERT(memory_usage_ >= i->second.memory);
+  memory_usage_ -= i->second.memory;
+  lru_.erase(i->second.lru);
+  slots_.erase(i);
+}
+
+} // namespace dmitigr::pgfe
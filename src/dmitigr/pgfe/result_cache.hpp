@@ -0,0 +1,303 @@
+// -*- C++ -*-
+//
+// Copyright 2023 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DMITIGR_PGFE_RESULT_CACHE_HPP
+#define DMITIGR_PGFE_RESULT_CACHE_HPP
+
+#include "completion.hpp"
+#include "connection.hpp"
+#include "conversions_api.hpp"
+#include "data.hpp"
+#include "dll.hpp"
+#include "pq.hpp"
+#include "row.hpp"
+#include "statement.hpp"
+#include "types_fwd.hpp"
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace dmitigr::pgfe {
+
+/**
+ * @ingroup utilities
+ *
+ * @brief A thread-safe client-side cache of the results of queries.
+ *
+ * @details The results are keyed by the server identity (the host, port,
+ * database, user and server version), the result format of the connection,
+ * the query string and the values of the parameters. Thus, the cache can be
+ * shared by the connections to different servers. The rows of the results are stored compactly, and the cache
+ * hits are served without a round-trip to the server. The entries are evicted
+ * when either the time-to-live expires, or the memory consumption exceeds the
+ * capacity (the least recently used entries are evicted first), or upon the
+ * invalidation.
+ *
+ * Each entry may depend on the names of tables or notification channels. The
+ * entries are invalidated by invalidate() which can be invoked either directly
+ * or upon the notification (see listen() and handle_notification()). The
+ * notification on the channel invalidates the entries which depend either on
+ * the channel or on the tables mapped to the channel by map_table().
+ *
+ * Example:
+ * @code
+ * pgfe::Result_cache cache{16*1024*1024, std::chrono::minutes{5}};
+ * cache.map_table("country", "country_changed");
+ * cache.listen(conn);
+ * cache.execute(conn, {"country"}, [](auto&& row)
+ * {
+ *   // Handle the row.
+ * }, "select * from country where code = $1", code);
+ * @endcode
+ *
+ * @remarks The cache is intended for the results of queries to the tables
+ * which are rarely changed.
+ */
+class Result_cache final {
+public:
+  /// A clock.
+  using Clock = std::chrono::steady_clock;
+
+  /// A list of names of the tables or channels the result depends on.
+  using Dependencies = std::vector<std::string>;
+
+  /// Not copy-constructible.
+  Result_cache(const Result_cache&) = delete;
+
+  /// Not copy-assignable.
+  Result_cache& operator=(const Result_cache&) = delete;
+
+  /// Not move-constructible.
+  Result_cache(Result_cache&&) = delete;
+
+  /// Not move-assignable.
+  Result_cache& operator=(Result_cache&&) = delete;
+
+  /**
+   * @brief The constructor.
+   *
+   * @param capacity The maximum memory consumption in bytes.
+   * @param ttl The time-to-live of the entries.
+   *
+   * @par Requires
+   * `capacity > 0 && ttl.count() > 0`.
+   */
+  DMITIGR_PGFE_API Result_cache(std::size_t capacity,
+    std::chrono::milliseconds ttl);
+
+  /// @returns The maximum memory consumption in bytes.
+  DMITIGR_PGFE_API std::size_t capacity() const noexcept;
+
+  /// @returns The time-to-live of the entries.
+  DMITIGR_PGFE_API std::chrono::milliseconds ttl() const noexcept;
+
+  /// @returns The number of entries.
+  DMITIGR_PGFE_API std::size_t size() const noexcept;
+
+  /// @returns `!size()`.
+  DMITIGR_PGFE_API bool is_empty() const noexcept;
+
+  /// @returns The approximate memory consumption in bytes.
+  DMITIGR_PGFE_API std::size_t memory_usage() const noexcept;
+
+  /// @returns The number of cache hits.
+  DMITIGR_PGFE_API std::size_t hit_count() const noexcept;
+
+  /// @returns The number of cache misses.
+  DMITIGR_PGFE_API std::size_t miss_count() const noexcept;
+
+  /**
+   * @brief Maps the `table` to the notification `channel`.
+   *
+   * @par Requires
+   * `!table.empty() && !channel.empty()`.
+   */
+  DMITIGR_PGFE_API void map_table(std::string table, std::string channel);
+
+  /**
+   * @brief Executes `LISTEN` for each channel specified by map_table() and
+   * sets the notification handler which calls handle_notification() and
+   * then the previous handler of `conn`, if any.
+   *
+   * @par Requires
+   * `conn.is_ready_for_request()`.
+   *
+   * @remarks The notifications are handled only upon the input is processed
+   * by `conn`.
+   *
+   * @warning This instance must outlive the notification handler of `conn`.
+   */
+  DMITIGR_PGFE_API void listen(Connection& conn);
+
+  /// Calls `invalidate(notification.channel_name())`.
+  DMITIGR_PGFE_API void handle_notification(const Notification& notification);
+
+  /**
+   * @brief Erases the entries which depend either on `name` or on the tables
+   * mapped to the channel `name`.
+   *
+   * @returns The number of entries erased.
+   */
+  DMITIGR_PGFE_API std::size_t invalidate(std::string_view name);
+
+  /// Erases all the entries.
+  DMITIGR_PGFE_API void clear() noexcept;
+
+  /**
+   * @brief Executes the `statement`, or serves the rows from the cache.
+   *
+   * @param conn A connection to execute the `statement` on cache miss.
+   * @param dependencies A names of tables or channels the result depends on.
+   * @param callback A callback which is called for each row.
+   * @param statement A statement to execute.
+   * @param parameters Parameters to bind with a parameterized `statement`.
+   *
+   * @par Requires
+   * `callback` must be invocable with `Row&&`.
+   *
+   * @returns The completion of the `statement`.
+   *
+   * @remarks The result is cached only if the whole result fits in capacity(),
+   * and neither invalidate() nor clear() is called while the `statement` is
+   * being executed (since the result might be stale).
+   */
+  template<typename F, typename ... Types>
+  Completion execute(Connection& conn, const Dependencies& dependencies,
+    F&& callback, const Statement& statement, Types&& ... parameters)
+  {
+    static_assert(std::is_invocable_v<F, Row&&>,
+      "callback must be invocable with Row&&");
+
+    std::array<std::unique_ptr<Data>, sizeof...(Types)> values{
+      to_data(std::forward<Types>(parameters))...};
+    auto key = make_key(conn, statement.to_query_string(conn),
+      values.data(), values.size());
+    if (const auto entry = find(key)) {
+      for_each_row(*entry, [&callback](Row&& row)
+      {
+        callback(std::move(row));
+      });
+      return Completion{entry->completion_tag};
+    }
+
+    // The result is not cached if invalidated while being executed.
+    const auto generation = this->generation();
+    Builder builder{capacity_};
+    auto completion = execute__(conn, [&builder, &callback](Row&& row)
+    {
+      builder.append(row);
+      callback(std::move(row));
+    }, statement, values, std::make_index_sequence<sizeof...(Types)>{});
+    insert(std::move(key), dependencies, std::move(builder), completion.tag(),
+      generation);
+    return completion;
+  }
+
+  /// @overload
+  template<typename F, typename ... Types>
+  std::enable_if_t<std::is_invocable_v<F, Row&&>, Completion>
+  execute(Connection& conn, F&& callback, const Statement& statement,
+    Types&& ... parameters)
+  {
+    return execute(conn, Dependencies{}, std::forward<F>(callback), statement,
+      std::forward<Types>(parameters)...);
+  }
+
+private:
+  /// An entry.
+  struct Entry final {
+    detail::pq::Result attributes; // invalid if there are no rows
+    std::string values; // the length-prefixed values of the rows
+    std::size_t row_count{};
+    std::string completion_tag;
+    Dependencies dependencies;
+    Clock::time_point expiration;
+  };
+
+  /// A builder of the entry from the rows.
+  class Builder final {
+  public:
+    explicit DMITIGR_PGFE_API Builder(std::size_t capacity) noexcept;
+    DMITIGR_PGFE_API void append(const Row& row);
+
+  private:
+    friend Result_cache;
+
+    std::size_t capacity_{};
+    detail::pq::Result attributes_;
+    std::string values_;
+    std::size_t row_count_{};
+    bool is_overflowed_{};
+  };
+
+  /// A slot of the entry.
+  struct Slot final {
+    std::shared_ptr<const Entry> entry;
+    std::list<std::string>::iterator lru;
+    std::size_t memory{};
+  };
+
+  mutable std::mutex mutex_;
+  std::size_t capacity_{};
+  std::chrono::milliseconds ttl_{};
+  std::size_t memory_usage_{};
+  std::size_t hit_count_{};
+  std::size_t miss_count_{};
+  std::unordered_map<std::string, Slot> slots_;
+  std::list<std::string> lru_; // the most recently used first
+  std::multimap<std::string, std::string, std::less<>> channel_tables_;
+  std::uint64_t generation_{}; // incremented upon each invalidation
+
+  static DMITIGR_PGFE_API std::string make_key(const Connection& conn,
+    const std::string& query, const std::unique_ptr<Data>* values,
+    std::size_t value_count);
+  DMITIGR_PGFE_API std::shared_ptr<const Entry> find(const std::string& key);
+  DMITIGR_PGFE_API std::uint64_t generation() const noexcept;
+  DMITIGR_PGFE_API void insert(std::string key, const Dependencies& dependencies,
+    Builder&& builder, std::string_view completion_tag, std::uint64_t generation);
+  DMITIGR_PGFE_API void for_each_row(const Entry& entry,
+    const std::function<void(Row&&)>& callback) const;
+  void erase__(std::unordered_map<std::string, Slot>::iterator i) noexcept;
+
+  template<typename F, typename V, std::size_t ... I>
+  static Completion execute__(Connection& conn, F&& callback,
+    const Statement& statement, V& values, std::index_sequence<I...>)
+  {
+    return conn.execute(std::forward<F>(callback), statement,
+      std::move(values[I])...);
+  }
+};
+
+} // namespace dmitigr::pgfe
+
+#ifndef DMITIGR_PGFE_NOT_HEADER_ONLY
+#include "result_cache.cpp"
+#endif
+
+#endif  // DMITIGR_PGFE_RESULT_CACHE_HPP
@@ -0,0 +1,184 @@
+// -*- C++ -*-
+//
+// Copyright 2023 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "exceptions.hpp"
+#include "result_set.hpp"
+
+#include <new>
+
+namespace dmitigr::pgfe {
+
+DMITIGR_PGFE_INLINE void Result_set::swap(Result_set& rhs) noexcept
+{
+  using std::swap;
+  swap(info_, rhs.info_);
+  swap(row_count_, rhs.row_count_);
+  swap(reserved_row_count_, rhs.reserved_row_count_);
+  swap(bytes_, rhs.bytes_);
+  swap(offsets_, rhs.offsets_);
+  swap(nulls_, rhs.nulls_);
+}
+
+DMITIGR_PGFE_INLINE void Result_set::append(const Row& row)
+{
+  if (!row.is_valid())
+    throw Generic_exception{"cannot append invalid row to result set"};
+
+  const auto& row_info = row.info();
+  const auto& row_result = row_info.pq_result_;
+  const int field_count{row_result.field_count()};
+  if (info_) {
+    const auto& result = info_.pq_result_;
+    bool is_compatible{field_count == result.field_count()};
+    for (int i{}; is_compatible && i < field_count; ++i)
+      is_compatible = row_result.field_type_oid(i) == result.field_type_oid(i);
+    if (!is_compatible)
+      throw Generic_exception{"cannot append row to result set: "
+        "incompatible row description"};
+  }
+
+  // Rollback on exception to provide the strong guarantee.
+  const auto bytes_size = bytes_.size();
+  const auto offsets_size = offsets_.size();
+  const auto nulls_size = nulls_.size();
+  try {
+    if (!info_) {
+      Row_info info{detail::pq::Result{PQcopyResult(row_result.native_handle(),
+        PG_COPYRES_ATTRS)}};
+      if (!info)
+        throw std::bad_alloc{};
+      const auto value_count = static_cast<std::size_t>(field_count) *
+        reserved_row_count_;
+      offsets_.reserve(value_count + 1);
+      nulls_.reserve(value_count);
+      offsets_.push_back(0);
+      info_ = std::move(info);
+    }
+
+    constexpr int rowi{};
+    for (int i{}; i < field_count; ++i) {
+      const bool is_null{row_result.is_data_null(rowi, i)};
+      if (!is_null)
+        bytes_.append(row_result.data_value(rowi, i),
+          static_cast<std::size_t>(row_result.data_size(rowi, i)));
+      bytes_.push_back('\0');
+      offsets_.push_back(bytes_.size());
+      nulls_.push_back(is_null);
+    }
+  } catch (...) {
+    bytes_.resize(bytes_size);
+    offsets_.resize(offsets_size);
+    nulls_.resize(nulls_size);
+    if (!row_count_) {
+      info_ = {};
+      offsets_.clear();
+    }
+    throw;
+  }
+  ++row_count_;
+}
+
+DMITIGR_PGFE_INLINE std::size_t Result_set::row_count() const noexcept
+{
+  return row_count_;
+}
+
+DMITIGR_PGFE_INLINE bool Result_set::is_empty() const noexcept
+{
+  return !row_count();
+}
+
+DMITIGR_PGFE_INLINE std::size_t Result_set::field_count() const noexcept
+{
+  return info_ ? info_.field_count() : 0;
+}
+
+DMITIGR_PGFE_INLINE const Row_info& Result_set::info() const noexcept
+{
+  return info_;
+}
+
+DMITIGR_PGFE_INLINE Data_view Result_set::data(const std::size_t row,
+  const std::size_t field) const
+{
+  const std::size_t fc{field_count()};
+  if (!(row < row_count_ && field < fc))
+    throw Generic_exception{"cannot get field data of result set"};
+
+  const std::size_t index{row*fc + field};
+  if (nulls_[index])
+    return Data_view{};
+
+  const auto offset = offsets_[index];
+  const auto size = offsets_[index + 1] - offset - 1; // exclude '\0'
+  return Data_view{bytes_.data() + offset, size,
+    info_.pq_result_.field_format(static_cast<int>(field))};
+}
+
+DMITIGR_PGFE_INLINE Data_view Result_set::data(const std::size_t row,
+  const std::string_view name, const std::size_t offset) const
+{
+  return data(row, info_ ? info_.field_index(name, offset) : 0);
+}
+
+DMITIGR_PGFE_INLINE auto Result_set::row(const std::size_t index) const
+  -> Row_view
+{
+  if (!(index < row_count_))
+    throw Generic_exception{"cannot get row of result set"};
+  return Row_view{this, index};
+}
+
+DMITIGR_PGFE_INLINE void Result_set::reserve(const std::size_t row_count,
+  const std::size_t byte_count)
+{
+  bytes_.reserve(byte_count + row_count*field_count());
+  if (info_) {
+    const std::size_t value_count{row_count*field_count()};
+    offsets_.reserve(value_count + 1);
+    nulls_.reserve(value_count);
+  } else
+    reserved_row_count_ = row_count;
+}
+
+DMITIGR_PGFE_INLINE void Result_set::shrink_to_fit()
+{
+  bytes_.shrink_to_fit();
+  offsets_.shrink_to_fit();
+  nulls_.shrink_to_fit();
+}
+
+DMITIGR_PGFE_INLINE void Result_set::clear() noexcept
+{
+  info_ = {};
+  row_count_ = 0;
+  reserved_row_count_ = 0;
+  bytes_.clear();
+  offsets_.clear();
+  nulls_.clear();
+}
+
+DMITIGR_PGFE_INLINE std::size_t Result_set::memory_usage() const noexcept
+{
+  std::size_t result{sizeof(*this) + bytes_.capacity() +
+    offsets_.capacity()*sizeof(decltype(offsets_)::value_type) +
+    nulls_.capacity()/8};
+  if (info_)
+    result += 64 * info_.field_count(); // approximately
+  return result;
+}
+
+} // namespace dmitigr::pgfe
@@ -0,0 +1,415 @@
+// -*- C++ -*-
+//
+// Copyright 2023 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DMITIGR_PGFE_RESULT_SET_HPP
+#define DMITIGR_PGFE_RESULT_SET_HPP
+
+#include "../base/assert.hpp"
+#include "composite.hpp"
+#include "conversions_api.hpp"
+#include "data.hpp"
+#include "dll.hpp"
+#include "exceptions.hpp"
+#include "row.hpp"
+#include "row_info.hpp"
+#include "types_fwd.hpp"
+
+#include <cstddef>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace dmitigr::pgfe {
+
+/**
+ * @ingroup main
+ *
+ * @brief A compact in-memory store of the rows of the same description.
+ *
+ * @details Unlike of `std::vector<Row>`, where each element owns a separate
+ * `PGresult`, the data of the appended rows is copied into a single row-major
+ * arena. The description of the rows (Row_info) is shared, and the positions
+ * of the values in the arena are kept in the offset table. Thus, the memory
+ * consumption is close to the size of the data itself (plus one byte of the
+ * terminator and the offset per field).
+ *
+ * Example:
+ * @code
+ * pgfe::Result_set rows;
+ * conn.execute([&rows](auto&& row){rows.append(row);},
+ *   "select id, name from person");
+ * for (const auto name : rows.column<std::string_view>("name"))
+ *   std::cout << name << std::endl;
+ * @endcode
+ */
+class Result_set final {
+public:
+  /**
+   * @brief A view of the row of the result set.
+   *
+   * @warning The view is invalidated by the operations which modify the
+   * result set.
+   */
+  class Row_view final : public Composite {
+  public:
+    /// Default-constructible. (Constructs invalid instance.)
+    Row_view() = default;
+
+    /// @returns `true` if the instance is valid.
+    bool is_valid() const noexcept
+    {
+      return static_cast<bool>(set_);
+    }
+
+    /// @returns `true` if the instance is valid.
+    explicit operator bool() const noexcept
+    {
+      return is_valid();
+    }
+
+    /// @returns The index of this row in the result set.
+    std::size_t index() const noexcept
+    {
+      return index_;
+    }
+
+    /// @see Compositional::field_count().
+    std::size_t field_count() const noexcept override
+    {
+      return set_->field_count();
+    }
+
+    /// @see Compositional::is_empty().
+    bool is_empty() const noexcept override
+    {
+      return !field_count();
+    }
+
+    /// @see Compositional::field_name().
+    std::string_view field_name(const std::size_t index) const override
+    {
+      return set_->info().field_name(index);
+    }
+
+    /// @see Compositional::field_index().
+    std::size_t field_index(const std::string_view name,
+      const std::size_t offset = 0) const noexcept override
+    {
+      return set_->info().field_index(name, offset);
+    }
+
+    /// @see Composite::data().
+    Data_view data(const std::size_t index = 0) const override
+    {
+      return set_->data(index_, index);
+    }
+
+    /// @see Composite::data().
+    Data_view data(const std::string_view name,
+      const std::size_t offset = 0) const override
+    {
+      return set_->data(index_, name, offset);
+    }
+
+  private:
+    friend Result_set;
+
+    const Result_set* set_{};
+    std::size_t index_{};
+
+    Row_view(const Result_set* const set, const std::size_t index) noexcept
+      : set_{set}
+      , index_{index}
+    {
+      DMITIGR_ASSERT(set_);
+    }
+  };
+
+  /**
+   * @brief A typed view of the column of the result set.
+   *
+   * @details The values are converted by `to<T>()` upon the access.
+   *
+   * @warning The view is invalidated by the operations which modify the
+   * result set.
+   */
+  template<typename T>
+  class Column_view final {
+  public:
+    /// An iterator.
+    class Iterator final {
+    public:
+      using iterator_category = std::input_iterator_tag;
+      using value_type = T;
+      using difference_type = std::ptrdiff_t;
+      using reference = T;
+      using pointer = void;
+
+      /// Constructs an invalid iterator.
+      Iterator() = default;
+
+      /// @returns The converted value.
+      reference operator*() const
+      {
+        DMITIGR_ASSERT(column_);
+        return (*column_)[row_];
+      }
+
+      /// Prefix increment.
+      Iterator& operator++() noexcept
+      {
+        ++row_;
+        return *this;
+      }
+
+      /// Postfix increment.
+      Iterator operator++(int) noexcept
+      {
+        auto tmp{*this};
+        ++row_;
+        return tmp;
+      }
+
+      /// @returns `true` if `*this == rhs`.
+      bool operator==(const Iterator& rhs) const noexcept
+      {
+        return (column_ == rhs.column_) && (row_ == rhs.row_);
+      }
+
+      /// @returns `true` if `*this != rhs`.
+      bool operator!=(const Iterator& rhs) const noexcept
+      {
+        return !(*this == rhs);
+      }
+
+    private:
+      friend Column_view;
+
+      const Column_view* column_{};
+      std::size_t row_{};
+
+      Iterator(const Column_view* const column, const std::size_t row) noexcept
+        : column_{column}
+        , row_{row}
+      {}
+    };
+
+    /// @returns The index of the field.
+    std::size_t field_index() const noexcept
+    {
+      return field_;
+    }
+
+    /// @returns The number of values.
+    std::size_t size() const noexcept
+    {
+      return set_->row_count();
+    }
+
+    /**
+     * @returns The value of the row at `index`.
+     *
+     * @par Requires
+     * `index < size()`.
+     */
+    T operator[](const std::size_t index) const
+    {
+      return to<T>(set_->data(index, field_));
+    }
+
+    /// @returns Iterator that points to the value of the first row.
+    Iterator begin() const noexcept
+    {
+      return Iterator{this, 0};
+    }
+
+    /// @returns Iterator that points to an one-past-the-last value.
+    Iterator end() const noexcept
+    {
+      return Iterator{this, size()};
+    }
+
+  private:
+    friend Result_set;
+
+    const Result_set* set_{};
+    std::size_t field_{};
+
+    Column_view(const Result_set* const set, const std::size_t field)
+      : set_{set}
+      , field_{field}
+    {
+      DMITIGR_ASSERT(set_);
+      if (!(field_ < set_->field_count()))
+        throw Generic_exception{"cannot get column of result set"};
+    }
+  };
+
+  /// Default-constructible. (Constructs an empty instance.)
+  Result_set() = default;
+
+  /// Not copy-constructible.
+  Result_set(const Result_set&) = delete;
+
+  /// Move-constructible.
+  Result_set(Result_set&&) = default;
+
+  /// Not copy-assignable.
+  Result_set& operator=(const Result_set&) = delete;
+
+  /// Move-assignable.
+  Result_set& operator=(Result_set&&) = default;
+
+  /// Swaps this with `rhs`.
+  DMITIGR_PGFE_API void swap(Result_set& rhs) noexcept;
+
+  /**
+   * @brief Copies the data of `row` to this instance.
+   *
+   * @details The description of the first appended row is shared by all the
+   * rows of this instance.
+   *
+   * @par Requires
+   * `row`. If `!is_empty()` then the row must have the same field count and
+   * field types as `info()`.
+   *
+   * @par Exception safety guarantee
+   * Strong.
+   */
+  DMITIGR_PGFE_API void append(const Row& row);
+
+  /// @returns The number of rows.
+  DMITIGR_PGFE_API std::size_t row_count() const noexcept;
+
+  /// @returns `!row_count()`.
+  DMITIGR_PGFE_API bool is_empty() const noexcept;
+
+  /// @returns The number of fields of each row.
+  DMITIGR_PGFE_API std::size_t field_count() const noexcept;
+
+  /**
+   * @returns The shared description of the rows, or invalid instance if
+   * no rows has been appended yet.
+   */
+  DMITIGR_PGFE_API const Row_info& info() const noexcept;
+
+  /**
+   * @returns The field data of the row at `row`, or invalid instance if
+   * SQL NULL.
+   *
+   * @par Requires
+   * `row < row_count() && field < field_count()`.
+   */
+  DMITIGR_PGFE_API Data_view data(std::size_t row, std::size_t field = 0) const;
+
+  /**
+   * @overload
+   *
+   * @par Requires
+   * `row < row_count() && info().field_index(name, offset) < field_count()`.
+   */
+  DMITIGR_PGFE_API Data_view data(std::size_t row, std::string_view name,
+    std::size_t offset = 0) const;
+
+  /**
+   * @returns The view of the row at `index`.
+   *
+   * @par Requires
+   * `index < row_count()`.
+   */
+  DMITIGR_PGFE_API Row_view row(std::size_t index) const;
+
+  /// @returns `row(index)`.
+  Row_view operator[](const std::size_t index) const
+  {
+    return row(index);
+  }
+
+  /**
+   * @returns The typed view of the column at `field`.
+   *
+   * @par Requires
+   * `field < field_count()`.
+   */
+  template<typename T>
+  Column_view<T> column(const std::size_t field) const
+  {
+    return Column_view<T>{this, field};
+  }
+
+  /**
+   * @overload
+   *
+   * @par Requires
+   * `info().field_index(name, offset) < field_count()`.
+   */
+  template<typename T>
+  Column_view<T> column(const std::string_view name,
+    const std::size_t offset = 0) const
+  {
+    return column<T>(info_ ? info_.field_index(name, offset) : 0);
+  }
+
+  /**
+   * @brief Reserves the memory for `row_count` rows of the total data size
+   * of `byte_count` bytes.
+   *
+   * @remarks The offset table is reserved upon the first append() if the
+   * description of rows is not known yet.
+   */
+  DMITIGR_PGFE_API void reserve(std::size_t row_count, std::size_t byte_count);
+
+  /// Releases the unused memory.
+  DMITIGR_PGFE_API void shrink_to_fit();
+
+  /**
+   * @brief Erases all the rows and the description.
+   *
+   * @par Effects
+   * `is_empty() && !info()`.
+   */
+  DMITIGR_PGFE_API void clear() noexcept;
+
+  /// @returns The approximate memory consumption in bytes.
+  DMITIGR_PGFE_API std::size_t memory_usage() const noexcept;
+
+private:
+  Row_info info_;
+  std::size_t row_count_{};
+  std::size_t reserved_row_count_{};
+  std::string bytes_; // values, each of which followed by '\0'
+  std::vector<std::size_t> offsets_; // row-major, field_count()*row_count() + 1
+  std::vector<bool> nulls_; // row-major, field_count()*row_count()
+};
+
+/**
+ * @ingroup main
+ *
+ * @brief Result_set is swappable.
+ */
+inline void swap(Result_set& lhs, Result_set& rhs) noexcept
+{
+  lhs.swap(rhs);
+}
+
+} // namespace dmitigr::pgfe
+
+#ifndef DMITIGR_PGFE_NOT_HEADER_ONLY
+#include "result_set.cpp"
+#endif
+
+#endif  // DMITIGR_PGFE_RESULT_SET_HPP
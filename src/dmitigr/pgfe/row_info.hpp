@@ -206,6 +206,8 @@ public:
 
 private:
   friend Connection;
+  friend Result_cache;
+  friend Result_set;
   friend Prepared_statement;
   friend Row;
 
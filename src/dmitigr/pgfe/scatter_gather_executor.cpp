@@ -0,0 +1,219 @@
+// -*- C++ -*-
+//
+// Copyright 2023 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "../base/assert.hpp"
+#include "../net/socket.hpp"
+#include "error.hpp"
+#include "exceptions.hpp"
+#include "scatter_gather_executor.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <memory>
+
+namespace dmitigr::pgfe {
+
+DMITIGR_PGFE_INLINE Scatter_gather_executor::Scatter_gather_executor(
+  std::vector<std::reference_wrapper<Connection_pool>> shards)
+  : shards_{std::move(shards)}
+{
+  if (shards_.empty())
+    throw Generic_exception{"cannot create scatter-gather executor: no shards"};
+}
+
+DMITIGR_PGFE_INLINE std::size_t
+Scatter_gather_executor::shard_count() const noexcept
+{
+  return shards_.size();
+}
+
+DMITIGR_PGFE_INLINE void Scatter_gather_executor::set_timeout(
+  const std::optional<std::chrono::milliseconds> timeout)
+{
+  if (timeout && timeout->count() < 0)
+    throw Generic_exception{"cannot set timeout of scatter-gather executor: "
+      "invalid timeout"};
+  timeout_ = timeout;
+}
+
+DMITIGR_PGFE_INLINE std::optional<std::chrono::milliseconds>
+Scatter_gather_executor::timeout() const noexcept
+{
+  return timeout_;
+}
+
+DMITIGR_PGFE_INLINE auto
+Scatter_gather_executor::execute__(const std::function<void(Connection&)>& send,
+  const std::function<void(std::size_t, Row&&)>& callback)
+  -> std::vector<Shard_result>
+{
+  using Clock = std::chrono::steady_clock;
+  using std::chrono::duration_cast;
+  using std::chrono::milliseconds;
+
+  struct Shard final {
+    std::optional<Connection_pool::Handle> handle; // has no default constructor
+    bool is_active{};
+  };
+
+  const auto started = Clock::now();
+  const std::size_t shard_count{shards_.size()};
+  std::vector<Shard_result> results(shard_count);
+  std::vector<Shard> shards(shard_count);
+
+  const auto finish = [&](const std::size_t i, std::exception_ptr error = {})
+  {
+    results[i].error = std::move(error);
+    results[i].duration = duration_cast<milliseconds>(Clock::now() - started);
+    shards[i].is_active = false;
+  };
+
+  // Scatter.
+  for (std::size_t i{}; i < shard_count; ++i) {
+    results[i].shard = i;
+    try {
+      auto handle = shards_[i].get().connection();
+      if (!handle)
+        throw Generic_exception{"cannot execute statement on shard: "
+          "no free connection in pool"};
+      send(*handle);
+      shards[i].handle.emplace(std::move(handle));
+      shards[i].is_active = true;
+    } catch (...) {
+      finish(i, std::current_exception());
+    }
+  }
+
+  // Handles the input of the shard until the socket polling is required.
+  const auto handle_input = [&](const std::size_t i)
+  {
+    auto& conn = **shards[i].handle;
+    while (true) {
+      Row row;
+      try {
+        const auto rs = conn.handle_input(false);
+        if (rs == Response_status::unready)
+          return;
+        else if (rs == Response_status::empty)
+          return finish(i);
+
+        DMITIGR_ASSERT(rs == Response_status::ready);
+        if (auto err = conn.error())
+          return finish(i, std::make_exception_ptr(
+              Sqlstate_exception{std::make_shared<Error>(std::move(err))}));
+        else if (!(row = conn.row())) {
+          results[i].completion = conn.completion();
+          return finish(i);
+        }
+      } catch (...) {
+        return finish(i, std::current_exception());
+      }
+      ++results[i].row_count;
+      callback(i, std::move(row));
+    }
+  };
+
+  // Gather.
+  const auto deadline = timeout_ ?
+    std::optional<Clock::time_point>{started + *timeout_} : std::nullopt;
+  std::vector<net::detail::Pollfd> fds;
+  std::vector<std::size_t> fd_shards; // indexes of shards of `fds`
+  fds.reserve(shard_count);
+  fd_shards.reserve(shard_count);
+  while (std::any_of(cbegin(shards), cend(shards),
+      [](const auto& shard){return shard.is_active;})) {
+    // Expire the shards, or compute the time left.
+    milliseconds timeout{-1};
+    if (deadline) {
+      const auto now = Clock::now();
+      if (now >= *deadline) {
+        /*
+         * Cancel the statement on the server, since otherwise it would continue
+         * to run after the connection is closed upon the release. (A failure
+         * to cancel doesn't matter here.)
+         */
+        for (std::size_t i{}; i < shard_count; ++i) {
+          if (shards[i].is_active) {
+            try {
+              (*shards[i].handle)->cancel_request();
+            } catch (...) {}
+            finish(i, std::make_exception_ptr(Generic_exception{Errc::timed_out,
+                  "shard execution timeout expired"}));
+          }
+        }
+        break;
+      }
+      timeout = std::chrono::ceil<milliseconds>(*deadline - now);
+    }
+
+    // Poll the sockets. (One pollfd per active shard, so there is no
+    // limitation on the values of the sockets as with select().)
+    fds.clear();
+    fd_shards.clear();
+    for (std::size_t i{}; i < shard_count; ++i) {
+      if (!shards[i].is_active)
+        continue;
+      else if (!(*shards[i].handle)->is_connected()) {
+        finish(i, std::make_exception_ptr(Generic_exception{
+              "cannot execute statement on shard: connection lost"}));
+        continue;
+      }
+      auto& fd = fds.emplace_back();
+      fd.fd = static_cast<net::Socket_native>((*shards[i].handle)->socket());
+      fd.events = net::detail::poll_read;
+      fd_shards.push_back(i);
+    }
+    if (fds.empty())
+      break;
+
+#ifdef _WIN32
+    const int r = ::WSAPoll(fds.data(), static_cast<ULONG>(fds.size()),
+      net::detail::to_poll_timeout(timeout));
+#else
+    const int r = ::poll(fds.data(), static_cast<nfds_t>(fds.size()),
+      net::detail::to_poll_timeout(timeout));
+#endif
+    if (net::is_socket_error(r)) {
+#ifdef _WIN32
+      if (net::last_error() == WSAEINTR)
+#else
+      if (net::last_error() == EINTR)
+#endif
+        continue;
+      throw Generic_exception{"cannot poll sockets of shards"};
+    } else if (!r)
+      continue; // timeout
+
+    // Handle the input.
+    for (std::size_t j{}; j < fds.size(); ++j) {
+      const auto i = fd_shards[j];
+      if (!shards[i].is_active || !fds[j].revents)
+        continue;
+
+      try {
+        (*shards[i].handle)->read_input();
+      } catch (...) {
+        finish(i, std::current_exception());
+        continue;
+      }
+      handle_input(i);
+    }
+  }
+
+  return results;
+}
+
+} // namespace dmitigr::pgfe
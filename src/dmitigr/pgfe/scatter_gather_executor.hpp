@@ -0,0 +1,185 @@
+// -*- C++ -*-
+//
+// Copyright 2023 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DMITIGR_PGFE_SCATTER_GATHER_EXECUTOR_HPP
+#define DMITIGR_PGFE_SCATTER_GATHER_EXECUTOR_HPP
+
+#include "completion.hpp"
+#include "connection.hpp"
+#include "connection_pool.hpp"
+#include "dll.hpp"
+#include "row.hpp"
+#include "statement.hpp"
+#include "types_fwd.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <optional>
+#include <type_traits>
+#include <vector>
+
+namespace dmitigr::pgfe {
+
+/**
+ * @ingroup utilities
+ *
+ * @brief An executor of the statement on the multiple databases (shards)
+ * simultaneously.
+ *
+ * @details The statement is sent to all the shards at once by using the
+ * connections borrowed from the pools, and then the responses are handled on
+ * the calling thread by polling the readiness of the connection sockets. Thus,
+ * the latency of the fan-out query is the latency of the slowest shard rather
+ * than the sum of the latencies. The rows are passed to the callback in the
+ * order they arrive from the shards.
+ *
+ * The failure of the shard (including the timeout) doesn't abort the other
+ * shards, but reported in the corresponding Shard_result instead.
+ *
+ * Example:
+ * @code
+ * pgfe::Scatter_gather_executor executor{{shard1, shard2, shard3}};
+ * executor.set_timeout(std::chrono::seconds{5});
+ * const auto results = executor.execute([](const std::size_t shard, auto&& row)
+ * {
+ *   // Handle the row of the shard.
+ * }, "select * from orders where customer_id = $1", customer_id);
+ * for (const auto& result : results) {
+ *   if (!result.is_ok())
+ *     // Handle the failure of result.shard.
+ * }
+ * @endcode
+ */
+class Scatter_gather_executor final {
+public:
+  /// A result of the execution on the shard.
+  struct Shard_result final {
+    /// The index of the shard.
+    std::size_t shard{};
+
+    /// The completion, or invalid instance if `!is_ok()`.
+    Completion completion;
+
+    /// The error, or `nullptr` if `is_ok()`.
+    std::exception_ptr error;
+
+    /// The number of rows received from the shard.
+    std::size_t row_count{};
+
+    /// The duration of the execution on the shard.
+    std::chrono::milliseconds duration{};
+
+    /// @returns `!error`.
+    bool is_ok() const noexcept
+    {
+      return !error;
+    }
+  };
+
+  /// Not copy-constructible.
+  Scatter_gather_executor(const Scatter_gather_executor&) = delete;
+
+  /// Not copy-assignable.
+  Scatter_gather_executor& operator=(const Scatter_gather_executor&) = delete;
+
+  /// Not move-constructible.
+  Scatter_gather_executor(Scatter_gather_executor&&) = delete;
+
+  /// Not move-assignable.
+  Scatter_gather_executor& operator=(Scatter_gather_executor&&) = delete;
+
+  /**
+   * @brief The constructor.
+   *
+   * @param shards The connection pools of the shards.
+   *
+   * @par Requires
+   * `!shards.empty()`.
+   *
+   * @remarks The pools must outlive this instance.
+   */
+  explicit DMITIGR_PGFE_API Scatter_gather_executor(
+    std::vector<std::reference_wrapper<Connection_pool>> shards);
+
+  /// @returns The number of shards.
+  DMITIGR_PGFE_API std::size_t shard_count() const noexcept;
+
+  /**
+   * @brief Sets the maximum time of the execution on each shard.
+   *
+   * @param timeout The value of `std::nullopt` means *eternity*.
+   *
+   * @par Requires
+   * `!timeout || timeout->count() >= 0`.
+   */
+  DMITIGR_PGFE_API void set_timeout(std::optional<std::chrono::milliseconds> timeout);
+
+  /// @returns The timeout. The default is `std::nullopt`.
+  DMITIGR_PGFE_API std::optional<std::chrono::milliseconds> timeout() const noexcept;
+
+  /**
+   * @brief Executes the `statement` on all the shards simultaneously.
+   *
+   * @param callback A function which is called with the index of the shard
+   * and the row received from it.
+   * @param statement A statement to execute.
+   * @param parameters Parameters to bind with a parameterized statement.
+   *
+   * @returns The results of the shards in the order of the shards.
+   *
+   * @par Requires
+   * `callback` must be invocable with `std::size_t` and `Row&&`.
+   *
+   * @par Exception safety guarantee
+   * Basic. If the callback throws, the execution is aborted on all the shards.
+   *
+   * @remarks The connections with an uncompleted request (for example, upon
+   * the timeout) are closed when returned to the pool. The statements which
+   * are timed out are cancelled on the server before.
+   */
+  template<typename F, typename ... Types>
+  std::vector<Shard_result> execute(F&& callback, const Statement& statement,
+    const Types& ... parameters)
+  {
+    static_assert(std::is_invocable_v<F, std::size_t, Row&&>,
+      "callback must be invocable with std::size_t and Row&&");
+    return execute__([&statement, &parameters...](Connection& conn)
+    {
+      conn.execute_nio(statement, parameters...);
+    }, [&callback](const std::size_t shard, Row&& row)
+    {
+      callback(shard, std::move(row));
+    });
+  }
+
+private:
+  std::vector<std::reference_wrapper<Connection_pool>> shards_;
+  std::optional<std::chrono::milliseconds> timeout_;
+
+  DMITIGR_PGFE_API std::vector<Shard_result>
+  execute__(const std::function<void(Connection&)>& send,
+    const std::function<void(std::size_t, Row&&)>& callback);
+};
+
+} // namespace dmitigr::pgfe
+
+#ifndef DMITIGR_PGFE_NOT_HEADER_ONLY
+#include "scatter_gather_executor.cpp"
+#endif
+
+#endif  // DMITIGR_PGFE_SCATTER_GATHER_EXECUTOR_HPP
@@ -0,0 +1,308 @@
+// -*- C++ -*-
+//
+// Copyright 2023 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DMITIGR_PGFE_SIMD_HPP
+#define DMITIGR_PGFE_SIMD_HPP
+
+#include <cstddef>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define DMITIGR_PGFE_SIMD_AVX2
+#define DMITIGR_PGFE_SIMD_SSE2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define DMITIGR_PGFE_SIMD_SSE2
+#endif
+
+/**
+ * @brief Vectorized routines of bulk text processing.
+ *
+ * @details The AVX2 code path is compiled in if `__AVX2__` is defined (i.e.
+ * when compiling with `-mavx2` or `-march` supporting it), the SSE2 code path
+ * is compiled in on any x86-64 target. Otherwise, only the scalar code path
+ * is used. Each function has the scalar counterpart with the `_scalar`
+ * suffix which produces exactly the same result.
+ */
+namespace dmitigr::pgfe::detail::simd {
+
+/// @returns The name of the widest instruction set in use.
+constexpr const char* instruction_set() noexcept
+{
+#if defined(DMITIGR_PGFE_SIMD_AVX2)
+  return "avx2";
+#elif defined(DMITIGR_PGFE_SIMD_SSE2)
+  return "sse2";
+#else
+  return "scalar";
+#endif
+}
+
+// -----------------------------------------------------------------------------
+// Hex decoding
+// -----------------------------------------------------------------------------
+
+/// @returns The value of the hex digit `c`, or `-1` if `c` is not a hex digit.
+inline int hex_digit_value(const char c) noexcept
+{
+  if ('0' <= c && c <= '9')
+    return c - '0';
+  else if ('a' <= c && c <= 'f')
+    return c - 'a' + 10;
+  else if ('A' <= c && c <= 'F')
+    return c - 'A' + 10;
+  else
+    return -1;
+}
+
+/**
+ * @brief Decodes `2*size` hex digits of `in` into `size` bytes of `out`.
+ *
+ * @returns `false` if `in` contains a character which is not a hex digit. In
+ * this case the content of `out` is unspecified.
+ */
+inline bool hex_decode_scalar(const char* in, unsigned char* out,
+  std::size_t size) noexcept
+{
+  for (; size; --size, in += 2) {
+    const int hi{hex_digit_value(in[0])};
+    const int lo{hex_digit_value(in[1])};
+    if ((hi | lo) < 0)
+      return false;
+    *out++ = static_cast<unsigned char>(hi << 4 | lo);
+  }
+  return true;
+}
+
+#ifdef DMITIGR_PGFE_SIMD_SSE2
+/**
+ * @returns 16-bit lanes with the bytes decoded from 16 hex digits of `v`, or
+ * sets `valid` to `false` if `v` contains not hex digits.
+ */
+inline __m128i hex_decode_sse2(const __m128i v, bool& valid) noexcept
+{
+  const __m128i lower{_mm_or_si128(v, _mm_set1_epi8(0x20))};
+  const __m128i is_digit{_mm_and_si128(
+      _mm_cmpgt_epi8(v, _mm_set1_epi8('0' - 1)),
+      _mm_cmpgt_epi8(_mm_set1_epi8('9' + 1), v))};
+  const __m128i is_alpha{_mm_and_si128(
+      _mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)),
+      _mm_cmpgt_epi8(_mm_set1_epi8('f' + 1), lower))};
+  valid &= _mm_movemask_epi8(_mm_or_si128(is_digit, is_alpha)) == 0xffff;
+  const __m128i nibbles{_mm_or_si128(
+      _mm_and_si128(is_digit, _mm_sub_epi8(v, _mm_set1_epi8('0'))),
+      _mm_and_si128(is_alpha, _mm_sub_epi8(lower, _mm_set1_epi8('a' - 10))))};
+  // Each 16-bit lane is `lo << 8 | hi` (little endian), make it `hi << 4 | lo`.
+  return _mm_or_si128(
+    _mm_and_si128(_mm_slli_epi16(nibbles, 4), _mm_set1_epi16(0x00f0)),
+    _mm_srli_epi16(nibbles, 8));
+}
+#endif
+
+#ifdef DMITIGR_PGFE_SIMD_AVX2
+/// The AVX2 counterpart of hex_decode_sse2().
+inline __m256i hex_decode_avx2(const __m256i v, bool& valid) noexcept
+{
+  const __m256i lower{_mm256_or_si256(v, _mm256_set1_epi8(0x20))};
+  const __m256i is_digit{_mm256_and_si256(
+      _mm256_cmpgt_epi8(v, _mm256_set1_epi8('0' - 1)),
+      _mm256_cmpgt_epi8(_mm256_set1_epi8('9' + 1), v))};
+  const __m256i is_alpha{_mm256_and_si256(
+      _mm256_cmpgt_epi8(lower, _mm256_set1_epi8('a' - 1)),
+      _mm256_cmpgt_epi8(_mm256_set1_epi8('f' + 1), lower))};
+  valid &= _mm256_movemask_epi8(_mm256_or_si256(is_digit, is_alpha)) == -1;
+  const __m256i nibbles{_mm256_or_si256(
+      _mm256_and_si256(is_digit, _mm256_sub_epi8(v, _mm256_set1_epi8('0'))),
+      _mm256_and_si256(is_alpha,
+        _mm256_sub_epi8(lower, _mm256_set1_epi8('a' - 10))))};
+  return _mm256_or_si256(
+    _mm256_and_si256(_mm256_slli_epi16(nibbles, 4), _mm256_set1_epi16(0x00f0)),
+    _mm256_srli_epi16(nibbles, 8));
+}
+#endif
+
+/// The vectorized counterpart of hex_decode_scalar().
+inline bool hex_decode(const char* in, unsigned char* out,
+  std::size_t size) noexcept
+{
+  bool valid{true};
+#ifdef DMITIGR_PGFE_SIMD_AVX2
+  for (; size >= 32; size -= 32, in += 64, out += 32) {
+    const auto* const p = reinterpret_cast<const __m256i*>(in);
+    const __m256i a{hex_decode_avx2(_mm256_loadu_si256(p), valid)};
+    const __m256i b{hex_decode_avx2(_mm256_loadu_si256(p + 1), valid)};
+    // Packing is done within 128-bit lanes, so the quadwords are reordered.
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out),
+      _mm256_permute4x64_epi64(_mm256_packus_epi16(a, b), 0xd8));
+  }
+#endif
+#ifdef DMITIGR_PGFE_SIMD_SSE2
+  for (; size >= 16; size -= 16, in += 32, out += 16) {
+    const auto* const p = reinterpret_cast<const __m128i*>(in);
+    const __m128i a{hex_decode_sse2(_mm_loadu_si128(p), valid)};
+    const __m128i b{hex_decode_sse2(_mm_loadu_si128(p + 1), valid)};
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_packus_epi16(a, b));
+  }
+#endif
+  return valid && hex_decode_scalar(in, out, size);
+}
+
+// -----------------------------------------------------------------------------
+// Hex encoding
+// -----------------------------------------------------------------------------
+
+/// Encodes `size` bytes of `in` into `2*size` lowercase hex digits of `out`.
+inline void hex_encode_scalar(const unsigned char* in, char* out,
+  std::size_t size) noexcept
+{
+  constexpr const char digits[] = "0123456789abcdef";
+  for (; size; --size) {
+    const unsigned char c{*in++};
+    *out++ = digits[c >> 4];
+    *out++ = digits[c & 0x0f];
+  }
+}
+
+#ifdef DMITIGR_PGFE_SIMD_SSE2
+/// @returns The lowercase hex digits of the nibbles `n`.
+inline __m128i hex_digits_sse2(const __m128i n) noexcept
+{
+  const __m128i is_alpha{_mm_cmpgt_epi8(n, _mm_set1_epi8(9))};
+  return _mm_add_epi8(_mm_add_epi8(n, _mm_set1_epi8('0')),
+    _mm_and_si128(is_alpha, _mm_set1_epi8('a' - '0' - 10)));
+}
+#endif
+
+#ifdef DMITIGR_PGFE_SIMD_AVX2
+/// The AVX2 counterpart of hex_digits_sse2().
+inline __m256i hex_digits_avx2(const __m256i n) noexcept
+{
+  const __m256i is_alpha{_mm256_cmpgt_epi8(n, _mm256_set1_epi8(9))};
+  return _mm256_add_epi8(_mm256_add_epi8(n, _mm256_set1_epi8('0')),
+    _mm256_and_si256(is_alpha, _mm256_set1_epi8('a' - '0' - 10)));
+}
+#endif
+
+/// The vectorized counterpart of hex_encode_scalar().
+inline void hex_encode(const unsigned char* in, char* out,
+  std::size_t size) noexcept
+{
+#ifdef DMITIGR_PGFE_SIMD_AVX2
+  for (; size >= 32; size -= 32, in += 32, out += 64) {
+    const __m256i v{_mm256_loadu_si256(reinterpret_cast<const __m256i*>(in))};
+    const __m256i mask{_mm256_set1_epi8(0x0f)};
+    const __m256i hi{hex_digits_avx2(
+        _mm256_and_si256(_mm256_srli_epi16(v, 4), mask))};
+    const __m256i lo{hex_digits_avx2(_mm256_and_si256(v, mask))};
+    // Unpacking is done within 128-bit lanes, so the lanes are reordered.
+    const __m256i a{_mm256_unpacklo_epi8(hi, lo)};
+    const __m256i b{_mm256_unpackhi_epi8(hi, lo)};
+    auto* const p = reinterpret_cast<__m256i*>(out);
+    _mm256_storeu_si256(p, _mm256_permute2x128_si256(a, b, 0x20));
+    _mm256_storeu_si256(p + 1, _mm256_permute2x128_si256(a, b, 0x31));
+  }
+#endif
+#ifdef DMITIGR_PGFE_SIMD_SSE2
+  for (; size >= 16; size -= 16, in += 16, out += 32) {
+    const __m128i v{_mm_loadu_si128(reinterpret_cast<const __m128i*>(in))};
+    const __m128i mask{_mm_set1_epi8(0x0f)};
+    const __m128i hi{hex_digits_sse2(_mm_and_si128(_mm_srli_epi16(v, 4), mask))};
+    const __m128i lo{hex_digits_sse2(_mm_and_si128(v, mask))};
+    auto* const p = reinterpret_cast<__m128i*>(out);
+    _mm_storeu_si128(p, _mm_unpacklo_epi8(hi, lo));
+    _mm_storeu_si128(p + 1, _mm_unpackhi_epi8(hi, lo));
+  }
+#endif
+  hex_encode_scalar(in, out, size);
+}
+
+// -----------------------------------------------------------------------------
+// Scanning
+// -----------------------------------------------------------------------------
+
+/**
+ * @returns The number of trailing zero bits of `mask`.
+ *
+ * @par Requires
+ * `mask`.
+ */
+inline unsigned count_trailing_zeros(unsigned mask) noexcept
+{
+#if defined(__GNUC__) || defined(__clang__)
+  return static_cast<unsigned>(__builtin_ctz(mask));
+#else
+  unsigned result{};
+  for (; !(mask & 1); mask >>= 1)
+    ++result;
+  return result;
+#endif
+}
+
+/**
+ * @returns The pointer to the first character of `[begin, end)` which is
+ * equal to any of `c1`, `c2` or `c3`, or `end` if there is no such character.
+ */
+inline const char* find_first_of_scalar(const char* begin, const char* const end,
+  const char c1, const char c2, const char c3) noexcept
+{
+  for (; begin != end; ++begin) {
+    const char c{*begin};
+    if (c == c1 || c == c2 || c == c3)
+      break;
+  }
+  return begin;
+}
+
+/// The vectorized counterpart of find_first_of_scalar().
+inline const char* find_first_of(const char* begin, const char* const end,
+  const char c1, const char c2, const char c3) noexcept
+{
+#ifdef DMITIGR_PGFE_SIMD_AVX2
+  {
+    const __m256i v1{_mm256_set1_epi8(c1)};
+    const __m256i v2{_mm256_set1_epi8(c2)};
+    const __m256i v3{_mm256_set1_epi8(c3)};
+    for (; end - begin >= 32; begin += 32) {
+      const __m256i v{_mm256_loadu_si256(reinterpret_cast<const __m256i*>(begin))};
+      const auto mask = static_cast<unsigned>(_mm256_movemask_epi8(
+        _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(v, v1),
+          _mm256_cmpeq_epi8(v, v2)), _mm256_cmpeq_epi8(v, v3))));
+      if (mask)
+        return begin + count_trailing_zeros(mask);
+    }
+  }
+#endif
+#ifdef DMITIGR_PGFE_SIMD_SSE2
+  {
+    const __m128i v1{_mm_set1_epi8(c1)};
+    const __m128i v2{_mm_set1_epi8(c2)};
+    const __m128i v3{_mm_set1_epi8(c3)};
+    for (; end - begin >= 16; begin += 16) {
+      const __m128i v{_mm_loadu_si128(reinterpret_cast<const __m128i*>(begin))};
+      const auto mask = static_cast<unsigned>(_mm_movemask_epi8(
+        _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, v1),
+          _mm_cmpeq_epi8(v, v2)), _mm_cmpeq_epi8(v, v3))));
+      if (mask)
+        return begin + count_trailing_zeros(mask);
+    }
+  }
+#endif
+  return find_first_of_scalar(begin, end, c1, c2, c3);
+}
+
+} // namespace dmitigr::pgfe::detail::simd
+
+#endif  // DMITIGR_PGFE_SIMD_HPP
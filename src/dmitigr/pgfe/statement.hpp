@@ -411,6 +411,7 @@ public:
   DMITIGR_PGFE_API Tuple& extra() noexcept;
 
 private:
+  friend Statement_reader;
   friend Statement_vector;
 
   /// A fragment.
@@ -0,0 +1,130 @@
+// -*- C++ -*-
+//
+// Copyright 2023 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "../base/assert.hpp"
+#include "statement_description_cache.hpp"
+
+#include <new>
+
+namespace dmitigr::pgfe {
+
+DMITIGR_PGFE_INLINE std::size_t
+Statement_description_cache::size() const noexcept
+{
+  const std::lock_guard lg{mutex_};
+  return descriptions_.size();
+}
+
+DMITIGR_PGFE_INLINE bool Statement_description_cache::is_empty() const noexcept
+{
+  return !size();
+}
+
+DMITIGR_PGFE_INLINE std::size_t
+Statement_description_cache::erase(const std::string_view query)
+{
+  const std::lock_guard lg{mutex_};
+  std::size_t result{};
+  for (auto i = begin(descriptions_); i != end(descriptions_);) {
+    const std::string_view key{i->first};
+    const auto pos = key.find('\0');
+    DMITIGR_ASSERT(pos != std::string_view::npos);
+    if (key.substr(pos + 1) == query) {
+      i = descriptions_.erase(i);
+      ++result;
+    } else
+      ++i;
+  }
+  return result;
+}
+
+DMITIGR_PGFE_INLINE void Statement_description_cache::clear() noexcept
+{
+  const std::lock_guard lg{mutex_};
+  descriptions_.clear();
+}
+
+DMITIGR_PGFE_INLINE std::string
+Statement_description_cache::key(const std::string_view server,
+  const std::string_view query)
+{
+  std::string result;
+  result.reserve(server.size() + 1 + query.size());
+  result.append(server).append(1, '\0').append(query);
+  return result;
+}
+
+DMITIGR_PGFE_INLINE auto
+Statement_description_cache::find(const std::string& key) const
+  -> std::shared_ptr<const Description>
+{
+  const std::lock_guard lg{mutex_};
+  const auto i = descriptions_.find(key);
+  return i != cend(descriptions_) ? i->second : nullptr;
+}
+
+DMITIGR_PGFE_INLINE void
+Statement_description_cache::insert(std::string key,
+  const detail::pq::Result& description,
+  std::vector<std::uint_fast32_t> parameter_type_oids)
+{
+  DMITIGR_ASSERT(description);
+  auto value = std::make_shared<Description>();
+  const int field_count{description.field_count()};
+  value->fields.reserve(static_cast<std::size_t>(field_count));
+  for (int i{}; i < field_count; ++i) {
+    value->fields.push_back(Field{
+      description.field_name(i),
+      description.field_table_oid(i),
+      description.field_table_column(i),
+      detail::pq::to_int(description.field_format(i)),
+      description.field_type_oid(i),
+      description.field_type_size(i),
+      description.field_type_modifier(i)});
+  }
+  value->parameter_type_oids = std::move(parameter_type_oids);
+
+  const std::lock_guard lg{mutex_};
+  descriptions_.insert_or_assign(std::move(key), std::move(value));
+}
+
+DMITIGR_PGFE_INLINE detail::pq::Result
+Statement_description_cache::to_result(const Description& description)
+{
+  detail::pq::Result result{PQmakeEmptyPGresult(nullptr, PGRES_COMMAND_OK)};
+  if (!result)
+    throw std::bad_alloc{};
+
+  if (const auto field_count = description.fields.size()) {
+    std::vector<PGresAttDesc> attributes;
+    attributes.reserve(field_count);
+    for (const auto& field : description.fields) {
+      attributes.push_back(PGresAttDesc{
+        const_cast<char*>(field.name.c_str()),
+        static_cast<::Oid>(field.table_oid),
+        field.table_column,
+        field.format,
+        static_cast<::Oid>(field.type_oid),
+        field.type_size,
+        field.type_modifier});
+    }
+    if (!result.set_attributes(attributes.data(), static_cast<int>(field_count)))
+      throw std::bad_alloc{};
+  }
+  return result;
+}
+
+} // namespace dmitigr::pgfe
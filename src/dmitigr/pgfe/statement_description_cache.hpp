@@ -0,0 +1,132 @@
+// -*- C++ -*-
+//
+// Copyright 2023 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DMITIGR_PGFE_STATEMENT_DESCRIPTION_CACHE_HPP
+#define DMITIGR_PGFE_STATEMENT_DESCRIPTION_CACHE_HPP
+
+#include "dll.hpp"
+#include "pq.hpp"
+#include "types_fwd.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace dmitigr::pgfe {
+
+/**
+ * @ingroup utilities
+ *
+ * @brief A thread-safe cache of the descriptions of prepared statements.
+ *
+ * @details The cache can be shared between the connections (for example, by
+ * all the connections of the process). The descriptions (the types of the
+ * parameters and the fields of the rows) are keyed by the query string and
+ * the server identity (the host, port, database, user and server version).
+ * Every connection the cache is set for:
+ *   - stores the description received upon describing the statement which
+ *   was prepared by the connection;
+ *   - attaches the description stored to the statement being prepared, so
+ *   such a statement is described without a round-trip to the server.
+ *
+ * @warning The descriptions cached may become stale after DDL changes or
+ * with different settings of `search_path` of the sessions. In such a cases
+ * either erase() or clear() must be called.
+ *
+ * @see Connection::set_description_cache(),
+ * Connection_pool::set_description_cache().
+ */
+class Statement_description_cache final {
+public:
+  /// Default-constructible.
+  Statement_description_cache() = default;
+
+  /// Not copy-constructible.
+  Statement_description_cache(const Statement_description_cache&) = delete;
+
+  /// Not copy-assignable.
+  Statement_description_cache& operator=(const Statement_description_cache&) = delete;
+
+  /// Not move-constructible.
+  Statement_description_cache(Statement_description_cache&&) = delete;
+
+  /// Not move-assignable.
+  Statement_description_cache& operator=(Statement_description_cache&&) = delete;
+
+  /// @returns The number of descriptions cached.
+  DMITIGR_PGFE_API std::size_t size() const noexcept;
+
+  /// @returns `!size()`.
+  DMITIGR_PGFE_API bool is_empty() const noexcept;
+
+  /**
+   * @brief Erases the descriptions of `query` of all the servers.
+   *
+   * @returns The number of descriptions erased.
+   */
+  DMITIGR_PGFE_API std::size_t erase(std::string_view query);
+
+  /// Erases all the descriptions.
+  DMITIGR_PGFE_API void clear() noexcept;
+
+private:
+  friend Connection;
+
+  /// A field description.
+  struct Field final {
+    std::string name;
+    std::uint_fast32_t table_oid{};
+    int table_column{};
+    int format{};
+    std::uint_fast32_t type_oid{};
+    int type_size{};
+    int type_modifier{};
+  };
+
+  /// A description.
+  struct Description final {
+    std::vector<Field> fields;
+    std::vector<std::uint_fast32_t> parameter_type_oids;
+  };
+
+  mutable std::mutex mutex_;
+  std::unordered_map<std::string, std::shared_ptr<const Description>> descriptions_;
+
+  /// @returns The key of the description.
+  static std::string key(std::string_view server, std::string_view query);
+
+  /// @returns The description, or `nullptr` if not found.
+  std::shared_ptr<const Description> find(const std::string& key) const;
+
+  /// Stores the description of the prepared statement.
+  void insert(std::string key, const detail::pq::Result& description,
+    std::vector<std::uint_fast32_t> parameter_type_oids);
+
+  /// @returns The result built from `description`.
+  static detail::pq::Result to_result(const Description& description);
+};
+
+} // namespace dmitigr::pgfe
+
+#ifndef DMITIGR_PGFE_NOT_HEADER_ONLY
+#include "statement_description_cache.cpp"
+#endif
+
+#endif  // DMITIGR_PGFE_STATEMENT_DESCRIPTION_CACHE_HPP
@@ -0,0 +1,198 @@
+// -*- C++ -*-
+//
+// Copyright 2023 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "../base/assert.hpp"
+#include "exceptions.hpp"
+#include "statement_reader.hpp"
+
+#include <utility>
+
+#ifdef _WIN32
+#include "../os/windows.hpp"
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace dmitigr::pgfe {
+
+DMITIGR_PGFE_INLINE Statement_reader::~Statement_reader() noexcept
+{
+  unmap();
+}
+
+DMITIGR_PGFE_INLINE
+Statement_reader::Statement_reader(const std::string_view input) noexcept
+  : data_{input.data()}
+  , size_{input.size()}
+{}
+
+DMITIGR_PGFE_INLINE Statement_reader
+Statement_reader::from_file(const std::filesystem::path& path)
+{
+  Statement_reader result;
+  const auto throw_error = [&path](const char* const what)
+  {
+    throw Generic_exception{std::string{"cannot "}.append(what)
+      .append(" file ").append(path.string())};
+  };
+
+#ifdef _WIN32
+  os::windows::Handle_guard file{CreateFileW(path.c_str(), GENERIC_READ,
+      FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+      FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr)};
+  if (file.handle() == INVALID_HANDLE_VALUE)
+    throw_error("open");
+
+  LARGE_INTEGER size{};
+  if (!GetFileSizeEx(file.handle(), &size))
+    throw_error("get size of");
+  else if (!size.QuadPart)
+    return result; // empty file cannot be mapped
+
+  const HANDLE mapping_handle{CreateFileMappingW(file.handle(),
+      nullptr, PAGE_READONLY, 0, 0, nullptr)};
+  if (!mapping_handle)
+    throw_error("create mapping of");
+  const os::windows::Handle_guard mapping{mapping_handle};
+
+  const auto* const data = MapViewOfFile(mapping.handle(), FILE_MAP_READ, 0, 0, 0);
+  if (!data)
+    throw_error("map");
+
+  result.data_ = static_cast<const char*>(data);
+  result.size_ = static_cast<std::size_t>(size.QuadPart);
+#else
+  const int fd{::open(path.c_str(), O_RDONLY | O_CLOEXEC)};
+  if (fd < 0)
+    throw_error("open");
+
+  struct stat st{};
+  if (::fstat(fd, &st)) {
+    ::close(fd);
+    throw_error("get size of");
+  } else if (!st.st_size) {
+    ::close(fd);
+    return result; // empty file cannot be mapped
+  }
+
+  const auto size = static_cast<std::size_t>(st.st_size);
+  void* const data{::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0)};
+  ::close(fd); // the mapping holds the reference to the file
+  if (data == MAP_FAILED)
+    throw_error("map");
+#ifdef MADV_SEQUENTIAL
+  ::madvise(data, size, MADV_SEQUENTIAL);
+#endif
+
+  result.data_ = static_cast<const char*>(data);
+  result.size_ = size;
+#endif
+  result.is_mapped_ = true;
+  return result;
+}
+
+DMITIGR_PGFE_INLINE
+Statement_reader::Statement_reader(Statement_reader&& rhs) noexcept
+  : data_{rhs.data_}
+  , size_{rhs.size_}
+  , position_{rhs.position_}
+  , is_mapped_{rhs.is_mapped_}
+{
+  rhs.data_ = {};
+  rhs.size_ = {};
+  rhs.position_ = {};
+  rhs.is_mapped_ = {};
+}
+
+DMITIGR_PGFE_INLINE Statement_reader&
+Statement_reader::operator=(Statement_reader&& rhs) noexcept
+{
+  if (this != &rhs) {
+    Statement_reader tmp{std::move(rhs)};
+    swap(tmp);
+  }
+  return *this;
+}
+
+DMITIGR_PGFE_INLINE void Statement_reader::swap(Statement_reader& rhs) noexcept
+{
+  using std::swap;
+  swap(data_, rhs.data_);
+  swap(size_, rhs.size_);
+  swap(position_, rhs.position_);
+  swap(is_mapped_, rhs.is_mapped_);
+}
+
+DMITIGR_PGFE_INLINE std::optional<Statement> Statement_reader::next()
+{
+  if (is_exhausted())
+    return std::nullopt;
+
+  auto [st, pos] = Statement::parse_sql_input(input().substr(position_));
+  DMITIGR_ASSERT(pos && position_ + pos <= size_);
+  position_ += pos;
+  return std::move(st);
+}
+
+DMITIGR_PGFE_INLINE bool Statement_reader::is_exhausted() const noexcept
+{
+  return position_ == size_;
+}
+
+DMITIGR_PGFE_INLINE bool Statement_reader::is_mapped() const noexcept
+{
+  return is_mapped_;
+}
+
+DMITIGR_PGFE_INLINE std::size_t Statement_reader::position() const noexcept
+{
+  return position_;
+}
+
+DMITIGR_PGFE_INLINE std::size_t Statement_reader::size() const noexcept
+{
+  return size_;
+}
+
+DMITIGR_PGFE_INLINE std::string_view Statement_reader::input() const noexcept
+{
+  return {data_, size_};
+}
+
+DMITIGR_PGFE_INLINE void Statement_reader::rewind() noexcept
+{
+  position_ = 0;
+}
+
+DMITIGR_PGFE_INLINE void Statement_reader::unmap() noexcept
+{
+  if (is_mapped_) {
+#ifdef _WIN32
+    UnmapViewOfFile(data_);
+#else
+    ::munmap(const_cast<char*>(data_), size_);
+#endif
+    is_mapped_ = false;
+  }
+  data_ = {};
+  size_ = {};
+  position_ = {};
+}
+
+} // namespace dmitigr::pgfe
@@ -0,0 +1,148 @@
+// -*- C++ -*-
+//
+// Copyright 2023 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DMITIGR_PGFE_STATEMENT_READER_HPP
+#define DMITIGR_PGFE_STATEMENT_READER_HPP
+
+#include "dll.hpp"
+#include "statement.hpp"
+#include "types_fwd.hpp"
+
+#include <cstddef>
+#include <filesystem>
+#include <optional>
+#include <string_view>
+
+namespace dmitigr::pgfe {
+
+/**
+ * @ingroup utilities
+ *
+ * @brief A sequential reader of Statements.
+ *
+ * @details Unlike Statement_vector, which parses the whole input at once, this
+ * class parses the input lazily, one statement per call of next(). When
+ * created by from_file(), the file is mapped into the memory of the process
+ * instead of being read into a string, so very large SQL scripts can be
+ * processed with memory usage bounded by the size of the largest statement.
+ *
+ * @see Statement_vector, Connection::execute_pipelined().
+ */
+class Statement_reader final {
+public:
+  /// The destructor.
+  DMITIGR_PGFE_API ~Statement_reader() noexcept;
+
+  /// Default-constructible. (Constructs an exhausted instance.)
+  Statement_reader() = default;
+
+  /**
+   * @brief Constructs the reader of statements from `input`.
+   *
+   * @par Lifetime
+   * The memory referenced by `input` must outlive this instance.
+   */
+  explicit DMITIGR_PGFE_API Statement_reader(std::string_view input) noexcept;
+
+  /**
+   * @returns The reader of statements from the file at `path`.
+   *
+   * @details The file is mapped into the memory for reading.
+   *
+   * @throws Generic_exception if the file cannot be opened or mapped.
+   */
+  static DMITIGR_PGFE_API Statement_reader from_file(const std::filesystem::path& path);
+
+  /// Non-copy-constructible.
+  Statement_reader(const Statement_reader&) = delete;
+
+  /// Non-copy-assignable.
+  Statement_reader& operator=(const Statement_reader&) = delete;
+
+  /// Move-constructible.
+  DMITIGR_PGFE_API Statement_reader(Statement_reader&& rhs) noexcept;
+
+  /// Move-assignable.
+  DMITIGR_PGFE_API Statement_reader& operator=(Statement_reader&& rhs) noexcept;
+
+  /// Swaps the instances.
+  DMITIGR_PGFE_API void swap(Statement_reader& rhs) noexcept;
+
+  /**
+   * @brief Parses the next statement of the input.
+   *
+   * @returns The next statement (possibly empty, i.e. consisting only of
+   * comments), or `std::nullopt` if `is_exhausted()`.
+   *
+   * @par Effects
+   * `position()` is advanced past the returned statement.
+   *
+   * @par Exception safety guarantee
+   * Strong.
+   *
+   * @see Statement_vector::Statement_vector(std::string_view).
+   */
+  DMITIGR_PGFE_API std::optional<Statement> next();
+
+  /// @returns `true` if the whole input is consumed.
+  DMITIGR_PGFE_API bool is_exhausted() const noexcept;
+
+  /// @returns `true` if the input is a memory-mapped file.
+  DMITIGR_PGFE_API bool is_mapped() const noexcept;
+
+  /// @returns The offset of the unconsumed part of the input.
+  DMITIGR_PGFE_API std::size_t position() const noexcept;
+
+  /// @returns The size of the input.
+  DMITIGR_PGFE_API std::size_t size() const noexcept;
+
+  /// @returns The whole input.
+  DMITIGR_PGFE_API std::string_view input() const noexcept;
+
+  /**
+   * @brief Resets the position to the start of the input.
+   *
+   * @par Effects
+   * `!position()`.
+   */
+  DMITIGR_PGFE_API void rewind() noexcept;
+
+private:
+  const char* data_{};
+  std::size_t size_{};
+  std::size_t position_{};
+  bool is_mapped_{};
+
+  void unmap() noexcept;
+};
+
+/**
+ * @ingroup utilities
+ *
+ * @brief Statement_reader is swappable.
+ */
+inline void swap(Statement_reader& lhs, Statement_reader& rhs) noexcept
+{
+  lhs.swap(rhs);
+}
+
+} // namespace dmitigr::pgfe
+
+#ifndef DMITIGR_PGFE_NOT_HEADER_ONLY
+#include "statement_reader.cpp"
+#endif
+
+#endif  // DMITIGR_PGFE_STATEMENT_READER_HPP
@@ -0,0 +1,211 @@
+// -*- C++ -*-
+//
+// Copyright 2023 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "pgfe-unit.hpp"
+#include "../../pgfe/simd.hpp"
+
+#include <libpq-fe.h>
+
+#include <cctype>
+#include <chrono>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace {
+
+template<typename F>
+void measure(const char* const what, const unsigned long iteration_count, F&& f)
+{
+  namespace chrono = std::chrono;
+  const auto start = chrono::steady_clock::now();
+  for (unsigned long i{}; i < iteration_count; ++i)
+    f();
+  const auto elapsed = chrono::duration_cast<chrono::microseconds>(
+    chrono::steady_clock::now() - start);
+  std::cout << what << ": " << elapsed.count() << " us" << std::endl;
+}
+
+} // namespace
+
+int main(const int argc, char* const argv[])
+try {
+  namespace pgfe = dmitigr::pgfe;
+  namespace simd = pgfe::detail::simd;
+  using Uptr = std::unique_ptr<void, void(*)(void*)>;
+
+  const unsigned long iteration_count{(argc >= 2) ? std::stoul(argv[1]) : 1};
+  const std::size_t size{(argc >= 3) ? std::stoul(argv[2]) : 1024*1024};
+  std::cout << "instruction set: " << simd::instruction_set() << std::endl;
+
+  // -------------------------------------------------------------------------
+  // Hex
+  // -------------------------------------------------------------------------
+
+  std::vector<unsigned char> binary(size);
+  for (std::size_t i{}; i < size; ++i)
+    binary[i] = static_cast<unsigned char>(i * 131 + i / 7);
+
+  // Encoding.
+  std::string hex(2*size, '\0');
+  simd::hex_encode(binary.data(), hex.data(), size);
+  {
+    std::string expected(2*size, '\0');
+    simd::hex_encode_scalar(binary.data(), expected.data(), size);
+    DMITIGR_ASSERT(hex == expected);
+
+    // Note, PQescapeBytea() without connection produces the escape format.
+    const std::string text{"\\x" + hex};
+    std::size_t length{};
+    const Uptr unescaped{PQunescapeBytea(
+        reinterpret_cast<const unsigned char*>(text.c_str()), &length), &PQfreemem};
+    DMITIGR_ASSERT(unescaped && length == size);
+    DMITIGR_ASSERT(!std::memcmp(unescaped.get(), binary.data(), size));
+  }
+  measure("hex encode (scalar)", iteration_count, [&]
+  {
+    simd::hex_encode_scalar(binary.data(), hex.data(), size);
+  });
+  measure("hex encode (vectorized)", iteration_count, [&]
+  {
+    simd::hex_encode(binary.data(), hex.data(), size);
+  });
+  measure("hex encode (PQescapeBytea)", iteration_count, [&]
+  {
+    std::size_t length{};
+    const Uptr escaped{PQescapeBytea(binary.data(), size, &length), &PQfreemem};
+  });
+
+  // Decoding.
+  const std::string text{"\\x" + hex};
+  {
+    std::vector<unsigned char> decoded(size);
+    DMITIGR_ASSERT(simd::hex_decode(hex.data(), decoded.data(), size));
+    DMITIGR_ASSERT(decoded == binary);
+    const auto bytea = pgfe::Data::to_bytea(text.c_str());
+    DMITIGR_ASSERT(bytea->size() == size);
+    DMITIGR_ASSERT(!std::memcmp(bytea->bytes(), binary.data(), size));
+
+    // Uppercase digits.
+    std::string upper{hex};
+    for (auto& c : upper)
+      c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+    DMITIGR_ASSERT(simd::hex_decode(upper.data(), decoded.data(), size));
+    DMITIGR_ASSERT(decoded == binary);
+
+    // Invalid digits.
+    for (const char c : {'g', 'G', '/', ':', '@', '`', '\x80'}) {
+      std::string invalid{hex.substr(0, 96)};
+      invalid[77] = c;
+      DMITIGR_ASSERT(!simd::hex_decode(invalid.data(), decoded.data(), 48));
+      DMITIGR_ASSERT(!simd::hex_decode_scalar(invalid.data(), decoded.data(), 48));
+    }
+
+    // Malformed input is decoded like libpq does.
+    const char* const malformed{"\\x0g1"};
+    const auto lenient = pgfe::Data::to_bytea(malformed);
+    std::size_t length{};
+    const Uptr expected{PQunescapeBytea(
+        reinterpret_cast<const unsigned char*>(malformed), &length), &PQfreemem};
+    DMITIGR_ASSERT(lenient->size() == length);
+    DMITIGR_ASSERT(!std::memcmp(lenient->bytes(), expected.get(), length));
+  }
+  std::vector<unsigned char> decoded(size);
+  measure("hex decode (scalar)", iteration_count, [&]
+  {
+    simd::hex_decode_scalar(hex.data(), decoded.data(), size);
+  });
+  measure("hex decode (vectorized)", iteration_count, [&]
+  {
+    simd::hex_decode(hex.data(), decoded.data(), size);
+  });
+  measure("hex decode (PQunescapeBytea)", iteration_count, [&]
+  {
+    std::size_t length{};
+    const Uptr unescaped{PQunescapeBytea(
+        reinterpret_cast<const unsigned char*>(text.c_str()), &length), &PQfreemem};
+  });
+  measure("hex decode (Data::to_bytea)", iteration_count, [&]
+  {
+    pgfe::Data::to_bytea(text.c_str());
+  });
+
+  // -------------------------------------------------------------------------
+  // Arrays
+  // -------------------------------------------------------------------------
+
+  std::string literal{"{"};
+  for (std::size_t i{}; literal.size() < size; ++i) {
+    if (i)
+      literal += ',';
+    literal += (i % 3) ? "\"quoted \\\"element\\\" number " : "unquoted_element_";
+    literal += std::to_string(i);
+    if (i % 3)
+      literal += '"';
+  }
+  literal += '}';
+  {
+    using Array = pgfe::Array_optional1<std::string>;
+    const auto elements = pgfe::to<Array>(pgfe::Data_view{literal.c_str()});
+    DMITIGR_ASSERT(elements.size() > 2);
+    DMITIGR_ASSERT(elements[0] == "unquoted_element_0");
+    DMITIGR_ASSERT(elements[1] == "quoted \"element\" number 1");
+    const auto arr = pgfe::to<Array>(
+      pgfe::Data_view{"{ a b ,NULL,\"c\\\\d\"}"});
+    DMITIGR_ASSERT(arr.size() == 3);
+    DMITIGR_ASSERT(arr[0] == "a b ");
+    DMITIGR_ASSERT(!arr[1]);
+    DMITIGR_ASSERT(arr[2] == "c\\d");
+  }
+  {
+    const char* const b{literal.data()};
+    const char* const e{b + literal.size()};
+    for (const char* p{b}; p != e;) {
+      const auto* const next = simd::find_first_of(p, e, '"', '\\', ',');
+      DMITIGR_ASSERT(next == simd::find_first_of_scalar(p, e, '"', '\\', ','));
+      p = next == e ? e : next + 1;
+    }
+  }
+  measure("array scan (scalar)", iteration_count, [&]
+  {
+    const char* const e{literal.data() + literal.size()};
+    for (const char* p{literal.data()}; p != e;) {
+      p = simd::find_first_of_scalar(p, e, '"', '\\', ',');
+      if (p != e)
+        ++p;
+    }
+  });
+  measure("array scan (vectorized)", iteration_count, [&]
+  {
+    const char* const e{literal.data() + literal.size()};
+    for (const char* p{literal.data()}; p != e;) {
+      p = simd::find_first_of(p, e, '"', '\\', ',');
+      if (p != e)
+        ++p;
+    }
+  });
+  measure("array parse", iteration_count, [&]
+  {
+    pgfe::to<pgfe::Array_optional1<std::string>>(pgfe::Data_view{literal.c_str()});
+  });
+} catch (const std::exception& e) {
+  std::cerr << e.what() << std::endl;
+  return 1;
+} catch (...) {
+  std::cerr << "unknown error" << std::endl;
+  return 2;
+}
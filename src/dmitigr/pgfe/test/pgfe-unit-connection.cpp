@@ -506,6 +506,21 @@ try {
         DMITIGR_ASSERT(conn->result_format() == pgfe::Data_format::text);
       }
 
+      // stats()
+      {
+        const auto before = conn->stats();
+        conn->execute("select generate_series(1, 100)");
+        const auto delta = conn->stats() - before;
+        DMITIGR_ASSERT(delta.request_count == 1);
+        DMITIGR_ASSERT(delta.wait_response_count >= 1);
+        DMITIGR_ASSERT(delta.wait_response_time.count() > 0);
+        DMITIGR_ASSERT(delta.flush_count >= 1);
+#ifdef __linux__
+        DMITIGR_ASSERT(delta.bytes_acked > 0);
+        DMITIGR_ASSERT(delta.bytes_received > 0);
+#endif
+      }
+
       // to_quoted_literal(), to_quoted_identifier()
       {
         const std::string s{"the string"};
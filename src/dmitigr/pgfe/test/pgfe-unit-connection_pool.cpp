@@ -59,6 +59,16 @@ try {
 
     auto conn4 = pool.connection();
     DMITIGR_ASSERT(!conn4);
+
+    // The counters of the connections in use are accounted as of borrowing.
+    const auto stats = pool.stats();
+    conn3->execute("select 3");
+    DMITIGR_ASSERT(pool.stats().request_count == stats.request_count);
+    conn3.release();
+    DMITIGR_ASSERT(pool.stats().request_count > stats.request_count);
+    DMITIGR_ASSERT(pool.stats().wait_response_count > stats.wait_response_count);
+    conn3 = pool.connection();
+    DMITIGR_ASSERT(conn3);
     pool.disconnect();
     DMITIGR_ASSERT(!pool.is_connected());
     DMITIGR_ASSERT(conn1->is_connected());
@@ -0,0 +1,110 @@
+// -*- C++ -*-
+//
+// Copyright 2023 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "pgfe-unit.hpp"
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#define ASSERT DMITIGR_ASSERT
+
+int main()
+try {
+  namespace pgfe = dmitigr::pgfe;
+  using Loader = pgfe::Copy_loader;
+
+  // Prepare.
+  auto conn = pgfe::test::make_connection();
+  conn->connect();
+  conn->execute("drop table if exists pgfe_copy_loader");
+  conn->execute("create table pgfe_copy_loader(id integer not null, str text)");
+  const auto count = [&conn]
+  {
+    long result{};
+    conn->execute([&result](auto&& row)
+    {
+      result = pgfe::to<long>(row[0]);
+    }, "select count(*) from pgfe_copy_loader");
+    return result;
+  };
+
+  constexpr std::size_t worker_count{3};
+  pgfe::Connection_pool pool{worker_count, pgfe::test::connection_options()};
+  pool.connect();
+
+  Loader loader{pool, "copy pgfe_copy_loader from stdin (format csv)",
+    worker_count};
+  ASSERT(loader.worker_count() == worker_count);
+  ASSERT(loader.commit_mode() == Loader::Commit_mode::independent);
+  ASSERT(loader.input_format() == Loader::Input_format::text);
+  loader.set_chunk_size(64);
+  ASSERT(loader.chunk_size() == 64);
+
+  // Load from the range.
+  std::vector<std::string> rows;
+  for (int i{}; i < 1000; ++i)
+    rows.push_back(std::to_string(i).append(",str").append(std::to_string(i)));
+  loader.load(cbegin(rows), cend(rows));
+  ASSERT(count() == 1000);
+  ASSERT(loader.worker_stats().size() == worker_count);
+  std::size_t row_count{};
+  for (const auto& stats : loader.worker_stats()) {
+    row_count += stats.row_count;
+    std::cout << "worker: " << stats.row_count << " rows, "
+              << stats.byte_count << " bytes, "
+              << stats.throughput() << " bytes/s" << std::endl;
+  }
+  ASSERT(row_count == 1000);
+
+  // Load from the stream with the multiline quoted values.
+  loader.set_input_format(Loader::Input_format::csv);
+  std::stringstream input;
+  for (int i{}; i < 1000; ++i)
+    input << i << ",\"multi\nline \"\"" << i << "\"\"\"\n";
+  loader.load(input);
+  ASSERT(count() == 2000);
+  conn->execute([](auto&& row)
+  {
+    ASSERT(pgfe::to<std::string>(row[0]) == "multi\nline \"7\"");
+  }, "select str from pgfe_copy_loader where str like 'multi%' and id = 7");
+
+  // Load malformed input.
+  {
+    const std::vector<std::string> malformed{"1,one", "two,2", "3,three"};
+    bool is_thrown{};
+    try {
+      loader.load(cbegin(malformed), cend(malformed));
+    } catch (const pgfe::Sqlstate_exception&) {
+      is_thrown = true;
+    }
+    ASSERT(is_thrown);
+    ASSERT(count() == 2000);
+  }
+
+  // Load after the failure.
+  loader.set_input_format(Loader::Input_format::text);
+  loader.load(cbegin(rows), cend(rows));
+  ASSERT(count() == 3000);
+
+  conn->execute("drop table pgfe_copy_loader");
+} catch (const std::exception& e) {
+  std::cerr << e.what() << std::endl;
+  return 1;
+} catch (...) {
+  std::cerr << "unknown error" << std::endl;
+  return 2;
+}
@@ -0,0 +1,87 @@
+// -*- C++ -*-
+//
+// Copyright 2023 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "pgfe-unit.hpp"
+
+#define ASSERT DMITIGR_ASSERT
+
+int main()
+try {
+  namespace pgfe = dmitigr::pgfe;
+  using pgfe::to;
+
+  auto conn = pgfe::test::make_connection();
+  conn->connect();
+
+  // Streaming in the transaction owned by the cursor.
+  {
+    pgfe::Cursor cursor{*conn, "c1",
+      "select generate_series(1, :n::int) i, repeat('x', 100) s", 10000};
+    ASSERT(cursor.owns_transaction());
+    ASSERT(conn->is_transaction_uncommitted());
+    cursor.set_fetch_count_limits(10, 1000);
+    cursor.set_batch_size_target(16*1024);
+    int expected{1};
+    while (const auto row = cursor.next()) {
+      ASSERT(to<int>(row["i"]) == expected);
+      ++expected;
+    }
+    ASSERT(expected == 10000 + 1);
+    ASSERT(cursor.is_exhausted());
+    ASSERT(cursor.fetch_count() < 1000);
+    ASSERT(conn->is_ready_for_request());
+    ASSERT(!cursor.next());
+    cursor.close();
+    ASSERT(cursor.is_closed());
+    ASSERT(!conn->is_transaction_uncommitted());
+  }
+
+  // Streaming in the transaction of the caller.
+  {
+    conn->execute("begin");
+    {
+      pgfe::Cursor cursor{*conn, "c2", "select generate_series(1, 3)"};
+      ASSERT(!cursor.owns_transaction());
+      ASSERT(cursor.next());
+    } // the cursor is closed by the destructor
+    ASSERT(conn->is_ready_for_request());
+    ASSERT(conn->is_transaction_uncommitted());
+    conn->execute("commit");
+  }
+
+  // Error while streaming.
+  {
+    pgfe::Cursor cursor{*conn, "c3", "select 1/(3 - i) from generate_series(1, 5) i"};
+    cursor.set_fetch_count_limits(1, 1);
+    bool is_thrown{};
+    try {
+      while (cursor.next());
+    } catch (const pgfe::Sqlstate_exception& e) {
+      ASSERT(e.error()->condition() == pgfe::Sqlstate::c22_division_by_zero);
+      is_thrown = true;
+    }
+    ASSERT(is_thrown);
+    ASSERT(cursor.is_closed());
+    ASSERT(conn->is_ready_for_request());
+    ASSERT(!conn->is_transaction_uncommitted());
+  }
+} catch (const std::exception& e) {
+  std::cerr << e.what() << std::endl;
+  return 1;
+} catch (...) {
+  std::cerr << "unknown error" << std::endl;
+  return 2;
+}
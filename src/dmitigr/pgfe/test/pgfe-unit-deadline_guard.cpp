@@ -0,0 +1,80 @@
+// -*- C++ -*-
+//
+// Copyright 2023 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "pgfe-unit.hpp"
+
+#include <chrono>
+
+#define ASSERT DMITIGR_ASSERT
+
+int main()
+try {
+  namespace pgfe = dmitigr::pgfe;
+  using std::chrono::milliseconds;
+  using Clock = pgfe::Deadline_guard::Clock;
+
+  auto conn = pgfe::test::make_connection();
+  conn->connect();
+  ASSERT(!conn->deadline());
+
+  // The deadline of the outer guard is not extended by the inner one.
+  {
+    pgfe::Deadline_guard outer{*conn, milliseconds{1000}};
+    const auto deadline = outer.deadline();
+    ASSERT(conn->deadline() == deadline);
+    {
+      pgfe::Deadline_guard inner{*conn, milliseconds{60000}};
+      ASSERT(inner.deadline() == deadline);
+    }
+    {
+      pgfe::Deadline_guard inner{*conn, milliseconds{10}};
+      ASSERT(inner.deadline() < deadline);
+      ASSERT(inner.time_left() <= milliseconds{10});
+    }
+    ASSERT(conn->deadline() == deadline);
+  }
+  ASSERT(!conn->deadline());
+
+  // The statement is cancelled upon the deadline.
+  {
+    const auto started = Clock::now();
+    bool is_thrown{};
+    try {
+      pgfe::Deadline_guard dg{*conn, milliseconds{200}};
+      conn->execute("select pg_sleep(10)");
+    } catch (const pgfe::Generic_exception& e) {
+      ASSERT(e.code() == pgfe::Errc::deadline_exceeded);
+      is_thrown = true;
+    }
+    ASSERT(is_thrown);
+    ASSERT(Clock::now() - started < milliseconds{5000});
+    ASSERT(conn->is_connected());
+    ASSERT(conn->is_ready_for_request());
+    ASSERT(conn->execute("select 1").row_count() == 1);
+  }
+
+  // The statement which fits in the deadline.
+  {
+    pgfe::Deadline_guard dg{*conn, milliseconds{5000}};
+    ASSERT(conn->execute("select pg_sleep(0.1)").row_count() == 1);
+  }
+} catch (const std::exception& e) {
+  std::cerr << e.what() << std::endl;
+  return 1;
+} catch (...) {
+  std::cerr << "unknown error" << std::endl;
+  return 2;
+}
@@ -0,0 +1,93 @@
+// -*- C++ -*-
+//
+// Copyright 2023 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "pgfe-unit.hpp"
+
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+#define ASSERT DMITIGR_ASSERT
+
+int main()
+try {
+  namespace pgfe = dmitigr::pgfe;
+  namespace thread = dmitigr::thread;
+
+  auto conn = pgfe::test::make_connection();
+  conn->connect();
+
+  constexpr int row_count{10000};
+  constexpr long long expected_sum{row_count*(row_count + 1LL)/2};
+  const pgfe::Statement query{"select generate_series(1, $1)"};
+
+  thread::Pool threads{4};
+  pgfe::Parallel_row_processor processor{threads, 4};
+  ASSERT(processor.worker_count() == 4);
+  processor.set_batch_size(100);
+  ASSERT(processor.batch_size() == 100);
+  processor.set_queue_capacity(4);
+  ASSERT(processor.queue_capacity() == 4);
+
+  // Unordered delivery.
+  {
+    std::atomic<long long> sum{};
+    const auto comp = processor.execute(*conn, [&sum](auto&& row)
+    {
+      sum += pgfe::to<int>(row[0]);
+    }, query, row_count);
+    ASSERT(comp.tag() == "SELECT");
+    ASSERT(sum == expected_sum);
+  }
+
+  // Ordered delivery.
+  {
+    std::vector<int> values;
+    processor.execute(*conn, [](auto&& row)
+    {
+      return pgfe::to<int>(row[0]);
+    }, [&values](int&& value)
+    {
+      values.push_back(value);
+    }, query, row_count);
+    ASSERT(values.size() == row_count);
+    for (int i{}; i < row_count; ++i)
+      ASSERT(values[i] == i + 1);
+  }
+
+  // Exception of the callback.
+  {
+    bool is_thrown{};
+    try {
+      processor.execute(*conn, [](auto&& row)
+      {
+        if (pgfe::to<int>(row[0]) == row_count/2)
+          throw std::runtime_error{"test"};
+      }, query, row_count);
+    } catch (const std::runtime_error&) {
+      is_thrown = true;
+    }
+    ASSERT(is_thrown);
+    ASSERT(conn->is_ready_for_request());
+    ASSERT(conn->execute("select 1").row_count() == 1);
+  }
+} catch (const std::exception& e) {
+  std::cerr << e.what() << std::endl;
+  return 1;
+} catch (...) {
+  std::cerr << "unknown error" << std::endl;
+  return 2;
+}
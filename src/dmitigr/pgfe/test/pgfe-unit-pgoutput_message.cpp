@@ -0,0 +1,182 @@
+// -*- C++ -*-
+//
+// Copyright 2023 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "pgfe-unit.hpp"
+
+#include <string>
+
+int main()
+try {
+  namespace pgfe = dmitigr::pgfe;
+  using Type = pgfe::Pgoutput_message_type;
+  using Kind = pgfe::Pgoutput_value::Kind;
+  using namespace std::string_literals;
+
+  // -------------------------------------------------------------------------
+  // LSN
+  // -------------------------------------------------------------------------
+
+  DMITIGR_ASSERT(pgfe::to_lsn("16/B374D848") == 0x16B374D848);
+  DMITIGR_ASSERT(pgfe::to_lsn("0/0") == 0);
+  DMITIGR_ASSERT(!pgfe::to_lsn("16B374D848"));
+  DMITIGR_ASSERT(!pgfe::to_lsn("/1"));
+  DMITIGR_ASSERT(!pgfe::to_lsn("1/x"));
+  DMITIGR_ASSERT(pgfe::to_lsn_string(0x16B374D848) == "16/B374D848");
+  DMITIGR_ASSERT(pgfe::to_lsn_string(0) == "0/0");
+
+  // -------------------------------------------------------------------------
+  // Messages
+  // -------------------------------------------------------------------------
+
+  pgfe::Pgoutput_message message;
+  DMITIGR_ASSERT(!message);
+  DMITIGR_ASSERT(message.type() == Type::invalid);
+
+  // Begin
+  {
+    const auto bytes = "B"
+      "\x00\x00\x00\x16\xB3\x74\xD8\x48"s // final LSN
+      "\x00\x00\x00\x00\x00\x00\x00\x2A"s // timestamp
+      "\x00\x00\x02\x00"s; // xid
+    message.assign(bytes);
+    DMITIGR_ASSERT(message && message.type() == Type::begin);
+    DMITIGR_ASSERT(message.commit_lsn() == 0x16B374D848);
+    DMITIGR_ASSERT(message.commit_timestamp() == 42);
+    DMITIGR_ASSERT(message.xid() == 512);
+    DMITIGR_ASSERT(message.bytes().data() == bytes.data());
+  }
+
+  // Commit
+  {
+    const auto bytes = "C\x00"s
+      "\x00\x00\x00\x00\x00\x00\x01\x00"s // commit LSN
+      "\x00\x00\x00\x00\x00\x00\x01\x10"s // end LSN
+      "\x00\x00\x00\x00\x00\x00\x00\x2B"s; // timestamp
+    message.assign(bytes);
+    DMITIGR_ASSERT(message.type() == Type::commit);
+    DMITIGR_ASSERT(message.commit_lsn() == 0x100);
+    DMITIGR_ASSERT(message.end_lsn() == 0x110);
+    DMITIGR_ASSERT(message.commit_timestamp() == 43);
+    DMITIGR_ASSERT(!message.xid());
+  }
+
+  // Relation
+  {
+    const auto bytes = "R"
+      "\x00\x00\x40\x00"s // relation Oid
+      "public\0"s "tab\0"s "d"
+      "\x00\x02"s // column count
+      "\x01" "id\0"s "\x00\x00\x00\x17"s "\xFF\xFF\xFF\xFF"s
+      "\x00" "name\0"s "\x00\x00\x00\x19"s "\xFF\xFF\xFF\xFF"s;
+    message.assign(bytes);
+    DMITIGR_ASSERT(message.type() == Type::relation);
+    DMITIGR_ASSERT(message.relation_oid() == 0x4000);
+    DMITIGR_ASSERT(message.relation_namespace() == "public");
+    DMITIGR_ASSERT(message.relation_name() == "tab");
+    DMITIGR_ASSERT(message.replica_identity() == 'd');
+    const auto& columns = message.columns();
+    DMITIGR_ASSERT(columns.size() == 2);
+    DMITIGR_ASSERT(columns[0].is_key && columns[0].name == "id");
+    DMITIGR_ASSERT(columns[0].type_oid == 23 && columns[0].type_modifier == -1);
+    DMITIGR_ASSERT(!columns[1].is_key && columns[1].name == "name");
+    DMITIGR_ASSERT(columns[1].type_oid == 25);
+  }
+
+  // Insert
+  {
+    const auto bytes = "I"
+      "\x00\x00\x40\x00"s "N"
+      "\x00\x02"s // column count
+      "t\x00\x00\x00\x01"s "1"
+      "n"s;
+    message.assign(bytes);
+    DMITIGR_ASSERT(message.type() == Type::insert);
+    DMITIGR_ASSERT(message.relation_oid() == 0x4000);
+    DMITIGR_ASSERT(message.columns().empty());
+    DMITIGR_ASSERT(!message.old_tuple_kind() && message.old_tuple().empty());
+    const auto& tuple = message.new_tuple();
+    DMITIGR_ASSERT(tuple.size() == 2);
+    DMITIGR_ASSERT(tuple[0].kind == Kind::text && tuple[0].data == "1");
+    DMITIGR_ASSERT(tuple[0].data.data() == bytes.data() + 13);
+    DMITIGR_ASSERT(tuple[1].kind == Kind::null && tuple[1].data.empty());
+  }
+
+  // Update with the old key
+  {
+    const auto bytes = "U"
+      "\x00\x00\x40\x00"s
+      "K\x00\x01"s "t\x00\x00\x00\x01"s "1"
+      "N\x00\x02"s "t\x00\x00\x00\x01"s "2" "u";
+    message.assign(bytes);
+    DMITIGR_ASSERT(message.type() == Type::update);
+    DMITIGR_ASSERT(message.old_tuple_kind() == 'K');
+    DMITIGR_ASSERT(message.old_tuple().size() == 1);
+    DMITIGR_ASSERT(message.old_tuple()[0].data == "1");
+    DMITIGR_ASSERT(message.new_tuple().size() == 2);
+    DMITIGR_ASSERT(message.new_tuple()[0].data == "2");
+    DMITIGR_ASSERT(message.new_tuple()[1].kind == Kind::unchanged_toast);
+  }
+
+  // Update without the old tuple
+  {
+    const auto bytes = "U"
+      "\x00\x00\x40\x00"s
+      "N\x00\x01"s "b\x00\x00\x00\x02"s "\x00\x01"s;
+    message.assign(bytes);
+    DMITIGR_ASSERT(!message.old_tuple_kind() && message.old_tuple().empty());
+    DMITIGR_ASSERT(message.new_tuple().size() == 1);
+    DMITIGR_ASSERT(message.new_tuple()[0].kind == Kind::binary);
+    DMITIGR_ASSERT(message.new_tuple()[0].data == "\x00\x01"s);
+  }
+
+  // Delete
+  {
+    const auto bytes = "D"
+      "\x00\x00\x40\x00"s
+      "O\x00\x01"s "t\x00\x00\x00\x02"s "42";
+    message.assign(bytes);
+    DMITIGR_ASSERT(message.type() == Type::delete_);
+    DMITIGR_ASSERT(message.old_tuple_kind() == 'O');
+    DMITIGR_ASSERT(message.old_tuple().size() == 1);
+    DMITIGR_ASSERT(message.old_tuple()[0].data == "42");
+    DMITIGR_ASSERT(message.new_tuple().empty());
+  }
+
+  // Not decoded
+  {
+    const pgfe::Pgoutput_message truncate{"T\x00\x00\x00\x00"s};
+    DMITIGR_ASSERT(truncate.type() == Type::truncate);
+    DMITIGR_ASSERT(truncate.bytes().size() == 5);
+  }
+
+  // Malformed
+  {
+    bool is_thrown{};
+    try {
+      message.assign("I\x00\x00\x40\x00N\x00\x01t\x00\x00\x00\x05" "1"s);
+    } catch (const pgfe::Generic_exception&) {
+      is_thrown = true;
+    }
+    DMITIGR_ASSERT(is_thrown);
+    DMITIGR_ASSERT(!message);
+  }
+} catch (const std::exception& e) {
+  std::cerr << e.what() << std::endl;
+  return 1;
+} catch (...) {
+  std::cerr << "unknown error" << std::endl;
+  return 2;
+}
@@ -119,6 +119,47 @@ try {
   conn->set_pipeline_enabled(false);
   ASSERT(conn->is_ready_for_request());
   ASSERT(conn->is_ready_for_nio_request());
+
+  /*
+   * Test case 5 (bounded pipelined execution).
+   */
+  {
+    const pgfe::Statement_vector statements{
+      "create temp table seq(id integer not null);"
+      "insert into seq select generate_series(1, 10);"
+      "-- empty statement\n;"
+      "select id from seq order by id;"
+      "select count(*) from seq;"
+      "drop table seq"};
+    int sum{};
+    const auto executed = conn->execute_pipelined([&sum](auto&& row)
+    {
+      sum += to<int>(row[0]);
+    }, statements, 2);
+    ASSERT(executed == 5);
+    ASSERT(sum == 55 + 10);
+    ASSERT(conn->is_ready_for_request());
+    ASSERT(conn->pipeline_status() == Pipeline_status::disabled);
+  }
+
+  /*
+   * Test case 6 (error in the middle of pipelined execution).
+   */
+  {
+    pgfe::Statement_reader reader{
+      "select 1; select 1/0; select 3; select 4; select 5"};
+    bool is_thrown{};
+    try {
+      conn->execute_pipelined(reader, 4);
+    } catch (const pgfe::Sqlstate_exception& e) {
+      ASSERT(e.error()->condition() == pgfe::Sqlstate::c22_division_by_zero);
+      is_thrown = true;
+    }
+    ASSERT(is_thrown);
+    ASSERT(conn->is_ready_for_request());
+    ASSERT(conn->pipeline_status() == Pipeline_status::disabled);
+    conn->execute("select 1");
+  }
   conn->set_pipeline_enabled(true);
   ASSERT(!conn->is_ready_for_request());
   ASSERT(conn->is_ready_for_nio_request());
@@ -149,6 +149,37 @@ try {
     ++i;
   });
 
+  // Test parameter buffering.
+  DMITIGR_ASSERT(!ps2.is_parameter_buffering_enabled());
+  ps2.set_parameter_buffering_enabled(true);
+  DMITIGR_ASSERT(ps2.is_parameter_buffering_enabled());
+  for (int sup{1}; sup <= 3; ++sup) {
+    ps2.bind_many(1, sup);
+    DMITIGR_ASSERT(ps2.bound(0) && to<int>(ps2.bound(0)) == 1);
+    DMITIGR_ASSERT(ps2.bound(1) && to<int>(ps2.bound(1)) == sup);
+    int count{};
+    ps2.execute([&count](auto&&){++count;});
+    DMITIGR_ASSERT(count == sup);
+  }
+  ps2.bind("supremum", std::string{"2"});
+  DMITIGR_ASSERT(to<std::string_view>(ps2.bound(1)) == "2");
+  ps2.bind("supremum", std::optional<int>{});
+  DMITIGR_ASSERT(!ps2.bound(1));
+  ps2.bind("supremum", *data1);
+  DMITIGR_ASSERT(ps2.bound(1) == *data1);
+  ps2.bind("supremum", 0.1);
+  DMITIGR_ASSERT(to<double>(ps2.bound(1)) == 0.1);
+  ps2.bind("supremum", true);
+  DMITIGR_ASSERT(to<bool>(ps2.bound(1)));
+  ps2.bind("supremum", "3");
+  DMITIGR_ASSERT(to<std::string_view>(ps2.bound(1)) == "3");
+  try {
+    ps2.bind("supremum", static_cast<const char*>(nullptr));
+    DMITIGR_ASSERT(false);
+  } catch (const pgfe::Generic_exception&) {}
+  DMITIGR_ASSERT(to<std::string_view>(ps2.bound(1)) == "3");
+  ps2.set_parameter_buffering_enabled(false);
+
   // Test invalidation of prepared statements after disconnection.
   auto ps3 = conn->prepare("select 3", "ps3");
   auto ps3_2 = conn->describe("ps3");
@@ -0,0 +1,139 @@
+// -*- C++ -*-
+//
+// Copyright 2023 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "pgfe-unit.hpp"
+
+#include <string>
+
+#define ASSERT DMITIGR_ASSERT
+
+int main()
+try {
+  namespace pgfe = dmitigr::pgfe;
+  using pgfe::Data_format;
+  using namespace std::string_literals;
+
+  const auto is_thrown = [](const auto& f)
+  {
+    try {
+      f();
+    } catch (const pgfe::Generic_exception&) {
+      return true;
+    }
+    return false;
+  };
+
+  // Invalid record.
+  {
+    pgfe::Record_view rec;
+    ASSERT(!rec);
+    ASSERT(rec.is_empty());
+    ASSERT(rec.field_count() == 0);
+    ASSERT(rec.begin() == rec.end());
+  }
+
+  // Malformed records.
+  {
+    const auto text = pgfe::Data::make("(1,2)");
+    ASSERT(is_thrown([&]{pgfe::Record_view{*text};}));
+    const auto truncated = pgfe::Data::make(
+      "\x00\x00\x00\x01"
+      "\x00\x00\x00\x17\x00\x00\x00\x04\x00\x00"s, Data_format::binary);
+    ASSERT(is_thrown([&]{pgfe::Record_view{*truncated};}));
+    const auto trailing = pgfe::Data::make("\x00\x00\x00\x00\x00"s,
+      Data_format::binary);
+    ASSERT(is_thrown([&]{pgfe::Record_view{*trailing};}));
+    // The huge field count must be rejected before allocating the offsets.
+    const auto huge = pgfe::Data::make("\x7f\xff\xff\xff"s,
+      Data_format::binary);
+    ASSERT(is_thrown([&]{pgfe::Record_view{*huge};}));
+  }
+
+  // row(42, row('foo', null))
+  {
+    const auto nested =
+      "\x00\x00\x00\x02"s // field count
+      "\x00\x00\x00\x19\x00\x00\x00\x03" "foo"s // text
+      "\x00\x00\x00\x17\xFF\xFF\xFF\xFF"s; // null int4
+    const auto size = "\x00\x00\x00"s + static_cast<char>(nested.size());
+    const auto data = pgfe::Data::make(
+      "\x00\x00\x00\x02"s // field count
+      "\x00\x00\x00\x17\x00\x00\x00\x04\x00\x00\x00\x2A"s // int4
+      "\x00\x00\x08\xC9"s + size + nested, // record
+      Data_format::binary);
+
+    const auto rec = pgfe::to<pgfe::Record_view>(*data);
+    ASSERT(rec);
+    ASSERT(rec.field_count() == 2);
+    ASSERT(rec.field_name(0).empty());
+    ASSERT(rec.field_index("", 1) == 1);
+    ASSERT(rec.field_index("id") == rec.field_count());
+    ASSERT(rec.field_type_oid(0) == 23);
+    ASSERT(rec.field_type_oid(1) == 2249);
+    ASSERT(rec[0].format() == Data_format::binary);
+    ASSERT(pgfe::to<int>(rec[0]) == 42);
+    ASSERT(is_thrown([&]{rec.data(2);}));
+
+    // The fields point into the source data.
+    const auto* const begin = static_cast<const char*>(data->bytes());
+    const auto* const field = static_cast<const char*>(rec[1].bytes());
+    ASSERT(begin < field && field < begin + data->size());
+
+    const auto rec2 = pgfe::to<pgfe::Record_view>(rec[1]);
+    ASSERT(rec2.field_count() == 2);
+    ASSERT(pgfe::to<std::string_view>(rec2[0]) == "foo");
+    ASSERT(!rec2[1]);
+
+    // Iteration.
+    std::size_t count{};
+    for (const auto& fld : rec2) {
+      if (count == 0) {
+        ASSERT(fld.type_oid == 25);
+        ASSERT(fld.data.size() == 3);
+      } else {
+        ASSERT(fld.type_oid == 23);
+        ASSERT(!fld.data);
+      }
+      ++count;
+    }
+    ASSERT(count == rec2.field_count());
+  }
+
+  // Random access to the fields of the wide record.
+  {
+    const int count{100};
+    auto bytes = "\x00\x00\x00"s + static_cast<char>(count);
+    for (int i{}; i < count; ++i) {
+      bytes += "\x00\x00\x00\x17\x00\x00\x00\x04\x00\x00\x00"s;
+      bytes += static_cast<char>(i);
+    }
+    const auto data = pgfe::Data::make(bytes, Data_format::binary);
+    const auto rec = pgfe::to<pgfe::Record_view>(*data);
+    ASSERT(rec.field_count() == count);
+    for (int i{count - 1}; i >= 0; --i) {
+      ASSERT(rec.field_type_oid(static_cast<std::size_t>(i)) == 23);
+      ASSERT(pgfe::to<int>(rec[static_cast<std::size_t>(i)]) == i);
+    }
+    const auto copy = rec;
+    ASSERT(pgfe::to<int>(copy[99]) == 99);
+  }
+} catch (const std::exception& e) {
+  std::cerr << e.what() << std::endl;
+  return 1;
+} catch (...) {
+  std::cerr << "unknown error" << std::endl;
+  return 2;
+}
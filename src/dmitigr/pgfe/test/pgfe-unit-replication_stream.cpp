@@ -0,0 +1,163 @@
+// -*- C++ -*-
+//
+// Copyright 2023 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Requires `wal_level = logical` and the REPLICATION attribute of the user.
+
+#include "pgfe-unit.hpp"
+
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#define ASSERT DMITIGR_ASSERT
+
+int main()
+try {
+  namespace pgfe = dmitigr::pgfe;
+  using Type = pgfe::Pgoutput_message_type;
+  using Kind = pgfe::Pgoutput_value::Kind;
+  using std::chrono::seconds;
+
+  const auto drop_slot = [](pgfe::Connection& conn)
+  {
+    conn.execute("select pg_drop_replication_slot(slot_name)"
+      " from pg_replication_slots where slot_name = 'pgfe_test_slot'");
+  };
+
+  // Prepare.
+  auto conn = pgfe::test::make_connection();
+  conn->connect();
+  drop_slot(*conn);
+  conn->execute("drop publication if exists pgfe_test_publication");
+  conn->execute("drop table if exists pgfe_test_replication");
+  conn->execute("create table pgfe_test_replication(id integer primary key,"
+    " name text)");
+  conn->execute("create publication pgfe_test_publication"
+    " for table pgfe_test_replication");
+  conn->execute("select pg_create_logical_replication_slot('pgfe_test_slot',"
+    " 'pgoutput')");
+
+  // The stream requires the connection in the logical replication mode.
+  {
+    bool is_thrown{};
+    try {
+      pgfe::Replication_stream stream{*conn, "pgfe_test_slot",
+        "pgfe_test_publication"};
+    } catch (const pgfe::Generic_exception&) {
+      is_thrown = true;
+    }
+    ASSERT(is_thrown);
+    ASSERT(conn->is_ready_for_request());
+  }
+
+  pgfe::Connection repl{pgfe::test::connection_options()
+    .set(pgfe::Replication_mode::logical)};
+  ASSERT(repl.options().replication_mode() == pgfe::Replication_mode::logical);
+  repl.connect();
+  ASSERT(repl.is_connected());
+
+  pgfe::Lsn end_lsn{};
+  {
+    pgfe::Replication_stream stream{repl, "pgfe_test_slot",
+      "pgfe_test_publication"};
+    ASSERT(!stream.is_stopped());
+    ASSERT(&stream.connection() == &repl);
+    ASSERT(!repl.is_ready_for_request());
+
+    // Nothing is changed yet.
+    ASSERT(!stream.receive(std::chrono::milliseconds{100}));
+    ASSERT(!stream.is_stopped());
+
+    conn->execute("insert into pgfe_test_replication values"
+      " (1, 'one'), (2, NULL)");
+
+    // Consume Begin, Relation, Insert, Insert, Commit.
+    std::uint32_t xid{};
+    pgfe::Oid relation_oid{};
+    std::vector<std::pair<std::string, std::optional<std::string>>> rows;
+    std::vector<Type> types;
+    while (true) {
+      const auto& message = stream.receive(seconds{10});
+      ASSERT(message);
+      types.push_back(message.type());
+      if (message.type() == Type::begin) {
+        xid = message.xid();
+        ASSERT(xid);
+        ASSERT(message.commit_lsn());
+      } else if (message.type() == Type::relation) {
+        relation_oid = message.relation_oid();
+        ASSERT(message.relation_namespace() == "public");
+        ASSERT(message.relation_name() == "pgfe_test_replication");
+        const auto& columns = message.columns();
+        ASSERT(columns.size() == 2);
+        ASSERT(columns[0].is_key && columns[0].name == "id");
+        ASSERT(columns[0].type_oid == 23);
+        ASSERT(!columns[1].is_key && columns[1].name == "name");
+        ASSERT(columns[1].type_oid == 25);
+      } else if (message.type() == Type::insert) {
+        ASSERT(message.relation_oid() == relation_oid);
+        const auto& tuple = message.new_tuple();
+        ASSERT(tuple.size() == 2);
+        ASSERT(tuple[0].kind == Kind::text);
+        auto& row = rows.emplace_back(std::string{tuple[0].data}, std::nullopt);
+        if (tuple[1].kind != Kind::null) {
+          ASSERT(tuple[1].kind == Kind::text);
+          row.second = std::string{tuple[1].data};
+        }
+      } else if (message.type() == Type::commit) {
+        ASSERT(message.end_lsn() >= message.commit_lsn());
+        ASSERT(stream.received_lsn());
+        end_lsn = message.end_lsn();
+        stream.confirm(end_lsn);
+        ASSERT(stream.confirmed_lsn() == end_lsn);
+        break;
+      }
+    }
+    ASSERT((types == std::vector<Type>{Type::begin, Type::relation,
+          Type::insert, Type::insert, Type::commit}));
+    ASSERT((rows == std::vector<std::pair<std::string,
+          std::optional<std::string>>>{{"1", "one"}, {"2", std::nullopt}}));
+
+    // The status update is sent through the bidirectional copier.
+    stream.send_status(true);
+    ASSERT(!stream.receive(std::chrono::milliseconds{100}));
+
+    stream.stop();
+    ASSERT(stream.is_stopped());
+    ASSERT(!stream.receive(seconds{1}));
+    ASSERT(repl.is_ready_for_request());
+  }
+
+  // The slot is advanced to the confirmed LSN upon the stop.
+  repl.disconnect();
+  conn->execute([](auto&& row)
+  {
+    ASSERT(pgfe::to<bool>(row[0]));
+  }, "select confirmed_flush_lsn >= $1::pg_lsn from pg_replication_slots"
+    " where slot_name = 'pgfe_test_slot'", pgfe::to_lsn_string(end_lsn));
+
+  // Cleanup.
+  drop_slot(*conn);
+  conn->execute("drop publication pgfe_test_publication");
+  conn->execute("drop table pgfe_test_replication");
+} catch (const std::exception& e) {
+  std::cerr << e.what() << std::endl;
+  return 1;
+} catch (...) {
+  std::cerr << "unknown error" << std::endl;
+  return 2;
+}
@@ -0,0 +1,142 @@
+// -*- C++ -*-
+//
+// Copyright 2023 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "pgfe-unit.hpp"
+
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define ASSERT DMITIGR_ASSERT
+
+int main()
+try {
+  namespace pgfe = dmitigr::pgfe;
+  using std::chrono::milliseconds;
+
+  auto conn = pgfe::test::make_connection();
+  conn->connect();
+  conn->execute("create temp table country(code text, name text)");
+  conn->execute("insert into country values ('ru', 'Russia'), ('by', NULL)");
+
+  pgfe::Result_cache cache{1024*1024, milliseconds{60000}};
+  ASSERT(cache.capacity() == 1024*1024);
+  ASSERT(cache.ttl() == milliseconds{60000});
+  ASSERT(cache.is_empty());
+
+  using Rows = std::vector<std::pair<std::string, std::optional<std::string>>>;
+  const auto select = [&](const std::string& code = {})
+  {
+    Rows result;
+    const auto callback = [&result](auto&& row)
+    {
+      result.emplace_back(pgfe::to<std::string>(row["code"]),
+        pgfe::to<std::optional<std::string>>(row["name"]));
+    };
+    const auto comp = code.empty() ?
+      cache.execute(*conn, {"country"}, callback,
+        "select * from country order by code") :
+      cache.execute(*conn, {"country"}, callback,
+        "select * from country where code = $1", code);
+    ASSERT(comp.tag() == "SELECT");
+    ASSERT(comp.row_count() == static_cast<long>(result.size()));
+    return result;
+  };
+
+  // Miss and hit.
+  const Rows all{{"by", std::nullopt}, {"ru", "Russia"}};
+  ASSERT(select() == all);
+  ASSERT(cache.size() == 1 && !cache.hit_count() && cache.miss_count() == 1);
+  ASSERT(cache.memory_usage() > 0);
+  conn->execute("insert into country values ('ge', 'Georgia')");
+  ASSERT(select() == all);
+  ASSERT(cache.hit_count() == 1);
+
+  // The parameters are the part of the key.
+  const Rows ru{{"ru", "Russia"}};
+  const Rows ge{{"ge", "Georgia"}};
+  ASSERT(select("ru") == ru);
+  ASSERT(select("ge") == ge);
+  ASSERT(select("ru") == ru);
+  ASSERT(cache.size() == 3 && cache.hit_count() == 2);
+
+  // The result format of the connection is the part of the key.
+  {
+    pgfe::Result_cache format_cache{1024*1024, milliseconds{60000}};
+    const auto execute = [&]
+    {
+      format_cache.execute(*conn, [](auto&&){}, "select 1::int");
+    };
+    execute();
+    conn->set_result_format(pgfe::Data_format::binary);
+    execute();
+    conn->set_result_format(pgfe::Data_format::text);
+    ASSERT(!format_cache.hit_count() && format_cache.miss_count() == 2);
+    execute();
+    ASSERT(format_cache.hit_count() == 1);
+  }
+
+  // Invalidation by the table mapped to the channel.
+  cache.map_table("country", "country_changed");
+  cache.listen(*conn);
+  conn->execute("notify country_changed");
+  ASSERT(cache.is_empty());
+  ASSERT(select().size() == 3);
+  ASSERT(cache.size() == 1);
+  ASSERT(cache.invalidate("country") == 1);
+  ASSERT(cache.is_empty());
+
+  // Invalidation while the query is being executed.
+  cache.execute(*conn, {"country"}, [&cache](auto&&)
+  {
+    cache.invalidate("country");
+  }, "select * from country");
+  ASSERT(cache.is_empty());
+
+  // Expiration.
+  {
+    pgfe::Result_cache short_cache{1024*1024, milliseconds{10}};
+    const auto execute = [&]
+    {
+      short_cache.execute(*conn, [](auto&&){}, "select 1");
+    };
+    execute();
+    execute();
+    ASSERT(short_cache.hit_count() == 1);
+    std::this_thread::sleep_for(milliseconds{20});
+    execute();
+    ASSERT(short_cache.hit_count() == 1 && short_cache.miss_count() == 2);
+  }
+
+  // Capacity.
+  {
+    pgfe::Result_cache small_cache{1024, milliseconds{60000}};
+    small_cache.execute(*conn, [](auto&&){},
+      "select repeat('x', 2048)");
+    ASSERT(small_cache.is_empty());
+    for (int i{}; i < 100; ++i)
+      small_cache.execute(*conn, [](auto&&){}, "select $1::int", i);
+    ASSERT(!small_cache.is_empty());
+    ASSERT(small_cache.memory_usage() <= small_cache.capacity());
+  }
+} catch (const std::exception& e) {
+  std::cerr << e.what() << std::endl;
+  return 1;
+} catch (...) {
+  std::cerr << "unknown error" << std::endl;
+  return 2;
+}
@@ -0,0 +1,97 @@
+// -*- C++ -*-
+//
+// Copyright 2023 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "pgfe-unit.hpp"
+
+#include <optional>
+#include <string>
+
+#define ASSERT DMITIGR_ASSERT
+
+int main()
+try {
+  namespace pgfe = dmitigr::pgfe;
+
+  auto conn = pgfe::test::make_connection();
+  conn->connect();
+
+  pgfe::Result_set rows;
+  ASSERT(rows.is_empty());
+  ASSERT(!rows.info());
+  ASSERT(!rows.field_count());
+
+  constexpr int row_count{1000};
+  rows.reserve(row_count, row_count*8);
+  conn->execute([&rows](auto&& row)
+  {
+    rows.append(row);
+  }, "select i id, 'row'||i str, nullif(i % 2, 0) odd"
+     " from generate_series(1, $1) i", row_count);
+  ASSERT(rows.row_count() == row_count);
+  ASSERT(rows.field_count() == 3);
+  ASSERT(rows.info().field_name(1) == "str");
+
+  // Random access.
+  ASSERT(pgfe::to<int>(rows.data(0)) == 1);
+  ASSERT(pgfe::to<std::string>(rows.data(99, "str")) == "row100");
+  ASSERT(!rows.data(99, "odd"));
+  ASSERT(pgfe::to<int>(rows.data(100, "odd")) == 1);
+  const auto row = rows[41];
+  ASSERT(row.index() == 41);
+  ASSERT(row.field_count() == 3);
+  ASSERT(pgfe::to<int>(row["id"]) == 42);
+  ASSERT(pgfe::to<std::string>(row[1]) == "row42");
+
+  // Typed column views.
+  {
+    int expected{1};
+    for (const auto id : rows.column<int>("id"))
+      ASSERT(id == expected++);
+    ASSERT(expected == row_count + 1);
+
+    const auto odd = rows.column<std::optional<int>>(2);
+    ASSERT(odd.size() == row_count);
+    ASSERT(odd[0] == 1);
+    ASSERT(!odd[1]);
+  }
+
+  // Incompatible rows are rejected.
+  bool is_thrown{};
+  try {
+    conn->execute([&rows](auto&& row)
+    {
+      rows.append(row);
+    }, "select 1::integer id");
+  } catch (const pgfe::Generic_exception&) {
+    is_thrown = true;
+  }
+  ASSERT(is_thrown);
+  ASSERT(rows.row_count() == row_count);
+
+  // The memory consumption is close to the size of the data.
+  rows.shrink_to_fit();
+  ASSERT(rows.memory_usage() < row_count * (3*(8 + 1) + 16) + 1024);
+
+  rows.clear();
+  ASSERT(rows.is_empty());
+  ASSERT(!rows.info());
+} catch (const std::exception& e) {
+  std::cerr << e.what() << std::endl;
+  return 1;
+} catch (...) {
+  std::cerr << "unknown error" << std::endl;
+  return 2;
+}
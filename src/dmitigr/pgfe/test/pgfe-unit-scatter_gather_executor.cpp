@@ -0,0 +1,104 @@
+// -*- C++ -*-
+//
+// Copyright 2023 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "pgfe-unit.hpp"
+
+#include <chrono>
+#include <vector>
+
+#define ASSERT DMITIGR_ASSERT
+
+int main()
+try {
+  namespace pgfe = dmitigr::pgfe;
+  using std::chrono::milliseconds;
+
+  pgfe::Connection_pool shard1{1, pgfe::test::connection_options()};
+  pgfe::Connection_pool shard2{1, pgfe::test::connection_options()};
+  pgfe::Connection_pool shard3{1, pgfe::test::connection_options()};
+  shard1.connect();
+  shard2.connect();
+  shard3.connect();
+
+  pgfe::Scatter_gather_executor executor{{shard1, shard2, shard3}};
+  ASSERT(executor.shard_count() == 3);
+  ASSERT(!executor.timeout());
+
+  // Success on all the shards.
+  {
+    std::vector<int> row_counts(executor.shard_count());
+    const auto results = executor.execute([&](const std::size_t shard, auto&& row)
+    {
+      ASSERT(pgfe::to<int>(row[0]) == ++row_counts[shard]);
+    }, "select generate_series(1, $1)", 100);
+    ASSERT(results.size() == executor.shard_count());
+    for (std::size_t i{}; i < results.size(); ++i) {
+      ASSERT(results[i].shard == i);
+      ASSERT(results[i].is_ok());
+      ASSERT(results[i].completion.tag() == "SELECT");
+      ASSERT(results[i].row_count == 100);
+      ASSERT(row_counts[i] == 100);
+    }
+  }
+
+  // Latency is the max rather than the sum.
+  {
+    const auto started = std::chrono::steady_clock::now();
+    const auto results = executor.execute([](auto, auto&&){},
+      "select pg_sleep(0.5)");
+    const auto elapsed = std::chrono::steady_clock::now() - started;
+    for (const auto& result : results)
+      ASSERT(result.is_ok());
+    ASSERT(elapsed < milliseconds{1000});
+  }
+
+  // Partial failure.
+  {
+    const auto results = executor.execute([](auto, auto&&){},
+      "select case when current_setting('application_name') = 'bad'"
+      " then 1/0 else 1 end");
+    for (const auto& result : results)
+      ASSERT(result.is_ok());
+
+    auto handle = shard2.connection();
+    handle->execute("set application_name to 'bad'");
+    handle.release();
+    const auto results2 = executor.execute([](auto, auto&&){},
+      "select case when current_setting('application_name') = 'bad'"
+      " then 1/0 else 1 end");
+    ASSERT(results2[0].is_ok());
+    ASSERT(!results2[1].is_ok());
+    ASSERT(results2[2].is_ok());
+  }
+
+  // Timeout.
+  {
+    executor.set_timeout(milliseconds{100});
+    ASSERT(executor.timeout() == milliseconds{100});
+    const auto results = executor.execute([](auto, auto&&){},
+      "select pg_sleep(10)");
+    for (const auto& result : results) {
+      ASSERT(!result.is_ok());
+      ASSERT(result.duration < milliseconds{1000});
+    }
+  }
+} catch (const std::exception& e) {
+  std::cerr << e.what() << std::endl;
+  return 1;
+} catch (...) {
+  std::cerr << "unknown error" << std::endl;
+  return 2;
+}
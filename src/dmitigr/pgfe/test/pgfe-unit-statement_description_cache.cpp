@@ -0,0 +1,98 @@
+// -*- C++ -*-
+//
+// Copyright 2023 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "pgfe-unit.hpp"
+
+#include <memory>
+
+#define ASSERT DMITIGR_ASSERT
+
+int main()
+try {
+  namespace pgfe = dmitigr::pgfe;
+
+  const auto cache = std::make_shared<pgfe::Statement_description_cache>();
+  ASSERT(cache->is_empty());
+  const pgfe::Statement query{"select $1::integer id, $2::text str"};
+
+  // The statement is described by the server and stored to the cache.
+  auto conn1 = pgfe::test::make_connection();
+  conn1->set_description_cache(cache);
+  ASSERT(conn1->description_cache() == cache);
+  conn1->connect();
+  auto ps1 = conn1->prepare(query, "ps");
+  ASSERT(!ps1.is_described());
+  ps1.describe();
+  ASSERT(ps1.is_described());
+  ASSERT(cache->size() == 1);
+
+  // The statement is described from the cache.
+  constexpr std::size_t pool_size{2};
+  pgfe::Connection_pool pool{pool_size, pgfe::test::connection_options()};
+  pool.set_description_cache(cache);
+  ASSERT(pool.description_cache() == cache);
+  pool.connect();
+  for (std::size_t i{}; i < pool_size; ++i) {
+    auto conn = pool.connection();
+    ASSERT(conn->description_cache() == cache);
+    auto ps = conn->prepare(query, "ps");
+    ASSERT(ps.is_described());
+    ASSERT(ps.parameter_count() == 2);
+    ASSERT(ps.parameter_type_oid(0) == ps1.parameter_type_oid(0));
+    ASSERT(ps.parameter_type_oid(1) == ps1.parameter_type_oid(1));
+    const auto& ri = ps.row_info();
+    ASSERT(ri.field_count() == 2);
+    ASSERT(ri.field_name(0) == "id");
+    ASSERT(ri.field_name(1) == "str");
+    ASSERT(ri.type_oid(0) == ps1.row_info().type_oid(0));
+    ASSERT(ri.type_oid(1) == ps1.row_info().type_oid(1));
+    ps.bind(0, 7).bind(1, "seven").execute([](auto&& row)
+    {
+      ASSERT(pgfe::to<int>(row["id"]) == 7);
+      ASSERT(pgfe::to<std::string>(row["str"]) == "seven");
+    });
+  }
+  ASSERT(cache->size() == 1);
+
+  // The statement without the result rows.
+  auto ps2 = conn1->prepare("set application_name to 'pgfe'", "ps2");
+  ps2.describe();
+  ASSERT(cache->size() == 2);
+  {
+    auto conn = pool.connection();
+    auto ps = conn->prepare("set application_name to 'pgfe'", "ps2");
+    ASSERT(ps.is_described());
+    ASSERT(!ps.row_info());
+    ASSERT(!ps.parameter_count());
+  }
+
+  // Invalidation.
+  ASSERT(cache->erase(query.to_query_string(*conn1)) == 1);
+  ASSERT(cache->size() == 1);
+  cache->clear();
+  ASSERT(cache->is_empty());
+  {
+    auto conn = pool.connection();
+    const auto ps = conn->prepare(query, "ps");
+    ASSERT(!ps.is_described());
+  }
+} catch (const std::exception& e) {
+  std::cerr << e.what() << std::endl;
+  return 1;
+} catch (...) {
+  std::cerr << "unknown error" << std::endl;
+  return 2;
+}
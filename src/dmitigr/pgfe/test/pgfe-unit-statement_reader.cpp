@@ -0,0 +1,87 @@
+// -*- C++ -*-
+//
+// Copyright 2023 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "pgfe-unit.hpp"
+
+int main(int, char* argv[])
+try {
+  namespace pgfe = dmitigr::pgfe;
+
+  // -------------------------------------------------------------------------
+  // String input
+  // -------------------------------------------------------------------------
+
+  {
+    pgfe::Statement_reader reader;
+    DMITIGR_ASSERT(reader.is_exhausted());
+    DMITIGR_ASSERT(!reader.next());
+  }
+
+  {
+    pgfe::Statement_reader reader{"SELECT 1; -- comment\n;SELECT ';'"};
+    DMITIGR_ASSERT(!reader.is_mapped());
+    DMITIGR_ASSERT(!reader.is_exhausted());
+    auto st = reader.next();
+    DMITIGR_ASSERT(st && st->to_string() == "SELECT 1");
+    st = reader.next();
+    DMITIGR_ASSERT(st && st->is_query_empty());
+    st = reader.next();
+    DMITIGR_ASSERT(st && st->to_string() == "SELECT ';'");
+    DMITIGR_ASSERT(reader.is_exhausted());
+    DMITIGR_ASSERT(reader.position() == reader.size());
+    DMITIGR_ASSERT(!reader.next());
+    reader.rewind();
+    DMITIGR_ASSERT(!reader.position());
+    DMITIGR_ASSERT(reader.next()->to_string() == "SELECT 1");
+  }
+
+  // -------------------------------------------------------------------------
+  // Mapped file input
+  // -------------------------------------------------------------------------
+
+  const std::filesystem::path this_exe_file_name{argv[0]};
+  const auto this_exe_dir_name = this_exe_file_name.parent_path();
+  auto reader = pgfe::Statement_reader::from_file(this_exe_dir_name /
+    "pgfe-unit-statement_vector.sql");
+  DMITIGR_ASSERT(reader.is_mapped());
+  DMITIGR_ASSERT(reader.size() > 0);
+  const pgfe::Statement_vector bunch{reader.input()};
+  std::size_t count{};
+  while (const auto st = reader.next()) {
+    DMITIGR_ASSERT(count < bunch.size());
+    DMITIGR_ASSERT(st->to_string() == bunch[count].to_string());
+    ++count;
+  }
+  DMITIGR_ASSERT(count == bunch.size());
+
+  pgfe::Statement_reader moved{std::move(reader)};
+  DMITIGR_ASSERT(moved.is_mapped() && moved.is_exhausted());
+  DMITIGR_ASSERT(!reader.is_mapped() && !reader.size());
+
+  bool is_thrown{};
+  try {
+    pgfe::Statement_reader::from_file(this_exe_dir_name / "nonexistent.sql");
+  } catch (const pgfe::Generic_exception&) {
+    is_thrown = true;
+  }
+  DMITIGR_ASSERT(is_thrown);
+} catch (const std::exception& e) {
+  std::cerr << e.what() << std::endl;
+  return 1;
+} catch (...) {
+  std::cerr << "unknown error" << std::endl;
+  return 2;
+}
@@ -38,8 +38,10 @@ enum class Data_direction;
 enum class Data_format;
 enum class External_library;
 enum class Password_encryption;
+enum class Pgoutput_message_type : char;
 enum class Pipeline_status;
 enum class Problem_severity;
+enum class Replication_mode;
 enum class Response_status;
 enum class Row_processing;
 enum class Socket_readiness;
@@ -67,23 +69,35 @@ class Connection;
 class Connection_options;
 class Connection_pool;
 class Copier;
+class Copy_loader;
+class Cursor;
 class Data;
 class Data_view;
+class Deadline_guard;
 class Error;
 class Large_object;
 class Message;
 class Notice;
 class Notification;
+class Parallel_row_processor;
 class Parameterizable;
+class Pgoutput_message;
 class Prepared_statement;
 class Named_argument;
 class Problem;
 class Ready_for_query;
+class Record_view;
+class Replication_stream;
 class Response;
+class Result_cache;
+class Result_set;
 class Row;
 class Row_info;
+class Scatter_gather_executor;
 class Signal;
 class Statement;
+class Statement_description_cache;
+class Statement_reader;
 class Statement_vector;
 class Transaction_guard;
 class Tuple;
@@ -94,6 +108,10 @@ class Generic_error_category;
 class Sqlstate_exception;
 class Sqlstate_error_category;
 
+struct Connection_stats;
+struct Pgoutput_column;
+struct Pgoutput_value;
+
 template<typename> struct Conversions;
 
 /// The implementation details.